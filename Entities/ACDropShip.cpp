@@ -1208,6 +1208,7 @@ void ACDropShip::Draw(BITMAP *pTargetBitmap,
         putpixel(pTargetBitmap, floorf(m_Pos.m_X),
                               floorf(m_Pos.m_Y),
                               64);
+        g_SceneMan.RegisterMOColorDrawing(pTargetBitmap, floorf(m_Pos.m_X), floorf(m_Pos.m_Y), floorf(m_Pos.m_X), floorf(m_Pos.m_Y));
         release_bitmap(pTargetBitmap);
 
         m_pAtomGroup->Draw(pTargetBitmap, targetPos, false, 122);
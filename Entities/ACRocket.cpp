@@ -1274,6 +1274,7 @@ void ACRocket::Draw(BITMAP *pTargetBitmap,
         putpixel(pTargetBitmap, floorf(m_Pos.m_X),
                               floorf(m_Pos.m_Y),
                               64);
+        g_SceneMan.RegisterMOColorDrawing(pTargetBitmap, floorf(m_Pos.m_X), floorf(m_Pos.m_Y), floorf(m_Pos.m_X), floorf(m_Pos.m_Y));
         release_bitmap(pTargetBitmap);
 
         m_pRFootGroup->Draw(pTargetBitmap, targetPos, true, 13);
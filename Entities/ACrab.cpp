@@ -88,6 +88,7 @@ void ACrab::Clear()
     m_JumpingRight = true;
     m_DigTunnelEndPos.Reset();
     m_SweepCenterAimAngle = 0;
+    m_LookRayID = -1;
     m_SweepRange = EigthPI;
     m_DigTarget.Reset();
     m_FireTimer.Reset();
@@ -939,8 +940,52 @@ bool ACrab::Look(float FOVSpread, float range)
 
 MovableObject * ACrab::LookForMOs(float FOVSpread, unsigned char ignoreMaterial, bool ignoreAllTerrain)
 {
-    MovableObject *pSeenMO = 0;
-    Vector aimPos = m_Pos;
+    Vector aimPos;
+    Vector lookVector;
+    GetLookRay(FOVSpread, aimPos, lookVector);
+
+    MOID seenMOID = g_SceneMan.CastMORay(aimPos, lookVector, m_MOID, IgnoresWhichTeam(), ignoreMaterial, ignoreAllTerrain, 5);
+    MovableObject *pSeenMO = g_MovableMan.GetMOFromID(seenMOID);
+    if (pSeenMO)
+        return pSeenMO->GetRootParent();
+
+    return pSeenMO;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          LookForMOsBatched
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Like LookForMOs, but queues the ray with SceneMan's ray batch instead
+//                  of casting it right away, and reports what the ray queued by the
+//                  previous call saw.
+
+MovableObject * ACrab::LookForMOsBatched(float FOVSpread, unsigned char ignoreMaterial, bool ignoreAllTerrain)
+{
+    // The batch has been cast at the start of this frame's MO updates, so the MOID is still valid
+    MovableObject *pSeenMO = g_MovableMan.GetMOFromID(g_SceneMan.GetBatchedRayMOID(m_LookRayID));
+
+    Vector aimPos;
+    Vector lookVector;
+    GetLookRay(FOVSpread, aimPos, lookVector);
+    m_LookRayID = g_SceneMan.QueueMORay(aimPos, lookVector, this, IgnoresWhichTeam(), ignoreMaterial, ignoreAllTerrain, 5);
+
+    if (pSeenMO)
+        return pSeenMO->GetRootParent();
+
+    return pSeenMO;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetLookRay
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Works out the ray LookForMOs casts, from where this is looking at the
+//                  time, with a random spread added.
+
+void ACrab::GetLookRay(float FOVSpread, Vector &aimPos, Vector &lookVector)
+{
+    aimPos = m_Pos;
     float aimDistance = m_AimDistance + g_FrameMan.GetPlayerScreenWidth() * 0.51;   // Set the length of the look vector
 
     // If aiming down the barrel, look through that
@@ -957,20 +1002,13 @@ MovableObject * ACrab::LookForMOs(float FOVSpread, unsigned char ignoreMaterial,
         aimPos = GetCPUPos();
 
     // Create the vector to trace along
-    Vector lookVector(aimDistance, 0);
+    lookVector.SetXY(aimDistance, 0);
     // Set the rotation to the actual aiming angle
     Matrix aimMatrix(m_HFlipped ? -m_AimAngle : m_AimAngle);
     aimMatrix.SetXFlipped(m_HFlipped);
     lookVector *= aimMatrix;
     // Add the spread
     lookVector.DegRotate(FOVSpread * NormalRand());
-
-    MOID seenMOID = g_SceneMan.CastMORay(aimPos, lookVector, m_MOID, IgnoresWhichTeam(), ignoreMaterial, ignoreAllTerrain, 5);
-    pSeenMO = g_MovableMan.GetMOFromID(seenMOID);
-    if (pSeenMO)
-        return pSeenMO->GetRootParent();
-
-    return pSeenMO;
 }
 
 
@@ -1415,7 +1453,7 @@ void ACrab::UpdateAI()
         }
 */
         // Narrow FOV range scan, 10 degrees each direction
-        pSeenMO = LookForMOs(10, g_MaterialGrass, false);
+        pSeenMO = LookForMOsBatched(10, g_MaterialGrass, false);
         // Saw something!
         if (pSeenMO)
         {
@@ -1628,7 +1666,7 @@ void ACrab::UpdateAI()
             m_ControlStates[AIM_DOWN] = true;
 */
         // Wide FOV range scan, 25 degrees each direction
-        pSeenMO = LookForMOs(25, g_MaterialGrass, false);
+        pSeenMO = LookForMOsBatched(25, g_MaterialGrass, false);
         // Saw something!
         if (pSeenMO)
         {
@@ -1661,7 +1699,7 @@ void ACrab::UpdateAI()
         m_ControlStates[aimAngleDiff > 0 ? AIM_UP : AIM_DOWN] = true;
 */
         // Narrow focused FOV range scan
-        pSeenMO = LookForMOs(10, g_MaterialGrass, false);
+        pSeenMO = LookForMOsBatched(10, g_MaterialGrass, false);
 
         // Saw the enemy actor again through the sights!
         if (pSeenMO)
@@ -1715,7 +1753,7 @@ void ACrab::UpdateAI()
         m_Controller.m_AnalogAim.CapMagnitude(1.0);
 
         // Narrow focused FOV range scan
-        pSeenMO = LookForMOs(8, g_MaterialGrass, false);
+        pSeenMO = LookForMOsBatched(8, g_MaterialGrass, false);
         // Still seeing enemy actor through the sights, keep firing!
         if (pSeenMO)
             pSeenActor = dynamic_cast<Actor *>(pSeenMO->GetRootParent());
@@ -3145,6 +3183,7 @@ void ACrab::Draw(BITMAP *pTargetBitmap,
         putpixel(pTargetBitmap, floorf(m_Pos.m_X),
                               floorf(m_Pos.m_Y),
                               64);
+        g_SceneMan.RegisterMOColorDrawing(pTargetBitmap, floorf(m_Pos.m_X), floorf(m_Pos.m_Y), floorf(m_Pos.m_X), floorf(m_Pos.m_Y));
         release_bitmap(pTargetBitmap);
 
         m_pAtomGroup->Draw(pTargetBitmap, targetPos, false, 122);
@@ -517,6 +517,19 @@ ENTITYALLOCATION(ACrab)
     virtual MovableObject * LookForMOs(float FOVSpread = 45, unsigned char ignoreMaterial = 0, bool ignoreAllTerrain = false);
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          LookForMOsBatched
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Like LookForMOs, but queues the ray with SceneMan's ray batch instead
+//                  of casting it right away, and reports what the ray queued by the
+//                  previous call saw. For the per-frame AI, where a frame's delay in what
+//                  is seen doesn't matter.
+// Arguments:       The same as for LookForMOs.
+// Return value:    A pointer to the MO seen by the previously queued ray, if any.
+
+    MovableObject * LookForMOsBatched(float FOVSpread = 45, unsigned char ignoreMaterial = 0, bool ignoreAllTerrain = false);
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Virtual method:  GibThis
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -820,6 +833,8 @@ protected:
     Timer m_PatrolTimer;
     // Timer for how long to be firing the jetpack in a direction
     Timer m_JumpTimer;
+    // The ID of the sensing ray last queued by LookForMOsBatched, or -1 if none
+    int m_LookRayID;
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -837,6 +852,18 @@ private:
 
     void Clear();
 
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetLookRay
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Works out the ray LookForMOs casts, from where this is looking at the
+//                  time, with a random spread added.
+// Arguments:       The degree angle to deviate from the current view point.
+//                  Vectors to be filled out with the start and the trace vector of the ray.
+// Return value:    None.
+
+    void GetLookRay(float FOVSpread, Vector &aimPos, Vector &lookVector);
+
     // Disallow the use of some implicit methods.
     ACrab(const ACrab &reference);
     ACrab & operator=(const ACrab &rhs);
@@ -91,6 +91,7 @@ void AHuman::Clear()
     m_Crawling = false;
     m_DigTunnelEndPos.Reset();
     m_SweepCenterAimAngle = 0;
+    m_LookRayID = -1;
     m_SweepRange = EigthPI;
     m_DigTarget.Reset();
     m_FireTimer.Reset();
@@ -1704,8 +1705,52 @@ bool AHuman::LookForGold(float FOVSpread, float range, Vector &foundLocation)
 
 MovableObject * AHuman::LookForMOs(float FOVSpread, unsigned char ignoreMaterial, bool ignoreAllTerrain)
 {
-    MovableObject *pSeenMO = 0;
-    Vector aimPos = m_Pos;
+    Vector aimPos;
+    Vector lookVector;
+    GetLookRay(FOVSpread, aimPos, lookVector);
+
+    MOID seenMOID = g_SceneMan.CastMORay(aimPos, lookVector, m_MOID, IgnoresWhichTeam(), ignoreMaterial, ignoreAllTerrain, 5);
+    MovableObject *pSeenMO = g_MovableMan.GetMOFromID(seenMOID);
+    if (pSeenMO)
+        return pSeenMO->GetRootParent();
+
+    return pSeenMO;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          LookForMOsBatched
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Like LookForMOs, but queues the ray with SceneMan's ray batch instead
+//                  of casting it right away, and reports what the ray queued by the
+//                  previous call saw.
+
+MovableObject * AHuman::LookForMOsBatched(float FOVSpread, unsigned char ignoreMaterial, bool ignoreAllTerrain)
+{
+    // The batch has been cast at the start of this frame's MO updates, so the MOID is still valid
+    MovableObject *pSeenMO = g_MovableMan.GetMOFromID(g_SceneMan.GetBatchedRayMOID(m_LookRayID));
+
+    Vector aimPos;
+    Vector lookVector;
+    GetLookRay(FOVSpread, aimPos, lookVector);
+    m_LookRayID = g_SceneMan.QueueMORay(aimPos, lookVector, this, IgnoresWhichTeam(), ignoreMaterial, ignoreAllTerrain, 5);
+
+    if (pSeenMO)
+        return pSeenMO->GetRootParent();
+
+    return pSeenMO;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetLookRay
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Works out the ray LookForMOs casts, from where this is looking at the
+//                  time, with a random spread added.
+
+void AHuman::GetLookRay(float FOVSpread, Vector &aimPos, Vector &lookVector)
+{
+    aimPos = m_Pos;
     float aimDistance = m_AimDistance + g_FrameMan.GetPlayerScreenWidth() * 0.51;   // Set the length of the look vector
 
     // If aiming down the barrel, look through that
@@ -1721,20 +1766,13 @@ MovableObject * AHuman::LookForMOs(float FOVSpread, unsigned char ignoreMaterial
     }
 
     // Create the vector to trace along
-    Vector lookVector(aimDistance, 0);
+    lookVector.SetXY(aimDistance, 0);
     // Set the rotation to the actual aiming angle
     Matrix aimMatrix(m_HFlipped ? -m_AimAngle : m_AimAngle);
     aimMatrix.SetXFlipped(m_HFlipped);
     lookVector *= aimMatrix;
     // Add the spread
     lookVector.DegRotate(FOVSpread * NormalRand());
-
-    MOID seenMOID = g_SceneMan.CastMORay(aimPos, lookVector, m_MOID, IgnoresWhichTeam(), ignoreMaterial, ignoreAllTerrain, 5);
-    pSeenMO = g_MovableMan.GetMOFromID(seenMOID);
-    if (pSeenMO)
-        return pSeenMO->GetRootParent();
-
-    return pSeenMO;
 }
 
 
@@ -2202,7 +2240,7 @@ void AHuman::UpdateAI()
         }
 */
         // Narrow FOV range scan, 10 degrees each direction
-        pSeenMO = LookForMOs(10, g_MaterialGrass, false);
+        pSeenMO = LookForMOsBatched(10, g_MaterialGrass, false);
         // Saw something!
         if (pSeenMO)
         {
@@ -2441,7 +2479,7 @@ void AHuman::UpdateAI()
             m_ControlStates[AIM_DOWN] = true;
 */
         // Wide FOV range scan, 25 degrees each direction
-        pSeenMO = LookForMOs(25, g_MaterialGrass, false);
+        pSeenMO = LookForMOsBatched(25, g_MaterialGrass, false);
         // Saw something!
         if (pSeenMO)
         {
@@ -2499,7 +2537,7 @@ void AHuman::UpdateAI()
         m_ControlStates[aimAngleDiff > 0 ? AIM_UP : AIM_DOWN] = true;
 */
         // Narrow focused FOV range scan
-        pSeenMO = LookForMOs(10, g_MaterialGrass, false);
+        pSeenMO = LookForMOsBatched(10, g_MaterialGrass, false);
 
         // Saw the enemy actor again through the sights!
         if (pSeenMO)
@@ -2572,7 +2610,7 @@ void AHuman::UpdateAI()
         m_Controller.m_AnalogAim.CapMagnitude(1.0);
 
         // Narrow focused FOV range scan
-        pSeenMO = LookForMOs(8, g_MaterialGrass, false);
+        pSeenMO = LookForMOsBatched(8, g_MaterialGrass, false);
         // Still seeing enemy actor through the sights, keep firing!
         if (pSeenMO)
             pSeenActor = dynamic_cast<Actor *>(pSeenMO->GetRootParent());
@@ -2606,7 +2644,7 @@ void AHuman::UpdateAI()
         m_Controller.m_AnalogAim.CapMagnitude(1.0);
 
         // Narrow focused FOV range scan
-        pSeenMO = LookForMOs(18, g_MaterialGrass, false);
+        pSeenMO = LookForMOsBatched(18, g_MaterialGrass, false);
         // Still seeing enemy actor through the sights, keep aiming the throw!
         if (pSeenMO)
             pSeenActor = dynamic_cast<Actor *>(pSeenMO->GetRootParent());
@@ -4767,6 +4805,7 @@ void AHuman::Draw(BITMAP *pTargetBitmap,
         putpixel(pTargetBitmap, floorf(m_Pos.m_X),
                               floorf(m_Pos.m_Y),
                               64);
+        g_SceneMan.RegisterMOColorDrawing(pTargetBitmap, floorf(m_Pos.m_X), floorf(m_Pos.m_Y), floorf(m_Pos.m_X), floorf(m_Pos.m_Y));
         release_bitmap(pTargetBitmap);
 
 //        m_pAtomGroup->Draw(pTargetBitmap, targetPos, false, 122);
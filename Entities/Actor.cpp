@@ -33,6 +33,11 @@
 #include "GUI/GUIFont.h"
 #include "GUI/AllegroBitmap.h"
 
+extern "C"
+{
+  #include "lauxlib.h"
+}
+
 using namespace std;
 namespace RTE
 {
@@ -116,6 +121,7 @@ void Actor::Clear()
 	m_DeploymentID = 0;
 
     m_ScriptedAIUpdate = false;
+    m_ScriptThrottled = false;
     m_AIMode = AIMODE_NONE;
     m_Waypoints.clear();
     m_DrawWaypoints = false;
@@ -125,6 +131,8 @@ void Actor::Clear()
     m_MoveVector.Reset();
     m_MovePath.clear();
     m_UpdateMovePath = true;
+    m_PathRequestID = -1;
+    m_PathRequestTarget.Reset();
     m_MoveProximityLimit = 100;
     m_LateralMoveState = LAT_STILL;
     m_MoveOvershootTimer.Reset();
@@ -480,6 +488,10 @@ int Actor::Save(Writer &writer) const
 
 void Actor::Destroy(bool notInherited)
 {
+    // Nobody is going to pick up the path anymore
+    if (m_PathRequestID >= 0 && g_SceneMan.GetScene())
+        g_SceneMan.GetScene()->CancelPathRequest(m_PathRequestID);
+
     for (deque<MovableObject *>::const_iterator itr = m_Inventory.begin(); itr != m_Inventory.end(); ++itr)
         delete (*itr);
 
@@ -1222,33 +1234,78 @@ MOID Actor::GetAIMOWaypointID()
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
-// Method:          UpdateMovePath
+// Method:          CalculateMovePath
 //////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Updates the path to move along to the currently set movetarget.
+// Description:     Works out a new move path from the ground under this to a target, with
+//                  this' team's doors open.
 
-bool Actor::UpdateMovePath()
+bool Actor::CalculateMovePath(const Vector &target)
 {
-    // TODO: Do throttling of calls for this function over time??
+    Scene *pScene = g_SceneMan.GetScene();
+    // Make sure the path starts from the ground and not somewhere up in the air if/when dropped out of ship
+    Vector start = g_SceneMan.MovePointToGround(m_Pos, m_CharHeight*0.2, 10);
 
+    // Have the background path worker figure it out, so the frame isn't held up
+    if (g_SettingsMan.AsyncPathFinding())
+    {
+        m_PathRequestID = pScene->RequestPath(start, target, m_DigStrenght, m_Team);
+        m_PathRequestTarget = target;
+        if (m_PathRequestID >= 0)
+            return false;
+    }
 
     // Remove the material representation of all doors of this guy's team so he can navigate through them (they'll open for him)
     g_MovableMan.OverrideMaterialDoors(true, m_Team);
     // Update the pathfinding with any changes to doors' material representations
-    g_SceneMan.GetScene()->UpdatePathFinding();
+    pScene->UpdatePathFinding();
+
+    pScene->CalculatePath(start, target, m_MovePath, m_DigStrenght);
+
+    // Place back the material representation of all doors of this guy's team so they are as we found them
+    g_MovableMan.OverrideMaterialDoors(false, m_Team);
+    // Update the pathfinding with any changes to doors' material representations
+    pScene->UpdatePathFinding();
+
+    return true;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          UpdateMovePath
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Updates the path to move along to the currently set movetarget.
 
+bool Actor::UpdateMovePath()
+{
+    // TODO: Do throttling of calls for this function over time??
+
+    // Still waiting on a path from the background, so keep following the old one until it's done
+    if (m_PathRequestID >= 0)
+    {
+        float pathCost = g_SceneMan.GetScene()->TakePathResult(m_PathRequestID, m_MovePath);
+        if (pathCost == -2)
+            return false;
+        m_PathRequestID = -1;
+        // The request got lost along with the pathfinding data, so ask again
+        if (pathCost == -3 && !CalculateMovePath(m_PathRequestTarget))
+            return false;
+    }
     // If we're following someone/thing, then never advance waypoints until that thing disappears
-    if (g_MovableMan.ValidMO(m_pMOMoveTarget))
-        g_SceneMan.GetScene()->CalculatePath(g_SceneMan.MovePointToGround(m_Pos, m_CharHeight*0.2, 10), m_pMOMoveTarget->GetPos(), m_MovePath, m_DigStrenght);
+    else if (g_MovableMan.ValidMO(m_pMOMoveTarget))
+    {
+        if (!CalculateMovePath(m_pMOMoveTarget->GetPos()))
+            return false;
+    }
     else
     {
+        Vector target;
         // Do we currently have a path to a static target we would like to still pursue?
         if (m_MovePath.empty())
         {
             // Ok no path going, so get a new path to the next waypoint, if there is a next waypoint
             if (!m_Waypoints.empty())
             {
-                // Make sure the path starts from the ground and not somewhere up in the air if/when dropped out of ship
-                g_SceneMan.GetScene()->CalculatePath(g_SceneMan.MovePointToGround(m_Pos, m_CharHeight*0.2, 10), m_Waypoints.front().first, m_MovePath, m_DigStrenght);
+                target = m_Waypoints.front().first;
                 // If the waypoint was tied to an MO to pursue, then load it into the current MO target
                 if (g_MovableMan.ValidMO(m_Waypoints.front().second))
                     m_pMOMoveTarget = m_Waypoints.front().second;
@@ -1259,17 +1316,15 @@ bool Actor::UpdateMovePath()
             }
             // Just try to get to the last Move Target
             else
-                g_SceneMan.GetScene()->CalculatePath(g_SceneMan.MovePointToGround(m_Pos, m_CharHeight*0.2, 10), m_MoveTarget, m_MovePath, m_DigStrenght);
+                target = m_MoveTarget;
         }
         // We had a path before trying to update, so use its last point as the final destination
         else
-            g_SceneMan.GetScene()->CalculatePath(g_SceneMan.MovePointToGround(m_Pos, m_CharHeight*0.2, 10), Vector(m_MovePath.back()), m_MovePath, m_DigStrenght);
-    }
+            target = m_MovePath.back();
 
-    // Place back the material representation of all doors of this guy's team so they are as we found them
-    g_MovableMan.OverrideMaterialDoors(false, m_Team);
-    // Update the pathfinding with any changes to doors' material representations
-    g_SceneMan.GetScene()->UpdatePathFinding();
+        if (!CalculateMovePath(target))
+            return false;
+    }
 
     // Process the new path we now have, if any
     if (!m_MovePath.empty())
@@ -1318,8 +1373,15 @@ bool Actor::UpdateAIScripted()
 
     int error = 0;
 
+    // If the Lua state was re-created since this' representation was made in it, that is gone and has to be made again
+    if (!m_ScriptObjectName.empty() && m_ScriptStateGeneration != g_LuaMan.GetStateGeneration())
+    {
+        m_ScriptObjectName.clear();
+        m_ScriptObjectRef = LUA_NOREF;
+    }
+
     // Check to make sure the preset of this is still defined in the Lua state. If not, re-create it and recover gracefully
-    if (!g_LuaMan.ExpressionIsTrue(m_ScriptPresetName, false))
+    if (!g_LuaMan.PathIsDefined(m_ScriptPresetName))
         ReloadScripts();
 
     // First see if we even have a representation stored in the Lua state, and if not, create one
@@ -1333,16 +1395,19 @@ bool Actor::UpdateAIScripted()
         // Create the Lua variable which will hold the object instance of this instance for as long as it exists
         if ((error = g_LuaMan.RunScriptString(m_ScriptObjectName + " = To" + GetClassName() + "(MovableMan.ScriptedEntity);")) < 0)
             return false;
+        // Keep a direct reference to it so the preset functions can be called without compiling any strings
+        m_ScriptObjectRef = g_LuaMan.CreateObjectReference(m_ScriptObjectName);
+        m_ScriptStateGeneration = g_LuaMan.GetStateGeneration();
 
-        // Call the scripted creation function, but only after first checking if it and this instance's Lua representation really exists
-        if ((error = g_LuaMan.RunScriptString("if " + m_ScriptPresetName + ".Create and " + m_ScriptObjectName + " then " + m_ScriptPresetName + ".Create(" + m_ScriptObjectName + "); end")) < 0)
+        // Call the scripted creation function, if it and this instance's Lua representation really exist
+        if ((error = g_LuaMan.CallPresetFunction(m_ScriptPresetName, LuaMan::PRESET_CREATE, m_ScriptObjectRef)) < 0)
             return false;
     }
 
-    // Call the defined function, but only after first checking if it and this instance's Lua representation exists
+    // Call the defined function, if it and this instance's Lua representation exist
 
 	g_FrameMan.StartPerformanceMeasurement(FrameMan::PERF_ACTORS_AI);
-	error = g_LuaMan.RunScriptString("if " + m_ScriptPresetName + ".UpdateAI and " + m_ScriptObjectName + " then " + m_ScriptPresetName + ".UpdateAI(" + m_ScriptObjectName + "); end");
+	error = g_LuaMan.CallPresetFunction(m_ScriptPresetName, LuaMan::PRESET_UPDATEAI, m_ScriptObjectRef);
 	g_FrameMan.StopPerformanceMeasurement(FrameMan::PERF_ACTORS_AI);
 
     if (error < 0)
@@ -1353,6 +1418,26 @@ bool Actor::UpdateAIScripted()
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          UpdateScriptThrottled
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Updates this' Lua script like UpdateScript, unless no player controls
+//                  this and the Lua script time budget of this sim update is used up.
+
+int Actor::UpdateScriptThrottled()
+{
+    if (!m_ScriptThrottled && !m_ScriptPath.empty() && !IsPlayerControlled() && g_LuaMan.ScriptBudgetExceeded())
+    {
+        m_ScriptThrottled = true;
+        g_LuaMan.AddThrottledScript();
+        return 0;
+    }
+
+    m_ScriptThrottled = false;
+    return UpdateScript();
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Virtual method:  UpdateAI
 //////////////////////////////////////////////////////////////////////////////////////////
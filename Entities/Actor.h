@@ -1144,7 +1144,9 @@ ENTITYALLOCATION(Actor)
 //                  current waypoint, if any. CAVEAT: this only actually updates if a queue
 //                  index number passed in is sufficiently close to 0 to allow this to
 //                  compute, based on an internal global assessment of how often this very
-//                  expensive computation is allowed to run.
+//                  expensive computation is allowed to run. With AsyncPathFinding on, the
+//                  path is worked out in the background and this keeps returning false,
+//                  with the old path left in place, until it's done.
 // Arguments:       The queue number this was given the last time
 // Return value:    Whether the update was performed, or if it should be tried again next
 //                  frame.
@@ -1152,6 +1154,19 @@ ENTITYALLOCATION(Actor)
     virtual bool UpdateMovePath();
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CalculateMovePath
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Works out a new move path from the ground under this to a target, with
+//                  this' team's doors open. Asks the background path worker for it if
+//                  AsyncPathFinding is on, or calculates it on the spot otherwise.
+// Arguments:       The target to path to.
+// Return value:    Whether m_MovePath now holds the new path. If not, it will be picked
+//                  up by a later UpdateMovePath.
+
+    bool CalculateMovePath(const Vector &target);
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Virtual method:  UpdateAIScripted
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1163,6 +1178,20 @@ ENTITYALLOCATION(Actor)
     virtual bool UpdateAIScripted();
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          UpdateScriptThrottled
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Updates this' Lua script like UpdateScript, unless no player controls
+//                  this and the Lua script time budget of this sim update is used up.
+//                  Then the script update waits for the next sim update, but it never
+//                  waits two in a row.
+// Arguments:       None.
+// Return value:    An error return value signaling sucess or any particular failure.
+//                  Anything below 0 is an error signal.
+
+    int UpdateScriptThrottled();
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Virtual method:  UpdateAI
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1475,6 +1504,8 @@ protected:
     static bool m_sIconsLoaded;
     // Whether a Lua update AI function was provided in this' script file
     bool m_ScriptedAIUpdate;
+    // Whether the script update was skipped during the last sim update to keep within the Lua time budget
+    bool m_ScriptThrottled;
     // The current mode the AI is set to perform as
     AIMode m_AIMode;
     // The list of waypoints remaining between which the paths are made. If this is empty, the last path is in teh MovePath
@@ -1494,6 +1525,9 @@ protected:
     std::list<Vector> m_MovePath;
     // Whether it's time to update the path
     bool m_UpdateMovePath;
+    // The ID of the path being worked out in the background, or -1 if none, and where it leads
+    int m_PathRequestID;
+    Vector m_PathRequestTarget;
     // The minimum range to consider having reached a move target is considered
     float m_MoveProximityLimit;
     // Whether the AI is trying to progress to the right, left, or stand still
@@ -686,6 +686,8 @@ void Arm::DrawHand(BITMAP *pTargetBitmap,
         draw_sprite(pTargetBitmap, m_pHand, handPos.m_X, handPos.m_Y);
     else
         draw_sprite_h_flip(pTargetBitmap, m_pHand, handPos.m_X, handPos.m_Y);
+
+    g_SceneMan.RegisterMOColorDrawing(pTargetBitmap, handPos.m_X, handPos.m_Y, (int)handPos.m_X + m_pHand->w, (int)handPos.m_Y + m_pHand->h);
 /*
 #ifdef _DEBUG
     if (m_PresetName == "Player BG Arm") {
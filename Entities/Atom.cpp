@@ -25,7 +25,7 @@ namespace RTE
 {
 
 const string Atom::ClassName = "Atom";
-std::vector<void *> Atom::m_AllocatedPool;
+SlabAllocator Atom::m_SlabAllocator;
 int Atom::m_PoolAllocBlockCount = 200;
 int Atom::m_InstancesInUse = 0;
 
@@ -111,13 +111,11 @@ void Atom::FillPool(int fillAmount)
     if (fillAmount <= 0)
         fillAmount = m_PoolAllocBlockCount;
 
-    // If concrete class, fill up the pool with pre-allocated memory blocks the size of the type
-    if (fillAmount > 0)
-    {
-        // As many as we're asked to make
-        for (int i = 0; i < fillAmount; ++i)
-            m_AllocatedPool.push_back(malloc(sizeof(Atom)));
-    }
+    if (!m_SlabAllocator.IsCreated())
+        m_SlabAllocator.Create(sizeof(Atom), m_PoolAllocBlockCount);
+
+    // Make sure there are at least as many free in the slabs as asked for
+    m_SlabAllocator.Reserve(fillAmount);
 }
 
 
@@ -129,13 +127,11 @@ void Atom::FillPool(int fillAmount)
 
 void * Atom::GetPoolMemory()
 {
-    // If the pool is empty, then fill it up again with as many instances as we are set to
-    if (m_AllocatedPool.empty())
-        FillPool(m_PoolAllocBlockCount > 0 ? m_PoolAllocBlockCount : 10);
+    if (!m_SlabAllocator.IsCreated())
+        m_SlabAllocator.Create(sizeof(Atom), m_PoolAllocBlockCount);
 
-    // Get the instance in the top of the pool and pop it off
-    void *pFoundMemory = m_AllocatedPool.back();
-    m_AllocatedPool.pop_back();
+    // Makes a new slab if all are in use
+    void *pFoundMemory = m_SlabAllocator.Allocate();
 
     DAssert(pFoundMemory, "Could not find an available instance in the pool, even after increasing its size!");
 
@@ -156,7 +152,10 @@ int Atom::ReturnPoolMemory(void *pReturnedMemory)
     if (!pReturnedMemory)
         return false;
 
-    m_AllocatedPool.push_back(pReturnedMemory);
+    bool returned = m_SlabAllocator.Deallocate(pReturnedMemory);
+    DAssert(returned, "Returned memory to the Atom pool that didn't come from it!");
+    // Only read by the assert, which isn't there in release builds
+    (void)returned;
 
     // Keep track of the number of instaces passed in
     m_InstancesInUse--;
@@ -165,6 +164,20 @@ int Atom::ReturnPoolMemory(void *pReturnedMemory)
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   DumpPoolMemoryInfo
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Writes the instances in use and slab occupancy of the Atom pool to a
+//                  file.
+
+void Atom::DumpPoolMemoryInfo(Writer &fileWriter)
+{
+    fileWriter << "Atom: " << m_InstancesInUse << ", Peak: " << m_SlabAllocator.GetPeakChunksInUse();
+    m_SlabAllocator.DumpInfo(fileWriter);
+    fileWriter << "\n";
+}
+
+
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          Clear
@@ -1214,7 +1227,10 @@ int Atom::Travel(float travelTime,
 
 #ifdef _DEBUG
                 if (m_TrailLength)
+                {
                     putpixel(pTrailBitmap, intPos[X], intPos[Y], 199);
+                    g_SceneMan.RegisterMOColorDrawing(pTrailBitmap, intPos[X], intPos[Y], intPos[X], intPos[Y]);
+                }
 #endif
                 // Try penetration of the terrain.
                 if (hitMaterial->id != g_MaterialOutOfBounds &&
@@ -1360,12 +1376,27 @@ int Atom::Travel(float travelTime,
     // Draw the trail
     if (g_TimerMan.DrawnSimUpdate() && m_TrailLength) {
         int length = m_TrailLength/* + 3 * PosRand()*/;
-        for (int i = trailPoints.size() - DMin(length, trailPoints.size()); i < trailPoints.size(); ++i)
+        int start = trailPoints.size() - DMin(length, trailPoints.size());
+        for (int i = start; i < trailPoints.size(); ++i)
         {
 //            DAssert(is_inside_bitmap(pTrailBitmap, trailPoints[i].first, trailPoints[i].second, 0), "Trying to draw out of bounds trail!");
 //            _putpixel(pTrailBitmap, trailPoints[i].first, trailPoints[i].second, m_TrailColor.GetIndex());
             putpixel(pTrailBitmap, trailPoints[i].first, trailPoints[i].second, m_TrailColor.GetIndex());
         }
+
+        // Register the trail in short stretches, so a long diagonal one doesn't make a huge box to clear
+        for (int i = start; i < trailPoints.size(); i += 16)
+        {
+            int left = trailPoints[i].first, right = left, top = trailPoints[i].second, bottom = top;
+            for (int j = i + 1; j < trailPoints.size() && j < i + 16; ++j)
+            {
+                left = MIN(left, trailPoints[j].first);
+                right = MAX(right, trailPoints[j].first);
+                top = MIN(top, trailPoints[j].second);
+                bottom = MAX(bottom, trailPoints[j].second);
+            }
+            g_SceneMan.RegisterMOColorDrawing(pTrailBitmap, left, top, right, bottom);
+        }
     }
 
     // Unlock all bitmaps involved.
@@ -1390,4 +1421,69 @@ int Atom::Travel(float travelTime,
     return hitCount;
 }
 
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          TravelPathIsClear
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Walks the same pixel path that Travel would take with the current
+//                  state of the owning MovableObject, without changing anything, to see
+//                  if it would run into any terrain or MOs that it could hit.
+
+bool Atom::TravelPathIsClear(float travelTime) const
+{
+    if (!m_pOwnerMO)
+        return false;
+
+    // Mirror the first seg of Travel; if nothing is hit there won't be any more segs
+    Vector position = m_pOwnerMO->m_Pos + m_Offset;
+    Vector segTraj = m_pOwnerMO->m_Vel * travelTime * g_FrameMan.GetPPM();
+
+    int intPos[2], delta[2], delta2[2], increment[2];
+    intPos[X] = floorf(position.m_X);
+    intPos[Y] = floorf(position.m_Y);
+    delta[X] = floorf(position.m_X + segTraj.m_X) - intPos[X];
+    delta[Y] = floorf(position.m_Y + segTraj.m_Y) - intPos[Y];
+
+    // Not moving a whole pixel, so nothing to run into
+    if (delta[X] == 0 && delta[Y] == 0)
+        return true;
+
+    // Starting out embedded in terrain always results in a penetration attempt
+    if (g_SceneMan.GetTerrMatter(intPos[X], intPos[Y]) != g_MaterialAir)
+        return false;
+
+    increment[X] = delta[X] < 0 ? -1 : 1;
+    increment[Y] = delta[Y] < 0 ? -1 : 1;
+    delta[X] = abs(delta[X]);
+    delta[Y] = abs(delta[Y]);
+    delta2[X] = delta[X] << 1;
+    delta2[Y] = delta[Y] << 1;
+
+    int dom = delta[X] > delta[Y] ? X : Y;
+    int sub = dom == X ? Y : X;
+    int error = m_ChangedDir ? delta2[sub] - delta[dom] : m_PrevError;
+
+    for (int domSteps = 0; domSteps < delta[dom]; ++domSteps)
+    {
+        intPos[dom] += increment[dom];
+        if (error >= 0)
+        {
+            intPos[sub] += increment[sub];
+            error -= delta2[dom];
+        }
+        error += delta2[sub];
+
+        g_SceneMan.WrapPosition(intPos[X], intPos[Y]);
+
+        // Any MO pixel counts, even ones on the ignore list, to stay on the safe side
+        if (m_pOwnerMO->m_HitsMOs && g_SceneMan.GetMOIDPixel(intPos[X], intPos[Y]) != g_NoMOID)
+            return false;
+
+        if (!m_pOwnerMO->m_IgnoreTerrain && g_SceneMan.GetTerrMatter(intPos[X], intPos[Y]) != g_MaterialAir)
+            return false;
+    }
+
+    return true;
+}
+
 } // namespace RTE
@@ -23,6 +23,7 @@
 #include "Material.h"
 #include "LimbPath.h"
 #include "Color.h"
+#include "SlabAllocator.h"
 
 #include "ConsoleMan.h"
 
@@ -157,6 +158,17 @@ public:
     static int ReturnPoolMemory(void *pReturnedMemory);
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   DumpPoolMemoryInfo
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Writes the instances in use and slab occupancy of the Atom pool to a
+//                  file, the same way as Entity::ClassInfo::DumpPoolMemoryInfo.
+// Arguments:       The writer to write info to.
+// Return value:    None.
+
+    static void DumpPoolMemoryInfo(Writer &fileWriter);
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Constructor:     Atom
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -511,7 +523,7 @@ public:
 // Arguments:       None.
 // Return value:    The new max length, in pixels. If 0, no trail is drawn.
 
-    int GetTrailLength() { return m_TrailLength; }
+    int GetTrailLength() const { return m_TrailLength; }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -975,6 +987,20 @@ public:
                bool scenePreLocked = false);
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          TravelPathIsClear
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Walks the same pixel path that Travel would take with the current
+//                  state of the owning MovableObject, without changing anything, to see
+//                  if it would run into any terrain or MOs that it could hit. If this
+//                  returns true, a following Travel won't write to the Scene or touch
+//                  any other MO. LockScene() must be called before using this method.
+// Arguments:       The amount of time in s that this Atom is to travel.
+// Return value:    Whether the path is clear of anything this Atom could collide with.
+
+    bool TravelPathIsClear(float travelTime) const;
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          SetIgnoreMOIDsByGroup
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -993,8 +1019,8 @@ protected:
 
     static const std::string ClassName;
 
-    // Pool of pre-allocated Atom:s
-    static std::vector<void *> m_AllocatedPool;
+    // Pool of pre-allocated Atom:s, packed into slabs
+    static SlabAllocator m_SlabAllocator;
     // The number of instances to fill up the pool of Atom;s with each time it runs dry
     static int m_PoolAllocBlockCount;
     // The number of allocated instances passed out from the pool
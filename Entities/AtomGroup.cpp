@@ -1170,6 +1170,7 @@ float AtomGroup::Travel(Vector &position,
 #ifdef _DEBUG
             // Draw the positions of the atoms at the start of each segment, for visual debugging.
             putpixel(g_SceneMan.GetMOColorBitmap(), (*aItr)->GetCurrentPos().m_X, (*aItr)->GetCurrentPos().m_Y, 122);
+            g_SceneMan.RegisterMOColorDrawing(g_SceneMan.GetMOColorBitmap(), (*aItr)->GetCurrentPos().m_X, (*aItr)->GetCurrentPos().m_Y, (*aItr)->GetCurrentPos().m_X, (*aItr)->GetCurrentPos().m_Y);
 #endif //_DEBUG
         }
 
@@ -1301,6 +1302,7 @@ float AtomGroup::Travel(Vector &position,
                     Vector tPos = (*aItr)->GetCurrentPos();
                     Vector tNorm = m_pOwnerMO->RotateOffset((*aItr)->GetNormal()) * 7;
                     line(g_SceneMan.GetMOColorBitmap(), tPos.m_X, tPos.m_Y, tPos.m_X + tNorm.m_X, tPos.m_Y + tNorm.m_Y, 244);
+                    g_SceneMan.RegisterMOColorDrawing(g_SceneMan.GetMOColorBitmap(), tPos, 8);
                     // Draw the positions of the hitpoints on screen for easy debugging.
 //                    putpixel(g_SceneMan.GetMOColorBitmap(), tPos.m_X, tPos.m_Y, 5);
 #endif //_DEBUG
@@ -1910,6 +1912,7 @@ before adding them to the MovableMan.
 #ifdef _DEBUG
                 // Draw the positions of the hitpoints on screen for easy debugging.
                 putpixel(g_SceneMan.GetMOColorBitmap(), floorf(position.m_X + rotatedOffset.m_X), floorf(position.m_Y + rotatedOffset.m_Y), 122);
+                g_SceneMan.RegisterMOColorDrawing(g_SceneMan.GetMOColorBitmap(), floorf(position.m_X + rotatedOffset.m_X), floorf(position.m_Y + rotatedOffset.m_Y), floorf(position.m_X + rotatedOffset.m_X), floorf(position.m_Y + rotatedOffset.m_Y));
 #endif //_DEBUG
 */
             }
@@ -2755,6 +2758,7 @@ void AtomGroup::Draw(BITMAP *pTargetBitmap,
 
         // Then draw the atom position
         putpixel(pTargetBitmap, aPos.m_X - targetPos.m_X, aPos.m_Y - targetPos.m_Y, color);
+        g_SceneMan.RegisterMOColorDrawing(pTargetBitmap, aPos - targetPos, 1);
     }
 
     release_bitmap(pTargetBitmap);
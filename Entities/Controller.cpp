@@ -16,6 +16,7 @@
 #include "ConsoleMan.h"
 #include "DDTTools.h"
 #include "Actor.h"
+#include "ReplayMan.h"
 
 using namespace std;
 
@@ -281,284 +282,351 @@ void Controller::Update()
 
     if (m_InputMode == CIM_PLAYER)
     {
-        // If the console is open, then disable regular player input and stop updating here
-        if (g_ConsoleMan.IsEnabled())
-            return;
+        // Feed back the recorded states instead of reading the input devices
+        if (g_ReplayMan.IsReplaying() && g_ReplayMan.InSimTick())
+            ReplayInput();
+        else
+        {
+            UpdatePlayerInput();
+            if (g_ReplayMan.IsRecording() && g_ReplayMan.InSimTick())
+                RecordInput();
+        }
+    }
+
+    ////////////////////////////////
+    // AI Input Mode
 
-        // Disabled won't get updates
-        if (m_Disabled || m_Player < 0)
+    else if (m_InputMode == CIM_AI)
+    {
+        // Disabled won't get updates, or when the activity isn't going
+        if (m_Disabled || !g_ActivityMan.ActivityRunning())
             return;
 
-        ///////////////////////////////////////////////////////////
-        // Set the control states according to digital key/d-pad states.
+        // Update the AI state of the Actor we're controlling
+        if (m_pControlled)
+        {
+            // Try to use any scripted AI defined for this Actor
+            if (!m_pControlled->UpdateAIScripted())
+                // if can't, fall back on the legacy C++ implementation
+                m_pControlled->UpdateAI();
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          UpdatePlayerInput
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Sets the control states from the input devices of the player.
+
+void Controller::UpdatePlayerInput()
+{
+    // If the console is open, then disable regular player input and stop updating here
+    if (g_ConsoleMan.IsEnabled())
+        return;
 
-        // PIE MENU ACTIVE
-        if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_PIEMENU))
+    // Disabled won't get updates
+    if (m_Disabled || m_Player < 0)
+        return;
+
+    ///////////////////////////////////////////////////////////
+    // Set the control states according to digital key/d-pad states.
+
+    // PIE MENU ACTIVE
+    if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_PIEMENU))
+    {
+        m_ControlStates[PIE_MENU_ACTIVE] = true;
+        m_ControlStates[MOVE_IDLE] = true;
+        m_ReleaseTimer.Reset();
+    }
+    else
+    {
+        // Holding of the switch buttons disables aiming later
+        if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_NEXT))
         {
-            m_ControlStates[PIE_MENU_ACTIVE] = true;
-            m_ControlStates[MOVE_IDLE] = true;
+            m_ControlStates[ACTOR_NEXT_PREP] = true;
             m_ReleaseTimer.Reset();
         }
-        else
+		else if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_PREV))
+		{
+			m_ControlStates[ACTOR_PREV_PREP] = true;
+			m_ReleaseTimer.Reset();
+		}
+		// No actions can be performed while switching actors or pie menu, and short time thereafter
+        else if (m_ReleaseTimer.IsPastRealMS(m_ReleaseDelay))
         {
-            // Holding of the switch buttons disables aiming later
-            if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_NEXT))
-            {
-                m_ControlStates[ACTOR_NEXT_PREP] = true;
-                m_ReleaseTimer.Reset();
-            }
-			else if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_PREV))
+            // WEAPON ACTIVATION
+            if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_FIRE))
+                m_ControlStates[WEAPON_FIRE] = true;
+
+            // SHARP AIM
+            if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_AIM))
+                m_ControlStates[AIM_SHARP] = true;
+/*
+            // RELOADING
+            if (g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_PIEMENU))
+                m_ControlStates[WEAPON_RELOAD] = true;
+*/
+            // JUMP START
+            if (g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_JUMP))
+                m_ControlStates[BODY_JUMPSTART] = true;
+
+            // JUMP EXECUTION
+            if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_JUMP))
+                m_ControlStates[BODY_JUMP] = true;
+
+            // CROUCH/PRONE
+            if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_CROUCH))
+                m_ControlStates[BODY_CROUCH] = true;
+
+            // MOVEMENT LEFT/RIGHT
+            if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_L_RIGHT))
+                m_ControlStates[MOVE_RIGHT] = true;
+            else if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_L_LEFT))
+                m_ControlStates[MOVE_LEFT] = true;
+            else
+                m_ControlStates[MOVE_IDLE] = true;
+
+            // AIM AND MOVE UP AND DOWN
+            if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_L_UP) || g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_AIM_UP))
+                m_ControlStates[MOVE_UP] = true;
+            else if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_L_DOWN) || g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_AIM_DOWN))
+                m_ControlStates[MOVE_DOWN] = true;
+
+            // AIM UP AND DOWN DIGITALLY
+            if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_AIM_UP))
+                m_ControlStates[AIM_UP] = true;
+            else if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_AIM_DOWN))
+                m_ControlStates[AIM_DOWN] = true;
+
+            // AIM LEFT AND RIGHT DIGITALLY  not really used as aiming, so convert into movement input
+            if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_AIM_LEFT))
+                m_ControlStates[MOVE_LEFT] = true;
+            else if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_AIM_RIGHT))
+                m_ControlStates[MOVE_RIGHT] = true;
+
+            if (g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_FIRE) || g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_AIM)/* || g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_PIEMENU) || g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_JUMP)*/)
+                m_ControlStates[PRESS_FACEBUTTON] = true;
+
+			if (!m_WeaponChangeNextIgnore && g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_WEAPON_CHANGE_NEXT))
 			{
-				m_ControlStates[ACTOR_PREV_PREP] = true;
-				m_ReleaseTimer.Reset();
+				m_ControlStates[WEAPON_CHANGE_NEXT] = true;
+				m_WeaponChangeNextIgnore = true;
+			}
+			if (!m_WeaponChangePrevIgnore && g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_WEAPON_CHANGE_PREV))
+			{
+				m_ControlStates[WEAPON_CHANGE_PREV] = true;
+				m_WeaponChangePrevIgnore = true;
+			}
+			if (!m_WeaponPickupIgnore && g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_WEAPON_PICKUP))
+			{
+				m_ControlStates[WEAPON_PICKUP] = true;
+				m_WeaponPickupIgnore = true;
+			}
+			if (!m_WeaponDropIgnore && g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_WEAPON_DROP))
+			{
+				m_ControlStates[WEAPON_DROP] = true;
+				m_WeaponDropIgnore = true;
+			}
+			if (!m_WeaponReloadIgnore && g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_WEAPON_RELOAD))
+			{
+				m_ControlStates[WEAPON_RELOAD] = true;
+				m_WeaponReloadIgnore = true;
 			}
-			// No actions can be performed while switching actors or pie menu, and short time thereafter
-            else if (m_ReleaseTimer.IsPastRealMS(m_ReleaseDelay))
-            {
-                // WEAPON ACTIVATION
-                if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_FIRE))
-                    m_ControlStates[WEAPON_FIRE] = true;
-
-                // SHARP AIM
-                if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_AIM))
-                    m_ControlStates[AIM_SHARP] = true;
-    /*
-                // RELOADING
-                if (g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_PIEMENU))
-                    m_ControlStates[WEAPON_RELOAD] = true;
-    */
-                // JUMP START
-                if (g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_JUMP))
-                    m_ControlStates[BODY_JUMPSTART] = true;
-
-                // JUMP EXECUTION
-                if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_JUMP))
-                    m_ControlStates[BODY_JUMP] = true;
-
-                // CROUCH/PRONE
-                if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_CROUCH))
-                    m_ControlStates[BODY_CROUCH] = true;
-
-                // MOVEMENT LEFT/RIGHT
-                if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_L_RIGHT))
-                    m_ControlStates[MOVE_RIGHT] = true;
-                else if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_L_LEFT))
-                    m_ControlStates[MOVE_LEFT] = true;
-                else
-                    m_ControlStates[MOVE_IDLE] = true;
-
-                // AIM AND MOVE UP AND DOWN
-                if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_L_UP) || g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_AIM_UP))
-                    m_ControlStates[MOVE_UP] = true;
-                else if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_L_DOWN) || g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_AIM_DOWN))
-                    m_ControlStates[MOVE_DOWN] = true;
-
-                // AIM UP AND DOWN DIGITALLY
-                if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_AIM_UP))
-                    m_ControlStates[AIM_UP] = true;
-                else if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_AIM_DOWN))
-                    m_ControlStates[AIM_DOWN] = true;
-
-                // AIM LEFT AND RIGHT DIGITALLY  not really used as aiming, so convert into movement input
-                if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_AIM_LEFT))
-                    m_ControlStates[MOVE_LEFT] = true;
-                else if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_AIM_RIGHT))
-                    m_ControlStates[MOVE_RIGHT] = true;
-
-                if (g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_FIRE) || g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_AIM)/* || g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_PIEMENU) || g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_JUMP)*/)
-                    m_ControlStates[PRESS_FACEBUTTON] = true;
-
-				if (!m_WeaponChangeNextIgnore && g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_WEAPON_CHANGE_NEXT))
-				{
-					m_ControlStates[WEAPON_CHANGE_NEXT] = true;
-					m_WeaponChangeNextIgnore = true;
-				}
-				if (!m_WeaponChangePrevIgnore && g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_WEAPON_CHANGE_PREV))
-				{
-					m_ControlStates[WEAPON_CHANGE_PREV] = true;
-					m_WeaponChangePrevIgnore = true;
-				}
-				if (!m_WeaponPickupIgnore && g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_WEAPON_PICKUP))
-				{
-					m_ControlStates[WEAPON_PICKUP] = true;
-					m_WeaponPickupIgnore = true;
-				}
-				if (!m_WeaponDropIgnore && g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_WEAPON_DROP))
-				{
-					m_ControlStates[WEAPON_DROP] = true;
-					m_WeaponDropIgnore = true;
-				}
-				if (!m_WeaponReloadIgnore && g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_WEAPON_RELOAD))
-				{
-					m_ControlStates[WEAPON_RELOAD] = true;
-					m_WeaponReloadIgnore = true;
-				}
-            }
-        }
-
-        // Only actually switch when the change button(s) are released
-        // BRAIN ACTOR
-        if ((g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_NEXT) && g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_PREV)) ||
-            (g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_NEXT) && g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_PREV)))
-        {
-            m_ControlStates[ACTOR_BRAIN] = true;
-            // Ignore the next releases of next and prev buttons so that the brain isnt' switched away form immedailtey after using the brain shortcut
-            m_NextIgnore = m_PrevIgnore = true;
-        }
-        // NEXT ACTOR
-        else if (g_UInputMan.ElementReleased(m_Player, UInputMan::INPUT_NEXT))
-        {
-            if (!m_NextIgnore)
-                m_ControlStates[ACTOR_NEXT] = true;
-            m_NextIgnore = false;
-        }
-        // PREV ACTOR
-        else if (g_UInputMan.ElementReleased(m_Player, UInputMan::INPUT_PREV))
-        {
-            if (!m_PrevIgnore)
-                m_ControlStates[ACTOR_PREV] = true;
-            m_PrevIgnore = false;
         }
-		else if (g_UInputMan.ElementReleased(m_Player, UInputMan::INPUT_WEAPON_CHANGE_NEXT))
-			m_WeaponChangeNextIgnore = false;
-		else if (g_UInputMan.ElementReleased(m_Player, UInputMan::INPUT_WEAPON_CHANGE_PREV))
-			m_WeaponChangePrevIgnore = false;
-		else if (g_UInputMan.ElementReleased(m_Player, UInputMan::INPUT_WEAPON_PICKUP))
-			m_WeaponPickupIgnore = false;
-		else if (g_UInputMan.ElementReleased(m_Player, UInputMan::INPUT_WEAPON_DROP))
-			m_WeaponDropIgnore = false;
-		else if (g_UInputMan.ElementReleased(m_Player, UInputMan::INPUT_WEAPON_RELOAD))
-			m_WeaponReloadIgnore = false;
-
-        if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_L_RIGHT) || g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_AIM_RIGHT))
-            m_ControlStates[HOLD_RIGHT] = true;
-        if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_L_LEFT) || g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_AIM_LEFT))
-            m_ControlStates[HOLD_LEFT] = true;
-        if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_L_UP) || g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_AIM_UP))
-            m_ControlStates[HOLD_UP] = true;
-        if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_L_DOWN) || g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_AIM_DOWN))
-            m_ControlStates[HOLD_DOWN] = true;
-
-        if (g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_L_RIGHT) || g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_AIM_RIGHT))
-            m_ControlStates[PRESS_RIGHT] = true;
-        if (g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_L_LEFT) || g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_AIM_LEFT))
-            m_ControlStates[PRESS_LEFT] = true;
-        if (g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_L_UP) || g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_AIM_UP))
-            m_ControlStates[PRESS_UP] = true;
-        if (g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_L_DOWN) || g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_AIM_DOWN))
-            m_ControlStates[PRESS_DOWN] = true;
-
-        if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_FIRE))
-            m_ControlStates[PRIMARY_ACTION] = true;
-        if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_PIEMENU))
-            m_ControlStates[SECONDARY_ACTION] = true;
-        if (g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_FIRE))
-            m_ControlStates[PRESS_PRIMARY] = true;
-        if (g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_PIEMENU))
-            m_ControlStates[PRESS_SECONDARY] = true;
-        if (g_UInputMan.ElementReleased(m_Player, UInputMan::INPUT_FIRE))
-            m_ControlStates[RELEASE_PRIMARY] = true;
-        if (g_UInputMan.ElementReleased(m_Player, UInputMan::INPUT_PIEMENU))
-            m_ControlStates[RELEASE_SECONDARY] = true;
-
-        ///////////////////////////////////////////
-        // ANALOG joystick values
+    }
 
-        Vector move = g_UInputMan.AnalogMoveValues(m_Player);
-        Vector aim = g_UInputMan.AnalogAimValues(m_Player);
-        // Only change aim and move if not holding actor swtich buttons - don't want to mess up AI's aim
-        if (!m_ControlStates[PIE_MENU_ACTIVE] && !m_ControlStates[ACTOR_PREV_PREP] && !m_ControlStates[ACTOR_NEXT_PREP] && m_ReleaseTimer.IsPastRealMS(m_ReleaseDelay))
-        {
-            m_AnalogMove = move;
-            m_AnalogAim = aim;
-        }
-        else
-            m_AnalogCursor = move.GetLargest() > aim.GetLargest() ? move : aim;
+    // Only actually switch when the change button(s) are released
+    // BRAIN ACTOR
+    if ((g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_NEXT) && g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_PREV)) ||
+        (g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_NEXT) && g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_PREV)))
+    {
+        m_ControlStates[ACTOR_BRAIN] = true;
+        // Ignore the next releases of next and prev buttons so that the brain isnt' switched away form immedailtey after using the brain shortcut
+        m_NextIgnore = m_PrevIgnore = true;
+    }
+    // NEXT ACTOR
+    else if (g_UInputMan.ElementReleased(m_Player, UInputMan::INPUT_NEXT))
+    {
+        if (!m_NextIgnore)
+            m_ControlStates[ACTOR_NEXT] = true;
+        m_NextIgnore = false;
+    }
+    // PREV ACTOR
+    else if (g_UInputMan.ElementReleased(m_Player, UInputMan::INPUT_PREV))
+    {
+        if (!m_PrevIgnore)
+            m_ControlStates[ACTOR_PREV] = true;
+        m_PrevIgnore = false;
+    }
+	else if (g_UInputMan.ElementReleased(m_Player, UInputMan::INPUT_WEAPON_CHANGE_NEXT))
+		m_WeaponChangeNextIgnore = false;
+	else if (g_UInputMan.ElementReleased(m_Player, UInputMan::INPUT_WEAPON_CHANGE_PREV))
+		m_WeaponChangePrevIgnore = false;
+	else if (g_UInputMan.ElementReleased(m_Player, UInputMan::INPUT_WEAPON_PICKUP))
+		m_WeaponPickupIgnore = false;
+	else if (g_UInputMan.ElementReleased(m_Player, UInputMan::INPUT_WEAPON_DROP))
+		m_WeaponDropIgnore = false;
+	else if (g_UInputMan.ElementReleased(m_Player, UInputMan::INPUT_WEAPON_RELOAD))
+		m_WeaponReloadIgnore = false;
+
+    if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_L_RIGHT) || g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_AIM_RIGHT))
+        m_ControlStates[HOLD_RIGHT] = true;
+    if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_L_LEFT) || g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_AIM_LEFT))
+        m_ControlStates[HOLD_LEFT] = true;
+    if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_L_UP) || g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_AIM_UP))
+        m_ControlStates[HOLD_UP] = true;
+    if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_L_DOWN) || g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_AIM_DOWN))
+        m_ControlStates[HOLD_DOWN] = true;
+
+    if (g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_L_RIGHT) || g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_AIM_RIGHT))
+        m_ControlStates[PRESS_RIGHT] = true;
+    if (g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_L_LEFT) || g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_AIM_LEFT))
+        m_ControlStates[PRESS_LEFT] = true;
+    if (g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_L_UP) || g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_AIM_UP))
+        m_ControlStates[PRESS_UP] = true;
+    if (g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_L_DOWN) || g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_AIM_DOWN))
+        m_ControlStates[PRESS_DOWN] = true;
+
+    if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_FIRE))
+        m_ControlStates[PRIMARY_ACTION] = true;
+    if (g_UInputMan.ElementHeld(m_Player, UInputMan::INPUT_PIEMENU))
+        m_ControlStates[SECONDARY_ACTION] = true;
+    if (g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_FIRE))
+        m_ControlStates[PRESS_PRIMARY] = true;
+    if (g_UInputMan.ElementPressed(m_Player, UInputMan::INPUT_PIEMENU))
+        m_ControlStates[PRESS_SECONDARY] = true;
+    if (g_UInputMan.ElementReleased(m_Player, UInputMan::INPUT_FIRE))
+        m_ControlStates[RELEASE_PRIMARY] = true;
+    if (g_UInputMan.ElementReleased(m_Player, UInputMan::INPUT_PIEMENU))
+        m_ControlStates[RELEASE_SECONDARY] = true;
+
+    ///////////////////////////////////////////
+    // ANALOG joystick values
+
+    Vector move = g_UInputMan.AnalogMoveValues(m_Player);
+    Vector aim = g_UInputMan.AnalogAimValues(m_Player);
+    // Only change aim and move if not holding actor swtich buttons - don't want to mess up AI's aim
+    if (!m_ControlStates[PIE_MENU_ACTIVE] && !m_ControlStates[ACTOR_PREV_PREP] && !m_ControlStates[ACTOR_NEXT_PREP] && m_ReleaseTimer.IsPastRealMS(m_ReleaseDelay))
+    {
+        m_AnalogMove = move;
+        m_AnalogAim = aim;
+    }
+    else
+        m_AnalogCursor = move.GetLargest() > aim.GetLargest() ? move : aim;
 
-        // If the joystick-controlled analog cursor is less than at the edge of input range, don't accelerate
-        if (GetAnalogCursor().GetMagnitude() < 0.85)
-            m_JoyAccelTimer.Reset();
-        // If the keyboard inputs for cursor movements is initially pressed, reset the acceleration timer
-        if (IsState(ACTOR_NEXT) || IsState(ACTOR_PREV) || (IsState(PRESS_LEFT) || IsState(PRESS_RIGHT) || IsState(PRESS_UP) || IsState(PRESS_DOWN)))
-            m_KeyAccelTimer.Reset();
+    // If the joystick-controlled analog cursor is less than at the edge of input range, don't accelerate
+    if (GetAnalogCursor().GetMagnitude() < 0.85)
+        m_JoyAccelTimer.Reset();
+    // If the keyboard inputs for cursor movements is initially pressed, reset the acceleration timer
+    if (IsState(ACTOR_NEXT) || IsState(ACTOR_PREV) || (IsState(PRESS_LEFT) || IsState(PRESS_RIGHT) || IsState(PRESS_UP) || IsState(PRESS_DOWN)))
+        m_KeyAccelTimer.Reset();
 
-        /////////////////////////////////////////
-        // Translate the analog inputs to the discrete control states
+    /////////////////////////////////////////
+    // Translate the analog inputs to the discrete control states
 
-        // Sharp Aim
-        if (m_AnalogAim.GetMagnitude() > 0.1 && !m_ControlStates[PIE_MENU_ACTIVE])
-            m_ControlStates[AIM_SHARP] = true;
+    // Sharp Aim
+    if (m_AnalogAim.GetMagnitude() > 0.1 && !m_ControlStates[PIE_MENU_ACTIVE])
+        m_ControlStates[AIM_SHARP] = true;
 
-        ////////////////////////////////////////////
-        // Overrides
+    ////////////////////////////////////////////
+    // Overrides
 
-        // Sharp aim can't happen when moving around
-        // This also helps with keyboard vs mouse fighting when moving and aiming in opposite directions
-        if (/*m_AnalogMove.GetMagnitude() > 0.1 || */m_ControlStates[PRESS_RIGHT] || m_ControlStates[PRESS_LEFT] || m_ControlStates[BODY_JUMPSTART] || (m_ControlStates[PIE_MENU_ACTIVE] && !m_ControlStates[SECONDARY_ACTION]))
-        {
-            // Also stunt the analog aim so that it isn't stuck out in the extreme
-            // Reset the aim if we were aiming sharp and not anymore, makes wiggle easier
-    //        if (m_ControlStates[AIM_SHARP])
-    //            m_AnalogAim.CapMagnitude(0.1);
+    // Sharp aim can't happen when moving around
+    // This also helps with keyboard vs mouse fighting when moving and aiming in opposite directions
+    if (/*m_AnalogMove.GetMagnitude() > 0.1 || */m_ControlStates[PRESS_RIGHT] || m_ControlStates[PRESS_LEFT] || m_ControlStates[BODY_JUMPSTART] || (m_ControlStates[PIE_MENU_ACTIVE] && !m_ControlStates[SECONDARY_ACTION]))
+    {
+        // Also stunt the analog aim so that it isn't stuck out in the extreme
+        // Reset the aim if we were aiming sharp and not anymore, makes wiggle easier
+//        if (m_ControlStates[AIM_SHARP])
+//            m_AnalogAim.CapMagnitude(0.1);
 
-            if (IsMouseControlled())
-                g_UInputMan.SetMouseValueMagnitude(0.05);
+        if (IsMouseControlled())
+            g_UInputMan.SetMouseValueMagnitude(0.05);
 
-            m_ControlStates[AIM_SHARP] = false;
-        }
+        m_ControlStates[AIM_SHARP] = false;
+    }
 
-        // Special handing of the mouse input, if applicable
-        if (IsMouseControlled())
-        {
-            m_MouseMovement = g_UInputMan.GetMouseMovement(m_Player);
+    // Special handing of the mouse input, if applicable
+    if (IsMouseControlled())
+    {
+        m_MouseMovement = g_UInputMan.GetMouseMovement(m_Player);
 
-            if (g_UInputMan.MouseWheelMovedByPlayer(m_Player) < 0)
-                m_ControlStates[WEAPON_CHANGE_NEXT] = m_ControlStates[SCROLL_DOWN] = true;
-            else if (g_UInputMan.MouseWheelMovedByPlayer(m_Player) > 0)
-                m_ControlStates[WEAPON_CHANGE_PREV] = m_ControlStates[SCROLL_UP] = true;
+        if (g_UInputMan.MouseWheelMovedByPlayer(m_Player) < 0)
+            m_ControlStates[WEAPON_CHANGE_NEXT] = m_ControlStates[SCROLL_DOWN] = true;
+        else if (g_UInputMan.MouseWheelMovedByPlayer(m_Player) > 0)
+            m_ControlStates[WEAPON_CHANGE_PREV] = m_ControlStates[SCROLL_UP] = true;
 
 //#if defined(WIN32)
-			UInputMan::MouseButtons activeSecondary = UInputMan::MOUSE_RIGHT;
+		UInputMan::MouseButtons activeSecondary = UInputMan::MOUSE_RIGHT;
 //#elif defined(__APPLE__)
 //			UInputMan::MouseButtons activeSecondary = UInputMan::MOUSE_CTRL;
 //#endif // defined(WIN32)
-			
-            if (g_UInputMan.MouseButtonHeld(UInputMan::MOUSE_LEFT, m_Player))
-                m_ControlStates[PRIMARY_ACTION] = true;
-            if (g_UInputMan.MouseButtonHeld(activeSecondary, m_Player))
-                m_ControlStates[SECONDARY_ACTION] = true;
-            if (g_UInputMan.MouseButtonPressed(UInputMan::MOUSE_LEFT, m_Player))
-                m_ControlStates[PRESS_PRIMARY] = true;
-            if (g_UInputMan.MouseButtonPressed(activeSecondary, m_Player))
-                m_ControlStates[PRESS_SECONDARY] = true;
-            if (g_UInputMan.MouseButtonReleased(UInputMan::MOUSE_LEFT, m_Player))
-                m_ControlStates[RELEASE_PRIMARY] = true;
-            if (g_UInputMan.MouseButtonReleased(activeSecondary, m_Player))
-                m_ControlStates[RELEASE_SECONDARY] = true;
-        }
-
-        ////////////////////////////////////
-        // DEBUG STUFF
+		
+        if (g_UInputMan.MouseButtonHeld(UInputMan::MOUSE_LEFT, m_Player))
+            m_ControlStates[PRIMARY_ACTION] = true;
+        if (g_UInputMan.MouseButtonHeld(activeSecondary, m_Player))
+            m_ControlStates[SECONDARY_ACTION] = true;
+        if (g_UInputMan.MouseButtonPressed(UInputMan::MOUSE_LEFT, m_Player))
+            m_ControlStates[PRESS_PRIMARY] = true;
+        if (g_UInputMan.MouseButtonPressed(activeSecondary, m_Player))
+            m_ControlStates[PRESS_SECONDARY] = true;
+        if (g_UInputMan.MouseButtonReleased(UInputMan::MOUSE_LEFT, m_Player))
+            m_ControlStates[RELEASE_PRIMARY] = true;
+        if (g_UInputMan.MouseButtonReleased(activeSecondary, m_Player))
+            m_ControlStates[RELEASE_SECONDARY] = true;
     }
 
-    ////////////////////////////////
-    // AI Input Mode
+    ////////////////////////////////////
+    // DEBUG STUFF
+}
 
-    else if (m_InputMode == CIM_AI)
-    {
-        // Disabled won't get updates, or when the activity isn't going
-        if (m_Disabled || !g_ActivityMan.ActivityRunning())
-            return;
 
-        // Update the AI state of the Actor we're controlling
-        if (m_pControlled)
-        {
-            // Try to use any scripted AI defined for this Actor
-            if (!m_pControlled->UpdateAIScripted())
-                // if can't, fall back on the legacy C++ implementation
-                m_pControlled->UpdateAI();
-        }
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RecordInput
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Adds the current control states to the replay recording.
+
+void Controller::RecordInput() const
+{
+    ReplayMan::ControlRecord record;
+    record.m_Player = m_Player;
+    record.m_States = 0;
+    for (int i = 0; i < CONTROLSTATECOUNT; ++i)
+    {
+        if (m_ControlStates[i])
+            record.m_States |= 1ULL << i;
     }
+    record.m_AnalogMove[0] = m_AnalogMove.m_X;
+    record.m_AnalogMove[1] = m_AnalogMove.m_Y;
+    record.m_AnalogAim[0] = m_AnalogAim.m_X;
+    record.m_AnalogAim[1] = m_AnalogAim.m_Y;
+    record.m_AnalogCursor[0] = m_AnalogCursor.m_X;
+    record.m_AnalogCursor[1] = m_AnalogCursor.m_Y;
+    record.m_MouseMovement[0] = m_MouseMovement.m_X;
+    record.m_MouseMovement[1] = m_MouseMovement.m_Y;
+
+    g_ReplayMan.RecordControls(record);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ReplayInput
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Sets the control states to the next recorded ones of the player in
+//                  the replay. Leaves them all off if there are none.
+
+void Controller::ReplayInput()
+{
+    ReplayMan::ControlRecord record;
+    if (!g_ReplayMan.ReplayControls(m_Player, record))
+        return;
+
+    for (int i = 0; i < CONTROLSTATECOUNT; ++i)
+        m_ControlStates[i] = (record.m_States & (1ULL << i)) != 0;
+    m_AnalogMove.SetXY(record.m_AnalogMove[0], record.m_AnalogMove[1]);
+    m_AnalogAim.SetXY(record.m_AnalogAim[0], record.m_AnalogAim[1]);
+    m_AnalogCursor.SetXY(record.m_AnalogCursor[0], record.m_AnalogCursor[1]);
+    m_MouseMovement.SetXY(record.m_MouseMovement[0], record.m_MouseMovement[1]);
 }
 
 } // namespace RTE
\ No newline at end of file
@@ -482,6 +482,38 @@ public:
 
 protected:
 
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          UpdatePlayerInput
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Sets the control states from the input devices of the player.
+// Arguments:       None.
+// Return value:    None.
+
+    void UpdatePlayerInput();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RecordInput
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Adds the current control states to the replay recording.
+// Arguments:       None.
+// Return value:    None.
+
+    void RecordInput() const;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ReplayInput
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Sets the control states to the next recorded ones of the player in
+//                  the replay. Leaves them all off if there are none.
+// Arguments:       None.
+// Return value:    None.
+
+    void ReplayInput();
+
+
     // Member variables
     static Entity::ClassInfo m_sClass;
     // Control states
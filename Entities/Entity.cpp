@@ -24,6 +24,7 @@ namespace RTE
 Entity::ClassInfo * Entity::ClassInfo::m_sClassHead = 0;
 
 Entity::ClassInfo Entity::m_sClass("Entity");
+int Entity::m_sPresetGroupChanges = 0;
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -31,7 +32,7 @@ Entity::ClassInfo Entity::m_sClass("Entity");
 //////////////////////////////////////////////////////////////////////////////////////////
 // Description:     Constructor method used to instantiate a ClassInfo Entity.
 
-Entity::ClassInfo::ClassInfo(const std::string &name, ClassInfo *pParentInfo, void * (*fpAllocFunc)(), void (*fpDeallocFunc)(void *), Entity * (*fpNewFunc)(), int allocBlockCount):
+Entity::ClassInfo::ClassInfo(const std::string &name, ClassInfo *pParentInfo, void * (*fpAllocFunc)(), void (*fpDeallocFunc)(void *), Entity * (*fpNewFunc)(), int allocBlockCount, size_t instanceSize):
     m_Name(name),
     m_pParentInfo(pParentInfo),
     m_fpAllocate(fpAllocFunc),
@@ -43,6 +44,12 @@ Entity::ClassInfo::ClassInfo(const std::string &name, ClassInfo *pParentInfo, vo
 
     m_AllocatedPool.clear();
     m_PoolAllocBlockCount = allocBlockCount > 0 ? allocBlockCount : 10;
+    m_InstancesInUse = 0;
+    m_PeakInstancesInUse = 0;
+
+    // Concrete classes get their instances packed into slabs
+    if (fpAllocFunc && instanceSize > 0)
+        m_SlabAllocator.Create(instanceSize, m_PoolAllocBlockCount);
 }
 
 
@@ -103,8 +110,11 @@ void Entity::ClassInfo::FillPool(int fillAmount)
     if (fillAmount <= 0)
         fillAmount = m_PoolAllocBlockCount;
 
+    // Make sure there are at least as many free in the slabs as asked for
+    if (m_SlabAllocator.IsCreated())
+        m_SlabAllocator.Reserve(fillAmount);
     // If concrete class, fill up the pool with pre-allocated memory blocks the size of the type
-    if (m_fpAllocate && fillAmount > 0)
+    else if (m_fpAllocate && fillAmount > 0)
     {
         // As many as we're asked to make
         for (int i = 0; i < fillAmount; ++i)
@@ -123,6 +133,17 @@ void * Entity::ClassInfo::GetPoolMemory()
 {
     DAssert(IsConcrete(), "Trying to get pool memory of an abstract Entity class!");
 
+    if (m_SlabAllocator.IsCreated())
+    {
+        void *pSlabMemory = m_SlabAllocator.Allocate();
+        DAssert(pSlabMemory, "Could not allocate a new slab for the pool!");
+
+        if (++m_InstancesInUse > m_PeakInstancesInUse)
+            m_PeakInstancesInUse = m_InstancesInUse;
+
+        return pSlabMemory;
+    }
+
     // If the pool is empty, then fill it up again with as many instances as we are set to
     if (m_AllocatedPool.empty())
         FillPool(m_PoolAllocBlockCount > 0 ? m_PoolAllocBlockCount : 10);
@@ -134,7 +155,8 @@ void * Entity::ClassInfo::GetPoolMemory()
     DAssert(pFoundMemory, "Could not find an available instance in the pool, even after increasing its size!");
 
     // Keep track of the number of instaces passed out
-    m_InstancesInUse++;
+    if (++m_InstancesInUse > m_PeakInstancesInUse)
+        m_PeakInstancesInUse = m_InstancesInUse;
 
     return pFoundMemory;
 }
@@ -150,7 +172,15 @@ int Entity::ClassInfo::ReturnPoolMemory(void *pReturnedMemory)
     if (!pReturnedMemory)
         return false;
 
-    m_AllocatedPool.push_back(pReturnedMemory);
+    if (m_SlabAllocator.IsCreated())
+    {
+        bool returned = m_SlabAllocator.Deallocate(pReturnedMemory);
+        DAssert(returned, "Returned memory to a pool it didn't come from!");
+        // Only read by the assert, which isn't there in release builds
+        (void)returned;
+    }
+    else
+        m_AllocatedPool.push_back(pReturnedMemory);
 
     // Keep track of the number of instaces passed in
     m_InstancesInUse--;
@@ -170,7 +200,10 @@ void Entity::ClassInfo::DumpPoolMemoryInfo(Writer &fileWriter)
     {
         if (itr->IsConcrete())
         {
-            fileWriter << itr->GetName() << ": " << itr->m_InstancesInUse << "\n";
+            fileWriter << itr->GetName() << ": " << itr->m_InstancesInUse << ", Peak: " << itr->m_PeakInstancesInUse;
+            if (itr->m_SlabAllocator.IsCreated())
+                itr->m_SlabAllocator.DumpInfo(fileWriter);
+            fileWriter << "\n";
         }
     }
 }
@@ -210,8 +243,8 @@ void Entity::Clear()
     m_PresetName = "None";
     m_IsOriginalPreset = false;
     m_DefinedInModule = -1;
-    m_PresetDescription.clear();
-    m_Groups.clear();
+    m_PresetDescription.Reset();
+    m_Groups.Reset();
     m_LastGroupSearch.clear();
     m_LastGroupResult = false;
 
@@ -227,7 +260,7 @@ void Entity::Clear()
 int Entity::Create()
 {
     // Special "All" group that includes.. all
-    m_Groups.push_back("All");
+    m_Groups.Edit().push_back("All");
 
     return 0;
 }
@@ -243,10 +276,9 @@ int Entity::Create(const Entity &reference)
     m_PresetName = reference.m_PresetName;
     // Note how m_IsOriginalPreset is NOT assigned, automatically indicating that the copy is not an original Preset!
     m_DefinedInModule = reference.m_DefinedInModule;
+    // These are hardly ever changed on copies, so they're shared with the reference until they are
     m_PresetDescription = reference.m_PresetDescription;
-
-    for (list<string>::const_iterator itr = reference.m_Groups.begin(); itr != reference.m_Groups.end(); ++itr)
-        m_Groups.push_back(*itr);
+    m_Groups = reference.m_Groups;
 
 	m_RandomWeight = reference.m_RandomWeight;
 
@@ -321,7 +353,7 @@ int Entity::ReadProperty(std::string propName, Reader &reader)
         m_DefinedInModule = reader.GetReadModuleID();
     }
     else if (propName == "Description")
-        reader >> m_PresetDescription;
+        reader >> m_PresetDescription.Edit();
 	else if (propName == "RandomWeight")
 	{
 		reader >> m_RandomWeight;
@@ -372,15 +404,15 @@ int Entity::Save(Writer &writer) const
         writer << GetModuleAndPresetName();
     }
 
-    if (!m_PresetDescription.empty())
+    if (!m_PresetDescription->empty())
     {
         writer.NewProperty("Description");
-        writer << m_PresetDescription;
+        writer << m_PresetDescription.Get();
     }
 
 // TODO: Make proper save system that knows not to save redundant data!
 /*
-    for (list<string>::const_iterator itr = m_Groups.begin(); itr != m_Groups.end(); ++itr)
+    for (list<string>::const_iterator itr = m_Groups->begin(); itr != m_Groups->end(); ++itr)
     {
         writer.NewProperty("AddToGroup");
         writer << *itr;
@@ -485,7 +517,7 @@ bool Entity::IsInGroup(const string &whichGroup)
     if (whichGroup == "None")
         return false;
 
-    for (list<string>::const_iterator itr = m_Groups.begin(); itr != m_Groups.end(); ++itr)
+    for (list<string>::const_iterator itr = m_Groups->begin(); itr != m_Groups->end(); ++itr)
     {
         if (whichGroup == *itr)
         {
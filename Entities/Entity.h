@@ -23,6 +23,8 @@
 #include "Writer.h"
 #include "DDTTools.h"
 #include "Vector.h"
+#include "SlabAllocator.h"
+#include "SharedData.h"
 #include <cstdlib>
 
 namespace RTE
@@ -82,10 +84,10 @@ namespace RTE
     Entity::ClassInfo TYPE::m_sClass(#TYPE, &PARENT::m_sClass);
 
 #define CONCRETECLASSINFO(TYPE, PARENT, BLOCKCOUNT) \
-    Entity::ClassInfo TYPE::m_sClass(#TYPE, &PARENT::m_sClass, TYPE::Allocate, TYPE::Deallocate, TYPE::NewInstance, BLOCKCOUNT);
+    Entity::ClassInfo TYPE::m_sClass(#TYPE, &PARENT::m_sClass, TYPE::Allocate, TYPE::Deallocate, TYPE::NewInstance, BLOCKCOUNT, sizeof(TYPE));
 
 #define CONCRETESUBCLASSINFO(TYPE, SUPER, PARENT, BLOCKCOUNT) \
-    Entity::ClassInfo SUPER::TYPE::m_sClass(#TYPE, &PARENT::m_sClass, SUPER::TYPE::Allocate, SUPER::TYPE::Deallocate, SUPER::TYPE::NewInstance, BLOCKCOUNT);
+    Entity::ClassInfo SUPER::TYPE::m_sClass(#TYPE, &PARENT::m_sClass, SUPER::TYPE::Allocate, SUPER::TYPE::Deallocate, SUPER::TYPE::NewInstance, BLOCKCOUNT, sizeof(SUPER::TYPE));
 
 
 // Whether to draw the colors, or own material property, or to clear the
@@ -163,9 +165,11 @@ public:
     //                  Function pointer to the new instance factory . If
     //                  the represented Entity subclass isn't concrete, pass in 0.
     //                  The number of new instances to fill the pre-allocated pool with when
-    //                  it runs out.
+    //                  it runs out; each slab of the pool holds at least this many.
+    //                  The size in bytes of the represented Entity subclass. If 0, the pool
+    //                  is filled through the raw allocation function one instance at a time.
 
-        ClassInfo(const std::string &name, ClassInfo *pParentInfo = 0, void * (*fpAllocFunc)() = 0, void (*fpDeallocFunc)(void *) = 0, Entity * (*fpNewFunc)() = 0, int allocBlockCount = 10);
+        ClassInfo(const std::string &name, ClassInfo *pParentInfo = 0, void * (*fpAllocFunc)() = 0, void (*fpDeallocFunc)(void *) = 0, Entity * (*fpNewFunc)() = 0, int allocBlockCount = 10, size_t instanceSize = 0);
 
 
     //////////////////////////////////////////////////////////////////////////////////////////
@@ -293,7 +297,8 @@ public:
     //////////////////////////////////////////////////////////////////////////////////////////
     // Static method:   DumpPoolMemoryInfo
     //////////////////////////////////////////////////////////////////////////////////////////
-    // Description:     Writes a bunch of useful debug info about the memory pools to a file.
+    // Description:     Writes a bunch of useful debug info about the memory pools to a file;
+    //                  instances in use, peak use, and slab occupancy and fragmentation.
     // Arguments:       The writer to write info to.
     // Return value:    None.
 
@@ -324,12 +329,16 @@ public:
         // Next ClassInfo after this one on aforementioned unordered linked list.
         ClassInfo *m_NextClass;
 
-        // Pool of pre-allocated objects of the type described by this ClassInfo
+        // Pool of pre-allocated objects of the type described by this ClassInfo, packed into slabs
+        SlabAllocator m_SlabAllocator;
+        // Pool of pre-allocated objects, for when the size of the type isn't known and so can't be slab allocated
         std::vector<void *> m_AllocatedPool;
         // The number of instances to fill up the pool of this type with each time it runs dry
         int m_PoolAllocBlockCount;
         // The number of allocated instances passed out from the pool
         int m_InstancesInUse;
+        // The most instances that have been passed out at once
+        int m_PeakInstancesInUse;
     };
 
 
@@ -551,7 +560,7 @@ public:
 // Arguments:       A string reference with the preset description.
 // Return value:    None.
 
-    void SetDescription(const std::string &newDesc) { m_PresetDescription = newDesc; }
+    void SetDescription(const std::string &newDesc) { m_PresetDescription.Edit() = newDesc; }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -561,7 +570,7 @@ public:
 // Arguments:       None.
 // Return value:    A string reference with the plain text description name of this Preset.
 
-    const std::string & GetDescription() const { return m_PresetDescription; }
+    const std::string & GetDescription() const { return m_PresetDescription.Get(); }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -624,7 +633,19 @@ public:
 //                  ignored.
 // Return value:    None.
 
-    void AddToGroup(std::string newGroup) { m_Groups.push_back(newGroup); m_Groups.sort(); m_Groups.unique(); m_LastGroupSearch.clear(); }
+    void AddToGroup(std::string newGroup) { std::list<std::string> &groups = m_Groups.Edit(); groups.push_back(newGroup); groups.sort(); groups.unique(); m_LastGroupSearch.clear(); if (m_IsOriginalPreset && m_DefinedInModule >= 0) ++m_sPresetGroupChanges; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   GetPresetGroupChanges
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets how many times any preset already added to a DataModule has been
+//                  added to a new group. DataModule:s use this to know when their group
+//                  indices have gone stale.
+// Arguments:       None.
+// Return value:    The running count of preset group changes.
+
+    static int GetPresetGroupChanges() { return m_sPresetGroupChanges; }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -635,7 +656,7 @@ public:
 // Return value:    A pointer to a list of strings which describes the groups this is added
 //                  to. WOenrship is NOT transferred!
 
-    const std::list<std::string> * GetGroupList() { return &m_Groups; }
+    const std::list<std::string> * GetGroupList() { return &m_Groups.Get(); }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -692,16 +713,18 @@ protected:
     // Member variables
     // Type description of this Entity
     static Entity::ClassInfo m_sClass;
+    // Running count of group changes made to presets already added to a DataModule
+    static int m_sPresetGroupChanges;
     // The name of the Preset data this was cloned from, if any
     std::string m_PresetName;
     // Whether this is to be added to the PresetMan as an original preset instance.
     bool m_IsOriginalPreset;
     // The DataModule ID that this was successfully added to at some point. -1 if not added to anything yet.
     int m_DefinedInModule;
-    // The description of the preset in user firendly plain text that will show up in menus etc
-    std::string m_PresetDescription;
-    // List of all tags associated with this. The groups are used to categorize and organize Entity:s
-    std::list<std::string> m_Groups;
+    // The description of the preset in user firendly plain text that will show up in menus etc. Shared with the preset
+    SharedData<std::string> m_PresetDescription;
+    // List of all tags associated with this. The groups are used to categorize and organize Entity:s. Shared with the preset
+    SharedData<std::list<std::string> > m_Groups;
     // Last group search string, for more efficient response on multiple tries for the same group name
     std::string m_LastGroupSearch;
     // Last group search result, for more efficient response on multiple tries for the same group name
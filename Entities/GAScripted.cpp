@@ -19,6 +19,7 @@
 #include "ConsoleMan.h"
 #include "AudioMan.h"
 #include "SettingsMan.h" 
+#include "TimerMan.h"
 #include "AHuman.h"
 #include "ACrab.h"
 #include "SLTerrain.h"
@@ -467,7 +468,9 @@ void GAScripted::Update()
     if (m_ActivityState != DEMOEND)
     {
         // Call the defined function, but only after first checking if it exists
+        long long updateStart = g_TimerMan.GetAbsoulteTime();
         g_LuaMan.RunScriptString("if " + m_LuaClassName + ".UpdateActivity then " + m_LuaClassName + ":UpdateActivity(); end");
+        g_LuaMan.AddScriptTime(GetPresetName() + " (" + m_ScriptPath + ")", "UpdateActivity", g_TimerMan.GetAbsoulteTime() - updateStart);
 
 		UpdateGlobalScripts(false);
     }
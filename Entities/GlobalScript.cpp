@@ -14,6 +14,7 @@
 #include "GlobalScript.h"
 #include "PresetMan.h"
 #include "LuaMan.h"
+#include "TimerMan.h"
 #include "MovableMan.h"
 
 using namespace std;
@@ -234,7 +235,9 @@ void GlobalScript::End()
 void GlobalScript::Update()
 {
     // Call the defined function, but only after first checking if it exists
+    long long updateStart = g_TimerMan.GetAbsoulteTime();
     int error = g_LuaMan.RunScriptString("if " + m_LuaClassName + ".UpdateScript then " + m_LuaClassName + ":UpdateScript(); end");
+    g_LuaMan.AddScriptTime(GetPresetName() + " (" + m_ScriptPath + ")", "UpdateScript", g_TimerMan.GetAbsoulteTime() - updateStart);
 	// Kill script on any error to avoid spamming the console with error messages
 	if (error)
 		Deactivate();
@@ -652,6 +652,7 @@ void LimbPath::Draw(BITMAP *pTargetBitmap,
     {
         nextPoint += (*itr) * m_Rotation;
         line(pTargetBitmap, prevPoint.m_X, prevPoint.m_Y, nextPoint.m_X, nextPoint.m_Y, color);
+        g_SceneMan.RegisterMOColorDrawing(pTargetBitmap, MIN(prevPoint.m_X, nextPoint.m_X), MIN(prevPoint.m_Y, nextPoint.m_Y), MAX(prevPoint.m_X, nextPoint.m_X), MAX(prevPoint.m_Y, nextPoint.m_Y));
         prevPoint += (*itr) * m_Rotation;
     }
 
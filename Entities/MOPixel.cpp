@@ -444,6 +444,9 @@ void MOPixel::Draw(BITMAP *pTargetBitmap,
 
     if (mode == g_DrawMOID)
         g_SceneMan.RegisterMOIDDrawing(m_Pos - targetPos, 1);
+    // Any other mode could be drawing to the MOColor layer, which is the only one this registers with
+    else
+        g_SceneMan.RegisterMOColorDrawing(pTargetBitmap, m_Pos.GetFloorIntX() - targetPos.m_X, m_Pos.GetFloorIntY() - targetPos.m_Y, m_Pos.GetFloorIntX() - targetPos.m_X, m_Pos.GetFloorIntY() - targetPos.m_Y);
 
     // Set the screen effect to draw at the final post processing stage
     if (m_pScreenEffect && mode == g_DrawColor && !onlyPhysical && m_AgeTimer.IsPastSimMS(m_EffectStartTime) && (m_EffectStopTime == 0 || !m_AgeTimer.IsPastSimMS(m_EffectStopTime)) && (m_EffectAlwaysShows || !g_SceneMan.ObscuredPoint(m_Pos.GetFloorIntX(), m_Pos.GetFloorIntY())))
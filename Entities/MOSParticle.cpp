@@ -433,6 +433,9 @@ void MOSParticle::Draw(BITMAP *pTargetBitmap,
     else
         draw_sprite(pTargetBitmap, m_aSprite[m_Frame], spritePos.GetFloorIntX(), spritePos.GetFloorIntY());
 
+    // Register potential MOColor drawing, whatever the mode, which only counts if it was to the MOColor layer
+    g_SceneMan.RegisterMOColorDrawing(pTargetBitmap, spritePos.GetFloorIntX(), spritePos.GetFloorIntY(), spritePos.GetFloorIntX() + m_aSprite[m_Frame]->w, spritePos.GetFloorIntY() + m_aSprite[m_Frame]->h);
+
     // Set the screen effect to draw at the final post processing stage
     if (m_pScreenEffect && mode == g_DrawColor && !onlyPhysical && m_AgeTimer.IsPastSimMS(m_EffectStartTime) && (m_EffectStopTime == 0 || !m_AgeTimer.IsPastSimMS(m_EffectStopTime)) &&  (m_EffectAlwaysShows || !g_SceneMan.ObscuredPoint(m_Pos.GetFloorIntX(), m_Pos.GetFloorIntY())))
     {
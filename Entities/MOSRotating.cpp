@@ -19,6 +19,7 @@
 #include "MOSParticle.h"
 #include "AEmitter.h"
 #include "Attachable.h"
+#include "RotatedSpriteCache.h"
 
 #include "DDTError.h"
 
@@ -196,7 +197,7 @@ void MOSRotating::Clear()
     m_RecoilOffset.Reset();
     m_Emitters.clear();
     m_Attachables.clear();
-    m_Gibs.clear();
+    m_Gibs.Reset();
     m_GibImpulseLimit = 0;
     m_GibWoundLimit = 0;
     m_GibSound.Reset();
@@ -392,12 +393,8 @@ int MOSRotating::Create(const MOSRotating &reference)
         pAttachable = 0;
     }
 
-    for (list<MOSRotating::Gib>::const_iterator gItr = reference.m_Gibs.begin(); gItr != reference.m_Gibs.end(); ++gItr)
-    {
-        SLICK_PROFILENAME("Gib Copies", 0xFF775544);
-
-        m_Gibs.push_back(*gItr);
-    }
+    // The gibs are the preset's, and only change on copies in editors; shared until then
+    m_Gibs = reference.m_Gibs;
 
     m_GibImpulseLimit = reference.m_GibImpulseLimit;
     m_GibWoundLimit = reference.m_GibWoundLimit;
@@ -465,7 +462,7 @@ int MOSRotating::ReadProperty(std::string propName, Reader &reader)
     {
         Gib gib;
         reader >> gib;
-        m_Gibs.push_back(gib);
+        m_Gibs.Edit().push_back(gib);
     }
     else if (propName == "GibImpulseLimit")
         reader >> m_GibImpulseLimit;
@@ -522,7 +519,7 @@ int MOSRotating::Save(Writer &writer) const
         writer << (*aItr);
     }
 */
-    for (list<Gib>::const_iterator gItr = m_Gibs.begin(); gItr != m_Gibs.end(); ++gItr)
+    for (list<Gib>::const_iterator gItr = m_Gibs->begin(); gItr != m_Gibs->end(); ++gItr)
     {
         writer.NewProperty("AddGib");
         writer << (*gItr);
@@ -1014,7 +1011,7 @@ void MOSRotating::GibThis(Vector impactImpulse, float internalBlast, MovableObje
     MovableObject *pGib = 0;
     float velMin, velRange, spread, angularVel;
     Vector gibROffset, gibVel;
-    for (list<MOSRotating::Gib>::iterator gItr = m_Gibs.begin(); gItr != m_Gibs.end(); ++gItr)
+    for (list<MOSRotating::Gib>::const_iterator gItr = m_Gibs->begin(); gItr != m_Gibs->end(); ++gItr)
     {
         SLICK_PROFILENAME("Throwing out Gibs", 0xFF446542);
 
@@ -1860,8 +1857,34 @@ void MOSRotating::Draw(BITMAP *pTargetBitmap,
     if (m_Recoiled)
         spritePos += m_RecoilOffset;
 
+    // See if a cached pre-rotated copy of the sprite can be used instead of rotating it here.
+    // Silhouettes in the key color are left to the regular path, which draws nothing for those
+    BITMAP *pRotatedSprite = 0;
+    int silhouetteColor = -1;
+    RotatedSpriteCache::CacheUser cacheUser = RotatedSpriteCache::COLOR;
+    if (mode == g_DrawMaterial)
+    {
+        silhouetteColor = m_SettleMaterialDisabled ? GetMaterial()->id : GetMaterial()->GetSettleMaterialID();
+        cacheUser = RotatedSpriteCache::MATERIAL;
+    }
+    else if (mode == g_DrawWhite)
+    {
+        silhouetteColor = g_WhiteColor;
+        cacheUser = RotatedSpriteCache::MATERIAL;
+    }
+    else if (mode == g_DrawMOID || mode == g_DrawNoMOID)
+    {
+        silhouetteColor = mode == g_DrawMOID ? m_MOID : g_NoMOID;
+        cacheUser = RotatedSpriteCache::MOID;
+    }
+    if (mode == g_DrawColor || (silhouetteColor >= 0 && silhouetteColor != keyColor))
+    {
+        int pivotX = m_HFlipped ? m_aSprite[m_Frame]->w + m_SpriteOffset.m_X : -(m_SpriteOffset.m_X);
+        pRotatedSprite = RotatedSpriteCache::GetRotatedSprite(m_aSprite[m_Frame], m_HFlipped, pivotX, -(m_SpriteOffset.m_Y), m_Rotation.GetAllegroAngle(), m_Scale, cacheUser);
+    }
+
     // If we're drawing a material silhouette, then create an intermediate material bitmap as well
-    if (mode != g_DrawColor && mode != g_DrawTrans)
+    if (mode != g_DrawColor && mode != g_DrawTrans && !pRotatedSprite)
     {
         clear_to_color(pTempBitmap, keyColor);
 
@@ -1951,9 +1974,31 @@ void MOSRotating::Draw(BITMAP *pTargetBitmap,
 	}
 
 
+    //////////////////
+    // CACHED
+    if (pRotatedSprite)
+    {
+        int halfWidth = pRotatedSprite->w / 2;
+        int halfHeight = pRotatedSprite->h / 2;
+        for (int i = 0; i < passes; ++i)
+        {
+            int drawX = aDrawPos[i].GetFloorIntX() - halfWidth;
+            int drawY = aDrawPos[i].GetFloorIntY() - halfHeight;
+            if (mode == g_DrawColor)
+                draw_sprite(pTargetBitmap, pRotatedSprite, drawX, drawY);
+            else
+                draw_character_ex(pTargetBitmap, pRotatedSprite, drawX, drawY, silhouetteColor, -1);
+
+            // Register potential MOID or MOColor drawing, the latter whatever the mode as long as it's to the MOColor layer
+            if (mode == g_DrawMOID)
+                g_SceneMan.RegisterMOIDDrawing(aDrawPos[i].GetFloored(), m_MaxRadius + 2);
+            else
+                g_SceneMan.RegisterMOColorDrawing(pTargetBitmap, drawX, drawY, drawX + pRotatedSprite->w - 1, drawY + pRotatedSprite->h - 1);
+        }
+    }
     //////////////////
     // FLIPPED
-    if (m_HFlipped && pFlipBitmap)
+    else if (m_HFlipped && pFlipBitmap)
     {
         // Don't size the intermediate bitmaps to the m_Scale, because the scaling happens after they are done
         clear_to_color(pFlipBitmap, keyColor);
@@ -1983,7 +2028,10 @@ void MOSRotating::Draw(BITMAP *pTargetBitmap,
             // Draw the now rotated object's temporary bitmap onto the final drawing bitmap with transperency
             // Do the passes loop in here so the intermediate drawing doesn't get done multiple times
             for (int i = 0; i < passes; ++i)
+            {
                 draw_trans_sprite(pTargetBitmap, pTempBitmap, aDrawPos[i].GetFloorIntX() - (pTempBitmap->w / 2), aDrawPos[i].GetFloorIntY() - (pTempBitmap->h / 2));
+                g_SceneMan.RegisterMOColorDrawing(pTargetBitmap, aDrawPos[i].GetFloorIntX() - (pTempBitmap->w / 2), aDrawPos[i].GetFloorIntY() - (pTempBitmap->h / 2), aDrawPos[i].GetFloorIntX() + (pTempBitmap->w / 2), aDrawPos[i].GetFloorIntY() + (pTempBitmap->h / 2));
+            }
         }
         // Non-transparent mode
         else
@@ -2001,9 +2049,11 @@ void MOSRotating::Draw(BITMAP *pTargetBitmap,
                                     ftofix(m_Rotation.GetAllegroAngle()),
                                     ftofix(m_Scale));
 
-                // Register potential MOID drawing
+                // Register potential MOID or MOColor drawing, the latter whatever the mode as long as it's to the MOColor layer
                 if (mode == g_DrawMOID)
                     g_SceneMan.RegisterMOIDDrawing(aDrawPos[i].GetFloored(), m_MaxRadius + 2);
+                else
+                    g_SceneMan.RegisterMOColorDrawing(pTargetBitmap, aDrawPos[i].GetFloored(), m_MaxRadius * MAX(m_Scale, 1.0f) + 2);
             }
         }
     }
@@ -2033,7 +2083,10 @@ void MOSRotating::Draw(BITMAP *pTargetBitmap,
             // Draw the now rotated object's temporary bitmap onto the final drawing bitmap with transperency
             // Do the passes loop in here so the intermediate drawing doesn't get done multiple times
             for (int i = 0; i < passes; ++i)
+            {
                 draw_trans_sprite(pTargetBitmap, pTempBitmap, aDrawPos[i].GetFloorIntX() - (pTempBitmap->w / 2), aDrawPos[i].GetFloorIntY() - (pTempBitmap->h / 2));
+                g_SceneMan.RegisterMOColorDrawing(pTargetBitmap, aDrawPos[i].GetFloorIntX() - (pTempBitmap->w / 2), aDrawPos[i].GetFloorIntY() - (pTempBitmap->h / 2), aDrawPos[i].GetFloorIntX() + (pTempBitmap->w / 2), aDrawPos[i].GetFloorIntY() + (pTempBitmap->h / 2));
+            }
         }
         // Non-transparent mode
         else
@@ -2049,9 +2102,11 @@ void MOSRotating::Draw(BITMAP *pTargetBitmap,
                                     ftofix(m_Rotation.GetAllegroAngle()),
                                     ftofix(m_Scale));
 
-                // Register potential MOID drawing
+                // Register potential MOID or MOColor drawing, the latter whatever the mode as long as it's to the MOColor layer
                 if (mode == g_DrawMOID)
                     g_SceneMan.RegisterMOIDDrawing(aDrawPos[i].GetFloored(), m_MaxRadius + 2);
+                else
+                    g_SceneMan.RegisterMOColorDrawing(pTargetBitmap, aDrawPos[i].GetFloored(), m_MaxRadius * MAX(m_Scale, 1.0f) + 2);
             }
         }
     }
@@ -156,7 +156,7 @@ friend class LuaMan;
     // Arguments:       None.
     // Return value:    A pointer to the particle to be emitted. Not transferred!
 
-        virtual const MovableObject * GetParticlePreset() { return m_pGibParticle; }
+        virtual const MovableObject * GetParticlePreset() const { return m_pGibParticle; }
 
 
     //////////////////////////////////////////////////////////////////////////////////////////
@@ -506,10 +506,11 @@ ENTITYALLOCATION(MOSRotating)
 // Method:          GetGibList
 //////////////////////////////////////////////////////////////////////////////////////////
 // Description:     Gets direct access to the list of object this is to generate upon gibbing.
+//                  This gets its own copy of the list first, if it's shared with a preset.
 // Arguments:       None.
 // Return value:    A pointer to the list of gibs. Ownership is NOT transferred!
 
-    std::list<Gib> * GetGibList() { return &m_Gibs; }
+    std::list<Gib> * GetGibList() { return &m_Gibs.Edit(); }
 
 /*
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1153,8 +1154,8 @@ protected:
     std::list<AEmitter *> m_Emitters;
     // The list of general Attachables currently attached and Owned by this.
     std::list<Attachable *> m_Attachables;
-    // The list of Gib:s this will create when gibbed
-    std::list<Gib> m_Gibs;
+    // The list of Gib:s this will create when gibbed. Shared with the preset
+    SharedData<std::list<Gib> > m_Gibs;
     // The amount of impulse force required to gib this, in kg * (m/s). 0 means no limit
     float m_GibImpulseLimit;
     // The number of emitters allowed before this gets gibbed. 0 means this can't get gibbed
@@ -564,6 +564,9 @@ void MOSprite::Draw(BITMAP *pTargetBitmap,
             else
                 draw_sprite_h_flip(pTargetBitmap, m_aSprite[m_Frame], aDrawPos[i].GetFloorIntX(), aDrawPos[i].GetFloorIntY());
         }
+
+        // Register potential MOColor drawing, whatever the mode, which only counts if it was to the MOColor layer
+        g_SceneMan.RegisterMOColorDrawing(pTargetBitmap, aDrawPos[i].GetFloorIntX(), aDrawPos[i].GetFloorIntY(), aDrawPos[i].GetFloorIntX() + m_aSprite[m_Frame]->w, aDrawPos[i].GetFloorIntY() + m_aSprite[m_Frame]->h);
     }
 }
 
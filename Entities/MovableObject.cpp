@@ -18,6 +18,10 @@
 #include "LuaMan.h"
 #include "Atom.h"
 
+extern "C"
+{
+  #include "lauxlib.h"
+}
 
 using namespace std;
 
@@ -78,6 +82,8 @@ void MovableObject::Clear()
     m_ScriptPath.clear();
     m_ScriptPresetName.clear();
     m_ScriptObjectName.clear();
+    m_ScriptObjectRef = LUA_NOREF;
+    m_ScriptStateGeneration = 0;
     m_ScreenEffectFile.Reset();
     m_pScreenEffect = 0;
 	m_EffectRotAngle = 0;
@@ -465,13 +471,13 @@ int MovableObject::Save(Writer &writer) const
 
 void MovableObject::Destroy(bool notInherited)
 {
-    // Clean up the existence of this in the script state
-    if (!m_ScriptObjectName.empty())
+    // Clean up the existence of this in the script state, unless that state has since been replaced
+    if (!m_ScriptObjectName.empty() && m_ScriptStateGeneration == g_LuaMan.GetStateGeneration())
     {
-        // Call the scripted destruction function, but only after first checking if it and this instance's Lua representation really exists
-        g_LuaMan.RunScriptString("if " + m_ScriptPresetName + " and " + m_ScriptPresetName + ".Destroy and " + m_ScriptObjectName + " then " + m_ScriptPresetName + ".Destroy(" + m_ScriptObjectName + "); end");
-        // Assign nil to the variable that held this' representation in Lua
-        g_LuaMan.RunScriptString("if " + m_ScriptObjectName + " then " + m_ScriptObjectName + " = nil; end");
+        // Call the scripted destruction function, if it and this instance's Lua representation really exist
+        g_LuaMan.CallPresetFunction(m_ScriptPresetName, LuaMan::PRESET_DESTROY, m_ScriptObjectRef);
+        // Release the reference and assign nil to the variable that held this' representation in Lua
+        g_LuaMan.ReleaseObjectReference(m_ScriptObjectName, m_ScriptObjectRef, m_ScriptStateGeneration);
     }
 
     if (!notInherited)
@@ -512,9 +518,14 @@ int MovableObject::LoadScripts(string scriptPath)
 // TODO WAIT A MINUTE.. is this an original preset????!! .. does it matter? A: not really
     // Get a new ID for this original preset so we can assign the read-in function definitions to it
     m_ScriptPresetName = GetClassName() + "s." + g_LuaMan.GetNewPresetID();
+    // Account the time spent in this preset's functions under its name and script
+    g_LuaMan.SetPresetScriptName(m_ScriptPresetName, GetPresetName().empty() ? m_ScriptPath : GetPresetName() + " (" + m_ScriptPath + ")");
 
     // Clear out the instance object name so it gets created in the state upon first UpdateScript
+    if (!m_ScriptObjectName.empty())
+        g_LuaMan.ReleaseObjectReference(m_ScriptObjectName, m_ScriptObjectRef, m_ScriptStateGeneration);
     m_ScriptObjectName.clear();
+    m_ScriptObjectRef = LUA_NOREF;
 
     // Under the class' table, create a new table for all functions of this specific preset and its unique ID
     if ((error = g_LuaMan.RunScriptString(m_ScriptPresetName + " = {};")) < 0)
@@ -835,8 +846,15 @@ int MovableObject::UpdateScript()
 
     int error = 0;
 
+    // If the Lua state was re-created since this' representation was made in it, that is gone and has to be made again
+    if (!m_ScriptObjectName.empty() && m_ScriptStateGeneration != g_LuaMan.GetStateGeneration())
+    {
+        m_ScriptObjectName.clear();
+        m_ScriptObjectRef = LUA_NOREF;
+    }
+
     // Check to make sure the preset of this is still defined in the Lua state. If not, re-create it and recover gracefully
-    if (!g_LuaMan.ExpressionIsTrue(m_ScriptPresetName, false))
+    if (!g_LuaMan.PathIsDefined(m_ScriptPresetName))
         ReloadScripts();
 
     // First see if we even have a representation stored in the Lua state, and if not, create one
@@ -850,14 +868,17 @@ int MovableObject::UpdateScript()
         // Create the Lua variable which will hold the object instance of this instance for as long as it exists
         if ((error = g_LuaMan.RunScriptString(m_ScriptObjectName + " = To" + GetClassName() + "(MovableMan.ScriptedEntity);")) < 0)
             return error;
+        // Keep a direct reference to it so the preset functions can be called without compiling any strings
+        m_ScriptObjectRef = g_LuaMan.CreateObjectReference(m_ScriptObjectName);
+        m_ScriptStateGeneration = g_LuaMan.GetStateGeneration();
 
-        // Call the scripted creation function, but only after first checking if it and this instance's Lua representation really exists
-        if ((error = g_LuaMan.RunScriptString("if " + m_ScriptPresetName + ".Create and " + m_ScriptObjectName + " then " + m_ScriptPresetName + ".Create(" + m_ScriptObjectName + "); end")) < 0)
+        // Call the scripted creation function, if it and this instance's Lua representation really exist
+        if ((error = g_LuaMan.CallPresetFunction(m_ScriptPresetName, LuaMan::PRESET_CREATE, m_ScriptObjectRef)) < 0)
             return error;
     }
 
-    // Call the defined function, but only after first checking if it and this instance's Lua representation exists
-    if ((error = g_LuaMan.RunScriptString("if " + m_ScriptPresetName + ".Update and " + m_ScriptObjectName + " then " + m_ScriptPresetName + ".Update(" + m_ScriptObjectName + "); end")) < 0)
+    // Call the defined function, if it and this instance's Lua representation exist
+    if ((error = g_LuaMan.CallPresetFunction(m_ScriptPresetName, LuaMan::PRESET_UPDATE, m_ScriptObjectRef)) < 0)
         return error;
 
     return error;
@@ -884,7 +905,7 @@ int MovableObject::OnPieMenu(Actor * pActor)
 
 	int error = 0;
 
-	if ((error = g_LuaMan.RunScriptString("if " + m_ScriptPresetName + ".OnPieMenu and " + m_ScriptObjectName + " then " + m_ScriptPresetName + ".OnPieMenu(" + m_ScriptObjectName + "); end")) < 0)
+	if ((error = g_LuaMan.CallPresetFunction(m_ScriptPresetName, LuaMan::PRESET_ONPIEMENU, m_ScriptObjectRef)) < 0)
 		return error;
 
 	return error;
@@ -912,7 +933,7 @@ void MovableObject::UpdateMOID(vector<MovableObject *> &MOIDIndex,
     UpdateChildMOIDs(MOIDIndex, rootMOID, makeNewMOID);
 
     // Figure out the total MOID footstep of this and all its children combined
-    m_MOIDFootprint = MOIDIndex.size() - m_MOID;
+    m_MOIDFootprint = m_MOID == g_NoMOID ? 0 : MOIDIndex.size() - m_MOID;
 }
 
 
@@ -943,16 +964,22 @@ void MovableObject::RegMOID(vector<MovableObject *> &MOIDIndex,
     // Make a new MOID for itself
     if (makeNewMOID)
     {
-		// Skip g_NoMOID item
-		if (MOIDIndex.size() == g_NoMOID)
+		// Skip the key color of the MOID silhouettes, those pixels never make it onto the MOID layer
+		if (MOIDIndex.size() == g_KeyColorS)
 			MOIDIndex.push_back(0);
 
-		m_MOID = MOIDIndex.size();
-		MOIDIndex.push_back(this);
+		// All out of IDs, so this won't get hit by other MOs this frame
+		if (MOIDIndex.size() >= g_NoMOID)
+			m_MOID = g_NoMOID;
+		else
+		{
+			m_MOID = MOIDIndex.size();
+			MOIDIndex.push_back(this);
+		}
     }
     // Use the parent's MOID instead (the two are considered the same MO)
     else
-        m_MOID = MOIDIndex.size() - 1;
+        m_MOID = MOIDIndex.size() >= g_NoMOID ? static_cast<MOID>(g_NoMOID) : static_cast<MOID>(MOIDIndex.size() - 1);
 
     // Assign the root MOID
     m_RootMOID = (rootMOID == g_NoMOID ? m_MOID : rootMOID);
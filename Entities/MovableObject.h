@@ -59,6 +59,7 @@ enum MOType
 };
 
 friend class Atom;
+friend class ParticleStore;
 
 /* Should be in all concrete subclasses
 // Concrete allocation and cloning definitions
@@ -1840,6 +1841,10 @@ protected:
     std::string m_ScriptPresetName;
     // The ID name unique to this' object instance representation in the Lua state.
     std::string m_ScriptObjectName;
+    // Registry reference to this' object instance representation in the Lua state, so preset functions can be called directly
+    int m_ScriptObjectRef;
+    // The generation of the Lua state the above representation and reference were made in
+    int m_ScriptStateGeneration;
 
     // Special post processing flash effect file and Bitmap. Shuold be loaded from a 32bpp bitmap
     ContentFile m_ScreenEffectFile;
@@ -0,0 +1,443 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// File:            ParticleStore.cpp
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Source file for the ParticleStore class.
+// Project:         Retro Terrain Engine
+// Author(s):
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Inclusions of header files
+
+#include "ParticleStore.h"
+#include "MOPixel.h"
+#include "Atom.h"
+#include "SceneMan.h"
+#include "FrameMan.h"
+#include "TimerMan.h"
+
+using namespace std;
+
+namespace RTE
+{
+
+// MOPixel::Update deletes any pixel older than this, to get rid of ones bouncing around forever
+static const float s_MaxPixelAge = 10000;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Clear
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Clears all the member variables of this ParticleStore, effectively
+//                  resetting the members of this abstraction level only.
+
+void ParticleStore::Clear()
+{
+    m_pPixels.clear();
+    m_PosX.clear();
+    m_PosY.clear();
+    m_VelX.clear();
+    m_VelY.clear();
+    m_GlobalAccScalar.clear();
+    m_AirResistance.clear();
+    m_AirThreshold.clear();
+    m_TimeLeft.clear();
+    m_Color.clear();
+    m_Material.clear();
+    m_Flags.clear();
+    m_NextX.clear();
+    m_NextY.clear();
+    m_Touched.clear();
+    m_Promoted.clear();
+    m_Expired.clear();
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Destroy
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Deletes all the kept MOPixels and resets (through Clear()) the
+//                  ParticleStore.
+
+void ParticleStore::Destroy()
+{
+    for (vector<MOPixel *>::iterator itr = m_pPixels.begin(); itr != m_pPixels.end(); ++itr)
+        delete (*itr);
+    for (deque<MovableObject *>::iterator itr = m_Touched.begin(); itr != m_Touched.end(); ++itr)
+        delete (*itr);
+    for (deque<MovableObject *>::iterator itr = m_Promoted.begin(); itr != m_Promoted.end(); ++itr)
+        delete (*itr);
+    for (deque<MovableObject *>::iterator itr = m_Expired.begin(); itr != m_Expired.end(); ++itr)
+        delete (*itr);
+
+    Clear();
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   CanStore
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Shows whether an MO is simple enough to be kept in here.
+
+bool ParticleStore::CanStore(const MovableObject *pMO)
+{
+    // Exactly MOPixel; anything derived from it may well do more in its overrides
+    if (!pMO || pMO->GetClassName() != "MOPixel")
+        return false;
+
+    if (!pMO->m_ScriptPath.empty() || pMO->m_HitsMOs || pMO->m_GetsHitByMOs || pMO->m_PinStrength > 0 || pMO->m_MissionCritical || pMO->m_RandomizeEffectRotAngleEveryFrame)
+        return false;
+    if (!pMO->m_Forces.empty() || !pMO->m_ImpulseForces.empty())
+        return false;
+
+    const Atom *pAtom = static_cast<const MOPixel *>(pMO)->GetAtom();
+    return pAtom && pAtom->GetMaterial() && pAtom->GetTrailLength() <= 0 && pAtom->GetOffset().IsZero();
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Add
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Takes over a MOPixel that passed CanStore.
+
+void ParticleStore::Add(MOPixel *pPixel)
+{
+    DAssert(CanStore(pPixel), "Adding a particle to the ParticleStore which can't be kept there!");
+
+    float timeLeft = s_MaxPixelAge;
+    if (pPixel->m_Lifetime > 0 && pPixel->m_Lifetime < timeLeft)
+        timeLeft = pPixel->m_Lifetime;
+    timeLeft -= pPixel->GetAge();
+
+    unsigned char flags = 0;
+    if (pPixel->m_IgnoreTerrain)
+        flags |= IGNORETERRAIN;
+    if (pPixel->m_pScreenEffect)
+        flags |= SCREENEFFECT;
+
+    m_pPixels.push_back(pPixel);
+    m_PosX.push_back(pPixel->m_Pos.m_X);
+    m_PosY.push_back(pPixel->m_Pos.m_Y);
+    m_VelX.push_back(pPixel->m_Vel.m_X);
+    m_VelY.push_back(pPixel->m_Vel.m_Y);
+    m_GlobalAccScalar.push_back(pPixel->m_GlobalAccScalar);
+    m_AirResistance.push_back(pPixel->m_AirResistance);
+    m_AirThreshold.push_back(pPixel->m_AirThreshold);
+    m_TimeLeft.push_back(timeLeft);
+    m_Color.push_back(pPixel->GetColor().GetIndex());
+    m_Material.push_back(pPixel->GetAtom()->GetMaterial()->GetSettleMaterialID());
+    m_Flags.push_back(flags);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Release
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gives up a kept MOPixel.
+
+bool ParticleStore::Release(const MovableObject *pMO)
+{
+    for (int i = 0; i < m_pPixels.size(); ++i)
+    {
+        if (m_pPixels[i] == pMO)
+        {
+            Remove(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Travel
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Applies gravity and air resistance to all kept particles, and moves
+//                  the ones whose paths are clear.
+
+void ParticleStore::Travel(float travelTime)
+{
+    // Let the MOPixels changed by scripts and the like since the last Travel take it from here, as they are now
+    for (int i = m_pPixels.size() - 1; i >= 0; --i)
+    {
+        if (IsTouched(i))
+            m_Touched.push_back(Remove(i));
+    }
+
+    int count = m_pPixels.size();
+    if (count == 0)
+        return;
+
+    Vector globalAcc = g_SceneMan.GetGlobalAcc();
+    float accX = globalAcc.m_X * travelTime;
+    float accY = globalAcc.m_Y * travelTime;
+    float travelPixels = travelTime * g_FrameMan.GetPPM();
+    float travelMS = travelTime * 1000;
+
+    m_NextX.resize(count);
+    m_NextY.resize(count);
+
+    // Integrate; the same as MovableObject::ApplyForces and the free flight part of Atom::Travel, but without touching anything but these arrays
+    for (int i = 0; i < count; ++i)
+    {
+        float velX = m_VelX[i] + accX * m_GlobalAccScalar[i];
+        float velY = m_VelY[i] + accY * m_GlobalAccScalar[i];
+        float largest = MAX(fabs(velX), fabs(velY));
+        if (m_AirResistance[i] > 0 && largest >= m_AirThreshold[i])
+        {
+            float retardation = 1.0F - m_AirResistance[i] * travelTime;
+            velX *= retardation;
+            velY *= retardation;
+        }
+        m_VelX[i] = velX;
+        m_VelY[i] = velY;
+        m_NextX[i] = m_PosX[i] + velX * travelPixels;
+        m_NextY[i] = m_PosY[i] + velY * travelPixels;
+        m_TimeLeft[i] -= travelMS;
+    }
+
+    // Check all the paths against the terrain, and move or release each particle. Go backwards so the ones moved into released slots have been checked already
+    for (int i = count - 1; i >= 0; --i)
+    {
+        if (!(m_Flags[i] & IGNORETERRAIN) && !PathIsClear(m_PosX[i], m_PosY[i], m_NextX[i], m_NextY[i]))
+        {
+            // Let the MOPixel take it from here, still at where it started this frame
+            m_pPixels[i]->m_Vel.SetXY(m_VelX[i], m_VelY[i]);
+            m_Promoted.push_back(Remove(i));
+            continue;
+        }
+
+        float posX = m_NextX[i];
+        float posY = m_NextY[i];
+        if (g_SceneMan.SceneWrapsX())
+        {
+            float width = g_SceneMan.GetSceneWidth();
+            if (posX < 0)
+                posX += width;
+            else if (posX >= width)
+                posX -= width;
+        }
+        if (g_SceneMan.SceneWrapsY())
+        {
+            float height = g_SceneMan.GetSceneHeight();
+            if (posY < 0)
+                posY += height;
+            else if (posY >= height)
+                posY -= height;
+        }
+        m_PosX[i] = posX;
+        m_PosY[i] = posY;
+
+        // Same as MovableObject::FixTooFast
+        if (MAX(fabs(m_VelX[i]), fabs(m_VelY[i])) > 500)
+        {
+            float scale = 450 / sqrtf(m_VelX[i] * m_VelX[i] + m_VelY[i] * m_VelY[i]);
+            m_VelX[i] *= scale;
+            m_VelY[i] *= scale;
+        }
+
+        // Keep the MOPixel up to date, so anything looking at it sees where it is, and IsTouched can tell if it's changed
+        m_pPixels[i]->m_Pos.SetXY(posX, posY);
+        m_pPixels[i]->m_Vel.SetXY(m_VelX[i], m_VelY[i]);
+
+        // Same checks as MovableObject::PostTravel and MOPixel::Update
+        if (m_TimeLeft[i] < 0 || !g_SceneMan.IsWithinBounds(floorf(posX), floorf(posY), 100))
+        {
+            MOPixel *pPixel = Remove(i);
+            pPixel->SetToDelete(true);
+            m_Expired.push_back(pPixel);
+        }
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          TakeReleased
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Hands over the particles released during the last Travel.
+
+void ParticleStore::TakeReleased(deque<MovableObject *> &touched, deque<MovableObject *> &promoted, deque<MovableObject *> &expired)
+{
+    touched.insert(touched.end(), m_Touched.begin(), m_Touched.end());
+    promoted.insert(promoted.end(), m_Promoted.begin(), m_Promoted.end());
+    expired.insert(expired.end(), m_Expired.begin(), m_Expired.end());
+    m_Touched.clear();
+    m_Promoted.clear();
+    m_Expired.clear();
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Draw
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Draws all kept particles to a BITMAP of choice.
+
+void ParticleStore::Draw(BITMAP *pTargetBitmap, const Vector &targetPos, DrawMode mode) const
+{
+    // Don't draw color if this isn't a drawing frame, same as MOPixel
+    if (mode == g_DrawColor && !g_TimerMan.DrawnSimUpdate())
+        return;
+
+    int count = m_pPixels.size();
+    int offsetX = targetPos.GetFloorIntX();
+    int offsetY = targetPos.GetFloorIntY();
+
+    acquire_bitmap(pTargetBitmap);
+
+    for (int i = 0; i < count; ++i)
+    {
+        // Glows are set up by the MOPixel itself, it knows all about its screen effect
+        if (mode == g_DrawColor && (m_Flags[i] & SCREENEFFECT))
+        {
+            m_pPixels[i]->Draw(pTargetBitmap, targetPos, mode);
+            continue;
+        }
+
+        int drawX = (int)floorf(m_PosX[i]) - offsetX;
+        int drawY = (int)floorf(m_PosY[i]) - offsetY;
+        putpixel(pTargetBitmap, drawX, drawY, mode == g_DrawMaterial ? m_Material[i] : m_Color[i]);
+        if (mode == g_DrawColor)
+            g_SceneMan.RegisterMOColorDrawing(pTargetBitmap, drawX, drawY, drawX, drawY);
+    }
+
+    release_bitmap(pTargetBitmap);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetStateHash
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Folds the positions and velocities of all kept particles into a
+//                  running hash.
+
+unsigned int ParticleStore::GetStateHash(unsigned int hash) const
+{
+    if (m_pPixels.empty())
+        return hash;
+
+    size_t arraySize = m_pPixels.size() * sizeof(float);
+    hash = HashBytes(&m_PosX[0], arraySize, hash);
+    hash = HashBytes(&m_PosY[0], arraySize, hash);
+    hash = HashBytes(&m_VelX[0], arraySize, hash);
+    return HashBytes(&m_VelY[0], arraySize, hash);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          PathIsClear
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Walks the pixel path from one point to another the same way
+//                  Atom::Travel would, to see if it runs into any terrain.
+
+bool ParticleStore::PathIsClear(float startX, float startY, float endX, float endY) const
+{
+    int intPos[2], delta[2], delta2[2], increment[2];
+    intPos[X] = floorf(startX);
+    intPos[Y] = floorf(startY);
+    delta[X] = (int)floorf(endX) - intPos[X];
+    delta[Y] = (int)floorf(endY) - intPos[Y];
+
+    // Not moving a whole pixel, so nothing to run into
+    if (delta[X] == 0 && delta[Y] == 0)
+        return true;
+
+    // Starting out embedded in terrain always results in a penetration attempt
+    if (g_SceneMan.GetTerrMatter(intPos[X], intPos[Y]) != g_MaterialAir)
+        return false;
+
+    increment[X] = delta[X] < 0 ? -1 : 1;
+    increment[Y] = delta[Y] < 0 ? -1 : 1;
+    delta[X] = abs(delta[X]);
+    delta[Y] = abs(delta[Y]);
+    delta2[X] = delta[X] << 1;
+    delta2[Y] = delta[Y] << 1;
+
+    // Kept particles have never bounced, so the Atom would start the error fresh too
+    int dom = delta[X] > delta[Y] ? X : Y;
+    int sub = dom == X ? Y : X;
+    int error = delta2[sub] - delta[dom];
+
+    for (int domSteps = 0; domSteps < delta[dom]; ++domSteps)
+    {
+        intPos[dom] += increment[dom];
+        if (error >= 0)
+        {
+            intPos[sub] += increment[sub];
+            error -= delta2[dom];
+        }
+        error += delta2[sub];
+
+        g_SceneMan.WrapPosition(intPos[X], intPos[Y]);
+
+        if (g_SceneMan.GetTerrMatter(intPos[X], intPos[Y]) != g_MaterialAir)
+            return false;
+    }
+
+    return true;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsTouched
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Shows whether the MOPixel of the particle at an index has been changed
+//                  by anything outside the store since the last Travel.
+
+bool ParticleStore::IsTouched(int index) const
+{
+    const MOPixel *pPixel = m_pPixels[index];
+    if (pPixel->IsSetToDelete() || !pPixel->m_Forces.empty() || !pPixel->m_ImpulseForces.empty())
+        return true;
+    if (pPixel->m_HitsMOs || pPixel->m_GetsHitByMOs || pPixel->m_PinStrength > 0)
+        return true;
+    // Travel leaves its own results in there, so anything else was set from outside
+    return pPixel->m_Pos.m_X != m_PosX[index] || pPixel->m_Pos.m_Y != m_PosY[index] || pPixel->m_Vel.m_X != m_VelX[index] || pPixel->m_Vel.m_Y != m_VelY[index];
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Remove
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Drops the particle at an index from the arrays by moving the last one
+//                  into its place.
+
+MOPixel * ParticleStore::Remove(int index)
+{
+    MOPixel *pPixel = m_pPixels[index];
+    // It hasn't been resting while in here, so don't let it settle in mid air right away
+    pPixel->NotResting();
+
+    int last = m_pPixels.size() - 1;
+    if (index != last)
+    {
+        m_pPixels[index] = m_pPixels[last];
+        m_PosX[index] = m_PosX[last];
+        m_PosY[index] = m_PosY[last];
+        m_VelX[index] = m_VelX[last];
+        m_VelY[index] = m_VelY[last];
+        m_GlobalAccScalar[index] = m_GlobalAccScalar[last];
+        m_AirResistance[index] = m_AirResistance[last];
+        m_AirThreshold[index] = m_AirThreshold[last];
+        m_TimeLeft[index] = m_TimeLeft[last];
+        m_Color[index] = m_Color[last];
+        m_Material[index] = m_Material[last];
+        m_Flags[index] = m_Flags[last];
+    }
+
+    m_pPixels.pop_back();
+    m_PosX.pop_back();
+    m_PosY.pop_back();
+    m_VelX.pop_back();
+    m_VelY.pop_back();
+    m_GlobalAccScalar.pop_back();
+    m_AirResistance.pop_back();
+    m_AirThreshold.pop_back();
+    m_TimeLeft.pop_back();
+    m_Color.pop_back();
+    m_Material.pop_back();
+    m_Flags.pop_back();
+
+    return pPixel;
+}
+
+} // namespace RTE
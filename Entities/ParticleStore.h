@@ -0,0 +1,289 @@
+#ifndef _RTEPARTICLESTORE_
+#define _RTEPARTICLESTORE_
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// File:            ParticleStore.h
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Header file for the ParticleStore class.
+// Project:         Retro Terrain Engine
+// Author(s):
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Inclusions of header files
+
+#include <deque>
+#include <vector>
+#include "Entity.h"
+
+struct BITMAP;
+
+namespace RTE
+{
+
+class MovableObject;
+class MOPixel;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Class:           ParticleStore
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Keeps the plain, unscripted MOPixels that nothing can hit - sparks,
+//                  smoke, blood and the like - while they fly freely, with their position,
+//                  velocity, remaining lifetime, color and material in packed arrays
+//                  instead of spread over full MovableObjects. They are moved in one tight
+//                  loop over those arrays and their paths are all checked against the
+//                  terrain in a second. Their MOPixels are kept up to date with where they
+//                  are, and as soon as one would hit anything, or is changed by anything
+//                  outside the store, it is released to travel and collide as usual.
+// Parent(s):       None.
+// Class history:   10/17/2026 ParticleStore created.
+
+class ParticleStore
+{
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Public member variable, method and friend function declarations
+
+public:
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Constructor:     ParticleStore
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Constructor method used to instantiate a ParticleStore object in
+//                  system memory.
+// Arguments:       None.
+
+    ParticleStore() { Clear(); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Destructor:      ~ParticleStore
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Destructor method used to clean up a ParticleStore object before
+//                  deletion from system memory.
+// Arguments:       None.
+
+    ~ParticleStore() { Destroy(); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Destroy
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Deletes all the kept MOPixels and resets (through Clear()) the
+//                  ParticleStore.
+// Arguments:       None.
+// Return value:    None.
+
+    void Destroy();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   CanStore
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Shows whether an MO is simple enough to be kept in here; a plain
+//                  MOPixel with no script, trail or pinning, which neither hits nor gets
+//                  hit by other MOs, and has no forces waiting to be applied.
+// Arguments:       The MO to check.
+// Return value:    Whether it can be added.
+
+    static bool CanStore(const MovableObject *pMO);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Add
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Takes over a MOPixel that passed CanStore.
+// Arguments:       The MOPixel. Ownership IS transferred!
+// Return value:    None.
+
+    void Add(MOPixel *pPixel);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Release
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gives up a kept MOPixel.
+// Arguments:       The MO to release.
+// Return value:    Whether it was kept in here. If so, ownership IS transferred to the
+//                  caller.
+
+    bool Release(const MovableObject *pMO);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Travel
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Applies gravity and air resistance to all kept particles, and moves
+//                  the ones whose paths are clear. The ones that have been changed from
+//                  outside since the last Travel are released first, untouched. The ones
+//                  that would hit terrain are released with the forces applied but before
+//                  moving, so they can travel as usual. The ones that expire or leave the
+//                  scene are released marked for deletion.
+// Arguments:       The time to travel for, in seconds.
+// Return value:    None.
+
+    void Travel(float travelTime);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          TakeReleased
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Hands over the particles released during the last Travel.
+// Arguments:       The list to append the ones changed from outside to. Nothing has been
+//                  done to them this frame. Ownership IS transferred!
+//                  The list to append the ones to travel as usual to. Their forces for
+//                  this frame have already been applied. Ownership IS transferred!
+//                  The list to append the ones marked for deletion to. Ownership IS
+//                  transferred!
+// Return value:    None.
+
+    void TakeReleased(std::deque<MovableObject *> &touched, std::deque<MovableObject *> &promoted, std::deque<MovableObject *> &expired);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Draw
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Draws all kept particles to a BITMAP of choice.
+// Arguments:       The bitmap to draw to.
+//                  The absolute position of the target bitmap's upper left corner in the
+//                  scene.
+//                  Which mode to draw in; g_DrawColor or g_DrawMaterial.
+// Return value:    None.
+
+    void Draw(BITMAP *pTargetBitmap, const Vector &targetPos, DrawMode mode = g_DrawColor) const;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetPixels
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the kept MOPixels.
+// Arguments:       None.
+// Return value:    The MOPixels. Ownership is NOT transferred!
+
+    const std::vector<MOPixel *> & GetPixels() const { return m_pPixels; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetCount
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the number of kept particles.
+// Arguments:       None.
+// Return value:    The count.
+
+    int GetCount() const { return m_pPixels.size(); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetStateHash
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Folds the positions and velocities of all kept particles into a
+//                  running hash.
+// Arguments:       The hash so far.
+// Return value:    The new hash.
+
+    unsigned int GetStateHash(unsigned int hash) const;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Protected member variable and method declarations
+
+protected:
+
+    // Per particle flags
+    enum ParticleFlags
+    {
+        IGNORETERRAIN = 1,
+        SCREENEFFECT = 2
+    };
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          PathIsClear
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Walks the pixel path from one point to another the same way
+//                  Atom::Travel would, to see if it runs into any terrain.
+// Arguments:       The start and end points.
+// Return value:    Whether the path is clear.
+
+    bool PathIsClear(float startX, float startY, float endX, float endY) const;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsTouched
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Shows whether the MOPixel of the particle at an index has been changed
+//                  by anything outside the store since the last Travel; moved, pushed,
+//                  marked for deletion or made to hit MOs.
+// Arguments:       The index.
+// Return value:    Whether it has been.
+
+    bool IsTouched(int index) const;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Remove
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Drops the particle at an index from the arrays by moving the last one
+//                  into its place.
+// Arguments:       The index.
+// Return value:    The MOPixel. Ownership IS transferred!
+
+    MOPixel * Remove(int index);
+
+
+    // The kept MOPixels, in the same order as the arrays below
+    std::vector<MOPixel *> m_pPixels;
+    // Position in pixels and velocity in meters per second
+    std::vector<float> m_PosX;
+    std::vector<float> m_PosY;
+    std::vector<float> m_VelX;
+    std::vector<float> m_VelY;
+    // Scalar of the scene's gravity, and air resistance and the speed it kicks in at
+    std::vector<float> m_GlobalAccScalar;
+    std::vector<float> m_AirResistance;
+    std::vector<float> m_AirThreshold;
+    // Sim time left until expiring, in ms
+    std::vector<float> m_TimeLeft;
+    // Palette color index, and settle material ID for drawing matter
+    std::vector<unsigned char> m_Color;
+    std::vector<unsigned char> m_Material;
+    // ParticleFlags
+    std::vector<unsigned char> m_Flags;
+    // Where each particle would end up this frame, filled in by the integration step of Travel. Not kept in step
+    // with the others by Remove, as Travel only removes particles it's done with
+    std::vector<float> m_NextX;
+    std::vector<float> m_NextY;
+    // The particles released during the last Travel
+    std::deque<MovableObject *> m_Touched;
+    std::deque<MovableObject *> m_Promoted;
+    std::deque<MovableObject *> m_Expired;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Private member variable and method declarations
+
+private:
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Clear
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Clears all the member variables of this ParticleStore, effectively
+//                  resetting the members of this abstraction level only.
+// Arguments:       None.
+// Return value:    None.
+
+    void Clear();
+
+
+    // Disallow the use of some implicit methods.
+    ParticleStore(const ParticleStore &reference);
+    ParticleStore & operator=(const ParticleStore &rhs);
+
+};
+
+} // namespace RTE
+
+#endif // File
@@ -21,6 +21,12 @@
 #include "MOPixel.h"
 #include "MOSprite.h"
 #include "Atom.h"
+#include "ThreadMan.h"
+#include "TimerMan.h"
+#include "SettingsMan.h"
+#include "ConsoleMan.h"
+#include <functional>
+#include <cstring>
 
 using namespace std;
 
@@ -44,6 +50,8 @@ BITMAP * SLTerrain::m_spTempBitmap64 = 0;
 BITMAP * SLTerrain::m_spTempBitmap128 = 0;
 BITMAP * SLTerrain::m_spTempBitmap256 = 0;
 BITMAP * SLTerrain::m_spTempBitmap512 = 0;
+const int SLTerrain::m_TexturingStripeHeight = 64;
+const int SLTerrain::m_FrostingStripeWidth = 256;
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -165,6 +173,8 @@ void SLTerrain::Clear()
     m_DrawMaterial = false;
 	m_NeedToClearFrostings = false;
 	m_NeedToClearDebris = false;
+    for (int stage = 0; stage < LOADSTAGECOUNT; ++stage)
+        m_LoadStageTimes[stage] = 0;
 }
 
 
@@ -284,6 +294,9 @@ int SLTerrain::LoadData()
     DAssert(m_pFGColor, "Terrain's foreground layer not instantiated before trying to load its data!");
     DAssert(m_pBGColor, "Terrain's background layer not instantiated before trying to load its data!");
 
+    for (int stage = 0; stage < LOADSTAGECOUNT; ++stage)
+        m_LoadStageTimes[stage] = 0;
+
     // Check if our color layers' BITMAP data is also to be loaded from disk, and not be generated from the material bitmap!
     if (m_pFGColor->IsFileData() && m_pBGColor->IsFileData())
     {
@@ -302,6 +315,8 @@ int SLTerrain::LoadData()
         return 0;
     }
 
+    int64_t stageStart = g_TimerMan.GetAbsoulteTime();
+
     // Create blank foreground layer
     m_pFGColor->Destroy();
     BITMAP *pFGBitmap = create_bitmap_ex(8, m_pMainBitmap->w, m_pMainBitmap->h);
@@ -326,173 +341,102 @@ int SLTerrain::LoadData()
     AAssert(m_pStructural, "Failed to allocate BITMAP in Terrain::Create");
     clear_bitmap(m_pStructural);
 
+    stageStart = TimeLoadStage(LOADLAYERS, stageStart);
+
     ///////////////////////////////////////////////
     // Load and texturize the FG color bitmap, based on the materials defined in the recently loaded (main) material layer!
 
-    int xPos, yPos, matIndex, pixelColor;
+    int matIndex;
+    int sceneWidth = m_pMainBitmap->w;
 
-    // Temporary references for all the materials' textures and colors, since we'll access them a lot
-    BITMAP *apTexBitmaps[256];
-    int aColors[256];
-    // Null em out so we can tell which ones we've already got once so far
-    for (matIndex = 0; matIndex < 256; ++matIndex)
-    {
-        apTexBitmaps[matIndex] = 0;
-        aColors[matIndex] = 0;
-    }
+    // The x % width tables for each distinct texture width, shared by all textures of that width
+    map<int, vector<int> > wrapTables;
 
+    TexturingPass texturing;
+    texturing.m_pFGBitmap = pFGBitmap;
+    texturing.m_pBGBitmap = pBGBitmap;
     // Get the background texture
-    BITMAP *m_pBGTexture = m_BGTextureFile.GetAsBitmap();
-    // Get the material palette for quicker access
-    Material **apMaterials = g_SceneMan.GetMaterialPalette();
+    texturing.m_pBGTexture = m_BGTextureFile.GetAsBitmap();
+    texturing.m_pBGWrapX = texturing.m_pBGTexture ? GetWrapTable(wrapTables, texturing.m_pBGTexture->w, sceneWidth) : 0;
     // Get the Material palette ID mappings local to the DataModule this SLTerrain is loaded from
-    const unsigned char *materialMappings = g_PresetMan.GetDataModule(m_BitmapFile.GetDataModuleID())->GetAllMaterialMappings();
+    texturing.m_MaterialMappings = g_PresetMan.GetDataModule(m_BitmapFile.GetDataModuleID())->GetAllMaterialMappings();
+
+    // Look up the texture or color of every material ID once, instead of for every pixel
+    Material **apMaterials = g_SceneMan.GetMaterialPalette();
     Material *pMaterial = 0;
+    for (matIndex = 0; matIndex < 256; ++matIndex)
+    {
+        // Validate the material, or default to default material
+        if (matIndex < NUM_PALETTE_ENTRIES && apMaterials[matIndex])
+            pMaterial = apMaterials[matIndex];
+        else
+            pMaterial = apMaterials[g_MaterialDefault];
+
+        texturing.m_apTextures[matIndex] = pMaterial->GetTexture();
+        texturing.m_aColors[matIndex] = pMaterial->color.GetIndex();
+        texturing.m_apWrapX[matIndex] = 0;
+        if (texturing.m_apTextures[matIndex])
+        {
+            acquire_bitmap(texturing.m_apTextures[matIndex]);
+            texturing.m_apWrapX[matIndex] = GetWrapTable(wrapTables, texturing.m_apTextures[matIndex]->w, sceneWidth);
+            texturing.m_TexturedIDs.push_back(matIndex);
+        }
+    }
 
     // Lock all involved bitmaps
     acquire_bitmap(m_pMainBitmap);
     acquire_bitmap(pFGBitmap);
     acquire_bitmap(pBGBitmap);
-    acquire_bitmap(m_pBGTexture);
+    acquire_bitmap(texturing.m_pBGTexture);
 
-    // Go through each pixel on the main bitmap, which contains all the material pixels loaded from the bitmap
-    // Place texture pixels on the FG layer corresponding to the materials on the main material bitmap
-    for (xPos = 0; xPos < m_pMainBitmap->w; ++xPos)
-    {
-        for (yPos = 0; yPos < m_pMainBitmap->h; ++yPos)
-        {
-            // Read which material the current pixel represents
-            matIndex = _getpixel(m_pMainBitmap, xPos, yPos);
-            // Map any materials defined in this data module but initially collided with other material ID's and thus were displaced to other ID's
-            if (materialMappings[matIndex] != 0)
-            {
-                // Assign the mapping and put it onto the material bitmap too
-                matIndex = materialMappings[matIndex];
-                _putpixel(m_pMainBitmap, xPos, yPos, matIndex);
-            }
-
-            // Validate the material, or default to default material
-            if (matIndex >= 0 && matIndex < NUM_PALETTE_ENTRIES && apMaterials[matIndex])
-                pMaterial = apMaterials[matIndex];
-            else
-                pMaterial = apMaterials[g_MaterialDefault];
-
-            // If haven't read a pixel of this material before, then get its texture so we can quickly access it
-            if (!apTexBitmaps[matIndex])
-            {
-                // Get, and acquire the texture bitmap if material has any
-                if (apTexBitmaps[matIndex] = pMaterial->GetTexture())
-                    acquire_bitmap(apTexBitmaps[matIndex]);
-            }
-
-            // If actually no texture for the material, then use the material's solid color instead
-            if (!apTexBitmaps[matIndex])
-            {
-                // If the color hasn't been retrieved yet, then do so
-                if (!aColors[matIndex])
-                    aColors[matIndex] = pMaterial->color.GetIndex();
-                // Use the color
-                pixelColor = aColors[matIndex];
-            }
-            // Use the texture's color
-            else
-            {
-//                acquire_bitmap(apTexBitmaps[matIndex]);
-                pixelColor = _getpixel(apTexBitmaps[matIndex], xPos % apTexBitmaps[matIndex]->w, yPos % apTexBitmaps[matIndex]->h);
-            }
+    // Place texture pixels on the FG layer corresponding to the materials on the main material bitmap, a stripe of rows per job
+    int stripeCount = (m_pMainBitmap->h + m_TexturingStripeHeight - 1) / m_TexturingStripeHeight;
+    g_ThreadMan.RunParallelJobs(stripeCount, std::bind(&SLTerrain::TextureStripe, this, std::cref(texturing), std::placeholders::_1));
 
-            // Draw the correct color pixel on the foreground
-            _putpixel(pFGBitmap, xPos, yPos, pixelColor);
-
-            // Draw background texture on the background where this is stuff on the foreground
-            if (m_pBGTexture && pixelColor != g_KeyColor)
-            {
-                pixelColor = _getpixel(m_pBGTexture, xPos % m_pBGTexture->w, yPos % m_pBGTexture->h);
-                _putpixel(pBGBitmap, xPos, yPos, pixelColor);
-            }
-            // Put a keycolor pixel in the bg otherwise
-            else
-                _putpixel(pBGBitmap, xPos, yPos, g_KeyColor);
-        }
+    for (matIndex = 0; matIndex < 256; ++matIndex)
+    {
+        if (texturing.m_apTextures[matIndex])
+            release_bitmap(texturing.m_apTextures[matIndex]);
     }
 
+    stageStart = TimeLoadStage(LOADTEXTURING, stageStart);
+
     ///////////////////////////////////////
     // Material frostings application!
 
-    bool targetFound = false, applyingFrosting = false;
-    int targetId, frostingId, thickness, thicknessGoal;
-    BITMAP *pFrostingTex = 0;
+    FrostingPass frosting;
+    frosting.m_pFGBitmap = pFGBitmap;
+    frosting.m_ThicknessGoals.resize(sceneWidth);
+    stripeCount = (sceneWidth + m_FrostingStripeWidth - 1) / m_FrostingStripeWidth;
     for (list<TerrainFrosting>::iterator tfItr = m_TerrainFrostings.begin(); tfItr != m_TerrainFrostings.end(); ++tfItr)
     {
-        targetId = (*tfItr).GetTargetMaterial().id;
-        frostingId = (*tfItr).GetFrostingMaterial().id;
+        frosting.m_TargetID = (*tfItr).GetTargetMaterial().id;
+        frosting.m_FrostingID = (*tfItr).GetFrostingMaterial().id;
+        frosting.m_InAirOnly = (*tfItr).InAirOnly();
         // Try to get the color texture of the frosting material. If fail, we'll use the color isntead
-        pFrostingTex = (*tfItr).GetFrostingMaterial().GetTexture();
-        if (pFrostingTex)
-            acquire_bitmap(pFrostingTex);
+        frosting.m_pTexture = (*tfItr).GetFrostingMaterial().GetTexture();
+        frosting.m_pWrapX = frosting.m_pTexture ? GetWrapTable(wrapTables, frosting.m_pTexture->w, sceneWidth) : 0;
+        frosting.m_Color = (*tfItr).GetFrostingMaterial().color.GetIndex();
+        if (frosting.m_pTexture)
+            acquire_bitmap(frosting.m_pTexture);
 
-        // Loop through all columns
-        for (xPos = 0; xPos < m_pMainBitmap->w; ++xPos)
-        {
-            // Get the thickness for this column
-            thicknessGoal = (*tfItr).GetThicknessSample();
-
-            // Work upward from the bottom of each column
-            for (yPos = m_pMainBitmap->h - 1; yPos >= 0; --yPos)
-            {
-                // Read which material the current pixel represents
-                matIndex = _getpixel(m_pMainBitmap, xPos, yPos);
+        // Sample the thickness of every column up front and in order, so the random sequence doesn't depend on how the stripes get run
+        for (int xPos = 0; xPos < sceneWidth; ++xPos)
+            frosting.m_ThicknessGoals[xPos] = (*tfItr).GetThicknessSample();
 
-                // We've encountered the target material! Prepare to apply frosting as soon as it ends!
-                if (!targetFound && matIndex == targetId)
-                {
-                    targetFound = true;
-                    thickness = 0;
-                }
-                // Target material has ended! See if we shuold start putting on the frosting
-                else if (targetFound && matIndex != targetId && thickness <= thicknessGoal)
-                {
-                    applyingFrosting = true;
-                    targetFound = false;
-                }
+        g_ThreadMan.RunParallelJobs(stripeCount, std::bind(&SLTerrain::FrostStripe, this, std::cref(frosting), std::placeholders::_1));
 
-                // If time to put down frosting pixels, then do so IF there is air, OR we're set to ignore what we're overwriting
-                if (applyingFrosting && (matIndex == g_MaterialAir || !(*tfItr).InAirOnly()) && thickness <= thicknessGoal)
-                {
-                    // Get the color either from the frosting material's texture or the solid color
-                    if (pFrostingTex)
-                        pixelColor = _getpixel(pFrostingTex, xPos % pFrostingTex->w, yPos % pFrostingTex->h);
-                    else
-                        pixelColor = (*tfItr).GetFrostingMaterial().color.GetIndex();
-
-                    // Put the frosting pixel color on the FG color layer
-                    _putpixel(pFGBitmap, xPos, yPos, pixelColor);
-                    // Put the material ID pixel on the material layer
-                    _putpixel(m_pMainBitmap, xPos, yPos, frostingId);
-
-                    // Keep track of the applied thickness
-                    thickness++;
-                }
-                else
-                    applyingFrosting = false;
-            }
-        }
-
-        if (pFrostingTex)
-            release_bitmap(pFrostingTex);
+        if (frosting.m_pTexture)
+            release_bitmap(frosting.m_pTexture);
     }
 
     // Release all involved bitmaps
     release_bitmap(m_pMainBitmap);
     release_bitmap(pFGBitmap);
     release_bitmap(pBGBitmap);
-    release_bitmap(m_pBGTexture);
+    release_bitmap(texturing.m_pBGTexture);
 
-    for (matIndex = 0; matIndex < 256; ++matIndex)
-    {
-        if (apTexBitmaps[matIndex])
-            release_bitmap(apTexBitmaps[matIndex]);
-    }
+    stageStart = TimeLoadStage(LOADFROSTING, stageStart);
 
     ///////////////////////////////////////////////
     // TerrainDebris application
@@ -502,6 +446,8 @@ int SLTerrain::LoadData()
         (*tdItr)->ApplyDebris(this);
     }
 
+    stageStart = TimeLoadStage(LOADDEBRIS, stageStart);
+
     ///////////////////////////////////////////////
     // Now take care of the TerrainObjects
 
@@ -511,12 +457,172 @@ int SLTerrain::LoadData()
     }
     CleanAir();
 
+    TimeLoadStage(LOADOBJECTS, stageStart);
+
+    if (g_SettingsMan.PrintDebugInfo())
+    {
+        char str[256];
+        sprintf(str, "DEBUG: Terrain %s generated in %.1f ms: layers %.1f, texturing %.1f, frosting %.1f, debris %.1f, objects %.1f", GetPresetName().c_str(),
+                m_LoadStageTimes[LOADLAYERS] + m_LoadStageTimes[LOADTEXTURING] + m_LoadStageTimes[LOADFROSTING] + m_LoadStageTimes[LOADDEBRIS] + m_LoadStageTimes[LOADOBJECTS],
+                m_LoadStageTimes[LOADLAYERS], m_LoadStageTimes[LOADTEXTURING], m_LoadStageTimes[LOADFROSTING], m_LoadStageTimes[LOADDEBRIS], m_LoadStageTimes[LOADOBJECTS]);
+        g_ConsoleMan.PrintString(str);
+    }
+
     InitScrollRatios();
 
     return 0;
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          TextureStripe
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Remaps the material IDs of a horizontal stripe of the main bitmap,
+//                  and fills in the same stripe of the color layers with the texture
+//                  colors of the materials, row by row.
+
+void SLTerrain::TextureStripe(const TexturingPass &pass, int stripe)
+{
+    int width = m_pMainBitmap->w;
+    int startY = stripe * m_TexturingStripeHeight;
+    int endY = MIN(startY + m_TexturingStripeHeight, m_pMainBitmap->h);
+    const unsigned char *materialMappings = pass.m_MaterialMappings;
+
+    // The row of each material's texture which lines up with the current row of the scene. Null for the untextured ones
+    const unsigned char *apTexRows[256];
+    for (int matIndex = 0; matIndex < 256; ++matIndex)
+        apTexRows[matIndex] = 0;
+
+    for (int yPos = startY; yPos < endY; ++yPos)
+    {
+        unsigned char *pMatRow = m_pMainBitmap->line[yPos];
+        unsigned char *pFGRow = pass.m_pFGBitmap->line[yPos];
+        unsigned char *pBGRow = pass.m_pBGBitmap->line[yPos];
+
+        for (vector<int>::const_iterator idItr = pass.m_TexturedIDs.begin(); idItr != pass.m_TexturedIDs.end(); ++idItr)
+            apTexRows[*idItr] = pass.m_apTextures[*idItr]->line[yPos % pass.m_apTextures[*idItr]->h];
+
+        // Map any materials defined in this data module but initially collided with other material ID's and thus were displaced to other ID's
+        for (int xPos = 0; xPos < width; ++xPos)
+        {
+            if (materialMappings[pMatRow[xPos]] != 0)
+                pMatRow[xPos] = materialMappings[pMatRow[xPos]];
+        }
+
+        // Draw the correct color pixel on the foreground, from the texture or the solid color of the material
+        for (int xPos = 0; xPos < width; ++xPos)
+        {
+            int matIndex = pMatRow[xPos];
+            pFGRow[xPos] = apTexRows[matIndex] ? apTexRows[matIndex][pass.m_apWrapX[matIndex][xPos]] : pass.m_aColors[matIndex];
+        }
+
+        // Draw background texture on the background where this is stuff on the foreground, and key color elsewhere
+        if (pass.m_pBGTexture)
+        {
+            const unsigned char *pBGTexRow = pass.m_pBGTexture->line[yPos % pass.m_pBGTexture->h];
+            for (int xPos = 0; xPos < width; ++xPos)
+                pBGRow[xPos] = pFGRow[xPos] != g_KeyColor ? pBGTexRow[pass.m_pBGWrapX[xPos]] : static_cast<unsigned char>(g_KeyColor);
+        }
+        else
+            memset(pBGRow, g_KeyColor, width);
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          FrostStripe
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Applies a TerrainFrosting to a vertical stripe of columns, going up
+//                  from the bottom one row at a time and keeping track of each column on
+//                  its own.
+
+void SLTerrain::FrostStripe(const FrostingPass &pass, int stripe)
+{
+    int startX = stripe * m_FrostingStripeWidth;
+    int endX = MIN(startX + m_FrostingStripeWidth, m_pMainBitmap->w);
+
+    // Where each column is at in working its way up
+    int columnCount = endX - startX;
+    vector<char> targetFound(columnCount, false);
+    vector<char> applyingFrosting(columnCount, false);
+    vector<int> thickness(columnCount, 0);
+
+    for (int yPos = m_pMainBitmap->h - 1; yPos >= 0; --yPos)
+    {
+        unsigned char *pMatRow = m_pMainBitmap->line[yPos];
+        unsigned char *pFGRow = pass.m_pFGBitmap->line[yPos];
+        const unsigned char *pTexRow = pass.m_pTexture ? pass.m_pTexture->line[yPos % pass.m_pTexture->h] : 0;
+
+        for (int xPos = startX; xPos < endX; ++xPos)
+        {
+            int column = xPos - startX;
+            int thicknessGoal = pass.m_ThicknessGoals[xPos];
+            // Read which material the current pixel represents
+            int matIndex = pMatRow[xPos];
+
+            // We've encountered the target material! Prepare to apply frosting as soon as it ends!
+            if (!targetFound[column] && matIndex == pass.m_TargetID)
+            {
+                targetFound[column] = true;
+                thickness[column] = 0;
+            }
+            // Target material has ended! See if we shuold start putting on the frosting
+            else if (targetFound[column] && matIndex != pass.m_TargetID && thickness[column] <= thicknessGoal)
+            {
+                applyingFrosting[column] = true;
+                targetFound[column] = false;
+            }
+
+            // If time to put down frosting pixels, then do so IF there is air, OR we're set to ignore what we're overwriting
+            if (applyingFrosting[column] && (matIndex == g_MaterialAir || !pass.m_InAirOnly) && thickness[column] <= thicknessGoal)
+            {
+                // Put the frosting pixel color on the FG color layer, either from the frosting material's texture or the solid color
+                pFGRow[xPos] = pTexRow ? pTexRow[pass.m_pWrapX[xPos]] : pass.m_Color;
+                // Put the material ID pixel on the material layer
+                pMatRow[xPos] = pass.m_FrostingID;
+
+                // Keep track of the applied thickness
+                thickness[column]++;
+            }
+            else
+                applyingFrosting[column] = false;
+        }
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   GetWrapTable
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the table of x % width for every column of the scene, making it
+//                  if there isn't one for that width yet.
+
+const int * SLTerrain::GetWrapTable(map<int, vector<int> > &wrapTables, int textureWidth, int sceneWidth)
+{
+    vector<int> &wrapTable = wrapTables[textureWidth];
+    if (wrapTable.empty())
+    {
+        wrapTable.resize(sceneWidth);
+        for (int xPos = 0; xPos < sceneWidth; ++xPos)
+            wrapTable[xPos] = xPos % textureWidth;
+    }
+    return &wrapTable[0];
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          TimeLoadStage
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Records how long a stage of LoadData took.
+
+int64_t SLTerrain::TimeLoadStage(LoadStage stage, int64_t stageStart)
+{
+    int64_t now = g_TimerMan.GetAbsoulteTime();
+    m_LoadStageTimes[stage] = (float)(now - stageStart) / 1000.0F;
+    return now;
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Virtual method:  SaveData
 //////////////////////////////////////////////////////////////////////////////////////////
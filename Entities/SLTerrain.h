@@ -17,6 +17,8 @@
 #include "SceneLayer.h"
 #include "Matrix.h"
 #include "Box.h"
+#include <map>
+#include <vector>
 
 namespace RTE
 {
@@ -230,6 +232,17 @@ class SLTerrain:
 
 public:
 
+    // The stages of generating the color layers in LoadData, which are timed separately
+    enum LoadStage
+    {
+        LOADLAYERS = 0,
+        LOADTEXTURING,
+        LOADFROSTING,
+        LOADDEBRIS,
+        LOADOBJECTS,
+        LOADSTAGECOUNT
+    };
+
 
 // Concrete allocation and cloning definitions
 ENTITYALLOCATION(SLTerrain)
@@ -777,11 +790,111 @@ ENTITYALLOCATION(SLTerrain)
 
     virtual void Draw(BITMAP *pTargetBitmap, Box& targetBox, const Vector &scrollOverride = Vector(-1, -1)) const;
 
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetLoadStageTime
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets how long a stage of generating the color layers took during the
+//                  last LoadData.
+// Arguments:       The stage.
+// Return value:    The time it took, in ms. 0 if the layers were loaded from file.
+
+    float GetLoadStageTime(LoadStage stage) const { return m_LoadStageTimes[stage]; }
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Protected member variable and method declarations
 
 protected:
 
+    // Everything the texturing stripes of LoadData share, all set up before they are started
+    struct TexturingPass
+    {
+        BITMAP *m_pFGBitmap;
+        BITMAP *m_pBGBitmap;
+        BITMAP *m_pBGTexture;
+        // Mappings of the material IDs in the bitmap to the ones actually used
+        const unsigned char *m_MaterialMappings;
+        // Texture, or solid color if none, of each material ID, after falling back to the default material
+        BITMAP *m_apTextures[256];
+        int m_aColors[256];
+        // x % texture width for every column of the scene, for each material's texture and the background texture
+        const int *m_apWrapX[256];
+        const int *m_pBGWrapX;
+        // The IDs which have textures, so only their texture rows need looking up for each row
+        std::vector<int> m_TexturedIDs;
+    };
+
+    // Everything the stripes of applying one TerrainFrosting share
+    struct FrostingPass
+    {
+        BITMAP *m_pFGBitmap;
+        int m_TargetID;
+        int m_FrostingID;
+        bool m_InAirOnly;
+        // Texture of the frosting material, or the solid color if none
+        BITMAP *m_pTexture;
+        const int *m_pWrapX;
+        int m_Color;
+        // The thickness to aim for in each column
+        std::vector<int> m_ThicknessGoals;
+    };
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          TextureStripe
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Remaps the material IDs of a horizontal stripe of the main bitmap,
+//                  and fills in the same stripe of the color layers with the texture
+//                  colors of the materials, row by row. Stripes don't overlap, so they
+//                  can be done in parallel.
+// Arguments:       The pass set up by LoadData.
+//                  The index of the stripe, m_TexturingStripeHeight rows each.
+// Return value:    None.
+
+    void TextureStripe(const TexturingPass &pass, int stripe);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          FrostStripe
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Applies a TerrainFrosting to a vertical stripe of columns, going up
+//                  from the bottom one row at a time and keeping track of each column on
+//                  its own. Stripes don't overlap, so they can be done in parallel.
+// Arguments:       The pass set up by LoadData.
+//                  The index of the stripe, m_FrostingStripeWidth columns each.
+// Return value:    None.
+
+    void FrostStripe(const FrostingPass &pass, int stripe);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   GetWrapTable
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the table of x % width for every column of the scene, making it
+//                  if there isn't one for that width yet.
+// Arguments:       The tables made so far, by width.
+//                  The width of the texture to wrap.
+//                  The width of the scene.
+// Return value:    The table. Stays valid as long as the map of tables.
+
+    static const int * GetWrapTable(std::map<int, std::vector<int> > &wrapTables, int textureWidth, int sceneWidth);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          TimeLoadStage
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Records how long a stage of LoadData took.
+// Arguments:       The stage.
+//                  When it started, as returned by TimerMan::GetAbsoulteTime.
+// Return value:    The time now, for the start of the next stage.
+
+    int64_t TimeLoadStage(LoadStage stage, int64_t stageStart);
+
+
+    // Rows in each texturing stripe, and columns in each frosting stripe, handed out to the worker threads
+    static const int m_TexturingStripeHeight;
+    static const int m_FrostingStripeWidth;
+
     // Member variables
     static Entity::ClassInfo m_sClass;
 
@@ -815,6 +928,8 @@ protected:
 	// Indicates, that before processing debris-related properties for this terrain
 	// derived list with debris must be cleared to avoid duplication when loading scenes
 	bool m_NeedToClearDebris;
+    // How long each stage of the last LoadData took, in ms
+    float m_LoadStageTimes[LOADSTAGECOUNT];
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -3026,6 +3026,74 @@ float Scene::CalculatePath(const Vector &start, const Vector &end, std::list<Vec
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RequestPath
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Asks for the least difficult path between two points on the current
+//                  scene to be calculated in the background, without holding up the
+//                  frame.
+
+int Scene::RequestPath(const Vector &start, const Vector &end, float digStrenght, int team)
+{
+    SLICK_PROFILE(0xFF343628);
+
+    if (!m_pPathFinder)
+        return -1;
+
+    // Hand over all terrain changes so far to be caught up on, so the team's doors below are all that's left in the list
+    m_pPathFinder->MarkAreasOutdated(m_pTerrain->GetUpdatedMaterialAreas());
+    m_pTerrain->ClearUpdatedAreas();
+
+    // Work out the costs with the team's doors open for this path only, then put the doors back as they were without touching the costs
+    vector<PathNodeCosts> costPatch;
+    if (team != Activity::NOTEAM)
+    {
+        g_MovableMan.OverrideMaterialDoors(true, team);
+        m_pPathFinder->CalculateCostPatch(m_pTerrain->GetUpdatedMaterialAreas(), costPatch);
+        m_pTerrain->ClearUpdatedAreas();
+        g_MovableMan.OverrideMaterialDoors(false, team);
+        m_pTerrain->ClearUpdatedAreas();
+    }
+
+    return m_pPathFinder->RequestPath(start, end, digStrenght, costPatch);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          TakePathResult
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Picks up the path asked for with RequestPath, if it's done.
+
+float Scene::TakePathResult(int requestID, std::list<Vector> &pathResult)
+{
+    if (!m_pPathFinder)
+        return -3;
+
+    float totalCostResult = -1;
+    int result = micropather::MicroPather::NO_SOLUTION;
+    int requestState = m_pPathFinder->TakePathResult(requestID, pathResult, totalCostResult, result);
+    if (requestState == PathFinder::REQUESTPENDING)
+        return -2;
+    else if (requestState != PathFinder::REQUESTDONE)
+        return -3;
+
+    // It's ok if start and end nodes happen to be the same, the exact pixel locations are added at the front and end of the result regardless
+    return (result == micropather::MicroPather::SOLVED || result == micropather::MicroPather::START_END_SAME) ? totalCostResult : -1;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CancelPathRequest
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Forgets about a path asked for with RequestPath, whether done or not.
+
+void Scene::CancelPathRequest(int requestID)
+{
+    if (m_pPathFinder)
+        m_pPathFinder->CancelPathRequest(requestID);
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          CalculateScenePath
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -3128,17 +3196,18 @@ void Scene::Update()
 		}
 	}
 
-    // Do full update every two minutes
+    // Do full update every two minutes, spread out over the frames after
     if (m_FullPathUpdateTimer.IsPastSimMS(120000))
     {
-        m_pPathFinder->RecalculateAllCosts();
+        m_pPathFinder->MarkAllOutdated();
         m_FullPathUpdateTimer.Reset();
-        m_PathfindingUpdated = true;
     }
 
-    // Do partial update every 10 seconds
-    if (m_PartialPathUpdateTimer.IsPastRealMS(10000))
-        UpdatePathFinding();
+    // Catch up on terrain changes a little every frame, instead of all at once whenever someone needs a path
+    m_pPathFinder->MarkAreasOutdated(m_pTerrain->GetUpdatedMaterialAreas());
+    m_pTerrain->ClearUpdatedAreas();
+    if (m_pPathFinder->UpdateOutdatedCosts(g_SettingsMan.GetPathFindingBudget()) > 0)
+        m_PathfindingUpdated = true;
 }
 
 } // namespace RTE
@@ -1298,6 +1298,46 @@ const SceneObject * PickPlacedActorInRange(int whichSet, Vector &scenePoint, int
     float CalculatePath(const Vector &start, const Vector &end, std::list<Vector> &pathResult, float digStrenght = 1);
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RequestPath
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Asks for the least difficult path between two points on the current
+//                  scene to be calculated in the background, without holding up the
+//                  frame. Any doors of the team are seen as open for this path only.
+//                  Pick up the result with TakePathResult.
+// Arguments:       Start and end positions on the scene to find the path between.
+//                  The maximum material strength the path can dig through.
+//                  The team whose doors open for the path, or Activity::NOTEAM.
+// Return value:    The ID of the request, or -1 if there's no pathfinding.
+
+    int RequestPath(const Vector &start, const Vector &end, float digStrenght, int team);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          TakePathResult
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Picks up the path asked for with RequestPath, if it's done.
+// Arguments:       The ID returned by RequestPath.
+//                  A list which will be filled out with waypoints between the start and
+//                  end, if done.
+// Return value:    The total minimum difficulty cost of the path, or -1 if there is no
+//                  path, same as CalculatePath. -2 if the path isn't done yet, and -3 if
+//                  there is no such request, ie it was already taken or cancelled, or the
+//                  pathfinding has been reset since it was made.
+
+    float TakePathResult(int requestID, std::list<Vector> &pathResult);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CancelPathRequest
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Forgets about a path asked for with RequestPath, whether done or not.
+// Arguments:       The ID returned by RequestPath.
+// Return value:    None.
+
+    void CancelPathRequest(int requestID);
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          CalculateScenePath
 //////////////////////////////////////////////////////////////////////////////////////////
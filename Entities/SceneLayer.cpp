@@ -13,6 +13,7 @@
 
 #include "SceneLayer.h"
 #include "ContentFile.h"
+#include <algorithm>
 
 using namespace std;
 
@@ -21,6 +22,8 @@ namespace RTE
 
 CONCRETECLASSINFO(SceneLayer, Entity, 0)
 
+const int SceneLayer::m_DirtyTileSize = 64;
+
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          Clear
@@ -46,6 +49,11 @@ void SceneLayer::Clear()
     m_FillRightColor = g_KeyColor;
     m_FillUpColor = g_KeyColor;
     m_FillDownColor = g_KeyColor;
+    m_TrackDirtyTiles = false;
+    m_DirtyTiles.clear();
+    m_DirtyTilesX = 0;
+    m_DirtyTilesY = 0;
+    m_DirtyTileCount = 0;
 }
 
 
@@ -382,6 +390,164 @@ void SceneLayer::SetScaleFactor(const Vector newScale)
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          SetTrackDirtyTiles
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Sets whether this should keep track of which tiles of its main bitmap
+//                  have been drawn to, so Draw only needs to composite those.
+
+void SceneLayer::SetTrackDirtyTiles(bool track)
+{
+    m_TrackDirtyTiles = track && m_pMainBitmap;
+    m_DirtyTiles.clear();
+    m_DirtyTilesX = 0;
+    m_DirtyTilesY = 0;
+    m_DirtyTileCount = 0;
+
+    if (m_TrackDirtyTiles)
+    {
+        m_DirtyTilesX = (m_pMainBitmap->w + m_DirtyTileSize - 1) / m_DirtyTileSize;
+        m_DirtyTilesY = (m_pMainBitmap->h + m_DirtyTileSize - 1) / m_DirtyTileSize;
+        m_DirtyTiles.resize(m_DirtyTilesX * m_DirtyTilesY, 0);
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RegisterDrawing
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Marks the tiles touched by an area drawn to on the main bitmap as
+//                  having content. Will take care of wrapping.
+
+void SceneLayer::RegisterDrawing(int left, int top, int right, int bottom)
+{
+    if (!m_TrackDirtyTiles)
+        return;
+
+    MarkDirtyTiles(left, top, right, bottom);
+
+    // Mark the wrapped parts too
+    int width = m_pMainBitmap->w;
+    int height = m_pMainBitmap->h;
+    if (m_WrapX)
+    {
+        if (left < 0)
+            MarkDirtyTiles(left + width, top, width - 1, bottom);
+        if (right >= width)
+            MarkDirtyTiles(0, top, right - width, bottom);
+    }
+    if (m_WrapY)
+    {
+        if (top < 0)
+            MarkDirtyTiles(left, top + height, right, height - 1);
+        if (bottom >= height)
+            MarkDirtyTiles(left, 0, right, bottom - height);
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ClearDirtyTiles
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Marks all tiles as empty again.
+
+void SceneLayer::ClearDirtyTiles()
+{
+    if (m_DirtyTileCount > 0)
+        std::fill(m_DirtyTiles.begin(), m_DirtyTiles.end(), 0);
+    m_DirtyTileCount = 0;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          MarkDirtyTiles
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Marks all tiles touched by an area of the main bitmap as having content.
+
+void SceneLayer::MarkDirtyTiles(int left, int top, int right, int bottom)
+{
+    left = MAX(left, 0);
+    top = MAX(top, 0);
+    right = MIN(right, m_pMainBitmap->w - 1);
+    bottom = MIN(bottom, m_pMainBitmap->h - 1);
+    if (left > right || top > bottom)
+        return;
+
+    int tileRight = right / m_DirtyTileSize;
+    int tileBottom = bottom / m_DirtyTileSize;
+    for (int tileY = top / m_DirtyTileSize; tileY <= tileBottom; ++tileY)
+    {
+        unsigned char *pRow = &m_DirtyTiles[tileY * m_DirtyTilesX];
+        for (int tileX = left / m_DirtyTileSize; tileX <= tileRight; ++tileX)
+        {
+            if (!pRow[tileX])
+            {
+                pRow[tileX] = 1;
+                ++m_DirtyTileCount;
+            }
+        }
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          DrawDirtyTiles
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Draws only the tiles with content, in runs of adjacent tiles, when the
+//                  main bitmap is at least as large as the target in both dimensions.
+
+void SceneLayer::DrawDirtyTiles(BITMAP *pTargetBitmap, const Box &targetBox, int offsetX, int offsetY) const
+{
+    void (*pfBlit)(BITMAP *source, BITMAP *dest, int source_x, int source_y, int dest_x, int dest_y, int width, int height) = m_DrawTrans ? &masked_blit : &blit;
+
+    int cornerX = targetBox.GetCorner().m_X;
+    int cornerY = targetBox.GetCorner().m_Y;
+
+    for (int tileY = 0; tileY < m_DirtyTilesY; ++tileY)
+    {
+        const unsigned char *pRow = &m_DirtyTiles[tileY * m_DirtyTilesX];
+        int sourceY = tileY * m_DirtyTileSize;
+        int sourceH = MIN(m_DirtyTileSize, m_pMainBitmap->h - sourceY);
+
+        // Same placement as the four blits of the whole layer in Draw; what is above or left of the offset gets wrapped to below or right of it.
+        // Tiles straddling the offset are drawn in both places, and the clipping to the target box cuts off the parts that don't belong
+        int destY = cornerY + sourceY - offsetY;
+        bool drawUnwrappedY = sourceY + sourceH > offsetY;
+        bool drawWrappedY = sourceY < offsetY;
+
+        int tileX = 0;
+        while (tileX < m_DirtyTilesX)
+        {
+            // Find the next run of tiles with content
+            if (!pRow[tileX])
+            {
+                ++tileX;
+                continue;
+            }
+            int runStart = tileX;
+            while (tileX < m_DirtyTilesX && pRow[tileX])
+                ++tileX;
+
+            int sourceX = runStart * m_DirtyTileSize;
+            int sourceW = MIN(tileX * m_DirtyTileSize, m_pMainBitmap->w) - sourceX;
+
+            int destX = cornerX + sourceX - offsetX;
+            bool drawUnwrappedX = sourceX + sourceW > offsetX;
+            bool drawWrappedX = sourceX < offsetX;
+
+            if (drawUnwrappedY && drawUnwrappedX)
+                pfBlit(m_pMainBitmap, pTargetBitmap, sourceX, sourceY, destX, destY, sourceW, sourceH);
+            if (drawUnwrappedY && drawWrappedX)
+                pfBlit(m_pMainBitmap, pTargetBitmap, sourceX, sourceY, destX + m_pMainBitmap->w, destY, sourceW, sourceH);
+            if (drawWrappedY && drawUnwrappedX)
+                pfBlit(m_pMainBitmap, pTargetBitmap, sourceX, sourceY, destX, destY + m_pMainBitmap->h, sourceW, sourceH);
+            if (drawWrappedY && drawWrappedX)
+                pfBlit(m_pMainBitmap, pTargetBitmap, sourceX, sourceY, destX + m_pMainBitmap->w, destY + m_pMainBitmap->h, sourceW, sourceH);
+        }
+    }
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          GetPixel
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -638,7 +804,13 @@ void SceneLayer::Draw(BITMAP *pTargetBitmap, Box& targetBox, const Vector &scrol
     void (*pfBlit)(BITMAP *source, BITMAP *dest, int source_x, int source_y, int dest_x, int dest_y, int width, int height) = m_DrawTrans ? &masked_blit : &blit;
 
     // See if this SceneLayer is wider AND higher than the target bitmap; then use simple wrapping logic - oterhwise need to tile
-    if (m_pMainBitmap->w >= pTargetBitmap->w && m_pMainBitmap->h >= pTargetBitmap->h)
+    if (m_pMainBitmap->w >= pTargetBitmap->w && m_pMainBitmap->h >= pTargetBitmap->h && m_TrackDirtyTiles)
+    {
+        // Only the tiles that have anything drawn in them need compositing
+        if (m_DirtyTileCount > 0)
+            DrawDirtyTiles(pTargetBitmap, targetBox, offsetX, offsetY);
+    }
+    else if (m_pMainBitmap->w >= pTargetBitmap->w && m_pMainBitmap->h >= pTargetBitmap->h)
     {
         sourceX     = offsetX;
         sourceY     = offsetY;
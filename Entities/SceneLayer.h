@@ -17,6 +17,7 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <vector>
 using std::string;
 
 #include "DDTTools.h"
@@ -417,6 +418,42 @@ ENTITYALLOCATION(SceneLayer)
     void SetScaleFactor(const Vector newScale);
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          SetTrackDirtyTiles
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Sets whether this should keep track of which tiles of its main bitmap
+//                  have been drawn to, so Draw only needs to composite those. When this
+//                  is on, everything drawn to the main bitmap must be registered with
+//                  RegisterDrawing, or it may not show up.
+// Arguments:       Whether to track dirty tiles.
+// Return value:    None.
+
+    void SetTrackDirtyTiles(bool track);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RegisterDrawing
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Marks the tiles touched by an area drawn to on the main bitmap as
+//                  having content. Does nothing unless dirty tiles are tracked. Will take
+//                  care of wrapping.
+// Arguments:       The corners of the drawn area, in main bitmap coordinates, inclusive.
+// Return value:    None.
+
+    void RegisterDrawing(int left, int top, int right, int bottom);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ClearDirtyTiles
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Marks all tiles as empty again. Should be done whenever everything
+//                  registered with RegisterDrawing has been cleared off the main bitmap.
+// Arguments:       None.
+// Return value:    None.
+
+    void ClearDirtyTiles();
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Virtual method:  LockBitmaps
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -618,6 +655,30 @@ protected:
 	void UpdateScrollRatiosForNetworkPlayer(int player);
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          MarkDirtyTiles
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Marks all tiles touched by an area of the main bitmap as having content.
+// Arguments:       The corners of the area, in main bitmap coordinates, inclusive. Parts
+//                  outside the main bitmap are ignored.
+// Return value:    None.
+
+    void MarkDirtyTiles(int left, int top, int right, int bottom);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          DrawDirtyTiles
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Draws only the tiles with content, in runs of adjacent tiles, when the
+//                  main bitmap is at least as large as the target in both dimensions.
+// Arguments:       The bitmap to draw to, clipped to the target box already.
+//                  The box on the target bitmap that the scroll position lines up with.
+//                  The scroll offset to draw from.
+// Return value:    None.
+
+    void DrawDirtyTiles(BITMAP *pTargetBitmap, const Box &targetBox, int offsetX, int offsetY) const;
+
+
     // Member variables
     static Entity::ClassInfo m_sClass;
 
@@ -642,6 +703,18 @@ protected:
     int m_FillUpColor;
     int m_FillDownColor;
 
+    // Side length, in pixels, of the tiles drawing is tracked in
+    static const int m_DirtyTileSize;
+    // Whether to track which tiles have been drawn to
+    bool m_TrackDirtyTiles;
+    // One flag per tile of the main bitmap, row by row, set if anything was drawn in it since last cleared
+    std::vector<unsigned char> m_DirtyTiles;
+    // How many tiles the main bitmap is divided into in each dimension
+    int m_DirtyTilesX;
+    int m_DirtyTilesY;
+    // How many tiles are flagged as having content
+    int m_DirtyTileCount;
+
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // Private member variable and method declarations
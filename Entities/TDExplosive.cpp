@@ -101,7 +101,7 @@ int TDExplosive::ReadProperty(std::string propName, Reader &reader)
         gib.m_MinVelocity = 25;
         gib.m_MaxVelocity = 50;
         // Add as gib!
-        m_Gibs.push_back(gib);
+        m_Gibs.Edit().push_back(gib);
     }
     // Also for backwads compatibility
     else if (propName == "DetonationSound")
@@ -26,6 +26,8 @@
 #include "SceneLayer.h"
 #include "MOSParticle.h"
 #include "MOSRotating.h"
+#include "Atom.h"
+#include "RotatedSpriteCache.h"
 #include "Controller.h"
 
 #include "MultiplayerServerLobby.h"
@@ -833,8 +835,13 @@ bool ResetActivity()
 
 // TODO: Remove
 //    g_ActivityMan.GetActivity()->SetActivityState(Activity::TESTING);
+    // Set up the benchmark, and start recording or replaying, if asked to, right before the activity gets going
+    int error = g_BenchmarkMan.StartActivity();
+    if (error >= 0)
+        error = g_ReplayMan.StartActivity();
     // Start the game with previous settings
-    int error = g_ActivityMan.RestartActivity();
+    if (error >= 0)
+        error = g_ActivityMan.RestartActivity();
 
     if (error >= 0)
         g_InActivity = true;
@@ -2332,11 +2339,16 @@ bool RunGameLoop()
 
     while (!g_Quit)
     {
+        // Start or stop capturing a trace between two frames, so only whole ones are captured
+        g_TraceMan.Update();
+
         SLICK_PROFILENAME("Game Loop", 0xFFFF0000);
 
         {
             // Need to clear this out; sometimes background layers don't cover the whole back
-            g_FrameMan.ClearBackBuffer8();
+            // A headless server only draws into the network back buffers, which are cleared by FrameMan itself
+            if (!g_FrameMan.IsHeadless())
+                g_FrameMan.ClearBackBuffer8();
 
 #ifdef SLICK_PROFILER
             // Force to only one sim update for this graphics frame if the profiling tool is connected
@@ -2361,12 +2373,15 @@ bool RunGameLoop()
 
 				g_FrameMan.StartPerformanceMeasurement(FrameMan::PERF_SIM_TOTAL);
 				g_UInputMan.Update();
+				g_ReplayMan.BeginSimTick();
 				// It is vital that server is updated after input manager but before activity because unput manager will clear 
 				// received pressed and released events on next update.
 				if (g_NetworkServer.IsServerModeEnabled())
 				{
 					g_NetworkServer.Update(true);
 					serverUpdated = true;
+					// Frames are encoded on the send threads, their time goes to whichever sim update is under way
+					g_FrameMan.AddPerformanceSample(FrameMan::PERF_NETWORK_ENCODE, g_NetworkServer.TakeEncodeTime());
 				}
 				g_FrameMan.Update();
 				g_AudioMan.Update();
@@ -2377,12 +2392,21 @@ bool RunGameLoop()
 				g_MovableMan.Update();
 
 				g_ActivityMan.LateUpdateGlobalScripts();
+				g_ReplayMan.EndSimTick();
 
 				g_ConsoleMan.Update();
 				g_FrameMan.StopPerformanceMeasurement(FrameMan::PERF_SIM_TOTAL);
 
                 if (!g_InActivity)
                 {
+					// Nobody is there to use the menus, so a benchmark that can't go on just ends
+					if (g_BenchmarkMan.IsRunning())
+					{
+						g_ConsoleMan.PrintString("ERROR: The benchmarked activity ended before all sim updates were run!");
+						g_BenchmarkMan.Stop();
+						g_Quit = true;
+						break;
+					}
 					g_TimerMan.PauseSim(true);
 					// If we're not in a metagame, then show main menu
 					if (g_MetaMan.GameInProgress())
@@ -2409,6 +2433,12 @@ bool RunGameLoop()
                 // Resuming the simulation
                 if (g_ResumeActivity)
                     ResumeActivity();
+                // Quit once the whole recording has been replayed
+                if (g_ReplayMan.ReplayFinished())
+                {
+                    g_Quit = true;
+                    break;
+                }
             }
 
 			if (g_NetworkServer.IsServerModeEnabled())
@@ -2451,6 +2481,11 @@ bool RunGameLoop()
             SLICK_PROFILENAME("Rendering Frame", 0xFFFF00FF);
             g_FrameMan.Draw();
             g_FrameMan.FlipFrameBuffers();
+
+            // Collect the performance sample of the sim update and frame, and quit once the benchmark is done
+            g_BenchmarkMan.EndFrame();
+            if (g_BenchmarkMan.BenchmarkFinished())
+                g_Quit = true;
         }
 
 // Slick Profiler updates - the debug tool needs to update BEFORE the profile system because control messages may have been sent.
@@ -2530,6 +2565,8 @@ bool HandleMainArgs(int argc, char *argv[], int &appExitVar)
 
 	if (argc > 2)
 	{
+		bool headless = false;
+
 		for (int i = 1; i < argc; i++)
 		{
 			if (strcmp(argv[i], "-server") == 0 && i + 1 < argc)
@@ -2543,6 +2580,43 @@ bool HandleMainArgs(int argc, char *argv[], int &appExitVar)
 			{
 				g_LoadSingleModule = argv[i + 1];
 			}
+
+			if (strcmp(argv[i], "-headless") == 0)
+			{
+				headless = true;
+			}
+
+			if (strcmp(argv[i], "-record") == 0 && i + 1 < argc)
+			{
+				g_ReplayMan.SetRecordPath(argv[i + 1]);
+			}
+
+			if (strcmp(argv[i], "-replay") == 0 && i + 1 < argc)
+			{
+				g_ReplayMan.SetReplayPath(argv[i + 1]);
+			}
+
+			if (strcmp(argv[i], "-benchmark") == 0 && i + 3 < argc)
+			{
+				g_BenchmarkMan.SetBenchmark(argv[i + 1], argv[i + 2], atoi(argv[i + 3]));
+			}
+
+			if (strcmp(argv[i], "-benchmark-output") == 0 && i + 1 < argc)
+			{
+				g_BenchmarkMan.SetReportPath(argv[i + 1]);
+			}
+
+			if (strcmp(argv[i], "-trace") == 0 && i + 2 < argc)
+			{
+				g_TraceMan.StartCapture(atoi(argv[i + 1]), argv[i + 2]);
+			}
+		}
+
+		// Dedicated server without a window or audio device, only makes sense together with -server. Benchmarks never need one
+		if ((headless && g_NetworkServer.IsServerModeEnabled()) || g_BenchmarkMan.IsBenchmarking())
+		{
+			g_FrameMan.SetHeadless(true);
+			g_AudioMan.SetHeadless(true);
 		}
 	}
 
@@ -2633,6 +2707,10 @@ int main(int argc, char *argv[])
     new LicenseMan();
     new SettingsMan();
     new TimerMan();
+    new ThreadMan();
+    new ReplayMan();
+    new BenchmarkMan();
+    new TraceMan();
     new PresetMan();
     new FrameMan();
     new AudioMan();
@@ -2663,6 +2741,7 @@ int main(int argc, char *argv[])
 	
 	Reader settingsReader("Base.rte/Settings.ini", false, 0, true);
     g_SettingsMan.Create(settingsReader);
+    RotatedSpriteCache::SetMemoryBudget(MAX(g_SettingsMan.GetRotatedSpriteCacheSize(), 0) * 1024L * 1024L);
 
 	g_NetworkServer.Create();
 	g_NetworkClient.Create();
@@ -2671,6 +2750,10 @@ int main(int argc, char *argv[])
     if (!HandleMainArgs(argc, argv, exitVar))
         return exitVar;
     g_TimerMan.Create();
+    g_ThreadMan.Create();
+    g_ReplayMan.Create();
+    g_BenchmarkMan.Create();
+    g_TraceMan.Create();
     g_PresetMan.Create();
     g_FrameMan.Create();
     g_AudioMan.Create();
@@ -2738,7 +2821,7 @@ int main(int argc, char *argv[])
 	}
 
     InitMainMenu();
-    if (g_SettingsMan.PlayIntro() && !g_NetworkServer.IsServerModeEnabled())
+    if (g_SettingsMan.PlayIntro() && !g_NetworkServer.IsServerModeEnabled() && !g_ReplayMan.IsReplayPending() && !g_BenchmarkMan.IsBenchmarking())
         PlayIntroTitle();
 
 	// NETWORK Create multiplayer lobby activity to start as default if server is running
@@ -2747,9 +2830,14 @@ int main(int argc, char *argv[])
 		EnterMultiplayerLobby();
 	}
 
-    // If we fail to start/reset the activity, then revert to the intro/menu
+    // If we fail to start/reset the activity, then revert to the intro/menu, unless nobody is there to use it
     if (!ResetActivity())
-        PlayIntroTitle();
+    {
+        if (g_BenchmarkMan.IsBenchmarking())
+            g_Quit = true;
+        else
+            PlayIntroTitle();
+    }
 	
     RunGameLoop();
 
@@ -2762,6 +2850,12 @@ int main(int argc, char *argv[])
 	//Writer writer("Base.rte/Settings.ini");
     //g_SettingsMan.Save(writer);
 
+    // Report a replay that didn't match its recording, or a benchmark that didn't complete, through the exit code
+    bool replayDiverged = g_ReplayMan.GetDivergenceCount() > 0;
+    bool benchmarkFailed = g_BenchmarkMan.BenchmarkFailed();
+    g_BenchmarkMan.Destroy();
+    g_ReplayMan.Destroy();
+
 	g_NetworkClient.Destroy();
 	g_NetworkServer.Destroy();
 
@@ -2773,10 +2867,13 @@ int main(int argc, char *argv[])
     g_PresetMan.Destroy();
     g_UInputMan.Destroy();
     g_FrameMan.Destroy();
+    g_ThreadMan.Destroy();
+    g_TraceMan.Destroy();
     g_TimerMan.Destroy();
     g_SettingsMan.Destroy();
     g_LicenseMan.Destroy();
     g_LuaMan.Destroy();
+    RotatedSpriteCache::FreeAll();
     ContentFile::FreeAllLoaded();
     g_ConsoleMan.Destroy();
 
@@ -2788,7 +2885,9 @@ int main(int argc, char *argv[])
 
 #ifdef _DEBUG
     // Dump out the info about how well memory cleanup went
-    Entity::ClassInfo::DumpPoolMemoryInfo(Writer("MemCleanupInfo.txt"));
+    Writer memInfoWriter("MemCleanupInfo.txt");
+    Entity::ClassInfo::DumpPoolMemoryInfo(memInfoWriter);
+    Atom::DumpPoolMemoryInfo(memInfoWriter);
 #endif // _DEBUG
 
 #ifdef SLICK_PROFILER
@@ -2800,6 +2899,6 @@ int main(int argc, char *argv[])
 	OsxUtil::Destroy();
 #endif // defined(__APPLE__)
 	
-    return 0;
+    return (replayDiverged || benchmarkFailed) ? 1 : 0;
 }
 END_OF_MAIN();
@@ -100,6 +100,7 @@ void AudioMan::Clear()
     m_SilenceTimer.Reset();
     m_SilenceTimer.SetRealTimeLimitS(-1);
 	m_IsInMultiplayerMode = false;
+	m_Headless = false;
 
 	for (int i = 0; i < MAX_CLIENTS; i++)
 	{
@@ -136,6 +137,10 @@ int AudioMan::Create()
     FSOUND_SetOutput( FSOUND_OUTPUT_ALSA );
 	#endif
 
+	// A dedicated server never plays anything itself, but still needs real channel handles to relay to clients
+	if (m_Headless)
+		FSOUND_SetOutput(FSOUND_OUTPUT_NOSOUND);
+
     if (!FSOUND_Init(audioBitrate, maxChannels, 0))
 	{
 		// Audio failed to init, so just disable it
@@ -161,6 +166,10 @@ int AudioMan::Create()
     // Init the global pitch
     SetGlobalPitch(m_GlobalPitch);
 #elif __USE_SOUND_SDLMIXER
+	// A dedicated server never plays anything itself, but still needs real channel handles to relay to clients
+	if (m_Headless)
+		SDL_setenv("SDL_AUDIODRIVER", "dummy", 1);
+
 	if (SDL_Init(SDL_INIT_AUDIO) < 0)
 	{
 		// Audio failed to init, so just disable it
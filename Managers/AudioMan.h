@@ -552,6 +552,28 @@ struct MusicNetworkData
 
 	void SetMultiplayerMode(bool value) { m_IsInMultiplayerMode = value; }
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsHeadless
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Tells whether this AudioMan mixes into a null output device instead of
+//                  opening the sound card, as a dedicated server does.
+// Arguments:       None.
+// Return value:    Whether no audio device is opened.
+
+	bool IsHeadless() const { return m_Headless; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          SetHeadless
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Sets whether to mix into a null output device instead of opening the
+//                  sound card. Channels are still allocated so that sound events relayed
+//                  to network clients keep valid channel handles. Must be set before Create.
+// Arguments:       Whether no audio device should be opened.
+// Return value:    None.
+
+	void SetHeadless(bool headless) { m_Headless = headless; }
+
 	void GetSoundEvents(int player, std::list<SoundNetworkData> & list);
 
 	void RegisterSoundEvent(int player, unsigned char state, size_t hash, short int distance, short int channel, short int loops, float pitch, bool affectedByPitch);
@@ -593,6 +615,8 @@ protected:
     Timer m_SilenceTimer;
 
 	bool m_IsInMultiplayerMode;
+	// Whether audio is mixed into a null output device instead of the sound card
+	bool m_Headless;
 
 	std::list<SoundNetworkData> m_SoundEvents[MAX_CLIENTS];
 
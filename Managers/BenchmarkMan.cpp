@@ -0,0 +1,303 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// File:            BenchmarkMan.cpp
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Source file for the BenchmarkMan class.
+// Project:         Retro Terrain Engine
+// Author(s):
+//
+//
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Inclusions of header files
+
+#include "BenchmarkMan.h"
+#include "FrameMan.h"
+#include "TimerMan.h"
+#include "ActivityMan.h"
+#include "PresetMan.h"
+#include "SceneMan.h"
+#include "ConsoleMan.h"
+#include "DDTTools.h"
+
+#include <fstream>
+#include <algorithm>
+#include <list>
+
+using namespace std;
+
+namespace RTE
+{
+
+const string BenchmarkMan::m_ClassName = "BenchmarkMan";
+const string BenchmarkMan::m_sDefaultReportPath = "Benchmark.json";
+const unsigned int BenchmarkMan::m_sSeed = 1;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Clear
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Clears all the member variables of this BenchmarkMan, effectively
+//                  resetting the members of this abstraction level only.
+
+void BenchmarkMan::Clear()
+{
+    m_ActivityName.clear();
+    m_SceneName.clear();
+    m_TickCount = 0;
+    m_ReportPath = m_sDefaultReportPath;
+    m_Started = false;
+    m_Running = false;
+    m_Finished = false;
+    m_Samples.clear();
+    m_LastFrameEnd = 0;
+    m_FrameTimes.clear();
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Create
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Makes the BenchmarkMan object ready for use.
+
+int BenchmarkMan::Create()
+{
+    return 0;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Destroy
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Stops any benchmark in progress and resets (through Clear()) the
+//                  BenchmarkMan object.
+
+void BenchmarkMan::Destroy()
+{
+    Stop();
+    Clear();
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          SetBenchmark
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Sets the benchmark to run instead of the next started activity.
+
+void BenchmarkMan::SetBenchmark(const string &activityName, const string &sceneName, int tickCount)
+{
+    m_ActivityName = activityName;
+    m_SceneName = sceneName;
+    m_TickCount = MAX(tickCount, 0);
+    m_Started = false;
+    m_Finished = false;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          StartActivity
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Sets the benchmarked activity and scene up to be restarted, the first
+//                  time this is called during a benchmark run, and starts stepping the
+//                  sim once per frame.
+
+int BenchmarkMan::StartActivity()
+{
+    // Only the first activity of the run is benchmarked
+    if (!IsBenchmarking() || m_Started)
+        return 0;
+    m_Started = true;
+
+    // Activities come in many classes, so look through all of them for the name
+    const Activity *pActivityPreset = 0;
+    list<Entity *> activityList;
+    g_PresetMan.GetAllOfType(activityList, "Activity");
+    for (list<Entity *>::iterator itr = activityList.begin(); itr != activityList.end() && !pActivityPreset; ++itr)
+    {
+        if ((*itr)->GetPresetName() == m_ActivityName)
+            pActivityPreset = dynamic_cast<const Activity *>(*itr);
+    }
+    if (!pActivityPreset)
+    {
+        g_ConsoleMan.PrintString("ERROR: Couldn't find the activity \"" + m_ActivityName + "\" to benchmark!");
+        return -1;
+    }
+    if (g_SceneMan.SetSceneToLoad(m_SceneName) < 0)
+    {
+        g_ConsoleMan.PrintString("ERROR: Couldn't find the scene \"" + m_SceneName + "\" to benchmark on!");
+        return -1;
+    }
+    // Ownership is transferred
+    g_ActivityMan.SetStartActivity(dynamic_cast<Activity *>(pActivityPreset->Clone()));
+
+    m_Samples.assign(FrameMan::PERF_COUNT, vector<long long>());
+    for (int pc = 0; pc < FrameMan::PERF_COUNT; ++pc)
+        m_Samples[pc].reserve(m_TickCount);
+    m_FrameTimes.clear();
+    m_FrameTimes.reserve(m_TickCount);
+    m_LastFrameEnd = 0;
+    m_Running = true;
+
+    SeedRand(m_sSeed);
+    g_TimerMan.SetFixedSimUpdates(true);
+
+    char report[512];
+    sprintf(report, "SYSTEM: Benchmarking %i sim updates of \"%s\" on \"%s\"", m_TickCount, m_ActivityName.c_str(), m_SceneName.c_str());
+    g_ConsoleMan.PrintString(report);
+
+    return 0;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Stop
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Stops collecting performance samples without writing the report, and
+//                  lets the sim follow real time again.
+
+void BenchmarkMan::Stop()
+{
+    if (!m_Running)
+        return;
+
+    m_Running = false;
+    g_TimerMan.SetFixedSimUpdates(false);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          EndFrame
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Collects the performance sample of the sim update just run and the
+//                  frame drawn after it. Writes the report and finishes once all sim
+//                  updates are done.
+
+void BenchmarkMan::EndFrame()
+{
+    // Nothing new to collect if no sim update was run this frame
+    if (!m_Running || g_TimerMan.SimUpdatesSinceDrawn() < 0)
+        return;
+
+    for (int pc = 0; pc < FrameMan::PERF_COUNT; ++pc)
+        m_Samples[pc].push_back(g_FrameMan.GetPerformanceSample(static_cast<FrameMan::PerformanceCounters>(pc)));
+
+    // The first frame has nothing to be measured from, it follows the activity loading
+    long long frameEnd = g_TimerMan.GetAbsoulteTime();
+    if (m_LastFrameEnd > 0)
+        m_FrameTimes.push_back(frameEnd - m_LastFrameEnd);
+    m_LastFrameEnd = frameEnd;
+
+    if ((int)m_Samples[FrameMan::PERF_SIM_TOTAL].size() >= m_TickCount)
+    {
+        Stop();
+        m_Finished = WriteReport() >= 0;
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          WriteReport
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Writes the statistics of all collected samples to the report file,
+//                  and prints a summary to the console.
+
+int BenchmarkMan::WriteReport()
+{
+    ofstream report(m_ReportPath.c_str(), ios_base::out | ios_base::trunc);
+    if (!report.good())
+    {
+        g_ConsoleMan.PrintString("ERROR: Couldn't open the benchmark report \"" + m_ReportPath + "\" for writing!");
+        return -1;
+    }
+
+    report << "{\n";
+    report << "  \"activity\": \"" << EscapeJSON(m_ActivityName) << "\",\n";
+    report << "  \"scene\": \"" << EscapeJSON(m_SceneName) << "\",\n";
+    report << "  \"simUpdates\": " << m_Samples[FrameMan::PERF_SIM_TOTAL].size() << ",\n";
+    report << "  \"deltaTimeMS\": " << g_TimerMan.GetDeltaTimeMS() << ",\n";
+    report << "  \"units\": \"microseconds\",\n";
+
+    // The real time of whole frames comes first, then each performance counter
+    report << "  \"counters\": {\n";
+    vector<long long> sorted;
+    for (int pc = -1; pc < FrameMan::PERF_COUNT; ++pc)
+    {
+        sorted = pc < 0 ? m_FrameTimes : m_Samples[pc];
+        if (sorted.empty())
+            continue;
+        sort(sorted.begin(), sorted.end());
+
+        long long sum = 0;
+        for (vector<long long>::const_iterator itr = sorted.begin(); itr != sorted.end(); ++itr)
+            sum += *itr;
+
+        string name = pc < 0 ? string("Frame") : g_FrameMan.GetPerformanceCounterName(static_cast<FrameMan::PerformanceCounters>(pc));
+        report << "    \"" << EscapeJSON(name) << "\": { ";
+        report << "\"mean\": " << sum / static_cast<long long>(sorted.size()) << ", ";
+        report << "\"p50\": " << GetPercentile(sorted, 50) << ", ";
+        report << "\"p90\": " << GetPercentile(sorted, 90) << ", ";
+        report << "\"p99\": " << GetPercentile(sorted, 99) << ", ";
+        report << "\"max\": " << sorted.back() << " }";
+        report << (pc + 1 < FrameMan::PERF_COUNT ? ",\n" : "\n");
+
+        if (pc == FrameMan::PERF_SIM_TOTAL)
+        {
+            char summary[512];
+            sprintf(summary, "SYSTEM: Benchmark done, sim update took %lld us on average, %lld us at the 99th percentile", sum / static_cast<long long>(sorted.size()), GetPercentile(sorted, 99));
+            g_ConsoleMan.PrintString(summary);
+        }
+    }
+    report << "  }\n";
+    report << "}\n";
+
+    if (!report.good())
+    {
+        g_ConsoleMan.PrintString("ERROR: Couldn't write the benchmark report \"" + m_ReportPath + "\"!");
+        return -1;
+    }
+    g_ConsoleMan.PrintString("SYSTEM: Benchmark report written to \"" + m_ReportPath + "\"");
+
+    return 0;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   GetPercentile
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets a percentile of sorted samples, by the nearest rank.
+
+long long BenchmarkMan::GetPercentile(const vector<long long> &sortedSamples, int percentile)
+{
+    int rank = (percentile * (int)sortedSamples.size() + 99) / 100;
+    return sortedSamples[MIN(MAX(rank - 1, 0), (int)sortedSamples.size() - 1)];
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   EscapeJSON
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Makes a string safe to put between quotes in JSON.
+
+string BenchmarkMan::EscapeJSON(const string &text)
+{
+    string escaped;
+    char code[8];
+    for (string::const_iterator itr = text.begin(); itr != text.end(); ++itr)
+    {
+        if (*itr == '"' || *itr == '\\')
+        {
+            escaped += '\\';
+            escaped += *itr;
+        }
+        else if (static_cast<unsigned char>(*itr) < 0x20)
+        {
+            sprintf(code, "\\u%04x", static_cast<unsigned char>(*itr));
+            escaped += code;
+        }
+        else
+            escaped += *itr;
+    }
+    return escaped;
+}
+
+} // namespace RTE
@@ -0,0 +1,305 @@
+#ifndef _RTEBenchmarkMan_
+#define _RTEBenchmarkMan_
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// File:            BenchmarkMan.h
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Header file for the BenchmarkMan class.
+// Project:         Retro Terrain Engine
+// Author(s):
+//
+//
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Inclusions of header files
+
+#include <string>
+#include <vector>
+
+#include "Singleton.h"
+#define g_BenchmarkMan BenchmarkMan::Instance()
+
+namespace RTE
+{
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Class:           BenchmarkMan
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     The centralized singleton manager of benchmark runs. Starts a given
+//                  activity on a given scene, steps the sim exactly once per frame for
+//                  a fixed number of sim updates, and collects the FrameMan performance
+//                  counters of each one. Once done, the mean, percentiles and peak of
+//                  every counter are written to a JSON report, so automated builds can
+//                  compare them between versions.
+// Parent(s):       Singleton
+// Class history:   10/17/2026  BenchmarkMan created.
+
+
+class BenchmarkMan:
+    public Singleton<BenchmarkMan>
+{
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Public member variable, method and friend function declarations
+
+public:
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Constructor:     BenchmarkMan
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Constructor method used to instantiate a BenchmarkMan object in system
+//                  memory. Create() should be called before using the object.
+// Arguments:       None.
+
+    BenchmarkMan() { Clear(); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Destructor:      ~BenchmarkMan
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Destructor method used to clean up a BenchmarkMan object before
+//                  deletion from system memory.
+// Arguments:       None.
+
+    virtual ~BenchmarkMan() { Destroy(); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Create
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Makes the BenchmarkMan object ready for use.
+// Arguments:       None.
+// Return value:    An error return value signaling sucess or any particular failure.
+//                  Anything below 0 is an error signal.
+
+    virtual int Create();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Virtual method:  Reset
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Resets the entire BenchmarkMan, including its inherited members, to
+//                  their default settings or values.
+// Arguments:       None.
+// Return value:    None.
+
+    virtual void Reset() { Clear(); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Destroy
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Stops any benchmark in progress and resets (through Clear()) the
+//                  BenchmarkMan object.
+// Arguments:       None.
+// Return value:    None.
+
+    void Destroy();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Virtual method:  GetClassName
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the class name of this Entity.
+// Arguments:       None.
+// Return value:    A string with the friendly-formatted type name of this object.
+
+    virtual const std::string & GetClassName() const { return m_ClassName; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          SetBenchmark
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Sets the benchmark to run instead of the next started activity.
+// Arguments:       The preset name of the activity to run.
+//                  The preset name of the scene to run it on.
+//                  How many sim updates to run it for.
+// Return value:    None.
+
+    void SetBenchmark(const std::string &activityName, const std::string &sceneName, int tickCount);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          SetReportPath
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Sets the file to write the JSON report to.
+// Arguments:       The path of the report.
+// Return value:    None.
+
+    void SetReportPath(const std::string &reportPath) { m_ReportPath = reportPath; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsBenchmarking
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Shows whether a benchmark has been asked for, whether it's running
+//                  yet or not.
+// Arguments:       None.
+// Return value:    Whether this is a benchmark run.
+
+    bool IsBenchmarking() const { return m_TickCount > 0; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsRunning
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Shows whether the benchmark is collecting performance samples.
+// Arguments:       None.
+// Return value:    Whether running.
+
+    bool IsRunning() const { return m_Running; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          BenchmarkFinished
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Shows whether the benchmark has run all its sim updates and written
+//                  its report.
+// Arguments:       None.
+// Return value:    Whether the benchmark is done.
+
+    bool BenchmarkFinished() const { return m_Finished; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          BenchmarkFailed
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Shows whether a benchmark was asked for but couldn't be completed.
+// Arguments:       None.
+// Return value:    Whether the benchmark failed.
+
+    bool BenchmarkFailed() const { return IsBenchmarking() && !m_Finished; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          StartActivity
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Sets the benchmarked activity and scene up to be restarted, the first
+//                  time this is called during a benchmark run, and starts stepping the
+//                  sim once per frame. Must be called right before
+//                  ActivityMan::RestartActivity.
+// Arguments:       None.
+// Return value:    An error return value signaling sucess or any particular failure.
+//                  Anything below 0 is an error signal.
+
+    int StartActivity();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Stop
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Stops collecting performance samples without writing the report, and
+//                  lets the sim follow real time again.
+// Arguments:       None.
+// Return value:    None.
+
+    void Stop();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          EndFrame
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Collects the performance sample of the sim update just run and the
+//                  frame drawn after it. Writes the report and finishes once all sim
+//                  updates are done.
+// Arguments:       None.
+// Return value:    None.
+
+    void EndFrame();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Protected member variable and method declarations
+
+protected:
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          WriteReport
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Writes the statistics of all collected samples to the report file,
+//                  and prints a summary to the console.
+// Arguments:       None.
+// Return value:    An error return value signaling sucess or any particular failure.
+//                  Anything below 0 is an error signal.
+
+    int WriteReport();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   GetPercentile
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets a percentile of sorted samples, by the nearest rank.
+// Arguments:       The samples, sorted in ascending order. Must not be empty.
+//                  The percentile, 0 to 100.
+// Return value:    The smallest sample that at least the given percentage of all
+//                  samples are less than or equal to.
+
+    static long long GetPercentile(const std::vector<long long> &sortedSamples, int percentile);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   EscapeJSON
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Makes a string safe to put between quotes in JSON.
+// Arguments:       The string.
+// Return value:    The escaped string.
+
+    static std::string EscapeJSON(const std::string &text);
+
+
+    // Member variables
+    static const std::string m_ClassName;
+    // The report file written when no other is set
+    static const std::string m_sDefaultReportPath;
+    // The seed of the random number generator, so each run simulates the same as far as possible
+    static const unsigned int m_sSeed;
+
+    // The preset names of the activity and scene to benchmark
+    std::string m_ActivityName;
+    std::string m_SceneName;
+    // How many sim updates to run, 0 if this isn't a benchmark run
+    int m_TickCount;
+    // The file to write the report to
+    std::string m_ReportPath;
+    // Whether the benchmarked activity has been set up to start
+    bool m_Started;
+    // Whether samples are being collected
+    bool m_Running;
+    // Whether all sim updates have been run and the report written
+    bool m_Finished;
+    // The collected samples of each performance counter, in microseconds
+    std::vector<std::vector<long long> > m_Samples;
+    // The absolute time the last collected frame ended, 0 before the first
+    long long m_LastFrameEnd;
+    // The real time from the end of each collected frame to the end of the next, in microseconds
+    std::vector<long long> m_FrameTimes;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Private member variable and method declarations
+
+private:
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Clear
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Clears all the member variables of this BenchmarkMan, effectively
+//                  resetting the members of this abstraction level only.
+// Arguments:       None.
+// Return value:    None.
+
+    void Clear();
+
+    // Disallow the use of some implicit methods.
+    BenchmarkMan(const BenchmarkMan &reference);
+    BenchmarkMan & operator=(const BenchmarkMan &rhs);
+
+};
+
+} // namespace RTE
+
+#endif // File
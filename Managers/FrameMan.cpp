@@ -12,6 +12,8 @@
 // Inclusions of header files
 
 #include <mutex>
+#include <thread>
+#include <condition_variable>
 
 #include "FrameMan.h"
 #include "PresetMan.h"
@@ -24,8 +26,10 @@
 #include "BuyMenuGUI.h"
 #include "SceneEditorGUI.h"
 #include "MovableMan.h"
+#include "LuaMan.h"
 #include "SLTerrain.h"
 #include "MOSprite.h"
+#include "RotatedSpriteCache.h"
 #include "Scene.h"
 
 
@@ -41,6 +45,10 @@
 
 // I know this is a crime, but if I include it in FrameMan.h the whole thing will collapse due to int redefinitions in Allegro
 std::mutex ScreenRelativeEffectsMutex[MAXSCREENCOUNT];
+// Same goes for the post processing thread and what it's synchronized with
+std::thread PostProcessThread;
+std::mutex PostProcessMutex;
+std::condition_variable PostProcessSignal;
 
 using std::list;
 using std::pair;
@@ -406,6 +414,7 @@ void FrameMan::Clear()
     m_pBackBuffer8 = 0;
 	m_DrawNetworkBackBuffer = false;
 	m_StoreNetworkBackBuffer = false;
+	m_Headless = false;
 	m_pBackBuffer32 = 0;
     m_pScreendumpBuffer = 0;
     m_PaletteFile.Reset();
@@ -425,6 +434,15 @@ void FrameMan::Clear()
     m_pBlueGlow = 0;
     m_BlueGlowHash = 0;
     m_PostScreenEffects.clear();
+    m_PostScreenGlowBoxes.clear();
+    m_PostProcessPending = false;
+    m_QuitPostProcessThread = false;
+    m_PostProcessQueued = false;
+    m_pPostProcessBuffer8 = 0;
+    m_PostProcessEffects.clear();
+    m_PostProcessGlowBoxes.clear();
+    m_PostProcessTime = 0;
+    m_GlowRandSeed = 1;
     m_HSplit = false;
     m_VSplit = false;
     m_HSplitOverride = false;
@@ -546,8 +564,10 @@ int FrameMan::Create()
 		windowedGfxDriver = GFX_DIRECTX_WIN_BORDERLESS;
 #endif // defined(__APPLE__)
 
-
-    if (set_gfx_mode(m_Fullscreen ? fullscreenGfxDriver : windowedGfxDriver, m_Fullscreen ? m_ResX * m_NxFullscreen : m_ResX * m_NxWindowed, m_Fullscreen ? m_ResY * m_NxFullscreen : m_ResY * m_NxWindowed, 0, 0) != 0)
+	// Dedicated servers never open a window, everything is drawn into memory bitmaps
+	if (m_Headless)
+		g_ConsoleMan.PrintString("MSG: Running headless, no graphics mode is set!");
+    else if (set_gfx_mode(m_Fullscreen ? fullscreenGfxDriver : windowedGfxDriver, m_Fullscreen ? m_ResX * m_NxFullscreen : m_ResX * m_NxWindowed, m_Fullscreen ? m_ResY * m_NxFullscreen : m_ResY * m_NxWindowed, 0, 0) != 0)
     {
 		g_ConsoleMan.PrintString("Failed to set gfx mode, trying different windowed scaling.");
 
@@ -580,10 +600,13 @@ int FrameMan::Create()
     }
 
     // Clear the screen buffer so it doesn't flash pink
-    if (m_BPP == 8)
-        clear_to_color(screen, m_BlackColor);
-    else
-        clear_to_color(screen, 0);
+    if (!m_Headless)
+    {
+        if (m_BPP == 8)
+            clear_to_color(screen, m_BlackColor);
+        else
+            clear_to_color(screen, 0);
+    }
 
     // Sets the allowed color conversions when loading bitmaps from files
     set_color_conversion(COLORCONV_MOST);
@@ -593,10 +616,13 @@ int FrameMan::Create()
         return -1;
 
     // Set the switching mode; what happens when the app window is switched to and fro
-    set_display_switch_mode(SWITCH_BACKGROUND);
-//    set_display_switch_mode(SWITCH_PAUSE);
-    set_display_switch_callback(SWITCH_OUT, DisplaySwitchOut);
-    set_display_switch_callback(SWITCH_IN, DisplaySwitchIn);
+    if (!m_Headless)
+    {
+        set_display_switch_mode(SWITCH_BACKGROUND);
+//        set_display_switch_mode(SWITCH_PAUSE);
+        set_display_switch_callback(SWITCH_OUT, DisplaySwitchOut);
+        set_display_switch_callback(SWITCH_IN, DisplaySwitchIn);
+    }
 
     // Create transparency color table
     PALETTE ccpal;
@@ -650,6 +676,13 @@ int FrameMan::Create()
 		m_pTempEffectBitmap_64 = create_bitmap_ex(32, 64, 64);
 		m_pTempEffectBitmap_128 = create_bitmap_ex(32, 128, 128);
 		m_pTempEffectBitmap_256 = create_bitmap_ex(32, 256, 256);
+
+        // Post process each frame on a thread of its own, while the next one is simulated and drawn
+        if (g_SettingsMan.ThreadedPostProcessing())
+        {
+            m_pPostProcessBuffer8 = create_bitmap_ex(8, m_ResX, m_ResY);
+            PostProcessThread = std::thread(&FrameMan::PostProcessLoop, this);
+        }
 	}
 
     m_PlayerScreenWidth = m_pBackBuffer8->w;
@@ -689,6 +722,11 @@ int FrameMan::Create()
     m_PerfCounterNames[PERF_PARTICLES_PASS2] = "Prt Update";
 	m_PerfCounterNames[PERF_ACTORS_AI] = "Act AI";
     m_PerfCounterNames[PERF_ACTIVITY] = "Activity";
+    m_PerfCounterNames[PERF_MOIDS] = "MOID Draw";
+    m_PerfCounterNames[PERF_SETTLE] = "Settle";
+    m_PerfCounterNames[PERF_LUA] = "Lua";
+    m_PerfCounterNames[PERF_POSTPROCESS] = "Post FX";
+    m_PerfCounterNames[PERF_NETWORK_ENCODE] = "Net Encode";
 
     return 0;
 }
@@ -875,6 +913,16 @@ int FrameMan::Save(Writer &writer) const
 
 void FrameMan::Destroy()
 {
+    // Stop the post processing thread before anything it uses goes away
+    {
+        std::lock_guard<std::mutex> lock(PostProcessMutex);
+        m_QuitPostProcessThread = true;
+    }
+    PostProcessSignal.notify_all();
+    if (PostProcessThread.joinable())
+        PostProcessThread.join();
+    destroy_bitmap(m_pPostProcessBuffer8);
+
     destroy_bitmap(m_pBackBuffer8);
 	for (int i = 0; i < MAXSCREENCOUNT; i++)
 	{
@@ -1168,6 +1216,9 @@ int FrameMan::SaveWorldToBMP(const char *namebase)
 	if (!g_ActivityMan.ActivityRunning())
 		return 0;
 
+    // The post effects below are drawn with the same blender and temp bitmaps as the post processing thread uses
+    WaitForPostProcess();
+
     int filenumber = 0;
     char fullfilename[256];
     int maxFileTrys = 1000;
@@ -1308,6 +1359,13 @@ int FrameMan::SaveBitmapToBMP(BITMAP *pBitmap, const char *namebase)
 
 int FrameMan::ToggleFullscreen()
 {
+    // No window to change
+    if (m_Headless)
+        return -1;
+
+    // Changing modes can't happen while a frame is being post processed
+    WaitForPostProcess();
+
     // Save the palette so we can re-set it after the change.
     PALETTE pal;
     get_palette(pal);
@@ -1449,7 +1507,7 @@ int FrameMan::ToggleFullscreen()
 int FrameMan::SwitchWindowMultiplier(int multiplier)
 {
     // Sanity check input
-    if (multiplier <= 0 || multiplier > 4 || multiplier == m_NxWindowed)
+    if (multiplier <= 0 || multiplier > 4 || multiplier == m_NxWindowed || m_Headless)
         return -1;
 
     // No need to do anyhting else if we're in fullscreen already
@@ -1459,6 +1517,9 @@ int FrameMan::SwitchWindowMultiplier(int multiplier)
         return 0;
     }
 
+    // Changing modes can't happen while a frame is being post processed
+    WaitForPostProcess();
+
     // Refuse windowed multiplier if the resolution is too high
     if (m_ResX > 1024)
         m_NxWindowed = 1;
@@ -1513,13 +1574,26 @@ int FrameMan::SwitchWindowMultiplier(int multiplier)
 
 void FrameMan::PostProcess()
 {
+    // Only profiled here on the main thread, the Slick Profiler can't take scopes from the post processing thread
     SLICK_PROFILE(0xFF354556);
 
     if (!m_PostProcessing)
         return;
 
-    // First copy the current 8bpp backbuffer to the 32bpp buffer; we'll add effects to it
-    blit(m_pBackBuffer8, m_pBackBuffer32, 0, 0, 0, 0, m_pBackBuffer8->w, m_pBackBuffer8->h);
+    PostProcess(m_pBackBuffer8, m_PostScreenEffects, m_PostScreenGlowBoxes);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          PostProcess
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Copies an 8bpp frame to the 32bpp back buffer, and adds the post
+//                  processing effects of that frame on top.
+
+void FrameMan::PostProcess(BITMAP *pSourceBitmap8, list<PostEffect> &postEffects, const list<Box> &glowBoxes)
+{
+    // First copy the 8bpp frame to the 32bpp buffer; we'll add effects to it
+    blit(pSourceBitmap8, m_pBackBuffer32, 0, 0, 0, 0, pSourceBitmap8->w, pSourceBitmap8->h);
 
 	// Set the screen blender mode for glows
 //    set_alpha_blender();
@@ -1534,7 +1608,7 @@ void FrameMan::PostProcess()
     {
         int x = 0, y = 0, startX = 0, startY = 0, endX = 0, endY = 0, testpixel = 0;
 
-        for (list<Box>::iterator bItr = m_PostScreenGlowBoxes.begin(); bItr != m_PostScreenGlowBoxes.end(); ++bItr)
+        for (list<Box>::const_iterator bItr = glowBoxes.begin(); bItr != glowBoxes.end(); ++bItr)
         {
             startX = (*bItr).m_Corner.m_X;
             startY = (*bItr).m_Corner.m_Y;
@@ -1543,8 +1617,8 @@ void FrameMan::PostProcess()
             testpixel = 0;
 
             // Sanity check a little at least
-            if (startX < 0 || startX >= m_pBackBuffer8->w || startY < 0 || startY >= m_pBackBuffer8->h ||
-                endX < 0 || endX >= m_pBackBuffer8->w || endY < 0 || endY >= m_pBackBuffer8->h)
+            if (startX < 0 || startX >= pSourceBitmap8->w || startY < 0 || startY >= pSourceBitmap8->h ||
+                endX < 0 || endX >= pSourceBitmap8->w || endY < 0 || endY >= pSourceBitmap8->h)
                 continue;
 
 // TODO: REMOVE TEMP DEBUG
@@ -1554,10 +1628,10 @@ void FrameMan::PostProcess()
             {
                 for (x = startX; x < endX; ++x)
                 {
-                    testpixel = _getpixel(m_pBackBuffer8, x, y);
+                    testpixel = _getpixel(pSourceBitmap8, x, y);
 
                     // YELLOW
-                    if ((testpixel == g_YellowGlowColor && PosRand() < 0.9) || testpixel == 98 || (testpixel == 120 && PosRand() < 0.7))// || testpixel == 39 || testpixel == 86 || testpixel == 47 || testpixel == 48 || testpixel == 116)
+                    if ((testpixel == g_YellowGlowColor && GlowRand() < 0.9) || testpixel == 98 || (testpixel == 120 && GlowRand() < 0.7))// || testpixel == 39 || testpixel == 86 || testpixel == 47 || testpixel == 48 || testpixel == 116)
                         draw_trans_sprite(m_pBackBuffer32, m_pYellowGlow, x - 2, y - 2);
                     // RED
         //            if (testpixel == 13)
@@ -1597,7 +1671,7 @@ void FrameMan::PostProcess()
     int strength = 0;
 	float angle = 0;
 
-    for (list<PostEffect>::iterator eItr = m_PostScreenEffects.begin(); eItr != m_PostScreenEffects.end(); ++eItr)
+    for (list<PostEffect>::iterator eItr = postEffects.begin(); eItr != postEffects.end(); ++eItr)
     {
 		if ((*eItr).m_pBitmap)
 		{
@@ -1649,7 +1723,121 @@ void FrameMan::PostProcess()
 //    set_trans_blender(128, 128, 128, 128);
 
     // Clear the effects list for this frame
-    m_PostScreenEffects.clear();
+    postEffects.clear();
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GlowRand
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets a random number between 0 and 1 for the glow pattern.
+
+double FrameMan::GlowRand()
+{
+    m_GlowRandSeed = m_GlowRandSeed * 1103515245 + 12345;
+    return static_cast<double>((m_GlowRandSeed >> 16) & 0x7FFF) / 32768.0;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          QueuePostProcess
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Shows the frame handed to the post processing thread last time, and
+//                  hands the one just drawn over to it.
+
+void FrameMan::QueuePostProcess()
+{
+    ShowPostProcessedFrame();
+
+    // Take a copy of the frame, the next one is drawn into the back buffer while this is post processed
+    blit(m_pBackBuffer8, m_pPostProcessBuffer8, 0, 0, 0, 0, m_pBackBuffer8->w, m_pBackBuffer8->h);
+    {
+        std::lock_guard<std::mutex> lock(PostProcessMutex);
+        // The lists of the last frame are empty once post processed, so the next frame fills those
+        m_PostProcessEffects.swap(m_PostScreenEffects);
+        m_PostProcessGlowBoxes.swap(m_PostScreenGlowBoxes);
+        m_PostProcessPending = true;
+    }
+    PostProcessSignal.notify_all();
+    m_PostProcessQueued = true;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ShowPostProcessedFrame
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Waits for the frame handed to the post processing thread to be done,
+//                  draws the console on it and flips it to the screen.
+
+void FrameMan::ShowPostProcessedFrame()
+{
+    if (!m_PostProcessQueued)
+        return;
+
+    WaitForPostProcess();
+
+    // The console is drawn on last, so it's never behind by a frame
+    g_ConsoleMan.Draw(m_pBackBuffer32);
+
+    if (!m_Fullscreen && m_NxWindowed != 1)
+        stretch_blit(m_pBackBuffer32, screen, 0, 0, m_pBackBuffer32->w, m_pBackBuffer32->h, 0, 0, SCREEN_W, SCREEN_H);
+    else if (m_Fullscreen && m_NxFullscreen != 1)
+        stretch_blit(m_pBackBuffer32, screen, 0, 0, m_pBackBuffer32->w, m_pBackBuffer32->h, 0, 0, SCREEN_W, SCREEN_H);
+    else
+        blit(m_pBackBuffer32, screen, 0, 0, 0, 0, m_pBackBuffer32->w, m_pBackBuffer32->h);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          WaitForPostProcess
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Blocks until the post processing thread is done with the frame handed
+//                  to it, if any, so the 32bpp back buffer and the blender can be used.
+
+void FrameMan::WaitForPostProcess()
+{
+    if (!m_PostProcessQueued)
+        return;
+
+    {
+        std::unique_lock<std::mutex> lock(PostProcessMutex);
+        while (m_PostProcessPending)
+            PostProcessSignal.wait(lock);
+    }
+    m_PostProcessQueued = false;
+
+    // Counted for the frame it's shown with, since it overlapped with that one
+    AddPerformanceSample(PERF_POSTPROCESS, m_PostProcessTime);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          PostProcessLoop
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     The function the post processing thread runs until the FrameMan is
+//                  destroyed, post processing each frame handed to it.
+
+void FrameMan::PostProcessLoop()
+{
+    std::unique_lock<std::mutex> lock(PostProcessMutex);
+    while (!m_QuitPostProcessThread)
+    {
+        if (!m_PostProcessPending)
+        {
+            PostProcessSignal.wait(lock);
+            continue;
+        }
+        lock.unlock();
+
+        int64_t startTime = g_TimerMan.GetAbsoulteTime();
+        PostProcess(m_pPostProcessBuffer8, m_PostProcessEffects, m_PostProcessGlowBoxes);
+        m_PostProcessGlowBoxes.clear();
+        m_PostProcessTime = g_TimerMan.GetAbsoulteTime() - startTime;
+
+        lock.lock();
+        m_PostProcessPending = false;
+        PostProcessSignal.notify_all();
+    }
 }
 
 
@@ -1662,6 +1850,18 @@ void FrameMan::FlipFrameBuffers()
 {
     SLICK_PROFILE(0xFF886532);
 
+    // Nothing to flip to
+    if (m_Headless)
+        return;
+
+    // A frame being post processed on its own thread is flipped once done, when the next one is drawn
+    if (m_PostProcessQueued)
+    {
+        if (g_InActivity)
+            return;
+        WaitForPostProcess();
+    }
+
     if (get_color_depth() == 32 && m_BPP == 32 && m_pBackBuffer32)
     {
         if (g_InActivity)
@@ -2226,7 +2426,7 @@ void FrameMan::Draw()
                 sprintf(str, "DeltaTime: %.2f ms ([5]-, [6]+)", dt);
                 GetLargeFont()->DrawAligned(&pPlayerGUIBitmap, 17, 54, str, GUIFont::Left);
 
-                sprintf(str, "Particles: %i", g_MovableMan.GetParticleCount());
+                sprintf(str, "Particles: %li (%li packed)", g_MovableMan.GetParticleCount(), g_MovableMan.GetPackedParticleCount());
                 GetLargeFont()->DrawAligned(&pPlayerGUIBitmap, 17, 64, str, GUIFont::Left);
 
 				sprintf(str, "Objects: %i", g_MovableMan.GetKnownObjectsCount());
@@ -2238,8 +2438,11 @@ void FrameMan::Draw()
                 sprintf(str, "Sim Updates Since Last Drawn: %i", g_TimerMan.SimUpdatesSinceDrawn());
                 GetLargeFont()->DrawAligned(&pPlayerGUIBitmap, 17, 94, str, GUIFont::Left);
 
+                sprintf(str, "Lua String Compiles: %i", g_LuaMan.GetStringCompileCount());
+                GetLargeFont()->DrawAligned(&pPlayerGUIBitmap, 17, 104, str, GUIFont::Left);
+
                 if (g_TimerMan.IsOneSimUpdatePerFrame())
-                    GetLargeFont()->DrawAligned(&pPlayerGUIBitmap, 17, 104, "ONE Sim Update Per Frame!", GUIFont::Left);
+                    GetLargeFont()->DrawAligned(&pPlayerGUIBitmap, 17, 114, "ONE Sim Update Per Frame!", GUIFont::Left);
 
 #ifdef __USE_SOUND_FMOD
 				int num2d, num3d, total;
@@ -2247,14 +2450,24 @@ void FrameMan::Draw()
 				FSOUND_GetNumHWChannels(&num2d, &num3d, &total);
 
 				sprintf(str, "Sound channels: %d / %d (HW %d + %d : %d)  CPU: %.1f", FSOUND_GetChannelsPlaying(), FSOUND_GetMaxChannels(), num2d, num3d, total, FSOUND_GetCPUUsage());
-				GetLargeFont()->DrawAligned(&pPlayerGUIBitmap, 17, 114, str, GUIFont::Left);
+				GetLargeFont()->DrawAligned(&pPlayerGUIBitmap, 17, 124, str, GUIFont::Left);
 #endif // __USE_SOUND_FMOD
 
+                sprintf(str, "Sprite Cache: %.1f MB, Hits: Color %.0f%% Mat %.0f%% MOID %.0f%%", RotatedSpriteCache::GetMemoryUsed() / (1024.0f * 1024.0f), RotatedSpriteCache::GetHitRatio(RotatedSpriteCache::COLOR) * 100, RotatedSpriteCache::GetHitRatio(RotatedSpriteCache::MATERIAL) * 100, RotatedSpriteCache::GetHitRatio(RotatedSpriteCache::MOID) * 100);
+                GetLargeFont()->DrawAligned(&pPlayerGUIBitmap, 17, 134, str, GUIFont::Left);
+
+                // The script function which took the longest, and how many scripts waited out the budget, during the last sim update
+                sprintf(str, "Lua Heaviest: %.2f ms %s, Throttled: %i", g_LuaMan.GetHeaviestScriptTime() / 1000.0f, g_LuaMan.GetHeaviestScriptName().c_str(), g_LuaMan.GetThrottledScriptCount());
+                GetLargeFont()->DrawAligned(&pPlayerGUIBitmap, 17, 144, str, GUIFont::Left);
+
 				int xOffset = 17;
-				int yOffset = 134;
+				int yOffset = 154;
 				int blockHeight = 34;
 				int graphHeight = 20;
 				int graphOffset = 14;
+				// Wrap the counters into more columns when they don't all fit below each other
+				int blocksPerColumn = MAX((pPlayerGUIBitmap.GetHeight() - yOffset) / blockHeight, 1);
+				int columnWidth = MAXSAMPLES + 80;
 
 				//Update current sample percentage
 				g_FrameMan.CalculateSamplePercentages();
@@ -2262,27 +2475,28 @@ void FrameMan::Draw()
 				//Draw advanced performance counters
 				for(int pc = 0 ; pc < FrameMan::PERF_COUNT; ++pc)
 				{
-					int blockStart = yOffset + pc * blockHeight;
+					int blockX = xOffset + (pc / blocksPerColumn) * columnWidth;
+					int blockStart = yOffset + (pc % blocksPerColumn) * blockHeight;
 
-					GetLargeFont()->DrawAligned(&pPlayerGUIBitmap, xOffset, blockStart , m_PerfCounterNames[pc], GUIFont::Left);
+					GetLargeFont()->DrawAligned(&pPlayerGUIBitmap, blockX, blockStart , m_PerfCounterNames[pc], GUIFont::Left);
 
 					// Print percentage from PerformanceCounters::PERF_SIM_TOTAL
 					int perc = (int)((float)GetPerormanceCounterAverage(static_cast<PerformanceCounters>(pc)) / (float)GetPerormanceCounterAverage(PERF_SIM_TOTAL) * 100);
 					sprintf(str, "%%: %i", perc);
-		            GetLargeFont()->DrawAligned(&pPlayerGUIBitmap, xOffset + 60, blockStart, str, GUIFont::Left);
+		            GetLargeFont()->DrawAligned(&pPlayerGUIBitmap, blockX + 60, blockStart, str, GUIFont::Left);
 					
 					// Print average processing time in ms
 					sprintf(str, "T: %i", GetPerormanceCounterAverage(static_cast<PerformanceCounters>(pc)) / 1000);
-		            GetLargeFont()->DrawAligned(&pPlayerGUIBitmap, xOffset + 96, blockStart, str, GUIFont::Left);
+		            GetLargeFont()->DrawAligned(&pPlayerGUIBitmap, blockX + 96, blockStart, str, GUIFont::Left);
 					
 					int graphStart = blockStart + graphOffset;
 
 					//Draw graph
 					//Draw graph backgrounds
-					pPlayerGUIBitmap.DrawRectangle(xOffset, graphStart , MAXSAMPLES, graphHeight , 240, true);
-					//pPlayerGUIBitmap.DrawLine(xOffset, graphStart, xOffset + MAXSAMPLES, graphStart, 48);
-					pPlayerGUIBitmap.DrawLine(xOffset, graphStart + graphHeight / 2, xOffset + MAXSAMPLES, graphStart + graphHeight / 2, 96);
-					//pPlayerGUIBitmap.DrawLine(xOffset, graphStart + graphHeight, xOffset + MAXSAMPLES, graphStart + graphHeight , 48);
+					pPlayerGUIBitmap.DrawRectangle(blockX, graphStart , MAXSAMPLES, graphHeight , 240, true);
+					//pPlayerGUIBitmap.DrawLine(blockX, graphStart, blockX + MAXSAMPLES, graphStart, 48);
+					pPlayerGUIBitmap.DrawLine(blockX, graphStart + graphHeight / 2, blockX + MAXSAMPLES, graphStart + graphHeight / 2, 96);
+					//pPlayerGUIBitmap.DrawLine(blockX, graphStart + graphHeight, blockX + MAXSAMPLES, graphStart + graphHeight , 48);
 
 					int smpl = m_Sample;
 
@@ -2313,7 +2527,7 @@ void FrameMan::Draw()
 							value = 100;
 						// Calculate dot height on the graph
 						int dotHeight = (int)((float)graphHeight / 100.0 * (float)value);
-						pPlayerGUIBitmap.SetPixel(xOffset + MAXSAMPLES - i, graphStart + graphHeight - dotHeight, 13);
+						pPlayerGUIBitmap.SetPixel(blockX + MAXSAMPLES - i, graphStart + graphHeight - dotHeight, 13);
 
 						if (peak < m_PerfData[pc][smpl])
 							peak = m_PerfData[pc][smpl];
@@ -2324,7 +2538,7 @@ void FrameMan::Draw()
 
 					// Print peak values
 					sprintf(str, "Peak: %i", peak / 1000);
-		            GetLargeFont()->DrawAligned(&pPlayerGUIBitmap, xOffset + 130, blockStart, str, GUIFont::Left);
+		            GetLargeFont()->DrawAligned(&pPlayerGUIBitmap, blockX + 130, blockStart, str, GUIFont::Left);
 				}
             }
 
@@ -2521,26 +2735,26 @@ void FrameMan::Draw()
 			m_NetworkBitmapIsLocked[i] = false;
 
 			// Draw all player's screen into one
-			if (g_UInputMan.KeyHeld(KEY_5))
+			if (!m_Headless && g_UInputMan.KeyHeld(KEY_5))
 				stretch_blit(m_pNetworkBackBufferFinal8[m_NetworkFrameCurrent][i], m_pBackBuffer8, 0, 0, m_pNetworkBackBufferFinal8[m_NetworkFrameReady][i]->w, m_pNetworkBackBufferFinal8[m_NetworkFrameReady][i]->h, dx, dy, dw, dh);
 		}
 
-		if (g_UInputMan.KeyHeld(KEY_1))
+		if (!m_Headless && g_UInputMan.KeyHeld(KEY_1))
 		{
 			stretch_blit(m_pNetworkBackBufferFinal8[0][0], m_pBackBuffer8, 0, 0, m_pNetworkBackBufferFinal8[m_NetworkFrameReady][0]->w, m_pNetworkBackBufferFinal8[m_NetworkFrameReady][0]->h, 0, 0, m_pBackBuffer8->w, m_pBackBuffer8->h);
 		}
 
-		if (g_UInputMan.KeyHeld(KEY_2))
+		if (!m_Headless && g_UInputMan.KeyHeld(KEY_2))
 		{
 			stretch_blit(m_pNetworkBackBufferFinal8[1][0], m_pBackBuffer8, 0, 0, m_pNetworkBackBufferFinal8[m_NetworkFrameReady][1]->w, m_pNetworkBackBufferFinal8[m_NetworkFrameReady][1]->h, 0, 0, m_pBackBuffer8->w, m_pBackBuffer8->h);
 		}
 
-		if (g_UInputMan.KeyHeld(KEY_3))
+		if (!m_Headless && g_UInputMan.KeyHeld(KEY_3))
 		{
 			stretch_blit(m_pNetworkBackBufferFinal8[m_NetworkFrameReady][2], m_pBackBuffer8, 0, 0, m_pNetworkBackBufferFinal8[m_NetworkFrameReady][2]->w, m_pNetworkBackBufferFinal8[m_NetworkFrameReady][2]->h, 0, 0, m_pBackBuffer8->w, m_pBackBuffer8->h);
 		}
 
-		if (g_UInputMan.KeyHeld(KEY_4))
+		if (!m_Headless && g_UInputMan.KeyHeld(KEY_4))
 		{
 			stretch_blit(m_pNetworkBackBufferFinal8[m_NetworkFrameReady][3], m_pBackBuffer8, 0, 0, m_pNetworkBackBufferFinal8[m_NetworkFrameReady][3]->w, m_pNetworkBackBufferFinal8[m_NetworkFrameReady][3]->h, 0, 0, m_pBackBuffer8->w, m_pBackBuffer8->h);
 		}
@@ -2565,12 +2779,25 @@ void FrameMan::Draw()
 		}*/
 	}
 
-    // Do postprocessing effects, if applicable and enabled
-    if (m_PostProcessing && g_InActivity && m_BPP == 32)
-        PostProcess();
+    // Do postprocessing effects, if applicable and enabled. Nobody would see them when headless
+    if (m_PostProcessing && g_InActivity && m_BPP == 32 && !m_Headless)
+    {
+        // Leave it to the post processing thread while the next frame is simulated and drawn
+        if (PostProcessThread.joinable())
+            QueuePostProcess();
+        else
+        {
+            StartPerformanceMeasurement(PERF_POSTPROCESS);
+            PostProcess();
+            StopPerformanceMeasurement(PERF_POSTPROCESS);
+        }
+    }
+    // Any frame still being post processed from before it was turned off isn't wanted anymore
+    else
+        WaitForPostProcess();
 
-    // Draw the console on top of everything
-    if (FlippingWith32BPP())
+    // Draw the console on top of everything, unless the frame is post processed on its own thread and gets it then
+    if (FlippingWith32BPP() && !m_Headless && !m_PostProcessQueued)
         g_ConsoleMan.Draw(m_pBackBuffer32);
 
     release_bitmap(m_pBackBuffer8);
@@ -29,7 +29,8 @@ enum
     g_WhiteColor = 254,
     g_RedColor = 13,
     g_YellowGlowColor = 117,
-    g_NoMOID = 255
+    // The MOID layer is 16bpp, so this is kept at the very top of its range; all IDs below it are usable except g_KeyColorS
+    g_NoMOID = 0xFFFF
 };
 
 enum DotGlowColor
@@ -128,6 +129,11 @@ public:
 		PERF_PARTICLES_PASS2,
 		PERF_PARTICLES_PASS1,
 		PERF_ACTIVITY,
+		PERF_MOIDS,
+		PERF_SETTLE,
+		PERF_LUA,
+		PERF_POSTPROCESS,
+		PERF_NETWORK_ENCODE,
 		PERF_COUNT
 	};
 
@@ -991,6 +997,28 @@ public:
 
 	void SetStoreNetworkBackBuffer(bool value) { m_StoreNetworkBackBuffer = value; }
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsHeadless
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Tells whether this FrameMan runs without a window, rendering player
+//                  views only into the network back buffers.
+// Arguments:       None.
+// Return value:    Whether there is no window to draw to.
+
+	bool IsHeadless() const { return m_Headless; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          SetHeadless
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Sets whether to run without a window. No graphics mode is set, frame
+//                  flips do nothing and Draw only renders into the network back buffers.
+//                  Must be set before Create.
+// Arguments:       Whether to run without a window.
+// Return value:    None.
+
+	void SetHeadless(bool headless) { m_Headless = headless; }
+
 	void CreateNewPlayerBackBuffer(int player, int w, int h);
 
 
@@ -999,10 +1027,11 @@ public:
 //////////////////////////////////////////////////////////////////////////////////////////
 // Description:     Gets the 32bpp back buffer bitmap, if available. If not, the 8bpp is
 //                  returned. Make sure you don't do any blending stuff to the 8bpp one!
+//                  Waits for any frame being post processed on its own thread first.
 // Arguments:       None.
 // Return value:    A pointer to the BITMAP 32bpp back buffer. OWNERSHIP IS NOT TRANSFERRED!
 
-    BITMAP * GetBackBuffer32() const { return m_pBackBuffer32 ? m_pBackBuffer32 : m_pBackBuffer8; }
+    BITMAP * GetBackBuffer32() { WaitForPostProcess(); return m_pBackBuffer32 ? m_pBackBuffer32 : m_pBackBuffer8; }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1475,11 +1504,12 @@ public:
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          ClearBackBuffer32
 //////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Clears the 32bpp backbuffer with black.
+// Description:     Clears the 32bpp backbuffer with black. Waits for any frame being post
+//                  processed on its own thread first.
 // Arguments:       None.
 // Return value:    None.
 
-    void ClearBackBuffer32() { if (m_pBackBuffer32) clear_to_color(m_pBackBuffer32, 0); }
+    void ClearBackBuffer32() { WaitForPostProcess(); if (m_pBackBuffer32) clear_to_color(m_pBackBuffer32, 0); }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1673,6 +1703,30 @@ public:
 		AddPerformanceSample(counter, m_PerfMeasureStop[counter] - m_PerfMeasureStart[counter]);
 	}
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          AddPerformanceSample
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Adds provided value to current sample of specified performance counter
+// Arguments:       Counter to update, value to add to this counter
+// Return value:    None.
+	void AddPerformanceSample(PerformanceCounters counter, int64_t value) { m_PerfData[counter][m_Sample] += value; }
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetPerformanceSample
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Returns the value of the current sample of specified performance counter
+// Arguments:       Counter to get the value of.
+// Return value:    The time measured so far in this sample, in microseconds.
+	int64_t GetPerformanceSample(PerformanceCounters counter) const { return m_PerfData[counter][m_Sample]; }
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetPerformanceCounterName
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Returns the name of specified performance counter as displayed on screen
+// Arguments:       Counter to get the name of.
+// Return value:    The name.
+	const string & GetPerformanceCounterName(PerformanceCounters counter) const { return m_PerfCounterNames[counter]; }
+
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          IsValidResolution	
@@ -1695,6 +1749,77 @@ public:
 
 protected:
 
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          PostProcess
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Copies an 8bpp frame to the 32bpp back buffer, and adds the post
+//                  processing effects of that frame on top.
+// Arguments:       The 8bpp frame to post process.
+//                  The post effects of the frame. Cleared once drawn.
+//                  The screen areas of the frame to put glows in.
+// Return value:    None.
+
+    void PostProcess(BITMAP *pSourceBitmap8, std::list<PostEffect> &postEffects, const std::list<Box> &glowBoxes);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GlowRand
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets a random number between 0 and 1 for the glow pattern. Kept apart
+//                  from the global random numbers, which belong to the simulation and
+//                  mustn't be touched from the post processing thread.
+// Arguments:       None.
+// Return value:    The random number.
+
+    double GlowRand();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          QueuePostProcess
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Shows the frame handed to the post processing thread last time, and
+//                  hands the one just drawn over to it.
+// Arguments:       None.
+// Return value:    None.
+
+    void QueuePostProcess();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ShowPostProcessedFrame
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Waits for the frame handed to the post processing thread to be done,
+//                  draws the console on it and flips it to the screen.
+// Arguments:       None.
+// Return value:    None.
+
+    void ShowPostProcessedFrame();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          WaitForPostProcess
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Blocks until the post processing thread is done with the frame handed
+//                  to it, if any, so the 32bpp back buffer and the blender can be used.
+//                  That frame won't be flipped to the screen anymore.
+// Arguments:       None.
+// Return value:    None.
+
+    void WaitForPostProcess();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          PostProcessLoop
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     The function the post processing thread runs until the FrameMan is
+//                  destroyed, post processing each frame handed to it.
+// Arguments:       None.
+// Return value:    None.
+
+    void PostProcessLoop();
+
+
     // Member variables
     static const std::string m_ClassName;
 
@@ -1733,6 +1858,9 @@ protected:
 	// If true, dumps the contents of the m_pBackBuffer8 to the m_pNetworkBackBuffer8 every frame
 	bool m_StoreNetworkBackBuffer;
 
+	// If true, no graphics mode is set and nothing is ever flipped to the screen
+	bool m_Headless;
+
     // Temporary buffer for making quick screencaps
     BITMAP *m_pScreendumpBuffer;
 
@@ -1782,6 +1910,22 @@ protected:
 	BITMAP * m_pTempEffectBitmap_128;
 	BITMAP * m_pTempEffectBitmap_256;
 
+    // Whether a frame has been handed to the post processing thread and is waiting to be done. Guarded by its mutex
+    bool m_PostProcessPending;
+    // Tells the post processing thread to finish. Guarded by its mutex
+    bool m_QuitPostProcessThread;
+    // Whether a frame has been handed to the post processing thread and not flipped to the screen yet. Main thread only
+    bool m_PostProcessQueued;
+    // Copy of the 8bpp back buffer of the frame being post processed, only there if post processing runs on its own thread
+    BITMAP *m_pPostProcessBuffer8;
+    // The post effects and glow boxes of the frame being post processed, only touched by the thread until it's done
+    std::list<PostEffect> m_PostProcessEffects;
+    std::list<Box> m_PostProcessGlowBoxes;
+    // How long the post processing thread took on the last frame, in microseconds
+    int64_t m_PostProcessTime;
+    // The state of the random numbers of the glow pattern
+    unsigned int m_GlowRandSeed;
+
     // Whether the screen is split horizontally across the screen, ie as two splitscreens one above the other.
     bool m_HSplit;
     // Whether the screen is split vertically across the screen, ie as two splitscreens side by side.
@@ -1880,14 +2024,6 @@ protected:
 	bool m_NetworkBitmapIsLocked[MAXSCREENCOUNT];
 	//std::mutex m_NetworkBitmapIsLocked[MAXSCREENCOUNT];
 
-//////////////////////////////////////////////////////////////////////////////////////////
-// Method:          AddPerformanceSample
-//////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Adds provided value to current sample of specified performance counter
-// Arguments:       Counter to update, value to add to this counter
-// Return value:    None.
-	void AddPerformanceSample(PerformanceCounters counter, int64_t value) { m_PerfData[counter][m_Sample] += value; }
-	
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          CalculateSamplePercentages
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -62,6 +62,8 @@ extern "C"
 //#include "boost/shared_ptr.hpp"
 
 #include <string>
+#include <algorithm>
+#include <functional>
 using namespace std;
 using namespace luabind;
 
@@ -121,6 +123,8 @@ namespace RTE
 {
 
 const string LuaMan::m_ClassName = "LuaMan";
+int LuaMan::m_sStateGeneration = 0;
+const char *LuaMan::m_PresetFunctionNames[PRESET_FUNCTIONCOUNT] = { "Create", "Destroy", "Update", "OnPieMenu", "UpdateAI" };
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -364,6 +368,10 @@ void AddParticle(MovableMan &This, MovableObject *pParticle)
     else
         This.AddParticle(pParticle);
 }
+deque<MovableObject *> & GetParticleList(MovableMan &This)
+{
+    return This.GetParticleList();
+}
 
 /*
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -410,12 +418,57 @@ void LuaMan::Clear()
     m_NextPresetID = 0;
     m_NextObjectID = 0;
     m_pTempEntity = 0;
+    m_PresetFunctionRefs.clear();
+    m_StringCompileCount = 0;
+    m_LastStringCompileCount = 0;
+    m_ScriptTimingDepth = 0;
+    m_ScriptTimingStart = 0;
+    m_UpdateScriptTime = 0;
+    m_PresetScriptNames.clear();
+    m_ScriptProfiles.clear();
+    m_ProfiledUpdateCount = 0;
+    m_HeaviestScriptName.clear();
+    m_HeaviestScriptTime = 0;
+    m_ThrottledScriptCount = 0;
+    m_LastThrottledScriptCount = 0;
 
 	//Clear files list
 	for (int i = 0; i < MAX_OPEN_FILES; ++i)
 		m_Files[i] = 0;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Constructor:     ScriptTiming
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Starts the Lua performance measurement, unless it's already running.
+
+LuaMan::ScriptTiming::ScriptTiming(LuaMan &luaMan):
+    m_LuaMan(luaMan)
+{
+    if (m_LuaMan.m_ScriptTimingDepth++ == 0)
+    {
+        g_FrameMan.StartPerformanceMeasurement(FrameMan::PERF_LUA);
+        m_LuaMan.m_ScriptTimingStart = g_TimerMan.GetAbsoulteTime();
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Destructor:      ~ScriptTiming
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Stops the Lua performance measurement, if this started it.
+
+LuaMan::ScriptTiming::~ScriptTiming()
+{
+    if (--m_LuaMan.m_ScriptTimingDepth == 0)
+    {
+        g_FrameMan.StopPerformanceMeasurement(FrameMan::PERF_LUA);
+        // Counted toward the budget of this update
+        m_LuaMan.m_UpdateScriptTime += g_TimerMan.GetAbsoulteTime() - m_LuaMan.m_ScriptTimingStart;
+    }
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          Create
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -425,6 +478,7 @@ int LuaMan::Create()
 {
     // Create the master state
     m_pMasterState = lua_open();
+    ++m_sStateGeneration;
     // Attach the master state to LuaBind
     open(m_pMasterState);
     // Open the lua libs for the master state
@@ -1730,6 +1784,12 @@ int LuaMan::Create()
             .def("CastFindMORay", &SceneMan::CastFindMORay)
             .def("CastObstacleRay", &SceneMan::CastObstacleRay)
             .def("GetLastRayHitPos", &SceneMan::GetLastRayHitPos)
+            .def("QueueMORay", &SceneMan::QueueMORay)
+            .def("QueueObstacleRay", &SceneMan::QueueObstacleRay)
+            .def("GetBatchedRayMOID", &SceneMan::GetBatchedRayMOID)
+            .def("GetBatchedRayHitPos", &SceneMan::GetBatchedRayHitPos)
+            .def("GetBatchedRayFreePos", &SceneMan::GetBatchedRayFreePos)
+            .def("GetBatchedRayDistance", &SceneMan::GetBatchedRayDistance)
             .def("FindAltitude", &SceneMan::FindAltitude)
             .def("MovePointToGround", &SceneMan::MovePointToGround)
             .def("IsWithinBounds", &SceneMan::IsWithinBounds)
@@ -2169,7 +2229,7 @@ int LuaMan::Create()
             .def("IsMOSubtractionEnabled", &MovableMan::IsMOSubtractionEnabled)
             .def_readwrite("Actors", &MovableMan::m_Actors, return_stl_iterator)
             .def_readwrite("Items", &MovableMan::m_Items, return_stl_iterator)
-            .def_readwrite("Particles", &MovableMan::m_Particles, return_stl_iterator)
+            .property("Particles", &GetParticleList, return_stl_iterator)
             .def_readwrite("AddedActors", &MovableMan::m_AddedActors, return_stl_iterator)
             .def_readwrite("AddedItems", &MovableMan::m_AddedItems, return_stl_iterator)
             .def_readwrite("AddedParticles", &MovableMan::m_AddedParticles, return_stl_iterator)
@@ -2184,8 +2244,17 @@ int LuaMan::Create()
 			.property("ForceVisibility", &ConsoleMan::IsForceVisible, &ConsoleMan::ForceVisibility)
 			.property("ScreenSize", &ConsoleMan::GetConsoleScreenSize, &ConsoleMan::SetConsoleScreenSize),
 
+        class_<TraceMan>("TraceManager")
+            .def("StartCapture", &TraceMan::StartCapture)
+            .def("StopCapture", &TraceMan::StopCapture)
+            .property("Capturing", &TraceMan::IsCapturing),
+
         class_<LuaMan>("LuaManager")
             .property("TempEntity", &LuaMan::GetTempEntity, &LuaMan::SetTempEntity)
+            .property("StringCompileCount", &LuaMan::GetStringCompileCount)
+            .property("ThrottledScriptCount", &LuaMan::GetThrottledScriptCount)
+            .def("PrintScriptProfile", &LuaMan::PrintScriptProfile)
+            .def("ResetScriptProfile", &LuaMan::ResetScriptProfile)
             .def("FileOpen", &LuaMan::FileOpen)
             .def("FileClose", &LuaMan::FileClose)
             .def("FileReadLine", &LuaMan::FileReadLine)
@@ -2194,7 +2263,8 @@ int LuaMan::Create()
 
         class_<SettingsMan>("SettingsdManager")
             .property("PrintDebugInfo", &SettingsMan::PrintDebugInfo, &SettingsMan::SetPrintDebugInfo)
-			.property("RecommendedMOIDCount", &SettingsMan::RecommendedMOIDCount),
+			.property("RecommendedMOIDCount", &SettingsMan::RecommendedMOIDCount)
+			.property("LuaScriptBudget", &SettingsMan::GetLuaScriptBudget, &SettingsMan::SetLuaScriptBudget),
 
         // NOT a member function, so adopting _1 instead of the _2 for the first param, since there's no "this" pointer!!
         def("DeleteEntity", &DeleteEntity, adopt(_1)),
@@ -2220,6 +2290,7 @@ int LuaMan::Create()
     globals(m_pMasterState)["MetaMan"] = &g_MetaMan;
     globals(m_pMasterState)["MovableMan"] = &g_MovableMan;
     globals(m_pMasterState)["ConsoleMan"] = &g_ConsoleMan;
+    globals(m_pMasterState)["TraceMan"] = &g_TraceMan;
     globals(m_pMasterState)["LuaMan"] = &g_LuaMan;
     globals(m_pMasterState)["SettingsMan"] = &g_SettingsMan;
 
@@ -2230,8 +2301,13 @@ int LuaMan::Create()
         "cls = function() ConsoleMan:Clear(); end;"
         // Add package path to the defaults
         "package.path = package.path .. \";Base.rte/?.lua\";\n"
+        // Make the table of engine constants
+        "rte = rte or {};\n"
     );
 
+    // The MOID that means no MO, for comparing the results of ray casts and MOID pixels with
+    globals(m_pMasterState)["rte"]["NoMOID"] = static_cast<int>(g_NoMOID);
+
     return 0;
 }
 
@@ -2283,6 +2359,17 @@ int LuaMan::Save(Writer &writer) const
 
 void LuaMan::Destroy()
 {
+    // Release the registry references to the presets' functions
+    for (map<string, PresetScript>::iterator itr = m_PresetFunctionRefs.begin(); itr != m_PresetFunctionRefs.end(); ++itr)
+    {
+        for (vector<int>::iterator refItr = itr->second.m_FunctionRefs.begin(); refItr != itr->second.m_FunctionRefs.end(); ++refItr)
+        {
+            if (*refItr != LUA_NOREF)
+                luaL_unref(m_pMasterState, LUA_REGISTRYINDEX, *refItr);
+        }
+    }
+    m_PresetFunctionRefs.clear();
+
     lua_close(m_pMasterState);
 
 	//Close all opened files
@@ -2356,6 +2443,57 @@ bool LuaMan::TableEntryIsDefined(string tableName, string indexName)
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          PushPathTable
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Pushes the table that holds the last element of a dot-separated path
+//                  onto the Lua stack.
+
+bool LuaMan::PushPathTable(const string &path, string &fieldName)
+{
+    // Start from the globals and walk down through each table named in the path
+    lua_pushvalue(m_pMasterState, LUA_GLOBALSINDEX);
+    size_t start = 0;
+    size_t dot = 0;
+    while ((dot = path.find('.', start)) != string::npos)
+    {
+        lua_getfield(m_pMasterState, -1, path.substr(start, dot - start).c_str());
+        // Replace the parent table with the child on the stack
+        lua_remove(m_pMasterState, -2);
+        if (!lua_istable(m_pMasterState, -1))
+        {
+            lua_pop(m_pMasterState, 1);
+            return false;
+        }
+        start = dot + 1;
+    }
+
+    fieldName = path.substr(start);
+    return true;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          PathIsDefined
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Checks if there is anything defined at a dot-separated path of nested
+//                  tables, like "MOSRotatings.Pre00012".
+
+bool LuaMan::PathIsDefined(const string &path)
+{
+    string fieldName;
+    if (path.empty() || !PushPathTable(path, fieldName))
+        return false;
+
+    lua_getfield(m_pMasterState, -1, fieldName.c_str());
+    bool isDefined = !lua_isnil(m_pMasterState, -1);
+    // Pop both the var and the table so this operation is balanced
+    lua_pop(m_pMasterState, 2);
+
+    return isDefined;
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          ExpressionIsTrue
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -2368,6 +2506,8 @@ bool LuaMan::ExpressionIsTrue(string expression, bool consoleErrors)
         return false;
 
     bool result = false;
+    m_StringCompileCount++;
+    ScriptTiming timing(*this);
 
     try
     {
@@ -2422,6 +2562,8 @@ int LuaMan::RunScriptString(string scriptString, bool consoleErrors)
         return -1;
 
     int error = 0;
+    m_StringCompileCount++;
+    ScriptTiming timing(*this);
 
     // Push the fancier error handler so pcall can use it if things go awry
 //    lua_pushcfunction(m_pMasterState, &AddFileAndLineToError);
@@ -2475,6 +2617,7 @@ int LuaMan::RunScriptFile(string filePath, bool consoleErrors)
 //        return -1;
 //     m_LastError = "Can't open from empty filepath!"
     int error = 0;
+    ScriptTiming timing(*this);
 
     // Push the fancier error handler so pcall can use it if things go awry
 //    lua_pushcfunction(m_pMasterState, &AddFileAndLineToError);
@@ -2524,6 +2667,150 @@ int LuaMan::RunScriptFile(string filePath, bool consoleErrors)
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CreateObjectReference
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Makes a registry reference to the Lua representation of a scripted
+//                  object instance.
+
+int LuaMan::CreateObjectReference(const string &objectName)
+{
+    string fieldName;
+    if (objectName.empty() || !PushPathTable(objectName, fieldName))
+        return LUA_NOREF;
+
+    lua_getfield(m_pMasterState, -1, fieldName.c_str());
+    // Pop the table regardless, leaving only the object on the stack
+    lua_remove(m_pMasterState, -2);
+    if (lua_isnil(m_pMasterState, -1))
+    {
+        lua_pop(m_pMasterState, 1);
+        return LUA_NOREF;
+    }
+
+    // Pops the object off the stack
+    return luaL_ref(m_pMasterState, LUA_REGISTRYINDEX);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ReleaseObjectReference
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Frees a registry reference made with CreateObjectReference and
+//                  assigns nil to the variable that held the object in the Lua state.
+
+void LuaMan::ReleaseObjectReference(const string &objectName, int objectRef, int stateGeneration)
+{
+    // The state the reference was made in is gone, along with the variable, and the reference could be to something else in this one
+    if (stateGeneration != m_sStateGeneration)
+        return;
+
+    if (objectRef != LUA_NOREF)
+        luaL_unref(m_pMasterState, LUA_REGISTRYINDEX, objectRef);
+
+    string fieldName;
+    if (objectName.empty() || !PushPathTable(objectName, fieldName))
+        return;
+
+    lua_pushnil(m_pMasterState);
+    lua_setfield(m_pMasterState, -2, fieldName.c_str());
+    lua_pop(m_pMasterState, 1);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CallPresetFunction
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Calls one of a preset's script functions directly with lua_pcall,
+//                  passing it an object instance.
+
+int LuaMan::CallPresetFunction(const string &presetName, PresetFunction function, int objectRef, bool consoleErrors)
+{
+    SLICK_PROFILE(0xFF124326);
+
+    if (objectRef == LUA_NOREF || presetName.empty())
+        return 0;
+
+    // Look up the preset's functions, and resolve them all into registry references if this is the first time
+    map<string, PresetScript>::iterator presetItr = m_PresetFunctionRefs.find(presetName);
+    if (presetItr == m_PresetFunctionRefs.end())
+    {
+        PresetScript presetScript;
+        vector<int> &functionRefs = presetScript.m_FunctionRefs;
+        functionRefs.assign(PRESET_FUNCTIONCOUNT, LUA_NOREF);
+        string fieldName;
+        if (PushPathTable(presetName, fieldName))
+        {
+            lua_getfield(m_pMasterState, -1, fieldName.c_str());
+            if (lua_istable(m_pMasterState, -1))
+            {
+                for (int i = 0; i < PRESET_FUNCTIONCOUNT; ++i)
+                {
+                    lua_getfield(m_pMasterState, -1, m_PresetFunctionNames[i]);
+                    if (lua_isfunction(m_pMasterState, -1))
+                        functionRefs[i] = luaL_ref(m_pMasterState, LUA_REGISTRYINDEX);
+                    else
+                        lua_pop(m_pMasterState, 1);
+                }
+            }
+            // Pop the preset table and its parent
+            lua_pop(m_pMasterState, 2);
+        }
+        // Don't cache presets that aren't defined yet, they may be loaded later
+        else
+            return 0;
+
+        // Account the time spent in the functions under the readable name of the script, if it has one
+        map<string, string>::const_iterator nameItr = m_PresetScriptNames.find(presetName);
+        const string &scriptName = nameItr != m_PresetScriptNames.end() ? nameItr->second : presetName;
+        for (int i = 0; i < PRESET_FUNCTIONCOUNT; ++i)
+            presetScript.m_Profiles.push_back(&GetScriptProfile(scriptName, m_PresetFunctionNames[i]));
+
+        presetItr = m_PresetFunctionRefs.insert(pair<string, PresetScript>(presetName, presetScript)).first;
+    }
+
+    int functionRef = presetItr->second.m_FunctionRefs[function];
+    if (functionRef == LUA_NOREF)
+        return 0;
+
+    int error = 0;
+    ScriptTiming timing(*this);
+    long long callStart = g_TimerMan.GetAbsoulteTime();
+
+    try
+    {
+        lua_rawgeti(m_pMasterState, LUA_REGISTRYINDEX, functionRef);
+        lua_rawgeti(m_pMasterState, LUA_REGISTRYINDEX, objectRef);
+        if (lua_pcall(m_pMasterState, 1, 0, 0))
+        {
+            // Retrieve and pop the error message off the stack
+            m_LastError = lua_tostring(m_pMasterState, -1);
+            lua_pop(m_pMasterState, 1);
+            if (consoleErrors)
+            {
+                g_ConsoleMan.PrintString("ERROR: " + m_LastError);
+                ClearErrors();
+            }
+            error = -1;
+        }
+    }
+    catch(const std::exception &e)
+    {
+        m_LastError = e.what();
+        if (consoleErrors)
+        {
+            g_ConsoleMan.PrintString("ERROR: " + m_LastError);
+            ClearErrors();
+        }
+        error = -1;
+    }
+
+    presetItr->second.m_Profiles[function]->AddCall(g_TimerMan.GetAbsoulteTime() - callStart);
+
+    return error;
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          GetNewPresetID
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -2569,7 +2856,103 @@ string LuaMan::GetNewObjectID()
 
 void LuaMan::Update()
 {
-	lua_gc(m_pMasterState, LUA_GCSTEP, 1);
+	// A new sim update starts, so the budget does too
+	m_UpdateScriptTime = 0;
+	{
+		ScriptTiming timing(*this);
+		lua_gc(m_pMasterState, LUA_GCSTEP, 1);
+	}
+
+	// Roll over the per-update count of compiled script strings
+	m_LastStringCompileCount = m_StringCompileCount;
+	m_StringCompileCount = 0;
+
+	// Roll over the script profiles, noting the heaviest of the update
+	m_HeaviestScriptName.clear();
+	m_HeaviestScriptTime = 0;
+	for (map<string, ScriptProfile>::iterator itr = m_ScriptProfiles.begin(); itr != m_ScriptProfiles.end(); ++itr)
+	{
+		ScriptProfile &profile = itr->second;
+		if (profile.m_CallCount == 0)
+			continue;
+		if (profile.m_UpdateTime > m_HeaviestScriptTime)
+		{
+			m_HeaviestScriptName = itr->first;
+			m_HeaviestScriptTime = profile.m_UpdateTime;
+		}
+		profile.m_TotalCallCount += profile.m_CallCount;
+		profile.m_TotalTime += profile.m_UpdateTime;
+		profile.m_PeakUpdateTime = MAX(profile.m_PeakUpdateTime, profile.m_UpdateTime);
+		profile.m_CallCount = 0;
+		profile.m_UpdateTime = 0;
+	}
+	++m_ProfiledUpdateCount;
+
+	m_LastThrottledScriptCount = m_ThrottledScriptCount;
+	m_ThrottledScriptCount = 0;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ScriptBudgetExceeded
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Tells whether low priority scripts should be skipped for the rest of
+//                  this sim update.
+
+bool LuaMan::ScriptBudgetExceeded() const
+{
+    // Another sim update is due right after this one if it's not the one drawn, so the sim is behind
+    float budget = g_SettingsMan.GetLuaScriptBudget();
+    return budget > 0 && !g_TimerMan.DrawnSimUpdate() && m_UpdateScriptTime >= static_cast<long long>(budget * 1000);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          PrintScriptProfile
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Prints the script functions which have taken the most time per update
+//                  on average since the profile was last reset to the console.
+
+void LuaMan::PrintScriptProfile(int count)
+{
+    if (m_ProfiledUpdateCount <= 0)
+    {
+        g_ConsoleMan.PrintString("SYSTEM: No Lua script updates have been profiled yet");
+        return;
+    }
+
+    // Sort by the total time, which is the same order as the average per update
+    vector<pair<long long, string> > sorted;
+    for (map<string, ScriptProfile>::const_iterator itr = m_ScriptProfiles.begin(); itr != m_ScriptProfiles.end(); ++itr)
+    {
+        if (itr->second.m_TotalCallCount > 0)
+            sorted.push_back(pair<long long, string>(itr->second.m_TotalTime, itr->first));
+    }
+    sort(sorted.begin(), sorted.end(), greater<pair<long long, string> >());
+
+    char line[512];
+    sprintf(line, "SYSTEM: Lua script time per update over the last %i updates:", m_ProfiledUpdateCount);
+    g_ConsoleMan.PrintString(line);
+    for (int i = 0; i < MIN(count, static_cast<int>(sorted.size())); ++i)
+    {
+        const ScriptProfile &profile = m_ScriptProfiles[sorted[i].second];
+        sprintf(line, "%7.3f ms avg %7.3f ms peak %6.1f calls  %s", profile.m_TotalTime / (m_ProfiledUpdateCount * 1000.0), profile.m_PeakUpdateTime / 1000.0, profile.m_TotalCallCount / static_cast<double>(m_ProfiledUpdateCount), sorted[i].second.c_str());
+        g_ConsoleMan.PrintString(line);
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ResetScriptProfile
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Forgets the time accounted for all script functions so far.
+
+void LuaMan::ResetScriptProfile()
+{
+    // The profiles themselves are pointed to by the cached preset functions, so they have to stay
+    for (map<string, ScriptProfile>::iterator itr = m_ScriptProfiles.begin(); itr != m_ScriptProfiles.end(); ++itr)
+        itr->second.Reset();
+    m_ProfiledUpdateCount = 0;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -14,6 +14,8 @@
 //////////////////////////////////////////////////////////////////////////////////////////
 // Inclusions of header files
 
+#include <map>
+#include <vector>
 #include "DDTTools.h"
 #include "Singleton.h"
 #define g_LuaMan LuaMan::Instance()
@@ -47,6 +49,17 @@ class LuaMan:
 
 public:
 
+// The preset functions that can be called directly through cached registry references
+enum PresetFunction
+{
+    PRESET_CREATE = 0,
+    PRESET_DESTROY,
+    PRESET_UPDATE,
+    PRESET_ONPIEMENU,
+    PRESET_UPDATEAI,
+    PRESET_FUNCTIONCOUNT
+};
+
 /*
 enum ServerResult
 {
@@ -216,6 +229,18 @@ enum ServerResult
     bool TableEntryIsDefined(std::string tableName, std::string indexName);
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          PathIsDefined
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Checks if there is anything defined at a dot-separated path of nested
+//                  tables, like "MOSRotatings.Pre00012". Unlike ExpressionIsTrue, this
+//                  does not compile any script string.
+// Arguments:       The dot-separated path to check, starting from the globals table.
+// Return value:    Whether anything non-nil is defined at that path.
+
+    bool PathIsDefined(const std::string &path);
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          ExpressionIsTrue
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -254,6 +279,175 @@ enum ServerResult
     int RunScriptFile(std::string filePath, bool consoleErrors = true);
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CreateObjectReference
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Makes a registry reference to the Lua representation of a scripted
+//                  object instance, so it can be passed to preset functions without
+//                  having to look it up by name each time.
+// Arguments:       The dot-separated path of the object instance in the Lua state.
+// Return value:    The registry reference, or LUA_NOREF if nothing is defined there.
+
+    int CreateObjectReference(const std::string &objectName);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ReleaseObjectReference
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Frees a registry reference made with CreateObjectReference and
+//                  assigns nil to the variable that held the object in the Lua state.
+//                  Nothing is done if the reference was made in a state since destroyed.
+// Arguments:       The dot-separated path of the object instance in the Lua state.
+//                  The registry reference to free. LUA_NOREF is ignored.
+//                  The generation of the state the reference was made in.
+// Return value:    None.
+
+    void ReleaseObjectReference(const std::string &objectName, int objectRef, int stateGeneration);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetStateGeneration
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the generation of the current master state, which goes up each
+//                  time it is re-created. Registry references and object names from
+//                  another generation don't mean anything in this one.
+// Arguments:       None.
+// Return value:    The generation of the current master state.
+
+    int GetStateGeneration() const { return m_sStateGeneration; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CallPresetFunction
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Calls one of a preset's script functions directly with lua_pcall,
+//                  passing it an object instance. The preset's functions are looked up
+//                  once and kept as registry references after that.
+// Arguments:       The ID name of the preset table in the Lua state.
+//                  Which of the preset's functions to call.
+//                  The registry reference to the object instance to pass in.
+//                  Whether to report any errors to the console immediately.
+// Return value:    Returns less than zero if any errors encountered when running the
+//                  function. Not having the function or object defined is not an error.
+
+    int CallPresetFunction(const std::string &presetName, PresetFunction function, int objectRef, bool consoleErrors = true);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          SetPresetScriptName
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Sets the readable name the time spent in a preset's script functions
+//                  is accounted under, instead of the preset's ID name.
+// Arguments:       The ID name of the preset table in the Lua state.
+//                  The readable name of the preset's script.
+// Return value:    None.
+
+    void SetPresetScriptName(const std::string &presetName, const std::string &scriptName) { m_PresetScriptNames[presetName] = scriptName; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          AddScriptTime
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Accounts for a call of a script function which isn't called through
+//                  CallPresetFunction, like the update functions of activities.
+// Arguments:       The readable name of the script.
+//                  The name of the function called.
+//                  How long the call took, in microseconds.
+// Return value:    None.
+
+    void AddScriptTime(const std::string &scriptName, const std::string &functionName, long long time) { GetScriptProfile(scriptName, functionName).AddCall(time); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ScriptBudgetExceeded
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Tells whether low priority scripts should be skipped for the rest of
+//                  this sim update. That is when the sim is running behind real time, and
+//                  the scripts have already taken longer than the budget set in the
+//                  settings.
+// Arguments:       None.
+// Return value:    Whether the script time budget is used up.
+
+    bool ScriptBudgetExceeded() const;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          AddThrottledScript
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Counts a low priority script which was skipped because the script
+//                  time budget was used up.
+// Arguments:       None.
+// Return value:    None.
+
+    void AddThrottledScript() { ++m_ThrottledScriptCount; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetThrottledScriptCount
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets how many low priority scripts were skipped during the last
+//                  completed update.
+// Arguments:       None.
+// Return value:    The number of skipped scripts.
+
+    int GetThrottledScriptCount() const { return m_LastThrottledScriptCount; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetHeaviestScriptName
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the script function which took the longest during the last
+//                  completed update.
+// Arguments:       None.
+// Return value:    The name of the script and function, empty if none were run.
+
+    const std::string & GetHeaviestScriptName() const { return m_HeaviestScriptName; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetHeaviestScriptTime
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets how long the script function which took the longest during the
+//                  last completed update took, all its calls together.
+// Arguments:       None.
+// Return value:    The time in microseconds.
+
+    long long GetHeaviestScriptTime() const { return m_HeaviestScriptTime; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          PrintScriptProfile
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Prints the script functions which have taken the most time per update
+//                  on average since the profile was last reset to the console.
+// Arguments:       How many of the script functions to print.
+// Return value:    None.
+
+    void PrintScriptProfile(int count);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ResetScriptProfile
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Forgets the time accounted for all script functions so far.
+// Arguments:       None.
+// Return value:    None.
+
+    void ResetScriptProfile();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetStringCompileCount
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets how many script strings had to be compiled during the last
+//                  completed update. Ideally this stays near zero in a running game.
+// Arguments:       None.
+// Return value:    The number of strings compiled by RunScriptString and
+//                  ExpressionIsTrue during the last update.
+
+    int GetStringCompileCount() const { return m_LastStringCompileCount; }
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          GetNewPresetID
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -384,8 +578,52 @@ enum ServerResult
 
 protected:
 
+    // Times the Lua code run while it's in scope for the Lua performance counter. Scripts run from within other
+    // scripts are already being timed, so only the outermost one counts
+    struct ScriptTiming
+    {
+        ScriptTiming(LuaMan &luaMan);
+        ~ScriptTiming();
+        LuaMan &m_LuaMan;
+    };
+
+    // The time spent in one script function, all calls of it together
+    struct ScriptProfile
+    {
+        ScriptProfile() { Reset(); }
+        void Reset() { m_CallCount = m_TotalCallCount = 0; m_UpdateTime = m_TotalTime = m_PeakUpdateTime = 0; }
+        void AddCall(long long time) { ++m_CallCount; m_UpdateTime += time; }
+        // The calls and time during the current update, and since the profile was last reset, in microseconds
+        int m_CallCount;
+        int m_TotalCallCount;
+        long long m_UpdateTime;
+        long long m_TotalTime;
+        // The most time taken during any one update
+        long long m_PeakUpdateTime;
+    };
+
+    // The registry references to a preset's functions, and the profiles their calls are accounted in
+    struct PresetScript
+    {
+        std::vector<int> m_FunctionRefs;
+        std::vector<ScriptProfile *> m_Profiles;
+    };
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetScriptProfile
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the profile of a script function, made empty the first time.
+// Arguments:       The readable name of the script.
+//                  The name of the function.
+// Return value:    The profile, which stays at the same address for as long as this does.
+
+    ScriptProfile & GetScriptProfile(const std::string &scriptName, const std::string &functionName) { return m_ScriptProfiles[scriptName + ":" + functionName]; }
+
     // Member variables
     static const std::string m_ClassName;
+    // How many times the master state has been created, to tell references into old ones apart
+    static int m_sStateGeneration;
 
     // The master parent script state
     lua_State *m_pMasterState;
@@ -399,6 +637,32 @@ protected:
     long m_NextObjectID;
     // Temporary holder for an Entity object that we want to pass into the Lua state without fuss
     Entity *m_pTempEntity;
+    // Registry references to the functions of each preset table, keyed by the preset's ID name
+    // Entries are resolved lazily upon the first call to any function of that preset
+    std::map<std::string, PresetScript> m_PresetFunctionRefs;
+    // The readable names of the presets' scripts, keyed by the preset's ID name
+    std::map<std::string, std::string> m_PresetScriptNames;
+    // The profiles of all script functions run, keyed by the script and function name
+    std::map<std::string, ScriptProfile> m_ScriptProfiles;
+    // How many updates the profiles have been accounted over since they were last reset
+    int m_ProfiledUpdateCount;
+    // The script function which took the longest during the last completed update, and how long in microseconds
+    std::string m_HeaviestScriptName;
+    long long m_HeaviestScriptTime;
+    // How many low priority scripts have been skipped during this update, and during the last completed one
+    int m_ThrottledScriptCount;
+    int m_LastThrottledScriptCount;
+    // The names of the functions in the PresetFunction enum, as defined by the script files
+    static const char *m_PresetFunctionNames[PRESET_FUNCTIONCOUNT];
+    // How many script strings have been compiled so far during this update
+    int m_StringCompileCount;
+    // How many script strings were compiled during the last completed update
+    int m_LastStringCompileCount;
+    // How many ScriptTimings are currently in scope
+    int m_ScriptTimingDepth;
+    // When the outermost ScriptTiming in scope started, and how long all scripts have run during this update, in microseconds
+    long long m_ScriptTimingStart;
+    long long m_UpdateScriptTime;
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -417,6 +681,18 @@ private:
     void Clear();
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          PushPathTable
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Pushes the table that holds the last element of a dot-separated path
+//                  onto the Lua stack.
+// Arguments:       The dot-separated path, starting from the globals table.
+//                  The string to put the name of the last element of the path into.
+// Return value:    Whether the table was found and pushed. Nothing is pushed if not.
+
+    bool PushPathTable(const std::string &path, std::string &fieldName);
+
+
     // Disallow the use of some implicit methods.
     LuaMan(const LuaMan &reference);
     LuaMan & operator=(const LuaMan &rhs);
@@ -24,6 +24,8 @@
 #include "Actor.h"
 #include "ADoor.h"
 #include "Atom.h"
+#include "SettingsMan.h"
+#include "ThreadMan.h"
 
 using namespace std;
 
@@ -31,6 +33,16 @@ namespace RTE
 {
 
 const string MovableMan::m_ClassName = "MovableMan";
+const int MovableMan::m_GridCellSize = 128;
+const int MovableMan::m_ParticleTravelChunkSize = 256;
+
+// How far a particle got during the parallel part of the travel pass
+enum ParticleTravelState
+{
+    TRAVEL_PENDING = 0,
+    TRAVEL_FORCESAPPLIED,
+    TRAVEL_DONE
+};
 
 
 // Comparison functor for sorting movable objects by their X position using STL's sort
@@ -52,6 +64,8 @@ void MovableMan::Clear()
     m_Actors.clear();
     m_Items.clear();
     m_Particles.clear();
+    m_ParticleList.clear();
+    m_ParticleListStale = true;
     m_AddedActors.clear();
     m_AddedItems.clear();
     m_AddedParticles.clear();
@@ -63,7 +77,12 @@ void MovableMan::Clear()
     m_SortTeamRoster[Activity::TEAM_2] = false;
     m_SortTeamRoster[Activity::TEAM_3] = false;
     m_SortTeamRoster[Activity::TEAM_4] = false;
-    m_ValiditySearchResults.clear();
+    m_ValidMOs.clear();
+    m_ActorGrid.clear();
+    m_ItemGrid.clear();
+    m_GridWidth = 0;
+    m_GridHeight = 0;
+    m_ParticleTravelState.clear();
     m_AddedAlarmEvents.clear();
     m_AlarmEvents.clear();
     m_MOIDIndex.clear();
@@ -151,9 +170,11 @@ int MovableMan::Save(Writer &writer) const
     for (deque<Actor *>::const_iterator itr = m_Actors.begin(); itr != m_Actors.end(); ++itr)
         writer << **itr;
 
-    writer << m_Particles.size();
+    writer << (m_Particles.size() + m_ParticleStore.GetCount());
     for (deque<MovableObject *>::const_iterator itr2 = m_Particles.begin(); itr2 != m_Particles.end(); ++itr2)
         writer << **itr2;
+    for (vector<MOPixel *>::const_iterator itr3 = m_ParticleStore.GetPixels().begin(); itr3 != m_ParticleStore.GetPixels().end(); ++itr3)
+        writer << **itr3;
 /* Not sure how to deal with this yet
     writer.NewProperty("ResolutionX");
     writer << m_ResX;
@@ -181,10 +202,33 @@ void MovableMan::Destroy()
         delete (*it2);
     for (deque<MovableObject *>::iterator it3 = m_Particles.begin(); it3 != m_Particles.end(); ++it3)
         delete (*it3);
+    m_ParticleStore.Destroy();
 
     Clear();
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetParticleList
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets all the particles currently held, both the packed ones and the
+//                  rest.
+
+deque<MovableObject *> & MovableMan::GetParticleList()
+{
+    if (m_ParticleStore.GetCount() == 0)
+        return m_Particles;
+
+    // Only made over when it's changed, so the scripts can go through it in nested loops
+    if (m_ParticleListStale)
+    {
+        m_ParticleList.assign(m_Particles.begin(), m_Particles.end());
+        m_ParticleList.insert(m_ParticleList.end(), m_ParticleStore.GetPixels().begin(), m_ParticleStore.GetPixels().end());
+        m_ParticleListStale = false;
+    }
+    return m_ParticleList;
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          GetMOFromID
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -248,10 +292,13 @@ void MovableMan::PurgeAllMOs()
         delete (*it2);
     for (deque<MovableObject *>::iterator it3 = m_Particles.begin(); it3 != m_Particles.end(); ++it3)
         delete (*it3);
+    m_ParticleStore.Destroy();
 
     m_Actors.clear();
     m_Items.clear();
     m_Particles.clear();
+    m_ParticleList.clear();
+    m_ParticleListStale = true;
     m_AddedActors.clear();
     m_AddedItems.clear();
     m_AddedParticles.clear();
@@ -263,7 +310,12 @@ void MovableMan::PurgeAllMOs()
     m_SortTeamRoster[Activity::TEAM_2] = false;
     m_SortTeamRoster[Activity::TEAM_3] = false;
     m_SortTeamRoster[Activity::TEAM_4] = false;
-    m_ValiditySearchResults.clear();
+    m_ValidMOs.clear();
+    m_ActorGrid.clear();
+    m_ItemGrid.clear();
+    m_GridWidth = 0;
+    m_GridHeight = 0;
+    m_ParticleTravelState.clear();
     m_AddedAlarmEvents.clear();
     m_AlarmEvents.clear();
     m_MOIDIndex.clear();
@@ -576,22 +628,33 @@ Actor * MovableMan::GetClosestTeamActor(int team, int player, const Vector &scen
     float shortestDistance = maxRadius;
     Actor *pClosestActor = 0;
 
-    // If we're looking for a noteam actor, then go through the entire actor list instead
+    // If we're looking for a noteam actor, then go through the nearby cells of the actor grid instead
     if (team == Activity::NOTEAM)
     {
-        for (deque<Actor *>::iterator aIt = m_Actors.begin(); aIt != m_Actors.end(); ++aIt)
+        int firstX, lastX, firstY, lastY;
+        if (!GetGridCellRange(scenePoint, maxRadius, firstX, lastX, firstY, lastY))
+            return 0;
+
+        for (int y = firstY; y <= lastY; ++y)
         {
-            if ((*aIt) == pExcludeThis || (*aIt)->GetTeam() != Activity::NOTEAM)
-                continue;
+            for (int x = firstX; x <= lastX; ++x)
+            {
+                const vector<Actor *> &cell = m_ActorGrid[((y % m_GridHeight + m_GridHeight) % m_GridHeight) * m_GridWidth + ((x % m_GridWidth + m_GridWidth) % m_GridWidth)];
+                for (vector<Actor *>::const_iterator aIt = cell.begin(); aIt != cell.end(); ++aIt)
+                {
+                    if ((*aIt) == pExcludeThis || (*aIt)->GetTeam() != Activity::NOTEAM)
+                        continue;
 
-            distanceVec = g_SceneMan.ShortestDistance((*aIt)->GetPos(), scenePoint);
-            distance = distanceVec.GetMagnitude();
+                    distanceVec = g_SceneMan.ShortestDistance((*aIt)->GetPos(), scenePoint);
+                    distance = distanceVec.GetMagnitude();
 
-            // Check if even within search radius
-            if (distance < shortestDistance)
-            {
-                shortestDistance = distance;
-                pClosestActor = *aIt;
+                    // Check if even within search radius
+                    if (distance < shortestDistance)
+                    {
+                        shortestDistance = distance;
+                        pClosestActor = *aIt;
+                    }
+                }
             }
         }
     }
@@ -637,24 +700,36 @@ Actor * MovableMan::GetClosestEnemyActor(int team, const Vector &scenePoint, int
     float distance;
     float shortestDistance = maxRadius;
     Actor *pClosestActor = 0;
-    
-    for (deque<Actor *>::iterator aIt = m_Actors.begin(); aIt != m_Actors.end(); ++aIt)
-    {
-        if ((*aIt)->GetTeam() == team)
-            continue;
 
-        distanceVec = g_SceneMan.ShortestDistance((*aIt)->GetPos(), scenePoint);
-        distance = distanceVec.GetMagnitude();
-        
-        // Check if even within search radius
-        if (distance < shortestDistance)
+    // Only go through the grid cells that can possibly be within the search radius
+    int firstX, lastX, firstY, lastY;
+    if (!GetGridCellRange(scenePoint, maxRadius, firstX, lastX, firstY, lastY))
+        return 0;
+
+    for (int y = firstY; y <= lastY; ++y)
+    {
+        for (int x = firstX; x <= lastX; ++x)
         {
-            shortestDistance = distance;
-            pClosestActor = *aIt;
-            getDistance.SetXY(distanceVec.GetX(), distanceVec.GetY());
+            const vector<Actor *> &cell = m_ActorGrid[((y % m_GridHeight + m_GridHeight) % m_GridHeight) * m_GridWidth + ((x % m_GridWidth + m_GridWidth) % m_GridWidth)];
+            for (vector<Actor *>::const_iterator aIt = cell.begin(); aIt != cell.end(); ++aIt)
+            {
+                if ((*aIt)->GetTeam() == team)
+                    continue;
+
+                distanceVec = g_SceneMan.ShortestDistance((*aIt)->GetPos(), scenePoint);
+                distance = distanceVec.GetMagnitude();
+
+                // Check if even within search radius
+                if (distance < shortestDistance)
+                {
+                    shortestDistance = distance;
+                    pClosestActor = *aIt;
+                    getDistance.SetXY(distanceVec.GetX(), distanceVec.GetY());
+                }
+            }
         }
     }
-    
+
     return pClosestActor;
 }
 
@@ -677,19 +752,31 @@ Actor * MovableMan::GetClosestActor(Vector &scenePoint, int maxRadius, float &ge
     float shortestDistance = maxRadius;
     Actor *pClosestActor = 0;
 
-    for (deque<Actor *>::iterator aIt = m_Actors.begin(); aIt != m_Actors.end(); ++aIt)
+    // Only go through the grid cells that can possibly be within the search radius
+    int firstX, lastX, firstY, lastY;
+    if (!GetGridCellRange(scenePoint, maxRadius, firstX, lastX, firstY, lastY))
+        return 0;
+
+    for (int y = firstY; y <= lastY; ++y)
     {
-        if ((*aIt) == pExcludeThis)
-            continue;
+        for (int x = firstX; x <= lastX; ++x)
+        {
+            const vector<Actor *> &cell = m_ActorGrid[((y % m_GridHeight + m_GridHeight) % m_GridHeight) * m_GridWidth + ((x % m_GridWidth + m_GridWidth) % m_GridWidth)];
+            for (vector<Actor *>::const_iterator aIt = cell.begin(); aIt != cell.end(); ++aIt)
+            {
+                if ((*aIt) == pExcludeThis)
+                    continue;
 
-        distanceVec = g_SceneMan.ShortestDistance((*aIt)->GetPos(), scenePoint);
-        distance = distanceVec.GetMagnitude();
+                distanceVec = g_SceneMan.ShortestDistance((*aIt)->GetPos(), scenePoint);
+                distance = distanceVec.GetMagnitude();
 
-        // Check if even within search radius
-        if (distance < shortestDistance)
-        {
-            shortestDistance = distance;
-            pClosestActor = *aIt;
+                // Check if even within search radius
+                if (distance < shortestDistance)
+                {
+                    shortestDistance = distance;
+                    pClosestActor = *aIt;
+                }
+            }
         }
     }
 
@@ -698,6 +785,212 @@ Actor * MovableMan::GetClosestActor(Vector &scenePoint, int maxRadius, float &ge
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetMOsInRadius
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gathers all Actors and Items kept by this that are within a radius of
+//                  a scene point.
+
+int MovableMan::GetMOsInRadius(const Vector &scenePoint, float radius, list<MovableObject *> &moList, bool includeItems) const
+{
+    int firstX, lastX, firstY, lastY;
+    if (!GetGridCellRange(scenePoint, radius, firstX, lastX, firstY, lastY))
+        return 0;
+
+    int foundCount = 0;
+
+    for (int y = firstY; y <= lastY; ++y)
+    {
+        for (int x = firstX; x <= lastX; ++x)
+        {
+            int cellIndex = ((y % m_GridHeight + m_GridHeight) % m_GridHeight) * m_GridWidth + ((x % m_GridWidth + m_GridWidth) % m_GridWidth);
+
+            const vector<Actor *> &actorCell = m_ActorGrid[cellIndex];
+            for (vector<Actor *>::const_iterator aIt = actorCell.begin(); aIt != actorCell.end(); ++aIt)
+            {
+                if (g_SceneMan.ShortestDistance((*aIt)->GetPos(), scenePoint).GetMagnitude() < radius)
+                {
+                    moList.push_back(*aIt);
+                    foundCount++;
+                }
+            }
+
+            if (!includeItems)
+                continue;
+
+            const vector<MovableObject *> &itemCell = m_ItemGrid[cellIndex];
+            for (vector<MovableObject *>::const_iterator iIt = itemCell.begin(); iIt != itemCell.end(); ++iIt)
+            {
+                if (g_SceneMan.ShortestDistance((*iIt)->GetPos(), scenePoint).GetMagnitude() < radius)
+                {
+                    moList.push_back(*iIt);
+                    foundCount++;
+                }
+            }
+        }
+    }
+
+    return foundCount;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetGridCellRange
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Figures out which grid cells need to be searched to cover a radius
+//                  around a scene point.
+
+bool MovableMan::GetGridCellRange(const Vector &scenePoint, float radius, int &firstX, int &lastX, int &firstY, int &lastY) const
+{
+    if (m_GridWidth <= 0 || m_GridHeight <= 0)
+        return false;
+
+    // Clamp the center cell first, so points outside the scene still find what's been clamped into the edge cells
+    int centerX = MAX(0, MIN(m_GridWidth - 1, static_cast<int>(floorf(scenePoint.m_X / m_GridCellSize))));
+    int centerY = MAX(0, MIN(m_GridHeight - 1, static_cast<int>(floorf(scenePoint.m_Y / m_GridCellSize))));
+    // Cap the radius so huge search radii don't overflow the cell math; they'll cover the whole grid anyway
+    int cellRadius = static_cast<int>(MIN(radius, static_cast<float>(m_GridCellSize * (m_GridWidth + m_GridHeight))) / m_GridCellSize) + 1;
+
+    firstX = centerX - cellRadius;
+    lastX = centerX + cellRadius;
+    if (!g_SceneMan.SceneWrapsX() || lastX - firstX + 1 >= m_GridWidth)
+    {
+        // Don't visit any cell twice if the range covers the whole width
+        if (g_SceneMan.SceneWrapsX())
+        {
+            firstX = 0;
+            lastX = m_GridWidth - 1;
+        }
+        firstX = MAX(firstX, 0);
+        lastX = MIN(lastX, m_GridWidth - 1);
+    }
+
+    firstY = centerY - cellRadius;
+    lastY = centerY + cellRadius;
+    if (!g_SceneMan.SceneWrapsY() || lastY - firstY + 1 >= m_GridHeight)
+    {
+        if (g_SceneMan.SceneWrapsY())
+        {
+            firstY = 0;
+            lastY = m_GridHeight - 1;
+        }
+        firstY = MAX(firstY, 0);
+        lastY = MIN(lastY, m_GridHeight - 1);
+    }
+
+    return true;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          TravelParticleChunk
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Applies forces to and travels the simple particles in one chunk of
+//                  m_Particles whose paths this frame are clear of anything they could
+//                  hit.
+
+void MovableMan::TravelParticleChunk(int chunk)
+{
+    int parIndex = chunk * m_ParticleTravelChunkSize;
+    int lastIndex = MIN(parIndex + m_ParticleTravelChunkSize, (int)m_Particles.size());
+    float travelTime = g_TimerMan.GetDeltaTimeSecs();
+
+    for (; parIndex < lastIndex; ++parIndex)
+    {
+        MovableObject *pParticle = m_Particles[parIndex];
+        // Skip the ones just released from the ParticleStore, which have been taken care of already
+        if (m_ParticleTravelState[parIndex] != TRAVEL_PENDING || pParticle->IsUpdated())
+            continue;
+
+        // Only plain pixels that nothing else can collide with, and which leave no trails on the scene
+        MOPixel *pPixel = dynamic_cast<MOPixel *>(pParticle);
+        if (!pPixel || pPixel->GetPinStrength() > 0 || pPixel->GetsHitByMOs() || !pPixel->GetAtom() || pPixel->GetAtom()->GetTrailLength() > 0)
+            continue;
+
+        pPixel->ApplyForces();
+        m_ParticleTravelState[parIndex] = TRAVEL_FORCESAPPLIED;
+
+        // Anything that would hit terrain or an MO is left for the serial pass
+        if (!pPixel->GetAtom()->TravelPathIsClear(travelTime))
+            continue;
+
+        pPixel->PreTravel();
+        pPixel->Travel();
+        pPixel->PostTravel();
+        m_ParticleTravelState[parIndex] = TRAVEL_DONE;
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          UpdateSpatialGrid
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Rebuilds the spatial grids from the current positions of all Actors
+//                  and Items, resizing them first if the scene dimensions changed.
+
+void MovableMan::UpdateSpatialGrid()
+{
+    int gridWidth = (g_SceneMan.GetSceneWidth() + m_GridCellSize - 1) / m_GridCellSize;
+    int gridHeight = (g_SceneMan.GetSceneHeight() + m_GridCellSize - 1) / m_GridCellSize;
+
+    if (gridWidth <= 0 || gridHeight <= 0)
+    {
+        m_ActorGrid.clear();
+        m_ItemGrid.clear();
+        m_GridWidth = m_GridHeight = 0;
+        return;
+    }
+
+    if (gridWidth != m_GridWidth || gridHeight != m_GridHeight)
+    {
+        m_GridWidth = gridWidth;
+        m_GridHeight = gridHeight;
+        m_ActorGrid.assign(m_GridWidth * m_GridHeight, vector<Actor *>());
+        m_ItemGrid.assign(m_GridWidth * m_GridHeight, vector<MovableObject *>());
+    }
+    else
+    {
+        // Keep the cells' allocated capacity around, it will most likely be needed again
+        for (int i = 0; i < m_GridWidth * m_GridHeight; ++i)
+        {
+            m_ActorGrid[i].clear();
+            m_ItemGrid[i].clear();
+        }
+    }
+
+    // Anything outside a non-wrapping scene gets clamped into the nearest edge cell
+    for (deque<Actor *>::iterator aIt = m_Actors.begin(); aIt != m_Actors.end(); ++aIt)
+    {
+        int cellX = MAX(0, MIN(m_GridWidth - 1, static_cast<int>(floorf((*aIt)->GetPos().m_X / m_GridCellSize))));
+        int cellY = MAX(0, MIN(m_GridHeight - 1, static_cast<int>(floorf((*aIt)->GetPos().m_Y / m_GridCellSize))));
+        m_ActorGrid[cellY * m_GridWidth + cellX].push_back(*aIt);
+    }
+    for (deque<MovableObject *>::iterator iIt = m_Items.begin(); iIt != m_Items.end(); ++iIt)
+    {
+        int cellX = MAX(0, MIN(m_GridWidth - 1, static_cast<int>(floorf((*iIt)->GetPos().m_X / m_GridCellSize))));
+        int cellY = MAX(0, MIN(m_GridHeight - 1, static_cast<int>(floorf((*iIt)->GetPos().m_Y / m_GridCellSize))));
+        m_ItemGrid[cellY * m_GridWidth + cellX].push_back(*iIt);
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RemoveFromSpatialGrid
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Removes an Actor or Item from whichever grid cell it's in, for when
+//                  it's taken out of this between grid rebuilds.
+
+void MovableMan::RemoveFromSpatialGrid(const MovableObject *pMOToRem)
+{
+    // The MO may have moved since the grid was built, so search all cells. This is rare enough to not matter.
+    for (int i = 0; i < m_GridWidth * m_GridHeight; ++i)
+    {
+        m_ActorGrid[i].erase(remove(m_ActorGrid[i].begin(), m_ActorGrid[i].end(), pMOToRem), m_ActorGrid[i].end());
+        m_ItemGrid[i].erase(remove(m_ItemGrid[i].begin(), m_ItemGrid[i].end(), pMOToRem), m_ItemGrid[i].end());
+    }
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          GetClosestBrainActor
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -869,6 +1162,7 @@ void MovableMan::AddActor(Actor *pActorToAdd)
             pActorToAdd->SetAge(0);
         }
         m_AddedActors.push_back(pActorToAdd);
+        m_ValidMOs[pActorToAdd] = LIST_ACTORS;
 
 		AddActorToTeamRoster(pActorToAdd);
     }
@@ -907,6 +1201,7 @@ void MovableMan::AddItem(MovableObject *pItemToAdd)
             pItemToAdd->SetAge(0);
         }
         m_AddedItems.push_back(pItemToAdd);
+        m_ValidMOs[pItemToAdd] = LIST_ITEMS;
     }
 }
 
@@ -941,9 +1236,15 @@ void MovableMan::AddParticle(MovableObject *pMOToAdd)
             pMOToAdd->SetAge(0);
         }
         if (pMOToAdd->IsDevice())
+        {
             m_AddedItems.push_back(pMOToAdd);
+            m_ValidMOs[pMOToAdd] = LIST_ITEMS;
+        }
         else
+        {
             m_AddedParticles.push_back(pMOToAdd);
+            m_ValidMOs[pMOToAdd] = LIST_PARTICLES;
+        }
     }
 }
 
@@ -984,6 +1285,12 @@ bool MovableMan::RemoveActor(MovableObject *pActorToRem)
             }
         }
 		RemoveActorFromTeamRoster(dynamic_cast<Actor *>(pActorToRem));
+
+        if (removed)
+        {
+            m_ValidMOs.erase(pActorToRem);
+            RemoveFromSpatialGrid(pActorToRem);
+        }
     }
     return removed;
 }
@@ -1024,6 +1331,12 @@ bool MovableMan::RemoveItem(MovableObject *pItemToRem)
                 }
             }
         }
+
+        if (removed)
+        {
+            m_ValidMOs.erase(pItemToRem);
+            RemoveFromSpatialGrid(pItemToRem);
+        }
     }
     return removed;
 }
@@ -1109,6 +1422,7 @@ bool MovableMan::RemoveParticle(MovableObject *pMOToRem)
             if (*itr == pMOToRem)
             {
                 m_Particles.erase(itr);
+                m_ParticleListStale = true;
                 removed = true;
                 break;
             }
@@ -1126,6 +1440,15 @@ bool MovableMan::RemoveParticle(MovableObject *pMOToRem)
                 }
             }
         }
+        // Last, see if it's kept packed
+        if (!removed)
+        {
+            removed = m_ParticleStore.Release(pMOToRem);
+            m_ParticleListStale = m_ParticleListStale || removed;
+        }
+
+        if (removed)
+            m_ValidMOs.erase(pMOToRem);
     }
     return removed;
 }
@@ -1162,31 +1485,7 @@ bool MovableMan::ValidateMOIDs()
 
 bool MovableMan::ValidMO(const MovableObject *pMOToCheck)
 {
-    bool found = false;
-
-    if (pMOToCheck)
-    {
-
-        // See if this MO has been found earlier this frame
-        for (deque<pair <const MovableObject *, bool> >::iterator itr = m_ValiditySearchResults.begin(); !found && itr != m_ValiditySearchResults.end(); ++itr)
-        {
-            // If the MO is found to have been searched for earlier this frame, then just return the search results
-            if (itr->first == pMOToCheck)
-                return itr->second;
-        }
-
-        // Check actors
-        found = found ? true : IsActor(pMOToCheck);
-        // Check Items
-        found = found ? true : IsDevice(pMOToCheck);
-        // Check particles
-        found = found ? true : IsParticle(pMOToCheck);
-
-        // Save search result for future requests this frame
-        m_ValiditySearchResults.push_back(pair<const MovableObject *, bool>(pMOToCheck, found));
-    }
-
-    return found;
+    return pMOToCheck && m_ValidMOs.find(pMOToCheck) != m_ValidMOs.end();
 }
 
 
@@ -1198,32 +1497,11 @@ bool MovableMan::ValidMO(const MovableObject *pMOToCheck)
 
 bool MovableMan::IsActor(const MovableObject *pMOToCheck)
 {
-    bool found = false;
+    if (!pMOToCheck)
+        return false;
 
-    if (pMOToCheck)
-    {
-        for (deque<Actor *>::iterator itr = m_Actors.begin(); !found && itr != m_Actors.end(); ++itr)
-        {
-            if (*itr == pMOToCheck)
-            {
-                found = true;
-                break;
-            }
-        }
-        // Try the actors just added this frame
-        if (!found)
-        {
-            for (deque<Actor *>::iterator itr = m_AddedActors.begin(); !found && itr != m_AddedActors.end(); ++itr)
-            {
-                if (*itr == pMOToCheck)
-                {
-                    found = true;
-                    break;
-                }
-            }
-        }
-    }
-    return found;
+    unordered_map<const MovableObject *, MOListType>::const_iterator itr = m_ValidMOs.find(pMOToCheck);
+    return itr != m_ValidMOs.end() && itr->second == LIST_ACTORS;
 }
 
 
@@ -1235,32 +1513,11 @@ bool MovableMan::IsActor(const MovableObject *pMOToCheck)
 
 bool MovableMan::IsDevice(const MovableObject *pMOToCheck)
 {
-    bool found = false;
+    if (!pMOToCheck)
+        return false;
 
-    if (pMOToCheck)
-    {
-        for (deque<MovableObject *>::iterator itr = m_Items.begin(); !found && itr != m_Items.end(); ++itr)
-        {
-            if (*itr == pMOToCheck)
-            {
-                found = true;
-                break;
-            }
-        }
-        // Try the items just added this frame
-        if (!found)
-        {
-            for (deque<MovableObject *>::iterator itr = m_AddedItems.begin(); !found && itr != m_AddedItems.end(); ++itr)
-            {
-                if (*itr == pMOToCheck)
-                {
-                    found = true;
-                    break;
-                }
-            }
-        }
-    }
-    return found;
+    unordered_map<const MovableObject *, MOListType>::const_iterator itr = m_ValidMOs.find(pMOToCheck);
+    return itr != m_ValidMOs.end() && itr->second == LIST_ITEMS;
 }
 
 
@@ -1272,32 +1529,11 @@ bool MovableMan::IsDevice(const MovableObject *pMOToCheck)
 
 bool MovableMan::IsParticle(const MovableObject *pMOToCheck)
 {
-    bool found = false;
+    if (!pMOToCheck)
+        return false;
 
-    if (pMOToCheck)
-    {
-        for (deque<MovableObject *>::iterator itr = m_Particles.begin(); !found && itr != m_Particles.end(); ++itr)
-        {
-            if (*itr == pMOToCheck)
-            {
-                found = true;
-                break;
-            }
-        }
-        // Try the items just added this frame
-        if (!found)
-        {
-            for (deque<MovableObject *>::iterator itr = m_AddedParticles.begin(); !found && itr != m_AddedParticles.end(); ++itr)
-            {
-                if (*itr == pMOToCheck)
-                {
-                    found = true;
-                    break;
-                }
-            }
-        }
-    }
-    return found;
+    unordered_map<const MovableObject *, MOListType>::const_iterator itr = m_ValidMOs.find(pMOToCheck);
+    return itr != m_ValidMOs.end() && itr->second == LIST_PARTICLES;
 }
 
 
@@ -1312,37 +1548,12 @@ bool MovableMan::IsOfActor(MOID checkMOID)
     if (checkMOID == g_NoMOID)
         return false;
 
-    bool found = false;
     MovableObject *pMO = GetMOFromID(checkMOID);
+    if (!pMO)
+        return false;
 
-    if (pMO)
-    {
-        MOID rootMOID = pMO->GetRootID();
-        if (checkMOID != g_NoMOID)
-        {
-            for (deque<Actor *>::iterator itr = m_Actors.begin(); !found && itr != m_Actors.end(); ++itr)
-            {
-                if ((*itr)->GetID() == checkMOID || (*itr)->GetID() == rootMOID)
-                {
-                    found = true;
-                    break;
-                }
-            }
-            // Check actors just added this frame
-            if (!found)
-            {
-                for (deque<Actor *>::iterator itr = m_AddedActors.begin(); !found && itr != m_AddedActors.end(); ++itr)
-                {
-                    if ((*itr)->GetID() == checkMOID || (*itr)->GetID() == rootMOID)
-                    {
-                        found = true;
-                        break;
-                    }
-                }
-            }
-        }
-    }
-    return found;
+    // Either the MO itself or its root parent has to be an Actor
+    return IsActor(pMO) || IsActor(GetMOFromID(pMO->GetRootID()));
 }
 
 
@@ -1447,6 +1658,7 @@ int MovableMan::EjectAllActors(list<SceneObject *> &actorList, int onlyTeam, boo
         }
         else
             delete *aIt;
+        m_ValidMOs.erase(*aIt);
     }
     // Clear the internal Actor list; we transferred the ownership of them
     m_Actors.clear();
@@ -1462,13 +1674,16 @@ int MovableMan::EjectAllActors(list<SceneObject *> &actorList, int onlyTeam, boo
         }
         else
             delete *aIt;
+        m_ValidMOs.erase(*aIt);
     }
     // Clear the internal Actor list; we transferred the ownership of them
     m_AddedActors.clear();
 
-    // Also clear the actor rosters
+    // Also clear the actor rosters and grid
     for (int team = Activity::TEAM_1; team < Activity::MAXTEAMCOUNT; ++team)
         m_ActorRoster[team].clear();
+    for (int i = 0; i < m_GridWidth * m_GridHeight; ++i)
+        m_ActorGrid[i].clear();
 
     return addedCount;
 }
@@ -1488,6 +1703,7 @@ int MovableMan::EjectAllItems(list<SceneObject *> &itemList)
     for (deque<MovableObject *>::iterator iIt = m_Items.begin(); iIt != m_Items.end(); ++iIt)
     {
         itemList.push_back((*iIt));
+        m_ValidMOs.erase(*iIt);
         addedCount++;
     }
     // Clear the internal Actor list; we transferred the ownership of them
@@ -1497,10 +1713,13 @@ int MovableMan::EjectAllItems(list<SceneObject *> &itemList)
     for (deque<MovableObject *>::iterator iIt = m_AddedItems.begin(); iIt != m_AddedItems.end(); ++iIt)
     {
         itemList.push_back((*iIt));
+        m_ValidMOs.erase(*iIt);
         addedCount++;
     }
     // Clear the internal Item list; we transferred the ownership of them
     m_AddedItems.clear();
+    for (int i = 0; i < m_GridWidth * m_GridHeight; ++i)
+        m_ItemGrid[i].clear();
 
     return addedCount;
 }
@@ -1518,6 +1737,43 @@ int MovableMan::GetTeamMOIDCount(int team) const
 		return 0;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetStateHash
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Folds the positions, velocities and rotations of all held MOs, and the
+//                  health of all actors, into a running hash.
+
+unsigned int MovableMan::GetStateHash(unsigned int hash) const
+{
+    float state[6];
+    for (deque<Actor *>::const_iterator aIt = m_Actors.begin(); aIt != m_Actors.end(); ++aIt)
+    {
+        state[0] = (*aIt)->GetPos().m_X;
+        state[1] = (*aIt)->GetPos().m_Y;
+        state[2] = (*aIt)->GetVel().m_X;
+        state[3] = (*aIt)->GetVel().m_Y;
+        state[4] = (*aIt)->GetRotAngle();
+        state[5] = (*aIt)->GetHealth();
+        hash = HashBytes(state, sizeof(state), hash);
+    }
+
+    const deque<MovableObject *> *pLists[2] = { &m_Items, &m_Particles };
+    for (int list = 0; list < 2; ++list)
+    {
+        for (deque<MovableObject *>::const_iterator mIt = pLists[list]->begin(); mIt != pLists[list]->end(); ++mIt)
+        {
+            state[0] = (*mIt)->GetPos().m_X;
+            state[1] = (*mIt)->GetPos().m_Y;
+            state[2] = (*mIt)->GetVel().m_X;
+            state[3] = (*mIt)->GetVel().m_Y;
+            state[4] = (*mIt)->GetRotAngle();
+            hash = HashBytes(state, sizeof(float) * 5, hash);
+        }
+    }
+
+    return m_ParticleStore.GetStateHash(hash);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          OpenAllDoors
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1673,8 +1929,6 @@ void MovableMan::Update()
     m_SortTeamRoster[Activity::TEAM_2] = false;
     m_SortTeamRoster[Activity::TEAM_3] = false;
     m_SortTeamRoster[Activity::TEAM_4] = false;
-    // Clear out MO finding optimization buffer - will be added to each frame as thigns are searched for as curently exisitng in the manager
-    m_ValiditySearchResults.clear();
 
     // Move all last frame's alarm events into the proper buffer, and clear out the new one to fill up with this frame's
     m_AlarmEvents.clear();
@@ -1748,11 +2002,47 @@ void MovableMan::Update()
         {
             SLICK_PROFILENAME("Travel Particles", 0xFF778962);
 
-            for (parIt = m_Particles.begin(); parIt != m_Particles.end(); ++parIt)
+            // Move the packed particles first. The ones changed from outside since the last frame come back out as they are, and are
+            // treated like any other particle. The ones that would hit something this frame come back out as full MOPixels with their
+            // forces already applied, and travel as usual below; the ones that expired come back marked for deletion.
+            int firstReleased = m_Particles.size();
+            int firstExpired = firstReleased;
+            if (m_ParticleStore.GetCount() > 0)
             {
-                if (!((*parIt)->IsUpdated()))
+                deque<MovableObject *> promoted;
+                deque<MovableObject *> expired;
+                m_ParticleStore.Travel(g_TimerMan.GetDeltaTimeSecs());
+                m_ParticleStore.TakeReleased(m_Particles, promoted, expired);
+                firstReleased = m_Particles.size();
+                m_Particles.insert(m_Particles.end(), promoted.begin(), promoted.end());
+                firstExpired = m_Particles.size();
+                m_Particles.insert(m_Particles.end(), expired.begin(), expired.end());
+                m_ParticleListStale = true;
+            }
+
+            // First let the worker threads move all the simple particles that can't run into anything this frame. Whatever might collide
+            // is left for the serial loop below, so all writes to the terrain and other MOs still happen on this thread in list order.
+            m_ParticleTravelState.assign(m_Particles.size(), TRAVEL_PENDING);
+            for (int released = firstReleased; released < m_Particles.size(); ++released)
+                m_ParticleTravelState[released] = released < firstExpired ? TRAVEL_FORCESAPPLIED : TRAVEL_DONE;
+            bool parallelTravel = g_SettingsMan.ParallelParticleTravel() && g_ThreadMan.GetWorkerCount() > 0;
+#ifdef PROFILER_ENABLED
+            // The profiler samples aren't thread safe
+            parallelTravel = false;
+#endif
+            if (parallelTravel)
+            {
+                int chunkCount = (m_Particles.size() + m_ParticleTravelChunkSize - 1) / m_ParticleTravelChunkSize;
+                g_ThreadMan.RunParallelJobs(chunkCount, std::bind(&MovableMan::TravelParticleChunk, this, std::placeholders::_1));
+            }
+
+            int parIndex = 0;
+            for (parIt = m_Particles.begin(); parIt != m_Particles.end(); ++parIt, ++parIndex)
+            {
+                if (m_ParticleTravelState[parIndex] != TRAVEL_DONE && !((*parIt)->IsUpdated()))
                 {
-                    (*parIt)->ApplyForces();
+                    if (m_ParticleTravelState[parIndex] != TRAVEL_FORCESAPPLIED)
+                        (*parIt)->ApplyForces();
                     (*parIt)->PreTravel();
                     (*parIt)->Travel();
                     (*parIt)->PostTravel();
@@ -1762,6 +2052,9 @@ void MovableMan::Update()
         }
 		g_FrameMan.StopPerformanceMeasurement(FrameMan::PERF_PARTICLES_PASS1);
 
+        // Everything has moved, so re-sort the Actors and Items into the spatial grid for the queries made during the second pass
+        UpdateSpatialGrid();
+
         g_SceneMan.UnlockScene();
     }
 
@@ -1773,6 +2066,9 @@ void MovableMan::Update()
 
         g_SceneMan.LockScene();
 
+        // Cast all the sensing rays queued during the last frame, so the AI updates below can pick up the results
+        g_SceneMan.CastRayBatch();
+
         // Actor:s
 		g_FrameMan.StartPerformanceMeasurement(FrameMan::PERF_ACTORS_PASS2);
         {
@@ -1783,7 +2079,8 @@ void MovableMan::Update()
 				(*aIt)->Update();
 				//g_FrameMan.StopPerformanceMeasurement(FrameMan::PERF_ACTORS_PASS2);
 				//g_FrameMan.StartPerformanceMeasurement(FrameMan::PERF_ACTORS_AI);
-                (*aIt)->UpdateScript();
+                // The scripts of actors no player controls can wait when the sim is running behind
+                (*aIt)->UpdateScriptThrottled();
 				//g_FrameMan.StopPerformanceMeasurement(FrameMan::PERF_ACTORS_AI);
                 (*aIt)->ApplyImpulses();
             }
@@ -1836,8 +2133,10 @@ void MovableMan::Update()
     ///////////////////////////////////////////////////
     // Clear the MOID layer before starting to delete stuff which may be in the MOIDIndex
 
+    g_FrameMan.StartPerformanceMeasurement(FrameMan::PERF_MOIDS);
     g_SceneMan.ClearAllMOIDDrawings();
 //    g_SceneMan.MOIDClearCheck();
+    g_FrameMan.StopPerformanceMeasurement(FrameMan::PERF_MOIDS);
 
     ///////////////////////////////////////////////////
     // Determine whether we should go into a brief period of slo-mo for when the sim gets hit heavily all of a sudden
@@ -1868,6 +2167,7 @@ void MovableMan::Update()
 				if ((*aIt)->GetTeam() >= 0)
 					//m_ActorRoster[(*aIt)->GetTeam()].remove(*aIt);
 					RemoveActorFromTeamRoster(*aIt);
+                m_ValidMOs.erase(*aIt);
                 delete (*aIt);
 			}
         }
@@ -1880,18 +2180,31 @@ void MovableMan::Update()
             if (!(*iIt)->IsSetToDelete())
                 m_Items.push_back(*iIt);
             else
+            {
+                m_ValidMOs.erase(*iIt);
                 delete (*iIt);
+            }
         }
         m_AddedItems.clear();
 
         // Particles
+        bool useParticleStore = g_SettingsMan.UseParticleStore();
         for (parIt = m_AddedParticles.begin(); parIt != m_AddedParticles.end(); ++parIt)
         {
             // Delete instead if it's marked for it
             if (!(*parIt)->IsSetToDelete())
-                m_Particles.push_back(*parIt);
+            {
+                // The simplest ones are kept packed while they fly freely
+                if (useParticleStore && ParticleStore::CanStore(*parIt))
+                    m_ParticleStore.Add(static_cast<MOPixel *>(*parIt));
+                else
+                    m_Particles.push_back(*parIt);
+            }
             else
+            {
+                m_ValidMOs.erase(*parIt);
                 delete (*parIt);
+            }
         }
         m_AddedParticles.clear();
     }
@@ -1899,6 +2212,7 @@ void MovableMan::Update()
     ////////////////////////////////////////////////////////////////////////////
     // Copy (Settle) Pass
 
+    g_FrameMan.StartPerformanceMeasurement(FrameMan::PERF_SETTLE);
     {
         SLICK_PROFILENAME("Copy and Settle Pass", 0xFF879684);
 
@@ -1920,6 +2234,7 @@ void MovableMan::Update()
 
                 // Add to the particles list
                 m_Particles.push_back(*aIt);
+                m_ValidMOs[*aIt] = LIST_PARTICLES;
                 // Remove from the team roster
 
                 if ((*aIt)->GetTeam() >= 0)
@@ -1946,6 +2261,7 @@ void MovableMan::Update()
 				// Disable TDExplosive's immunity to settling
 				if ((*iIt)->GetRestThreshold()< 0)
 					(*iIt)->SetRestThreshold(500);
+                m_ValidMOs[*iIt] = LIST_PARTICLES;
                 m_Particles.push_back(*(iIt++));
             }
             m_Items.erase(imidIt, m_Items.end());
@@ -1975,6 +2291,7 @@ void MovableMan::Update()
 				RemoveActorFromTeamRoster(*aIt);
 
             // Delete
+            m_ValidMOs.erase(*aIt);
             delete *aIt;
             aIt++;
         }
@@ -1987,7 +2304,10 @@ void MovableMan::Update()
         imidIt = iIt;
 
         while (iIt != m_Items.end())
+        {
+            m_ValidMOs.erase(*iIt);
             delete *(iIt++);
+        }
         m_Items.erase(imidIt, m_Items.end());
 
         // Particles
@@ -1995,7 +2315,10 @@ void MovableMan::Update()
         midIt = parIt;
 
         while (parIt != m_Particles.end())
+        {
+            m_ValidMOs.erase(*parIt);
             delete *(parIt++);
+        }
         m_Particles.erase(midIt, m_Particles.end());
     }
 
@@ -2032,19 +2355,26 @@ void MovableMan::Update()
 //                (*parIt)->Draw(g_SceneMan.GetTerrain()->GetMaterialBitmap(), Vector(), g_DrawMaterial, true);
                 g_SceneMan.GetTerrain()->ApplyMovableObject(*parIt);
             }
+            m_ValidMOs.erase(*parIt);
             delete *(parIt++);
         }
         m_Particles.erase(midIt, m_Particles.end());
     }
 
     release_bitmap(g_SceneMan.GetTerrain()->GetMaterialBitmap());
+    g_FrameMan.StopPerformanceMeasurement(FrameMan::PERF_SETTLE);
+
+    // Rebuild the spatial grid now that dead and deleted Actors and Items are gone, so it won't hold any dangling pointers
+    UpdateSpatialGrid();
 
     ////////////////////////////////////////////////////////////////////////
     // Draw the MO matter and IDs to their layers for next frame
 
 // Not anymore, we're using ClearAllMOIDDrawings instead.. much more efficient
 //    g_SceneMan.ClearMOIDLayer();
+    g_FrameMan.StartPerformanceMeasurement(FrameMan::PERF_MOIDS);
     UpdateDrawMOIDs(g_SceneMan.GetMOIDBitmap());
+    g_FrameMan.StopPerformanceMeasurement(FrameMan::PERF_MOIDS);
 
 	// COUNT MOID USAGE PER TEAM  //////////////////////////////////////////////////
 	{
@@ -2084,6 +2414,9 @@ void MovableMan::Update()
         if (m_SortTeamRoster[Activity::TEAM_4])
             m_ActorRoster[Activity::TEAM_4].sort(MOXPosComparison());
     }
+
+    // Particles have been added, removed and settled
+    m_ParticleListStale = true;
 }
 
 
@@ -2101,6 +2434,8 @@ void MovableMan::DrawMatter(BITMAP *pTargetBitmap, Vector &targetPos)
 
     for (deque<MovableObject *>::iterator parIt = --m_Particles.end(); parIt != --m_Particles.begin(); --parIt)
         (*parIt)->Draw(pTargetBitmap, targetPos, g_DrawMaterial);
+
+    m_ParticleStore.Draw(pTargetBitmap, targetPos, g_DrawMaterial);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -2121,7 +2456,6 @@ void MovableMan::VerifyMOIDIndex()
 			DAssert((*aIt)->GetRootID() == g_NoMOID || ((*aIt)->GetRootID() >= 0 && (*aIt)->GetRootID() < g_MovableMan.GetMOIDCount()), "MOIDIndex broken!");
 		}
 		count++;
-		if (count == g_NoMOID) count++;
 	}
 
 
@@ -2209,6 +2543,8 @@ void MovableMan::Draw(BITMAP *pTargetBitmap, const Vector &targetPos)
     SLICK_PROFILE(0xFF564462);
 
     // Draw objects to accumulation bitmap, in reverse order so actors appear on top.
+    m_ParticleStore.Draw(pTargetBitmap, targetPos);
+
     for (deque<MovableObject *>::iterator parIt = m_Particles.begin(); parIt != m_Particles.end(); ++parIt)
         (*parIt)->Draw(pTargetBitmap, targetPos);
 
@@ -16,6 +16,7 @@
 
 #include <list>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <string>
 #include <algorithm>
@@ -31,6 +32,7 @@
 #include "LuaMan.h"
 #include "ActivityMan.h"
 #include "Vector.h"
+#include "ParticleStore.h"
 //#include "MOPixel.h"
 //#include "AHuman.h"
 //#include "MovableObject.h"
@@ -329,6 +331,21 @@ public:
     Actor * GetClosestEnemyActor(int team, const Vector &scenePoint, int maxRadius, Vector &getDistance);
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetMOsInRadius
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gathers all Actors and Items kept by this that are within a radius of
+//                  a scene point. Uses the spatial grid so only the nearby cells are
+//                  searched instead of the whole Actor and Item lists.
+// Arguments:       The Scene point to search around.
+//                  The radius around that scene point to search.
+//                  The list to add the found MOs to. Ownership is NOT transferred!
+//                  Whether to include Items in the search, or only Actors.
+// Return value:    The number of MOs that were added to the list.
+
+    int GetMOsInRadius(const Vector &scenePoint, float radius, std::list<MovableObject *> &moList, bool includeItems = true) const;
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          GetFirstTeamActor
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -444,7 +461,42 @@ public:
 // Arguments:       None.
 // Return value:    The number of particles.
 
-    long GetParticleCount() const { return m_Particles.size(); }
+    long GetParticleCount() const { return m_Particles.size() + m_ParticleStore.GetCount(); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetPackedParticleCount
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the number of the held particles which are simple enough to be
+//                  kept in the packed ParticleStore while they fly freely.
+// Arguments:       None.
+// Return value:    The number of packed particles.
+
+    long GetPackedParticleCount() const { return m_ParticleStore.GetCount(); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetParticleList
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets all the particles currently held, both the packed ones and the
+//                  rest. Made for the scripts, which shouldn't have to tell them apart.
+//                  The list stays the same until particles are moved, added or removed.
+// Arguments:       None.
+// Return value:    The particles. Ownership is NOT transferred!
+
+    std::deque<MovableObject *> & GetParticleList();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetStateHash
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Folds the positions, velocities and rotations of all held MOs, and the
+//                  health of all actors, into a running hash. Two runs of the sim that
+//                  stayed in step come out the same.
+// Arguments:       The hash so far.
+// Return value:    The new hash.
+
+    unsigned int GetStateHash(unsigned int hash) const;
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -658,8 +710,8 @@ public:
 //////////////////////////////////////////////////////////////////////////////////////////
 // Description:     Indicates whether the passed in MovableObject pointer points to an
 //                  MO that's currently active in the simulation, and kept by this
-//                  MovableMan. Internal optimization is made so that the same MO can
-//                  efficiently be checked many times during the same frame.
+//                  MovableMan. This is a constant time lookup in the validity index,
+//                  so it can be called many times per frame.
 // Arguments:       A pointer to the MovableObject to check for being actively kept by
 //                  this MovableMan.
 // Return value:    Whether the MO instance was found in the active list or not.
@@ -1031,6 +1083,12 @@ protected:
     std::deque<MovableObject *> m_Items;
     // List of free, dead particles flying around
     std::deque<MovableObject *> m_Particles;
+    // The simplest free flying MOPixels, kept packed apart from m_Particles until they are about to hit something.
+    // Still count as in the particle list as far as m_ValidMOs is concerned.
+    ParticleStore m_ParticleStore;
+    // m_Particles and the packed particles together, as handed to the scripts, and whether it needs to be made over
+    std::deque<MovableObject *> m_ParticleList;
+    bool m_ParticleListStale;
     // These are the actors/items/particles which were added during a frame.
     // They are moved to the containers above at the end of the frame.
     std::deque<Actor *> m_AddedActors;
@@ -1044,10 +1102,28 @@ protected:
 	// Every team's MO footprint
 	int m_TeamMOIDCount[Activity::MAXTEAMCOUNT];
 
+    // Which of the internal lists an MO kept by this is in
+    enum MOListType
+    {
+        LIST_ACTORS = 0,
+        LIST_ITEMS,
+        LIST_PARTICLES
+    };
     // Optimization implementation
-    // MO's that have already been asked whether they exist in the manager this frame, and the search result.
-    // Gets cleaned out each frame. Does NOT own any instances.
-    std::deque<std::pair<const MovableObject *, bool> > m_ValiditySearchResults;
+    // Every MO kept by this, including the ones added this frame, and which list it belongs to.
+    // Kept up to date whenever MOs are added, moved between lists, removed or deleted. Does NOT own any instances.
+    std::unordered_map<const MovableObject *, MOListType> m_ValidMOs;
+
+    // Uniform grid of the Actors and Items in the scene, each cell holding the ones whose positions are inside it.
+    // Rebuilt after the travel pass and again after deletions, so it never holds deleted MOs. Does NOT own any instances.
+    std::vector<std::vector<Actor *> > m_ActorGrid;
+    std::vector<std::vector<MovableObject *> > m_ItemGrid;
+    // The dimensions of the spatial grids, in cells
+    int m_GridWidth;
+    int m_GridHeight;
+
+    // How far each particle got during the parallel part of the travel pass, indexed the same as m_Particles
+    std::vector<unsigned char> m_ParticleTravelState;
 
     // The alarm events on the scene where something alarming happened, for use with AI firings awareness os they react to shots fired etc.
     // This is the last frame's events, is the one for Actors to poll for events, should be cleaned out and refilled each frame.
@@ -1104,6 +1180,61 @@ private:
     void Clear();
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          UpdateSpatialGrid
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Rebuilds the spatial grids from the current positions of all Actors
+//                  and Items, resizing them first if the scene dimensions changed.
+// Arguments:       None.
+// Return value:    None.
+
+    void UpdateSpatialGrid();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RemoveFromSpatialGrid
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Removes an Actor or Item from whichever grid cell it's in, for when
+//                  it's taken out of this between grid rebuilds.
+// Arguments:       The MO to remove.
+// Return value:    None.
+
+    void RemoveFromSpatialGrid(const MovableObject *pMOToRem);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetGridCellRange
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Figures out which grid cells need to be searched to cover a radius
+//                  around a scene point. Cell ranges may extend past the grid edges on
+//                  wrapping scenes, and need to be wrapped when used.
+// Arguments:       The Scene point to search around.
+//                  The radius around that scene point to search.
+//                  The first and last cell columns to search.
+//                  The first and last cell rows to search.
+// Return value:    Whether there is anything in the grid to search at all.
+
+    bool GetGridCellRange(const Vector &scenePoint, float radius, int &firstX, int &lastX, int &firstY, int &lastY) const;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          TravelParticleChunk
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Applies forces to and travels the simple particles in one chunk of
+//                  m_Particles whose paths this frame are clear of anything they could
+//                  hit, recording how far each one got in m_ParticleTravelState. Only
+//                  touches the particles of its own chunk, so may run on any thread.
+// Arguments:       The index of the chunk of m_ParticleTravelChunkSize particles.
+// Return value:    None.
+
+    void TravelParticleChunk(int chunk);
+
+
+    // The size of the spatial grid cells, in pixels
+    static const int m_GridCellSize;
+    // How many particles each job of the parallel travel pass handles
+    static const int m_ParticleTravelChunkSize;
+
     // Disallow the use of some implicit methods.
     MovableMan(const MovableMan &reference);
     MovableMan & operator=(const MovableMan &rhs);
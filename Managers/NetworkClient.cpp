@@ -63,6 +63,15 @@ namespace RTE
 			m_TargetPos[f].Reset();
 		m_CurrentSceneLayerReceived = -1;
 		m_CurrentFrame = 0;
+		for (int slot = 0; slot < KEYFRAME_SLOTS; slot++)
+		{
+			m_pKeyframe8[slot] = 0;
+			m_pKeyframeGUI8[slot] = 0;
+			m_KeyframeIds[slot] = -1;
+			m_KeyframeBoxesReceived[slot] = 0;
+			m_KeyframeComplete[slot] = false;
+		}
+		m_LastKeyframeReceived = -1;
 		m_UseNATPunchThroughService = false;
 		m_ServerGuid = RakNet::UNASSIGNED_RAKNET_GUID;
 
@@ -118,6 +127,14 @@ namespace RTE
 
 	void NetworkClient::Destroy()
 	{
+		for (int slot = 0; slot < KEYFRAME_SLOTS; slot++)
+		{
+			if (m_pKeyframe8[slot])
+				destroy_bitmap(m_pKeyframe8[slot]);
+			if (m_pKeyframeGUI8[slot])
+				destroy_bitmap(m_pKeyframeGUI8[slot]);
+		}
+
 		Clear();
 	}
 
@@ -343,6 +360,9 @@ namespace RTE
 		g_UInputMan.ClearAccumulatedStates();
 		//buf[UInputMan::INPUT_COUNT] = 0;
 
+		// Lets the server know which keyframe it can build frame box deltas against
+		msg.LastKeyframeReceived = m_LastKeyframeReceived;
+
 		m_Client->Send((const char *)&msg, sizeof(msg), IMMEDIATE_PRIORITY, RELIABLE_ORDERED, 0, m_ServerID, false);
 
 		/*if (msg.InputElementHeld > 0 || msg.InputElementPressed > 0 || msg.InputElementReleased > 0)
@@ -923,8 +943,43 @@ namespace RTE
 
 		if (bpx + maxWidth - 1 < bmp->w && bpy + maxHeight - 1 < bmp->h && bpx >= 0 && bpy >= 0)
 		{
+			if (frameData->Flags == FRAMEBOX_DELTA)
+			{
+				int slot = frameData->KeyframeSlot;
+
+				// Delta against a keyframe we don't have, drop it and wait for the server to resend the box
+				if (slot >= KEYFRAME_SLOTS || !m_KeyframeComplete[slot] || m_KeyframeIds[slot] != frameData->KeyframeId)
+				{
+					release_bitmap(bmp);
+					return;
+				}
+
+				BITMAP * keyframe = frameData->Layer == 0 ? m_pKeyframe8[slot] : m_pKeyframeGUI8[slot];
+
+				// Empty delta means the box is identical to the keyframe
+				if (frameData->DataSize == 0)
+					memset(m_aPixelLineBuffer, 0, frameData->UncompressedSize);
+				else if (frameData->DataSize == frameData->UncompressedSize)
+					memcpy_s(m_aPixelLineBuffer, size, p->data + sizeof(MsgFrameBox), size);
+				else
+					LZ4_decompress_safe((char *)(p->data + sizeof(MsgFrameBox)), (char *)(m_aPixelLineBuffer), size, frameData->UncompressedSize);
+
+				// Apply the delta to the keyframe box line by line
+				unsigned char * lineAddr = m_aPixelLineBuffer;
+				for (int y = 0; y < maxHeight; y++)
+				{
+					unsigned char * pDest = bmp->line[bpy + y] + bpx;
+					unsigned char * pReference = keyframe->line[bpy + y] + bpx;
+					for (int x = 0; x < maxWidth; x++)
+						pDest[x] = lineAddr[x] ^ pReference[x];
+					lineAddr += maxWidth;
+				}
+
+				if (g_UInputMan.KeyHeld(KEY_0))
+					rect(bmp, bpx, bpy, bpx + maxWidth - 1, bpy + maxHeight - 1, g_WhiteColor);
+			}
 			// Unpack box
-			if (frameData->DataSize == 0)
+			else if (frameData->DataSize == 0)
 			{
 				//memset(bmp->line[lineNumber], g_KeyColor, bmp->w);
 				rectfill(bmp, bpx, bpy, bpx + maxWidth - 1, bpy + maxHeight - 1, g_KeyColor);
@@ -948,11 +1003,57 @@ namespace RTE
 					rect(bmp, bpx, bpy, bpx + maxWidth - 1, bpy + maxHeight - 1, g_BlackColor);
 			}
 
+			if (frameData->Flags == FRAMEBOX_KEYFRAME)
+				StoreKeyframeBox(frameData, bmp);
 		}
 
 		release_bitmap(bmp);
 	}
 
+	void NetworkClient::StoreKeyframeBox(const MsgFrameBox * frameData, BITMAP * bmp)
+	{
+		int slot = frameData->KeyframeSlot;
+		if (slot >= KEYFRAME_SLOTS)
+			return;
+
+		// First box of a new keyframe, the server never reuses the slot of the keyframe we acknowledged last
+		if (m_KeyframeIds[slot] != frameData->KeyframeId)
+		{
+			m_KeyframeIds[slot] = frameData->KeyframeId;
+			m_KeyframeBoxesReceived[slot] = 0;
+			m_KeyframeComplete[slot] = false;
+		}
+
+		BITMAP * &keyframe = frameData->Layer == 0 ? m_pKeyframe8[slot] : m_pKeyframeGUI8[slot];
+		if (keyframe && (keyframe->w != bmp->w || keyframe->h != bmp->h))
+		{
+			destroy_bitmap(keyframe);
+			keyframe = 0;
+		}
+		if (!keyframe)
+			keyframe = create_bitmap_ex(8, bmp->w, bmp->h);
+
+		blit(bmp, keyframe, frameData->BoxX, frameData->BoxY, frameData->BoxX, frameData->BoxY, frameData->BoxWidth, frameData->BoxHeight);
+
+		m_KeyframeBoxesReceived[slot]++;
+		if (!m_KeyframeComplete[slot] && m_KeyframeBoxesReceived[slot] >= frameData->KeyframeBoxes)
+		{
+			m_KeyframeComplete[slot] = true;
+			m_LastKeyframeReceived = frameData->KeyframeId;
+		}
+	}
+
+	void NetworkClient::ResetKeyframes()
+	{
+		for (int slot = 0; slot < KEYFRAME_SLOTS; slot++)
+		{
+			m_KeyframeIds[slot] = -1;
+			m_KeyframeBoxesReceived[slot] = 0;
+			m_KeyframeComplete[slot] = false;
+		}
+		m_LastKeyframeReceived = -1;
+	}
+
 	void NetworkClient::ReceiveFrameLineMsg(RakNet::Packet * p)
 	{
 		RTE::MsgFrameLine * frameData = (RTE::MsgFrameLine *)p->data;
@@ -1043,6 +1144,9 @@ namespace RTE
 		clear_to_color(g_FrameMan.GetNetworkBackBufferIntermediateGUI8Ready(0), g_KeyColor);
 		clear_to_color(g_FrameMan.GetNetworkBackBufferGUI8Ready(0), g_KeyColor);
 
+		// Server starts over with a new keyframe once the scene is accepted
+		ResetKeyframes();
+
 		RTE::MsgSceneSetup * frameData = (RTE::MsgSceneSetup *)p->data;
 
 		m_SceneId = frameData->SceneId;
@@ -140,6 +140,8 @@ namespace RTE
 			unsigned int InputElementReleased;
 			unsigned int InputElementHeld;
 
+			// Id of the last frame box keyframe received completely, -1 if none
+			int LastKeyframeReceived;
 		};
 
 		//////////////////////////////////////////////////////////////////////////////////////////
@@ -192,6 +194,27 @@ namespace RTE
 
 		void ReceiveFrameBoxMsg(RakNet::Packet * p);
 
+		//////////////////////////////////////////////////////////////////////////////////////////
+		// Method:          StoreKeyframeBox
+		//////////////////////////////////////////////////////////////////////////////////////////
+		// Description:     Copies a box just received as part of a keyframe from the frame bitmap
+		//                  into its keyframe slot and marks the keyframe complete once all of
+		//                  its boxes are in.
+		// Arguments:       The frame box message and the bitmap the box was unpacked to.
+		// Return value:    None.
+
+		void StoreKeyframeBox(const MsgFrameBox * frameData, BITMAP * bmp);
+
+		//////////////////////////////////////////////////////////////////////////////////////////
+		// Method:          ResetKeyframes
+		//////////////////////////////////////////////////////////////////////////////////////////
+		// Description:     Forgets all stored keyframes so delta boxes are ignored until the
+		//                  server sends a new keyframe.
+		// Arguments:       None.
+		// Return value:    None.
+
+		void ResetKeyframes();
+
 		void ReceiveSceneMsg(RakNet::Packet * p);
 
 		void ReceiveAcceptedMsg();
@@ -229,6 +252,16 @@ namespace RTE
 
 		unsigned char m_aPixelLineBuffer[MAX_PIXEL_LINE_BUFFER_SIZE];
 
+		// Keyframes received from the server, delta boxes are XOR'ed against them. OWNED!!!
+		BITMAP * m_pKeyframe8[KEYFRAME_SLOTS];
+		BITMAP * m_pKeyframeGUI8[KEYFRAME_SLOTS];
+		// Id of the keyframe stored in each slot, -1 if the slot is empty
+		int m_KeyframeIds[KEYFRAME_SLOTS];
+		unsigned int m_KeyframeBoxesReceived[KEYFRAME_SLOTS];
+		bool m_KeyframeComplete[KEYFRAME_SLOTS];
+		// Reported back to the server with every input message
+		int m_LastKeyframeReceived;
+
 		long int m_ReceivedData;
 
 		long int m_CompressedData;
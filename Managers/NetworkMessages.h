@@ -6,6 +6,7 @@ namespace RTE
 #define MAX_PIXEL_LINE_BUFFER_SIZE 8192
 #define MAX_BACKGROUND_LAYERS_TRANSMITTED 10
 #define FRAMES_TO_REMEMBER 3
+#define KEYFRAME_SLOTS 2
 
 #define MAX_CLIENTS 4
 
@@ -36,6 +37,17 @@ namespace RTE
 		ID_SRV_MUSIC_EVENTS
 	};
 
+	// How the payload of a MsgFrameBox should be applied on the client
+	enum FrameBoxFlags
+	{
+		// Raw box pixels
+		FRAMEBOX_INTRA = 0,
+		// Raw box pixels which also belong to keyframe KeyframeId stored in KeyframeSlot
+		FRAMEBOX_KEYFRAME = 1,
+		// Box pixels XOR'ed against the same box of keyframe KeyframeId stored in KeyframeSlot
+		FRAMEBOX_DELTA = 2
+	};
+
 #pragma pack(push, 1)
 	struct MsgRegisterServer
 	{
@@ -116,6 +128,12 @@ namespace RTE
 		unsigned char BoxHeight;
 		unsigned short int DataSize;
 		unsigned short int UncompressedSize;
+
+		unsigned char Flags;
+		unsigned char KeyframeId;
+		unsigned char KeyframeSlot;
+		// Total number of boxes in the keyframe, both layers included
+		unsigned int KeyframeBoxes;
 	};
 
 	struct MsgDisconnect
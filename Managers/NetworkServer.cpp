@@ -31,6 +31,7 @@
 #include "Scene.h"
 #include "SLTerrain.h"
 #include "TimerMan.h"
+#include "ThreadMan.h"
 #include "AudioMan.h"
 #include "GameActivity.h"
 
@@ -45,6 +46,18 @@ namespace RTE
 {
 	const std::string NetworkServer::m_ClassName = "NetworkServer";
 
+	// 64-bit FNV-1a hash of box pixels, used to detect boxes which did not change since the last frame
+	unsigned long long HashFrameBox(const unsigned char * pData, int size)
+	{
+		unsigned long long hash = 14695981039346656037ULL;
+		for (int i = 0; i < size; i++)
+		{
+			hash ^= pData[i];
+			hash *= 1099511628211ULL;
+		}
+		return hash;
+	}
+
 	void BackgroundSendThreadFunction(NetworkServer * ns, int player)
 	{
 		while (ns->IsServerModeEnabled() && ns->IsPlayerConnected(player))
@@ -88,6 +101,20 @@ namespace RTE
 		}
 	}
 
+	int64_t NetworkServer::TakeEncodeTime()
+	{
+		std::lock_guard<std::mutex> lock(m_EncodeTimeMutex);
+		int64_t usecs = m_UsecEncodedSinceTaken;
+		m_UsecEncodedSinceTaken = 0;
+		return usecs;
+	}
+
+	void NetworkServer::AddEncodeTime(int64_t usecs)
+	{
+		std::lock_guard<std::mutex> lock(m_EncodeTimeMutex);
+		m_UsecEncodedSinceTaken += usecs;
+	}
+
 	//////////////////////////////////////////////////////////////////////////////////////////
 	// Method:          Clear
 	//////////////////////////////////////////////////////////////////////////////////////////
@@ -96,22 +123,61 @@ namespace RTE
 
 	void NetworkServer::Clear()
 	{
+		m_UsecEncodedSinceTaken = 0;
+
+		m_TerrainWidth = 0;
+		m_TerrainHeight = 0;
+		m_TerrainTilesX = 0;
+		m_TerrainTilesY = 0;
+		m_DirtyTerrainTiles.clear();
+		m_DirtyTerrainTileList.clear();
+		m_TerrainTileVersions.clear();
+		m_TerrainVersion = 0;
 
 		for (int i = 0; i < MAX_CLIENTS; i++)
 		{
 			m_pBackBuffer8[i] = 0;
 			m_pBackBufferGUI8[i] = 0;
 
+			m_SentTerrainVersion[i] = 0;
+			m_TerrainChangeRuns[i].clear();
+
 			m_LastFrameSentTime[i] = 0;
 			m_LastStatResetTime[i] = 0;
 
 			m_DelayedFrames[i] = 0;
 			m_MsecPerFrame[i] = 0;
 			m_MsecPerSendCall[i] = 0;
+			m_UsecPerPrepare[i] = 0;
+			m_UsecPerEncode[i] = 0;
+			m_UsecPerSend[i] = 0;
 
 			m_pLZ4CompressionState[i] = 0;
 			m_pLZ4FastCompressionState[i] = 0;
 
+			for (int slot = 0; slot < KEYFRAME_SLOTS; slot++)
+			{
+				m_pKeyframeBuffer8[i][slot] = 0;
+				m_pKeyframeBufferGUI8[i][slot] = 0;
+				m_KeyframeIds[i][slot] = -1;
+			}
+			m_AckedKeyframeSlot[i] = -1;
+			m_PendingKeyframeSlot[i] = -1;
+			m_LastKeyframeReceived[i] = -1;
+			m_NextKeyframeId[i] = 0;
+			m_FramesSinceKeyframe[i] = 0;
+			m_ForceKeyframe[i] = true;
+			m_BoxHashes[i].clear();
+
+			m_FrameBoxJobs[i].clear();
+			m_EncodedBoxes[i].clear();
+			m_EncodeScratch[i].clear();
+			m_pLZ4ChunkStates[i].clear();
+			m_pLZ4FastChunkStates[i].clear();
+			m_EncodeChunks[i] = 1;
+			m_EncodeKeyframe[i] = false;
+			m_EncodeReferenceSlot[i] = -1;
+
 			m_MouseState1[i] = 0;
 			m_MouseState2[i] = 0;
 			m_MouseState3[i] = 0;
@@ -170,6 +236,9 @@ namespace RTE
 
 			m_EmptyBlocks[i] = 0;
 			m_FullBlocks[i] = 0;
+			m_DeltaBlocks[i] = 0;
+			m_SkippedBlocks[i] = 0;
+			m_KeyframesSent[i] = 0;
 		}
 
 		m_UseHighCompression = true;
@@ -183,6 +252,10 @@ namespace RTE
 		m_TransmitAsBoxes = true;
 		m_BoxWidth = 32;
 		m_BoxHeight = 44;
+		m_UseDeltaCompression = true;
+		m_KeyframeInterval = 150;
+		m_BoxRefreshInterval = 30;
+		m_KeyframeAckTimeout = 30;
 		m_NatServerConnected = false;
 		m_LastPackedReceived.Reset();
 	}
@@ -220,6 +293,10 @@ namespace RTE
 		m_BoxWidth = g_SettingsMan.GetServerBoxWidth();
 		m_BoxHeight = g_SettingsMan.GetServerBoxHeight();
 
+		m_UseDeltaCompression = g_SettingsMan.GetServerUseDeltaCompression();
+		m_KeyframeInterval = MAX(g_SettingsMan.GetServerKeyframeInterval(), 1);
+		m_BoxRefreshInterval = MAX(g_SettingsMan.GetServerBoxRefreshInterval(), 1);
+
 		return 0;
 	}
 
@@ -281,6 +358,11 @@ namespace RTE
 			if (m_pLZ4FastCompressionState[i])
 				free(m_pLZ4FastCompressionState[i]);
 			m_pLZ4FastCompressionState[i] = 0;
+
+			for (int chunk = 0; chunk < m_pLZ4ChunkStates[i].size(); chunk++)
+				free(m_pLZ4ChunkStates[i][chunk]);
+			for (int chunk = 0; chunk < m_pLZ4FastChunkStates[i].size(); chunk++)
+				free(m_pLZ4FastChunkStates[i][chunk]);
 		}
 
 		Clear();
@@ -361,6 +443,9 @@ namespace RTE
 	{
 		RakNet::Packet *p;
 
+		// Hand the terrain changed since the last update over to the send threads
+		FlushTerrainChanges();
+
 		for (p = m_Server->Receive(); p; m_Server->DeallocatePacket(p), p = m_Server->Receive())
 		{
 			m_LastPackedReceived.Reset();
@@ -529,7 +614,9 @@ namespace RTE
 			}
 		}
 
-		DrawStatisticsData();
+		// Nobody is looking at the statistics when there is no window
+		if (!g_FrameMan.IsHeadless())
+			DrawStatisticsData();
 
 		// Clear sound events for unconnected players because AudioMan does not know about their state and stores broadcast sounds to their event lists
 		{
@@ -580,7 +667,7 @@ namespace RTE
 		guid += GetServerGuid().ToString();
 		g_FrameMan.GetLargeFont()->DrawAligned(&pGUIBitmap, midX, 5, guid, GUIFont::Centre);
 
-		char buf[256];
+		char buf[512];
 
 		if (m_NatServerConnected)
 		{
@@ -628,6 +715,9 @@ namespace RTE
 
 		m_FullBlocks[STATS_SUM] = 0;
 		m_EmptyBlocks[STATS_SUM] = 0;
+		m_DeltaBlocks[STATS_SUM] = 0;
+		m_SkippedBlocks[STATS_SUM] = 0;
+		m_KeyframesSent[STATS_SUM] = 0;
 
 
 		for (int i = 0; i < MAX_STAT_RECORDS; i++)
@@ -656,6 +746,9 @@ namespace RTE
 
 				m_FullBlocks[STATS_SUM] += m_FullBlocks[i];
 				m_EmptyBlocks[STATS_SUM] += m_EmptyBlocks[i];
+				m_DeltaBlocks[STATS_SUM] += m_DeltaBlocks[i];
+				m_SkippedBlocks[STATS_SUM] += m_SkippedBlocks[i];
+				m_KeyframesSent[STATS_SUM] += m_KeyframesSent[i];
 			}
 
 			// Update compression ratio
@@ -666,7 +759,7 @@ namespace RTE
 			if (m_MsecPerFrame[i] > 0)
 				fps = 1000 / m_MsecPerFrame[i];
 
-			sprintf(buf, "%s\nPing %u\nCmp Mbit: %.1f\nUnc Mbit: %.1f\nR: %.2f\nFrame Kbit: %lu\nGlow Kbit: %lu\nSound Kbit: %lu\nScene Kbit: %lu\nFrames sent: %uK\nFrame skipped: %uK\nBlocks full: %uK\nBlocks empty: %uK\nBlk Ratio: %.2f\nFPS: %d\nSend Ms %d\nTotal Data %lu MB",
+			sprintf(buf, "%s\nPing %u\nCmp Mbit: %.1f\nUnc Mbit: %.1f\nR: %.2f\nFrame Kbit: %lu\nGlow Kbit: %lu\nSound Kbit: %lu\nScene Kbit: %lu\nFrames sent: %uK\nFrame skipped: %uK\nBlocks full: %uK\nBlocks empty: %uK\nBlocks delta: %uK\nBlocks skipped: %uK\nKeyframes: %u\nBlk Ratio: %.2f\nFPS: %d\nSend Ms %d\nPrep/Enc/Snd Us %d/%d/%d\nTotal Data %lu MB",
 				i == STATS_SUM ? "- TOTALS - " : IsPlayerConnected(i) ? GetPlayerName(i).c_str() : "- NO PLAYER -",
 				i < MAX_CLIENTS ? m_Ping[i] : 0,
 				(double)m_DataSentCurrent[i][STAT_SHOWN] / (125000),
@@ -680,9 +773,15 @@ namespace RTE
 				m_FramesSkipped[i] / 1000,
 				m_FullBlocks[i] / 1000,
 				m_EmptyBlocks[i] / 1000,
+				m_DeltaBlocks[i] / 1000,
+				m_SkippedBlocks[i] / 1000,
+				m_KeyframesSent[i],
 				emptyRatio,
 				i < MAX_CLIENTS ? fps : 0,
 				i < MAX_CLIENTS ? m_MsecPerSendCall[i] : 0,
+				i < MAX_CLIENTS ? m_UsecPerPrepare[i] : 0,
+				i < MAX_CLIENTS ? m_UsecPerEncode[i] : 0,
+				i < MAX_CLIENTS ? m_UsecPerSend[i] : 0,
 				m_DataSentTotal[i] / (1024 * 1024));
 
 				g_FrameMan.GetLargeFont()->DrawAligned(&pGUIBitmap, 10 + i * g_FrameMan.GetResX() / 5, 75, buf, GUIFont::Left);
@@ -730,6 +829,96 @@ namespace RTE
 		if (m_pBackBufferGUI8)
 			destroy_bitmap(m_pBackBufferGUI8[player]);
 		m_pBackBufferGUI8[player] = 0;
+
+		for (int slot = 0; slot < KEYFRAME_SLOTS; slot++)
+		{
+			if (m_pKeyframeBuffer8[player][slot])
+				destroy_bitmap(m_pKeyframeBuffer8[player][slot]);
+			m_pKeyframeBuffer8[player][slot] = 0;
+
+			if (m_pKeyframeBufferGUI8[player][slot])
+				destroy_bitmap(m_pKeyframeBufferGUI8[player][slot]);
+			m_pKeyframeBufferGUI8[player][slot] = 0;
+		}
+
+		// Keyframes are gone, so the client must get a new one before any deltas
+		m_ForceKeyframe[player] = true;
+	}
+
+	void NetworkServer::ResetFrameDelta(int player)
+	{
+		// Only flag it, the sending thread owns the delta state and resets it in UpdateFrameDelta
+		m_ForceKeyframe[player] = true;
+	}
+
+	bool NetworkServer::UpdateFrameDelta(int player)
+	{
+		int columns = (m_pBackBuffer8[player]->w + m_BoxWidth - 1) / m_BoxWidth;
+		int rows = (m_pBackBuffer8[player]->h + m_BoxHeight - 1) / m_BoxHeight;
+
+		if (m_ForceKeyframe[player])
+		{
+			m_ForceKeyframe[player] = false;
+
+			// Neither of the keyframes can be trusted anymore
+			for (int slot = 0; slot < KEYFRAME_SLOTS; slot++)
+				m_KeyframeIds[player][slot] = -1;
+			m_AckedKeyframeSlot[player] = -1;
+			m_PendingKeyframeSlot[player] = -1;
+			m_BoxHashes[player].assign(columns * rows * 2, 0);
+
+			m_FramesSinceKeyframe[player] = m_KeyframeInterval;
+		}
+
+		// The client reports the last keyframe it received completely, promote it to the delta reference if it's the one we're waiting for
+		int pendingSlot = m_PendingKeyframeSlot[player];
+		if (pendingSlot >= 0 && m_KeyframeIds[player][pendingSlot] == m_LastKeyframeReceived[player])
+		{
+			m_AckedKeyframeSlot[player] = pendingSlot;
+			m_PendingKeyframeSlot[player] = -1;
+		}
+
+		bool sendKeyframe = false;
+		if (m_PendingKeyframeSlot[player] < 0)
+			sendKeyframe = m_AckedKeyframeSlot[player] < 0 || m_FramesSinceKeyframe[player] >= m_KeyframeInterval;
+		else
+			// Keyframe was probably lost, send a new one in its place
+			sendKeyframe = m_FramesSinceKeyframe[player] >= m_KeyframeAckTimeout;
+
+		m_FramesSinceKeyframe[player]++;
+
+		if (!sendKeyframe)
+			return false;
+
+		// Never overwrite the keyframe the client acknowledged, deltas are still built against it until the new one arrives
+		int slot = m_AckedKeyframeSlot[player] == 0 ? 1 : 0;
+
+		for (int layer = 0; layer < 2; layer++)
+		{
+			BITMAP * backBuffer = layer == 0 ? m_pBackBuffer8[player] : m_pBackBufferGUI8[player];
+			BITMAP * &keyframe = layer == 0 ? m_pKeyframeBuffer8[player][slot] : m_pKeyframeBufferGUI8[player][slot];
+
+			if (keyframe && (keyframe->w != backBuffer->w || keyframe->h != backBuffer->h))
+			{
+				destroy_bitmap(keyframe);
+				keyframe = 0;
+			}
+			if (!keyframe)
+				keyframe = create_bitmap_ex(8, backBuffer->w, backBuffer->h);
+
+			blit(backBuffer, keyframe, 0, 0, 0, 0, backBuffer->w, backBuffer->h);
+		}
+
+		m_KeyframeIds[player][slot] = m_NextKeyframeId[player];
+		m_NextKeyframeId[player] = (m_NextKeyframeId[player] + 1) % 256;
+		m_PendingKeyframeSlot[player] = slot;
+		m_FramesSinceKeyframe[player] = 0;
+		m_KeyframesSent[player]++;
+
+		if ((int)m_BoxHashes[player].size() != columns * rows * 2)
+			m_BoxHashes[player].assign(columns * rows * 2, 0);
+
+		return true;
 	}
 
 	void NetworkServer::SendSceneSetupData(int player)
@@ -837,83 +1026,127 @@ namespace RTE
 
 	void NetworkServer::RegisterTerrainChange(SceneMan::TerrainChange tc)
 	{
-		if (m_IsInServerMode)
+		if (!m_IsInServerMode)
+			return;
+
+		if (g_SceneMan.GetSceneWidth() != m_TerrainWidth || g_SceneMan.GetSceneHeight() != m_TerrainHeight)
+			ResizeTerrainTiles(g_SceneMan.GetSceneWidth(), g_SceneMan.GetSceneHeight());
+
+		int left = MAX(tc.x / TERRAIN_TILE_SIZE, 0);
+		int top = MAX(tc.y / TERRAIN_TILE_SIZE, 0);
+		int right = MIN((tc.x + tc.w - 1) / TERRAIN_TILE_SIZE, m_TerrainTilesX - 1);
+		int bottom = MIN((tc.y + tc.h - 1) / TERRAIN_TILE_SIZE, m_TerrainTilesY - 1);
+		int layerStart = tc.back ? m_TerrainTilesX * m_TerrainTilesY : 0;
+
+		// Only mark the tiles, however many times they change this frame they're sent once
+		for (int y = top; y <= bottom; y++)
 		{
-			for (int p = 0; p < MAX_CLIENTS; p++)
+			for (int x = left; x <= right; x++)
 			{
-				if (IsPlayerConnected(p))
+				int tile = layerStart + y * m_TerrainTilesX + x;
+				if (!m_DirtyTerrainTiles[tile])
 				{
-					m_Mutex[p].lock();
-					m_PendingTerrainChanges[p].push(tc);
-					m_Mutex[p].unlock();
+					m_DirtyTerrainTiles[tile] = true;
+					m_DirtyTerrainTileList.push_back(tile);
 				}
 			}
 		}
 	}
 
-	bool NetworkServer::NeedToProcessTerrainChanges(int player)
+	void NetworkServer::ResizeTerrainTiles(int width, int height)
 	{
-		bool result;
+		std::lock_guard<std::mutex> lock(m_TerrainTileMutex);
 
-		m_Mutex[player].lock();
-		result = !m_PendingTerrainChanges[player].empty();
-		m_Mutex[player].unlock();
+		m_TerrainWidth = width;
+		m_TerrainHeight = height;
+		m_TerrainTilesX = (width + TERRAIN_TILE_SIZE - 1) / TERRAIN_TILE_SIZE;
+		m_TerrainTilesY = (height + TERRAIN_TILE_SIZE - 1) / TERRAIN_TILE_SIZE;
 
-		return result;
+		// The version keeps counting up, so what the players have been sent stays valid
+		m_TerrainTileVersions.assign(2 * m_TerrainTilesX * m_TerrainTilesY, 0);
+		m_DirtyTerrainTiles.assign(m_TerrainTileVersions.size(), false);
+		m_DirtyTerrainTileList.clear();
 	}
 
-	void NetworkServer::ProcessTerrainChanges(int player)
+	void NetworkServer::FlushTerrainChanges()
 	{
-		m_Mutex[player].lock();
-		while (!m_PendingTerrainChanges[player].empty())
+		if (m_DirtyTerrainTileList.empty())
+			return;
+
+		std::lock_guard<std::mutex> lock(m_TerrainTileMutex);
+
+		m_TerrainVersion++;
+		for (std::vector<int>::const_iterator itr = m_DirtyTerrainTileList.begin(); itr != m_DirtyTerrainTileList.end(); ++itr)
 		{
-			m_CurrentTerrainChanges[player].push(m_PendingTerrainChanges[player].front());
-			m_PendingTerrainChanges[player].pop();
+			m_TerrainTileVersions[*itr] = m_TerrainVersion;
+			m_DirtyTerrainTiles[*itr] = false;
 		}
-		m_Mutex[player].unlock();
+		m_DirtyTerrainTileList.clear();
+	}
 
-		while (!m_CurrentTerrainChanges[player].empty())
-		{
-			int maxSize = 1280;
+	bool NetworkServer::NeedToProcessTerrainChanges(int player)
+	{
+		std::lock_guard<std::mutex> lock(m_TerrainTileMutex);
+		return m_SentTerrainVersion[player] != m_TerrainVersion;
+	}
 
-			SceneMan::TerrainChange tc = m_CurrentTerrainChanges[player].front();
-			m_CurrentTerrainChanges[player].pop();
+	void NetworkServer::ProcessTerrainChanges(int player)
+	{
+		// As many tiles as fit one packet are sent together, in runs along each row
+		const int maxRunTiles = MAX(1280 / (TERRAIN_TILE_SIZE * TERRAIN_TILE_SIZE), 1);
 
-			// Fragment region if it does not fit one packet
-			if (tc.w * tc.h > maxSize)
-			{
-				int size = 0;
-				int height = 1;
-				int heightStart = 0;
+		std::vector<SceneMan::TerrainChange> &runs = m_TerrainChangeRuns[player];
+		runs.clear();
 
-				for (int y = 0; y < tc.h; y++)
-				{
-					height++;
-					size += tc.w;
+		{
+			std::lock_guard<std::mutex> lock(m_TerrainTileMutex);
+			if (m_SentTerrainVersion[player] == m_TerrainVersion)
+				return;
 
-					// Store changed block if the size is over the MTU or if it's the last block.
-					if (size + tc.w >= maxSize || y == tc.h - 1)
+			unsigned int sentVersion = m_SentTerrainVersion[player];
+			int tile = 0;
+			for (int layer = 0; layer < 2; layer++)
+			{
+				for (int y = 0; y < m_TerrainTilesY; y++)
+				{
+					int runStart = -1;
+					for (int x = 0; x <= m_TerrainTilesX; x++, tile++)
 					{
-						SceneMan::TerrainChange tcf;
-						tcf.x = tc.x;
-						tcf.y = tc.y + heightStart;
-						tcf.w = tc.w;
-						tcf.h = height;
-						tcf.back = tc.back;
-						tcf.color = tc.color;
-
-						SendTerrainChangeMsg(player, tcf);
-
-						size = 0;
-						heightStart = y;
-						height = 1;
+						bool changed = x < m_TerrainTilesX && m_TerrainTileVersions[tile] > sentVersion;
+						if (changed && runStart < 0)
+							runStart = x;
+
+						// End the run at the first unchanged tile, the end of the row, or once the packet is full
+						if (runStart >= 0 && (!changed || x - runStart == maxRunTiles))
+						{
+							SceneMan::TerrainChange tc;
+							tc.x = runStart * TERRAIN_TILE_SIZE;
+							tc.y = y * TERRAIN_TILE_SIZE;
+							tc.w = MIN(x * TERRAIN_TILE_SIZE, m_TerrainWidth) - tc.x;
+							tc.h = MIN(tc.y + TERRAIN_TILE_SIZE, m_TerrainHeight) - tc.y;
+							tc.back = layer == 1;
+							tc.color = 0;
+							runs.push_back(tc);
+							runStart = changed ? x : -1;
+						}
 					}
+					// The loop went one past the row to close the last run
+					tile--;
 				}
 			}
-			else 
-			{
-				SendTerrainChangeMsg(player, tc);
-			}
+			m_SentTerrainVersion[player] = m_TerrainVersion;
+		}
+
+		SLTerrain * pTerrain = g_SceneMan.GetScene() ? g_SceneMan.GetScene()->GetTerrain() : 0;
+		if (!pTerrain)
+			return;
+
+		for (std::vector<SceneMan::TerrainChange>::iterator itr = runs.begin(); itr != runs.end(); ++itr)
+		{
+			// Single pixels are sent by color alone
+			if (itr->w == 1 && itr->h == 1)
+				itr->color = _getpixel(itr->back ? pTerrain->GetBGColorBitmap() : pTerrain->GetFGColorBitmap(), itr->x, itr->y);
+			SendTerrainChangeMsg(player, *itr);
 		}
 	}
 
@@ -1006,12 +1239,9 @@ namespace RTE
 
 	void NetworkServer::ClearTerrainChangeQueue(int player)
 	{
-		m_Mutex[player].lock();
-		while (!m_PendingTerrainChanges[player].empty())
-			m_PendingTerrainChanges[player].pop();
-		while (!m_CurrentTerrainChanges[player].empty())
-			m_CurrentTerrainChanges[player].pop();
-		m_Mutex[player].unlock();
+		// The whole scene is about to be sent, so all changes up to now are in it
+		std::lock_guard<std::mutex> lock(m_TerrainTileMutex);
+		m_SentTerrainVersion[player] = m_TerrainVersion;
 	}
 
 
@@ -1140,7 +1370,11 @@ namespace RTE
 	{
 		for (int player = 0; player < MAX_CLIENTS; player++)
 			if (m_ClientConnections[player].ClientId == p->systemAddress)
+			{
+				// Client has just cleared its screen and forgot its keyframes while loading the scene
+				ResetFrameDelta(player);
 				m_SendFrameData[player] = true;
+			}
 	}
 
 	void NetworkServer::SendPostEffectData(int player)
@@ -1473,25 +1707,37 @@ namespace RTE
 
 		m_SendEven[player] = !m_SendEven[player];
 
+		// Per stage timings
+		int64_t stageTicks = g_TimerMan.GetRealTickCount();
+		m_UsecPerPrepare[player] = (double)(stageTicks - currentTicks) / g_TimerMan.GetTicksPerSecond() * m_MicroSecs;
+
 		if (m_TransmitAsBoxes)
 		{
-			RTE::MsgFrameBox * frameData = (RTE::MsgFrameBox *)m_aPixelLineBuffer[player];
-			frameData->FrameNumber = m_FrameNumbers[player];
-
-			// Save msg ID
-			frameData->Id = ID_SRV_FRAME_BOX;
-			frameData->BoxWidth = m_BoxWidth;
-			frameData->BoxHeight = m_BoxHeight;
-
 			int bw = m_pBackBuffer8[player]->w / m_BoxWidth;
 			int bh = m_pBackBuffer8[player]->h / m_BoxHeight;
+			int columns = (m_pBackBuffer8[player]->w + m_BoxWidth - 1) / m_BoxWidth;
+			int boxSize = m_BoxWidth * m_BoxHeight;
+
+			m_EncodeKeyframe[player] = false;
+			m_EncodeReferenceSlot[player] = -1;
+
+			if (m_UseDeltaCompression)
+			{
+				m_EncodeKeyframe[player] = UpdateFrameDelta(player);
+				m_EncodeReferenceSlot[player] = m_AckedKeyframeSlot[player];
+			}
+
+			// Lay out the boxes to send this frame, each gets a fixed slot in the packet buffer so they can be encoded in any order
+			std::vector<FrameBoxJob> &jobs = m_FrameBoxJobs[player];
+			jobs.clear();
 
 			for (int by = 0; by <= bh; by++)
 			{
 				int step = 1;
 				int startLine = 0;
 
-				if (m_UseInterlacing)
+				// Keyframes must be complete, so they're never interlaced
+				if (m_UseInterlacing && !m_EncodeKeyframe[player])
 				{
 					step = 2;
 					if (m_SendEven[player])
@@ -1508,123 +1754,90 @@ namespace RTE
 					if (bpx >= m_pBackBuffer8[player]->w || bpy >= m_pBackBuffer8[player]->h)
 						break;
 
-					frameData->BoxX = bpx;
-					frameData->BoxY = bpy;
-
-					int maxWidth = m_BoxWidth;
-					if (bpx + m_BoxWidth >= m_pBackBuffer8[player]->w)
-					{
-						maxWidth = m_pBackBuffer8[player]->w - bpx;
-						frameData->BoxWidth = maxWidth;
-					}
-
-					int maxHeight = m_BoxHeight;
-					if (bpy + m_BoxHeight >= m_pBackBuffer8[player]->h)
-					{
-						maxHeight = m_pBackBuffer8[player]->h - bpy;
-						frameData->BoxHeight = maxHeight;
-					}
-
-					int size = maxWidth * maxHeight;
-					frameData->UncompressedSize = size;
-					frameData->DataSize = size;
-
 					for (int layer = 0; layer < 2; layer++)
 					{
-						bool boxIsEmpty = true;
-						int line = 0;
+						FrameBoxJob job;
+						job.X = bpx;
+						job.Y = bpy;
+						job.Width = MIN(m_BoxWidth, m_pBackBuffer8[player]->w - bpx);
+						job.Height = MIN(m_BoxHeight, m_pBackBuffer8[player]->h - bpy);
+						job.Layer = layer;
+						job.HashIndex = (by * columns + bx) * 2 + layer;
+						job.Hash = 0;
+						job.PacketOffset = jobs.size() * (sizeof(RTE::MsgFrameBox) + boxSize);
+						job.PacketSize = 0;
+						job.Result = FrameBoxJob::BOX_SKIPPED;
+						job.Delta = false;
+						jobs.push_back(job);
+					}
+				}
+			}
 
-						BITMAP * backBuffer = 0;
-						if (layer == 0)
-							backBuffer = m_pBackBuffer8[player];
-						if (layer == 1)
-							backBuffer = m_pBackBufferGUI8[player];
+			// More chunks than threads so a chunk full of empty boxes doesn't leave a thread idle
+			int chunks = MAX(MIN((g_ThreadMan.GetWorkerCount() + 1) * 2, (int)jobs.size()), 1);
+			m_EncodeChunks[player] = chunks;
+
+			int packetsSize = jobs.size() * (sizeof(RTE::MsgFrameBox) + boxSize);
+			if ((int)m_EncodedBoxes[player].size() < packetsSize)
+				m_EncodedBoxes[player].resize(packetsSize);
+			if ((int)m_EncodeScratch[player].size() < chunks * boxSize * 2)
+				m_EncodeScratch[player].resize(chunks * boxSize * 2);
+			// The first chunk uses the player's own LZ4 states, nothing else on this send thread compresses while the chunks run
+			while ((int)m_pLZ4ChunkStates[player].size() < chunks - 1)
+			{
+				m_pLZ4ChunkStates[player].push_back(malloc(LZ4_sizeofStateHC()));
+				m_pLZ4FastChunkStates[player].push_back(malloc(LZ4_sizeofState()));
+			}
 
-						frameData->Layer = layer;
+			// Compress the boxes on the shared pool, this send thread helps out
+			g_ThreadMan.RunParallelJobs(chunks, std::bind(&NetworkServer::EncodeFrameBoxes, this, player, std::placeholders::_1));
 
-						unsigned char * pDest = (unsigned char *)(m_aTerrainChangeBuffer[player]);
+			int64_t encodeTicks = g_TimerMan.GetRealTickCount();
+			m_UsecPerEncode[player] = (double)(encodeTicks - stageTicks) / g_TimerMan.GetTicksPerSecond() * m_MicroSecs;
+			stageTicks = encodeTicks;
+			AddEncodeTime(m_UsecPerEncode[player]);
 
-						// Copy block to line buffer and aso check if block is empty
-						for (line = 0; line < maxHeight; line++)
-						{
-							// Copy bitmap data
-							memcpy(pDest, backBuffer->line[bpy + line] + bpx, maxWidth);
-							pDest += maxWidth;
-						}
-						// Check if block is empty
-						unsigned long int * pixelInt = (unsigned long int *)m_aTerrainChangeBuffer[player];
-						int counter = 0;
-						for (counter = 0; counter < size; counter += sizeof(unsigned long int))
-						{
-							if (*pixelInt > 0)
-							{
-								boxIsEmpty = false;
-								break;
-							}
-							pixelInt++;
-						}
-						if (boxIsEmpty && counter > size)
-						{
-							pixelInt--;
-							counter -= sizeof(unsigned long int);
+			// The client drops deltas against a keyframe it doesn't have, so their boxes must not be taken as shown unless it has reported that one
+			int referenceKeyframeId = m_EncodeReferenceSlot[player] >= 0 ? m_KeyframeIds[player][m_EncodeReferenceSlot[player]] : -1;
+			bool referenceReceived = referenceKeyframeId >= 0 && referenceKeyframeId == m_LastKeyframeReceived[player];
 
-							unsigned char * pixelChr = (unsigned char *)pixelInt;
-							for (; counter < size; counter++)
-							{
-								if (*pixelChr > 0)
-								{
-									boxIsEmpty = false;
-									break;
-								}
-								pixelChr++;
-							}
-						}
+			// Send the packets in order
+			for (std::vector<FrameBoxJob>::iterator itr = jobs.begin(); itr != jobs.end(); ++itr)
+			{
+				if (itr->Result == FrameBoxJob::BOX_SKIPPED)
+				{
+					m_SkippedBlocks[player]++;
+					continue;
+				}
 
-						if (!boxIsEmpty)
-						{
-							int result = 0;
+				if (itr->Result == FrameBoxJob::BOX_FULL)
+					m_FullBlocks[player]++;
+				else
+					m_EmptyBlocks[player]++;
 
-							if (m_UseHighCompression)
-								result = LZ4_compress_HC_extStateHC(m_pLZ4CompressionState[player], (char *)m_aTerrainChangeBuffer[player], (char *)(m_aPixelLineBuffer[player] + sizeof(RTE::MsgFrameBox)), size, size, compressionMethod);
-							else if (m_UseFastCompression)
-								result = LZ4_compress_fast_extState(m_pLZ4FastCompressionState[player], (char *)m_aTerrainChangeBuffer[player], (char *)(m_aPixelLineBuffer[player] + sizeof(RTE::MsgFrameBox)), size, size, accelerationFactor);
+				if (itr->Delta)
+					m_DeltaBlocks[player]++;
 
-							// Compression failed or ineffective, send as is
-							if (result == 0 || result == backBuffer->w)
-							{
-								memcpy_s(m_aPixelLineBuffer[player] + sizeof(RTE::MsgFrameBox), MAX_PIXEL_LINE_BUFFER_SIZE, m_aTerrainChangeBuffer[player], size);
-							}
-							else
-							{
-								frameData->DataSize = result;
-							}
+				RTE::MsgFrameBox * frameData = (RTE::MsgFrameBox *)&m_EncodedBoxes[player][itr->PacketOffset];
+				int payloadSize = itr->PacketSize;
 
-							m_FullBlocks[player]++;
-						}
-						else
-						{
-							frameData->DataSize = 0;
-							m_EmptyBlocks[player]++;
-						}
+				m_Server->Send((const char *)frameData, payloadSize, MEDIUM_PRIORITY, UNRELIABLE_SEQUENCED, 0, m_ClientConnections[player].ClientId, false);
 
-						int payloadSize = frameData->DataSize + sizeof(RTE::MsgFrameBox);
+				// Only now is the box known to be sent, the same one won't be sent again until the next refresh
+				if (m_UseDeltaCompression && (!itr->Delta || referenceReceived))
+					m_BoxHashes[player][itr->HashIndex] = itr->Hash;
 
-						//if (!boxIsEmpty)
-							m_Server->Send((const char *)frameData, payloadSize, MEDIUM_PRIORITY, UNRELIABLE_SEQUENCED, 0, m_ClientConnections[player].ClientId, false);
-						//else
-						//	payloadSize = 0;
-						
-						m_DataSentCurrent[player][STAT_CURRENT] += payloadSize;
-						m_DataSentTotal[player] += payloadSize;
+				m_DataSentCurrent[player][STAT_CURRENT] += payloadSize;
+				m_DataSentTotal[player] += payloadSize;
 
-						m_FrameDataSentCurrent[player][STAT_CURRENT] += payloadSize;
-						m_FrameDataSentTotal[player] += payloadSize;
+				m_FrameDataSentCurrent[player][STAT_CURRENT] += payloadSize;
+				m_FrameDataSentTotal[player] += payloadSize;
 
-						m_DataUncompressedCurrent[player][STAT_CURRENT] += frameData->UncompressedSize;
-						m_DataUncompressedTotal[player] += frameData->UncompressedSize;
-					}
-				}
+				m_DataUncompressedCurrent[player][STAT_CURRENT] += frameData->UncompressedSize;
+				m_DataUncompressedTotal[player] += frameData->UncompressedSize;
 			}
+
+			m_UsecPerSend[player] = (double)(g_TimerMan.GetRealTickCount() - stageTicks) / g_TimerMan.GetTicksPerSecond() * m_MicroSecs;
 		}
 		else
 		{
@@ -1743,6 +1956,11 @@ namespace RTE
 					m_DataUncompressedTotal[player] += frameData->UncompressedSize;
 				}
 			}
+
+			// Lines are compressed and sent in one go
+			m_UsecPerEncode[player] = (double)(g_TimerMan.GetRealTickCount() - stageTicks) / g_TimerMan.GetTicksPerSecond() * m_MicroSecs;
+			m_UsecPerSend[player] = 0;
+			AddEncodeTime(m_UsecPerEncode[player]);
 		}
 
 		ProcessTerrainChanges(player);
@@ -1754,6 +1972,183 @@ namespace RTE
 		return 0;
 	}
 
+	void NetworkServer::EncodeFrameBoxes(int player, int chunk)
+	{
+		std::vector<FrameBoxJob> &jobs = m_FrameBoxJobs[player];
+		int firstJob = jobs.size() * chunk / m_EncodeChunks[player];
+		int lastJob = jobs.size() * (chunk + 1) / m_EncodeChunks[player];
+
+		int boxSize = m_BoxWidth * m_BoxHeight;
+		bool sendKeyframe = m_EncodeKeyframe[player];
+		int referenceSlot = m_EncodeReferenceSlot[player];
+
+		// Every chunk has its own scratch buffers and LZ4 states
+		unsigned char * pRawBuffer = &m_EncodeScratch[player][chunk * boxSize * 2];
+		unsigned char * pDeltaBuffer = pRawBuffer + boxSize;
+		void * pLZ4State = chunk == 0 ? m_pLZ4CompressionState[player] : m_pLZ4ChunkStates[player][chunk - 1];
+		void * pLZ4FastState = chunk == 0 ? m_pLZ4FastCompressionState[player] : m_pLZ4FastChunkStates[player][chunk - 1];
+
+		for (int j = firstJob; j < lastJob; j++)
+		{
+			FrameBoxJob &job = jobs[j];
+
+			int maxWidth = job.Width;
+			int maxHeight = job.Height;
+			int size = maxWidth * maxHeight;
+
+			RTE::MsgFrameBox * frameData = (RTE::MsgFrameBox *)&m_EncodedBoxes[player][job.PacketOffset];
+			frameData->Id = ID_SRV_FRAME_BOX;
+			frameData->FrameNumber = m_FrameNumbers[player];
+			frameData->Layer = job.Layer;
+			frameData->BoxX = job.X;
+			frameData->BoxY = job.Y;
+			frameData->BoxWidth = maxWidth;
+			frameData->BoxHeight = maxHeight;
+			frameData->UncompressedSize = size;
+			frameData->DataSize = size;
+			frameData->Flags = FRAMEBOX_INTRA;
+			frameData->KeyframeId = 0;
+			frameData->KeyframeSlot = 0;
+			frameData->KeyframeBoxes = m_BoxHashes[player].size();
+
+			bool boxIsEmpty = true;
+			int line = 0;
+
+			BITMAP * backBuffer = 0;
+			if (job.Layer == 0)
+				backBuffer = m_pBackBuffer8[player];
+			if (job.Layer == 1)
+				backBuffer = m_pBackBufferGUI8[player];
+
+			unsigned char * pDest = pRawBuffer;
+
+			// Copy block to line buffer and aso check if block is empty
+			for (line = 0; line < maxHeight; line++)
+			{
+				// Copy bitmap data
+				memcpy(pDest, backBuffer->line[job.Y + line] + job.X, maxWidth);
+				pDest += maxWidth;
+			}
+
+			// Box data to compress and send, either the raw pixels or their delta against the keyframe
+			unsigned char * pBoxData = pRawBuffer;
+
+			if (sendKeyframe)
+			{
+				frameData->Flags = FRAMEBOX_KEYFRAME;
+				frameData->KeyframeId = m_KeyframeIds[player][m_PendingKeyframeSlot[player]];
+				frameData->KeyframeSlot = m_PendingKeyframeSlot[player];
+
+				job.Hash = HashFrameBox(pBoxData, size);
+			}
+			else if (m_UseDeltaCompression)
+			{
+				job.Hash = HashFrameBox(pBoxData, size);
+
+				// Client already shows this box, unless the packet got lost. Boxes are resent every once in a while in a staggered way to repair that.
+				// The hashes are only read here, the sending loop records them after the chunks are done.
+				if (job.Hash == m_BoxHashes[player][job.HashIndex] && (m_FramesSinceKeyframe[player] + job.HashIndex) % m_BoxRefreshInterval != 0)
+				{
+					job.Result = FrameBoxJob::BOX_SKIPPED;
+					continue;
+				}
+
+				if (referenceSlot >= 0)
+				{
+					BITMAP * keyframe = job.Layer == 0 ? m_pKeyframeBuffer8[player][referenceSlot] : m_pKeyframeBufferGUI8[player][referenceSlot];
+
+					// XOR against the keyframe and see which representation has more zeroes, the more zeroes the better LZ4 does
+					unsigned char * pRaw = pRawBuffer;
+					unsigned char * pDelta = pDeltaBuffer;
+					int rawZeroes = 0;
+					int deltaZeroes = 0;
+
+					for (line = 0; line < maxHeight; line++)
+					{
+						unsigned char * pReference = keyframe->line[job.Y + line] + job.X;
+						for (int x = 0; x < maxWidth; x++)
+						{
+							*pDelta = *pRaw ^ pReference[x];
+							rawZeroes += *pRaw == 0;
+							deltaZeroes += *pDelta == 0;
+							pRaw++;
+							pDelta++;
+						}
+					}
+
+					if (deltaZeroes > rawZeroes)
+					{
+						pBoxData = pDeltaBuffer;
+						frameData->Flags = FRAMEBOX_DELTA;
+						frameData->KeyframeId = m_KeyframeIds[player][referenceSlot];
+						frameData->KeyframeSlot = referenceSlot;
+						job.Delta = true;
+					}
+				}
+			}
+
+			// Check if block is empty
+			unsigned long int * pixelInt = (unsigned long int *)pBoxData;
+			int counter = 0;
+			for (counter = 0; counter < size; counter += sizeof(unsigned long int))
+			{
+				if (*pixelInt > 0)
+				{
+					boxIsEmpty = false;
+					break;
+				}
+				pixelInt++;
+			}
+			if (boxIsEmpty && counter > size)
+			{
+				pixelInt--;
+				counter -= sizeof(unsigned long int);
+
+				unsigned char * pixelChr = (unsigned char *)pixelInt;
+				for (; counter < size; counter++)
+				{
+					if (*pixelChr > 0)
+					{
+						boxIsEmpty = false;
+						break;
+					}
+					pixelChr++;
+				}
+			}
+
+			if (!boxIsEmpty)
+			{
+				int result = 0;
+				char * pPayload = (char *)frameData + sizeof(RTE::MsgFrameBox);
+
+				if (m_UseHighCompression)
+					result = LZ4_compress_HC_extStateHC(pLZ4State, (char *)pBoxData, pPayload, size, size, m_HighCompressionLevel);
+				else if (m_UseFastCompression)
+					result = LZ4_compress_fast_extState(pLZ4FastState, (char *)pBoxData, pPayload, size, size, m_FastAccelerationFactor);
+
+				// Compression failed or ineffective, send as is
+				if (result == 0 || result == backBuffer->w)
+				{
+					memcpy_s(pPayload, boxSize, pBoxData, size);
+				}
+				else
+				{
+					frameData->DataSize = result;
+				}
+
+				job.Result = FrameBoxJob::BOX_FULL;
+			}
+			else
+			{
+				// For delta boxes this means the box is identical to the keyframe
+				frameData->DataSize = 0;
+				job.Result = FrameBoxJob::BOX_EMPTY;
+			}
+
+			job.PacketSize = frameData->DataSize + sizeof(RTE::MsgFrameBox);
+		}
+	}
+
 	void NetworkServer::ReceiveDisconnection(RakNet::Packet * p)
 	{
 		std::string msg = "ID_CONNECTION_LOST from";
@@ -1980,6 +2375,9 @@ namespace RTE
 			msg.InputElementReleased = m->InputElementReleased;
 			msg.InputElementHeld = m->InputElementHeld;
 
+			msg.LastKeyframeReceived = m->LastKeyframeReceived;
+			m_LastKeyframeReceived[player] = m->LastKeyframeReceived;
+
 
 			bool skip = true;
 
@@ -22,6 +22,8 @@
 
 #include "boost\thread.hpp"
 #include <mutex>
+#include <atomic>
+#include <vector>
 
 #include "TimerMan.h"
 
@@ -34,6 +36,9 @@
 #define STAT_CURRENT 0
 #define STAT_SHOWN 1
 
+// Side of the square tiles terrain changes are tracked and sent in, in pixels
+#define TERRAIN_TILE_SIZE 16
+
 #define g_NetworkServer NetworkServer::Instance()
 
 namespace RTE
@@ -165,6 +170,41 @@ namespace RTE
 
 		void DestroyBackBuffer(int player);
 
+		//////////////////////////////////////////////////////////////////////////////////////////
+		// Method:          ResetFrameDelta
+		//////////////////////////////////////////////////////////////////////////////////////////
+		// Description:     Makes the sending thread forget all box hashes and keyframes of a
+		//                  player, so the next frame is sent as a fresh keyframe. Must be called
+		//                  whenever the client's picture can no longer be trusted, e.g. after
+		//                  a scene change.
+		// Arguments:       Player to reset.
+		// Return value:    None.
+
+		void ResetFrameDelta(int player);
+
+		//////////////////////////////////////////////////////////////////////////////////////////
+		// Method:          UpdateFrameDelta
+		//////////////////////////////////////////////////////////////////////////////////////////
+		// Description:     Picks up the keyframe acknowledged by the client and decides whether
+		//                  the frame in the player's back buffers goes out as a new keyframe,
+		//                  in which case it is also stored as the pending delta reference.
+		// Arguments:       Player to update.
+		// Return value:    Whether the current frame must be sent as a keyframe.
+
+		bool UpdateFrameDelta(int player);
+
+		//////////////////////////////////////////////////////////////////////////////////////////
+		// Method:          EncodeFrameBoxes
+		//////////////////////////////////////////////////////////////////////////////////////////
+		// Description:     Encodes one chunk of the frame boxes laid out by SendFrame into their
+		//                  packet slots. Chunks of the same frame run in parallel on the
+		//                  ThreadMan pool, each with its own scratch buffers and LZ4 states.
+		// Arguments:       Player whose frame is being encoded.
+		//                  Index of the chunk of boxes to encode.
+		// Return value:    None.
+
+		void EncodeFrameBoxes(int player, int chunk);
+
 		std::string & GetPlayerName(int player);
 
 		void SetThreadExitReason(int player, int reason) { m_ThreadExitReason[player] = reason; };
@@ -193,6 +233,7 @@ namespace RTE
 
 		void ReceiveSceneAcceptedMsg(RakNet::Packet * p);
 
+		// Marks the terrain tiles under a change to be sent to all players. Sim thread only
 		void RegisterTerrainChange(SceneMan::TerrainChange tc);
 
 		void NetworkServer::ClearTerrainChangeQueue(int player);
@@ -231,6 +272,9 @@ namespace RTE
 
 		unsigned int GetPing(int player) const { return m_Ping[player]; }
 
+		// Returns the time the send threads have spent encoding frames since the last call, in microseconds
+		int64_t TakeEncodeTime();
+
 		//////////////////////////////////////////////////////////////////////////////////////////
 		// Protected member variable and method declarations
 
@@ -250,6 +294,31 @@ namespace RTE
 
 		ClientConnection m_ClientConnections[MAX_CLIENTS];
 
+		// One box layer to be encoded and sent this frame
+		struct FrameBoxJob
+		{
+			enum BoxResult
+			{
+				BOX_SKIPPED = 0,
+				BOX_EMPTY,
+				BOX_FULL
+			};
+
+			int X;
+			int Y;
+			int Width;
+			int Height;
+			int Layer;
+			// Index into m_BoxHashes, and the hash of the box to record there once it's sent
+			int HashIndex;
+			unsigned long long Hash;
+			// Where the finished packet lives in m_EncodedBoxes
+			int PacketOffset;
+			int PacketSize;
+			BoxResult Result;
+			bool Delta;
+		};
+
 		// Member variables
 		static const std::string m_ClassName;
 
@@ -303,6 +372,12 @@ namespace RTE
 
 		int m_FullBlocks[MAX_STAT_RECORDS];
 
+		int m_DeltaBlocks[MAX_STAT_RECORDS];
+
+		int m_SkippedBlocks[MAX_STAT_RECORDS];
+
+		int m_KeyframesSent[MAX_STAT_RECORDS];
+
 		int m_SendBufferBytes[MAX_STAT_RECORDS];
 
 		int m_SendBufferMessages[MAX_STAT_RECORDS];
@@ -313,6 +388,11 @@ namespace RTE
 
 		int m_MsecPerSendCall[MAX_CLIENTS];
 
+		// Time spent in each stage of the last SendFrame call, in microseconds
+		int m_UsecPerPrepare[MAX_CLIENTS];
+		int m_UsecPerEncode[MAX_CLIENTS];
+		int m_UsecPerSend[MAX_CLIENTS];
+
 		BITMAP * m_pBackBuffer8[MAX_CLIENTS];
 
 		BITMAP * m_pBackBufferGUI8[MAX_CLIENTS];
@@ -361,11 +441,38 @@ namespace RTE
 		bool m_SendFrameData[MAX_CLIENTS];
 		std::mutex m_SceneLock[MAX_CLIENTS];
 
-		std::queue<SceneMan::TerrainChange> m_PendingTerrainChanges[MAX_CLIENTS];
+		// Size of the scene the terrain tiles cover, in pixels, and of the tile grid of each layer, in tiles
+		int m_TerrainWidth;
+		int m_TerrainHeight;
+		int m_TerrainTilesX;
+		int m_TerrainTilesY;
+
+		// The foreground then background tiles changed since the last FlushTerrainChanges, and a list of them. Sim thread only
+		std::vector<bool> m_DirtyTerrainTiles;
+		std::vector<int> m_DirtyTerrainTileList;
+
+		// The terrain version each tile was last changed in, and the latest version flushed. Guarded by m_TerrainTileMutex
+		std::vector<unsigned int> m_TerrainTileVersions;
+		unsigned int m_TerrainVersion;
+		std::mutex m_TerrainTileMutex;
+
+		// The terrain version each player has been sent all changed tiles up to. Guarded by m_TerrainTileMutex
+		unsigned int m_SentTerrainVersion[MAX_CLIENTS];
+		// The runs of changed tiles to send to each player, kept to reuse their memory. Send threads only
+		std::vector<SceneMan::TerrainChange> m_TerrainChangeRuns[MAX_CLIENTS];
 
-		std::queue<SceneMan::TerrainChange> m_CurrentTerrainChanges[MAX_CLIENTS];
+		// Makes the terrain tiles cover a scene of a new size, forgetting all changes
+		void ResizeTerrainTiles(int width, int height);
 
-		std::mutex m_Mutex[MAX_CLIENTS];
+		// Stamps the tiles changed since the last call with a new terrain version, so the send threads pick them up
+		void FlushTerrainChanges();
+
+		// Time spent encoding frames on all send threads since TakeEncodeTime was last called, in microseconds
+		int64_t m_UsecEncodedSinceTaken;
+		std::mutex m_EncodeTimeMutex;
+
+		// Adds to the time spent encoding frames, called from the send threads
+		void AddEncodeTime(int64_t usecs);
 
 		//std::mutex m_InputQueueMutex[MAX_CLIENTS];
 		std::queue<NetworkClient::MsgInput>m_InputMessages[MAX_CLIENTS];
@@ -391,6 +498,44 @@ namespace RTE
 		int m_BoxWidth;
 		int m_BoxHeight;
 
+		// Skip unchanged boxes and send changed ones as XOR deltas against the last acknowledged keyframe
+		bool m_UseDeltaCompression;
+		int m_KeyframeInterval;
+		int m_BoxRefreshInterval;
+		// How many frames to wait for a keyframe acknowledgement before sending another one
+		int m_KeyframeAckTimeout;
+
+		// Copies of the frames sent as keyframes, XOR reference for delta boxes
+		BITMAP * m_pKeyframeBuffer8[MAX_CLIENTS][KEYFRAME_SLOTS];
+		BITMAP * m_pKeyframeBufferGUI8[MAX_CLIENTS][KEYFRAME_SLOTS];
+		// Id of the keyframe stored in each slot, -1 if the slot is empty
+		int m_KeyframeIds[MAX_CLIENTS][KEYFRAME_SLOTS];
+		// Slot of the keyframe the client has fully received, -1 if none yet
+		int m_AckedKeyframeSlot[MAX_CLIENTS];
+		// Slot of the keyframe sent but not yet acknowledged, -1 if none
+		int m_PendingKeyframeSlot[MAX_CLIENTS];
+		// Id of the last complete keyframe reported by the client, written by the receiving thread and read by the sending one
+		std::atomic<int> m_LastKeyframeReceived[MAX_CLIENTS];
+		int m_NextKeyframeId[MAX_CLIENTS];
+		int m_FramesSinceKeyframe[MAX_CLIENTS];
+		bool m_ForceKeyframe[MAX_CLIENTS];
+		// Hash of every box layer as it was last sent, indexed by (row * columns + column) * 2 + layer
+		std::vector<unsigned long long> m_BoxHashes[MAX_CLIENTS];
+
+		// Boxes of the frame being sent, in sending order
+		std::vector<FrameBoxJob> m_FrameBoxJobs[MAX_CLIENTS];
+		// Fixed size packet slot for every box job, filled in by the encoding chunks
+		std::vector<unsigned char> m_EncodedBoxes[MAX_CLIENTS];
+		// Raw and delta box scratch buffers of each encoding chunk
+		std::vector<unsigned char> m_EncodeScratch[MAX_CLIENTS];
+		// LZ4 states of each encoding chunk after the first, which uses the player's own. OWNED!!!
+		std::vector<void *> m_pLZ4ChunkStates[MAX_CLIENTS];
+		std::vector<void *> m_pLZ4FastChunkStates[MAX_CLIENTS];
+		// Parameters of the frame being encoded, read by all the chunks
+		int m_EncodeChunks[MAX_CLIENTS];
+		bool m_EncodeKeyframe[MAX_CLIENTS];
+		int m_EncodeReferenceSlot[MAX_CLIENTS];
+
 		bool m_NatServerConnected;
 
 		RakNet::SystemAddress m_NATServiceServerID;
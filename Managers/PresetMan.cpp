@@ -46,6 +46,7 @@ void PresetMan::Clear()
     m_DataModuleIDs.clear();
     m_OfficialModuleCount = 0;
     m_TotalGroupRegister.clear();
+    m_PresetIndex.clear();
 }
 
 /*
@@ -158,6 +159,10 @@ bool PresetMan::LoadDataModule(string moduleName, bool official, void (*fpProgre
 
         // Adjust offical tally
         m_OfficialModuleCount++;
+
+        // Any non-official modules after this one just had their IDs bumped up
+        if (m_pDataModules.size() > m_OfficialModuleCount)
+            RebuildPresetIndex();
     }
     // Non-official modules are just added the end
     else
@@ -292,7 +297,13 @@ bool PresetMan::AddEntityPreset(Entity *pEntToAdd, int whichModule, bool overwri
 {
     AAssert(whichModule >= 0 && whichModule < m_pDataModules.size(), "Tried to access an out of bounds data module number!");
 
-    return m_pDataModules[whichModule]->AddEntityPreset(pEntToAdd, overwriteSame, readFromFile);
+    if (!m_pDataModules[whichModule]->AddEntityPreset(pEntToAdd, overwriteSame, readFromFile))
+        return false;
+
+    // Overwritten presets are cloned into the existing instance, so this only changes anything for new ones
+    AddToPresetIndex(m_pDataModules[whichModule]->GetEntityPreset(pEntToAdd->GetClassName(), pEntToAdd->GetPresetName()), whichModule);
+
+    return true;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -304,8 +315,6 @@ const Entity * PresetMan::GetEntityPreset(string type, string preset, int whichM
 {
     AAssert(whichModule < (int)m_pDataModules.size(), "Tried to access an out of bounds data module number!");
 
-    const Entity *pRetEntity = 0;
-
     // Preset name might have "[ModuleName]/" preceding it, detect it here and select proper module!
     int slashPos = preset.find_first_of('/');
     if (slashPos != string::npos)
@@ -315,27 +324,34 @@ const Entity * PresetMan::GetEntityPreset(string type, string preset, int whichM
         preset = preset.substr(slashPos + 1);
     }
 
-    // All modules
-    if (whichModule < 0)
-    {
-        // Search all modules
-        for (int i = 0; i < m_pDataModules.size() && !pRetEntity; ++i)
-            pRetEntity = m_pDataModules[i]->GetEntityPreset(type, preset);
-    }
-    // Specific module
-    else
-    {
-        // Try to get it from the asked for module
+    return GetIndexedPreset(type, preset, whichModule);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetIndexedPreset
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets a previously read in (defined) Entity, by exact type and preset
+//                  name, without parsing any module specifier out of the name.
+
+const Entity * PresetMan::GetIndexedPreset(const std::string &type, const std::string &preset, int whichModule)
+{
+    const Entity *pRetEntity = 0;
+
+    // Specific module; try to get it from the asked for module first
+    if (whichModule >= 0)
         pRetEntity = m_pDataModules[whichModule]->GetEntityPreset(type, preset);
 
-        // If couldn't find it in there, then try all the official modules!
-        if (!pRetEntity)
+    // If all modules were asked for, or couldn't find it in the specific one, then look where it is first found in all or the official modules
+    if (!pRetEntity)
+    {
+        AAssert(m_OfficialModuleCount <= m_pDataModules.size(), "More official modules than modules loaded?!");
+        unordered_map<string, unordered_map<string, PresetIndexEntry> >::const_iterator clsItr = m_PresetIndex.find(type);
+        if (clsItr != m_PresetIndex.end())
         {
-            AAssert(m_OfficialModuleCount <= m_pDataModules.size(), "More official modules than modules loaded?!");
-            for (int i = 0; i < m_OfficialModuleCount && !pRetEntity; ++i)
-            {
-                pRetEntity = m_pDataModules[i]->GetEntityPreset(type, preset);
-            }
+            unordered_map<string, PresetIndexEntry>::const_iterator presetItr = clsItr->second.find(preset);
+            if (presetItr != clsItr->second.end())
+                pRetEntity = whichModule < 0 ? presetItr->second.m_pFirst : presetItr->second.m_pFirstOfficial;
         }
     }
 
@@ -385,17 +401,11 @@ const Entity * PresetMan::GetEntityPreset(Reader &reader)
 		else if (pNewInstance)
 		{
 			// Try to add the instance to the collection
-			m_pDataModules[whichModule]->AddEntityPreset(pNewInstance, reader.GetPresetOverwriting(), entityFilePath);
+			AddEntityPreset(pNewInstance, whichModule, reader.GetPresetOverwriting(), entityFilePath);
 
 			// Regardless of whether there was a collision or not, use whatever now exists in the instance map of that class and name
-			pReturnPreset = m_pDataModules[whichModule]->GetEntityPreset(pNewInstance->GetClassName(), pNewInstance->GetPresetName());
-			// If the instance wasn't found in the specific DataModule, try to find it in all the official ones instead
-			if (!pReturnPreset)
-			{
-				AAssert(m_OfficialModuleCount <= m_pDataModules.size(), "More official modules than modules loaded?!");
-				for (int i = 0; i < m_OfficialModuleCount && !pReturnPreset; ++i)
-					pReturnPreset = m_pDataModules[i]->GetEntityPreset(pNewInstance->GetClassName(), pNewInstance->GetPresetName());
-			}
+			// If the instance wasn't found in the specific DataModule, this finds it in the official ones instead
+			pReturnPreset = GetIndexedPreset(pNewInstance->GetClassName(), pNewInstance->GetPresetName(), whichModule);
 		}
         // Get rid of the read-in instance as its copy is now either added to the map, or discarded as there already was somehting in there of the same name.
         delete pNewInstance; pNewInstance = 0;
@@ -445,7 +455,7 @@ Entity * PresetMan::ReadReflectedPreset(Reader &reader)
 		{
 			// Try to add the instance to the collection.
 			// Note that we'll return this instance regardless of whether the adding was succesful or not
-			m_pDataModules[whichModule]->AddEntityPreset(pNewInstance, reader.GetPresetOverwriting(), entityFilePath);
+			AddEntityPreset(pNewInstance, whichModule, reader.GetPresetOverwriting(), entityFilePath);
 		    return pNewInstance;
 		}
     }
@@ -1048,4 +1058,52 @@ Actor * PresetMan::GetLoadout(std::string loadoutName, int moduleNumber, bool sp
 
 
 
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          AddToPresetIndex
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Records a preset in the cross-module preset index, if it is found
+//                  before any other of the same exact class and name.
+
+void PresetMan::AddToPresetIndex(const Entity *pPreset, int whichModule)
+{
+    if (!pPreset)
+        return;
+
+    PresetIndexEntry &entry = m_PresetIndex[pPreset->GetClassName()][pPreset->GetPresetName()];
+
+    // Modules are searched in order, so the lowest numbered one containing the preset wins
+    if (!entry.m_pFirst || whichModule < entry.m_FirstModule)
+    {
+        entry.m_pFirst = pPreset;
+        entry.m_FirstModule = whichModule;
+    }
+    if (whichModule < m_OfficialModuleCount && (!entry.m_pFirstOfficial || whichModule < entry.m_FirstOfficialModule))
+    {
+        entry.m_pFirstOfficial = pPreset;
+        entry.m_FirstOfficialModule = whichModule;
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RebuildPresetIndex
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Rebuilds the cross-module preset index from all loaded modules.
+
+void PresetMan::RebuildPresetIndex()
+{
+    m_PresetIndex.clear();
+
+    list<Entity *> presetList;
+    for (int module = 0; module < m_pDataModules.size(); ++module)
+    {
+        presetList.clear();
+        m_pDataModules[module]->GetAllOfType(presetList, "Entity");
+        // The Entity typelist has every preset of the module, each exactly once
+        for (list<Entity *>::iterator itr = presetList.begin(); itr != presetList.end(); ++itr)
+            AddToPresetIndex(*itr, module);
+    }
+}
+
 } // namespace RTE
\ No newline at end of file
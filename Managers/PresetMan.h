@@ -16,6 +16,7 @@
 
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <string>
 
 #include "DDTTools.h"
@@ -511,6 +512,58 @@ public:
 
 protected:
 
+    // Where a preset of a particular exact class and name is first found when searching the modules in order
+    struct PresetIndexEntry
+    {
+        PresetIndexEntry() { m_pFirst = 0; m_FirstModule = -1; m_pFirstOfficial = 0; m_FirstOfficialModule = -1; }
+
+        // The preset found in the lowest numbered module, and that module's ID
+        const Entity *m_pFirst;
+        int m_FirstModule;
+        // The preset found in the lowest numbered official module, and that module's ID
+        const Entity *m_pFirstOfficial;
+        int m_FirstOfficialModule;
+    };
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetIndexedPreset
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets a previously read in (defined) Entity, by exact type and preset
+//                  name, without parsing any module specifier out of the name. If it
+//                  isn't in the specified module, the official modules are looked in.
+// Arguments:       The exact type name of the Entity to get.
+//                  The preset name of the Entity to get.
+//                  The module ID to look first in, or -1 to look in all modules.
+// Return value:    The preset found in the lowest numbered module searched, or 0 if none
+//                  was found. Ownership is NOT transferred!
+
+    const Entity * GetIndexedPreset(const std::string &type, const std::string &preset, int whichModule);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          AddToPresetIndex
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Records a preset in the cross-module preset index, if it is found
+//                  before any other of the same exact class and name.
+// Arguments:       The preset to record. Ownership is NOT transferred!
+//                  The ID of the module the preset is in.
+// Return value:    None.
+
+    void AddToPresetIndex(const Entity *pPreset, int whichModule);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RebuildPresetIndex
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Rebuilds the cross-module preset index from all loaded modules. Needed
+//                  when module IDs shift because of an official module being inserted.
+// Arguments:       None.
+// Return value:    None.
+
+    void RebuildPresetIndex();
+
+
     // Member variables
     static const std::string m_ClassName;
 
@@ -529,6 +582,10 @@ protected:
     // This is just a handy total of all the groups registered in all the individual DataModule:s
     std::list<std::string> m_TotalGroupRegister;
 
+    // Map of <EXACT class names and <map of preset names and where that preset is first found among the modules> >
+    // This is what lets all-module and official module fallback lookups skip searching each module in turn
+    std::unordered_map<std::string, std::unordered_map<std::string, PresetIndexEntry> > m_PresetIndex;
+
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // Private member variable and method declarations
@@ -13,6 +13,10 @@
 #include "LicenseMan.h"
 #include "SettingsMan.h"
 #include "TimerMan.h"
+#include "ThreadMan.h"
+#include "ReplayMan.h"
+#include "BenchmarkMan.h"
+#include "TraceMan.h"
 #include "FrameMan.h"
 #include "PresetMan.h"
 #include "AudioMan.h"
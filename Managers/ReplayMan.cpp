@@ -0,0 +1,689 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// File:            ReplayMan.cpp
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Source file for the ReplayMan class.
+// Project:         Retro Terrain Engine
+// Author(s):
+//
+//
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Inclusions of header files
+
+#include "ReplayMan.h"
+#include "SettingsMan.h"
+#include "ActivityMan.h"
+#include "PresetMan.h"
+#include "TimerMan.h"
+#include "MovableMan.h"
+#include "SceneMan.h"
+#include "Scene.h"
+#include "SLTerrain.h"
+#include "ConsoleMan.h"
+#include "Reader.h"
+#include "Writer.h"
+#include "DDTTools.h"
+
+#include <fstream>
+#include <cstring>
+#include <ctime>
+
+using namespace std;
+
+namespace RTE
+{
+
+const string ReplayMan::m_ClassName = "ReplayMan";
+const char ReplayMan::m_sTickTag = 'T';
+const char ReplayMan::m_sRepeatTag = 'R';
+const char ReplayMan::m_sHashTag = 'H';
+const char ReplayMan::m_sEndTag = 'E';
+const int ReplayMan::m_sDefaultHashInterval = 60;
+const int ReplayMan::m_sMaxTickRecords = 256;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Operator:        ControlRecord equality
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Shows whether two controller states are exactly the same.
+
+bool ReplayMan::ControlRecord::operator==(const ControlRecord &rhs) const
+{
+    return m_Player == rhs.m_Player && m_States == rhs.m_States &&
+           m_AnalogMove[0] == rhs.m_AnalogMove[0] && m_AnalogMove[1] == rhs.m_AnalogMove[1] &&
+           m_AnalogAim[0] == rhs.m_AnalogAim[0] && m_AnalogAim[1] == rhs.m_AnalogAim[1] &&
+           m_AnalogCursor[0] == rhs.m_AnalogCursor[0] && m_AnalogCursor[1] == rhs.m_AnalogCursor[1] &&
+           m_MouseMovement[0] == rhs.m_MouseMovement[0] && m_MouseMovement[1] == rhs.m_MouseMovement[1];
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Clear
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Clears all the member variables of this ReplayMan, effectively
+//                  resetting the members of this abstraction level only.
+
+void ReplayMan::Clear()
+{
+    m_Mode = REPLAY_OFF;
+    m_RecordPath.clear();
+    m_ReplayPath.clear();
+    m_pOutStream = 0;
+    m_pInStream = 0;
+    m_HashInterval = m_sDefaultHashInterval;
+    m_Seed = 0;
+    m_TickCount = 0;
+    m_InSimTick = false;
+    m_TickRecords.clear();
+    m_LastTickRecords.clear();
+    m_RecordsReplayed.clear();
+    m_RepeatCount = 0;
+    m_HashesChecked = 0;
+    m_DivergenceCount = 0;
+    m_FirstDivergentTick = -1;
+    m_ReplayFinished = false;
+    m_SettingsOverridden = false;
+    m_OldAsyncPathFinding = false;
+    m_OldPathFindingBudget = 0;
+    m_OldLuaScriptBudget = 0;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Create
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Makes the ReplayMan object ready for use.
+
+int ReplayMan::Create()
+{
+    return 0;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Destroy
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Finishes any recording or replay in progress and resets (through
+//                  Clear()) the ReplayMan object.
+
+void ReplayMan::Destroy()
+{
+    Stop();
+    Clear();
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          StartActivity
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Starts recording or replaying, if a path has been set, and finishes
+//                  any recording or replay in progress.
+
+int ReplayMan::StartActivity()
+{
+    // A restart ends whatever was going on, it wasn't recorded
+    Stop();
+
+    int error = 0;
+    if (!m_RecordPath.empty())
+    {
+        error = StartRecording();
+    }
+    else if (!m_ReplayPath.empty())
+    {
+        error = StartReplay();
+        m_ReplayPath.clear();
+    }
+
+    if (error < 0)
+        Stop();
+    return error;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Stop
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Finishes the recording or replay in progress, if any, and puts the
+//                  overridden settings back.
+
+void ReplayMan::Stop()
+{
+    char report[512];
+
+    if (m_Mode == REPLAY_RECORDING && m_pOutStream)
+    {
+        FlushRepeats();
+        m_pOutStream->put(m_sEndTag);
+        WriteVarInt(m_TickCount);
+        sprintf(report, "SYSTEM: Recorded %lld sim updates", m_TickCount);
+        g_ConsoleMan.PrintString(report);
+    }
+    else if (m_Mode == REPLAY_PLAYING)
+    {
+        if (!m_ReplayFinished)
+        {
+            sprintf(report, "WARNING: Replay cut short after %lld sim updates!", m_TickCount);
+            g_ConsoleMan.PrintString(report);
+        }
+        sprintf(report, "SYSTEM: Replayed %lld sim updates, %i of %i state hashes matched", m_TickCount, m_HashesChecked - m_DivergenceCount, m_HashesChecked);
+        g_ConsoleMan.PrintString(report);
+        if (m_DivergenceCount > 0)
+        {
+            sprintf(report, "WARNING: Replay first diverged at sim update %lld!", m_FirstDivergentTick);
+            g_ConsoleMan.PrintString(report);
+        }
+    }
+
+    delete m_pOutStream;
+    m_pOutStream = 0;
+    delete m_pInStream;
+    m_pInStream = 0;
+    m_Mode = REPLAY_OFF;
+    m_InSimTick = false;
+    m_TickRecords.clear();
+    m_LastTickRecords.clear();
+    m_RecordsReplayed.clear();
+    m_RepeatCount = 0;
+
+    if (m_SettingsOverridden)
+    {
+        g_SettingsMan.SetAsyncPathFinding(m_OldAsyncPathFinding);
+        g_SettingsMan.SetPathFindingBudget(m_OldPathFindingBudget);
+        g_SettingsMan.SetLuaScriptBudget(m_OldLuaScriptBudget);
+        m_SettingsOverridden = false;
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          BeginSimTick
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Marks the start of a sim update. Seeds the random number generator for
+//                  it, and when replaying, reads the recorded controller states for it.
+
+void ReplayMan::BeginSimTick()
+{
+    if (m_Mode == REPLAY_OFF)
+        return;
+
+    m_InSimTick = true;
+
+    // Drawing uses random numbers too, and doesn't happen the same number of times between sim updates from run to
+    // run, so each update gets its own seed to keep it from throwing the sim off
+    SeedRand(HashBytes(&m_TickCount, sizeof(m_TickCount), m_Seed));
+
+    if (m_Mode == REPLAY_RECORDING)
+        m_TickRecords.clear();
+    else
+    {
+        // Within a run of repeats, the states of the last sim update are simply used again
+        if (m_RepeatCount > 0)
+            --m_RepeatCount;
+        else
+        {
+            bool readOK = false;
+            unsigned long long count = 0;
+            int tag = m_pInStream->get();
+            if (tag == m_sTickTag && ReadVarInt(count) && count <= m_sMaxTickRecords)
+            {
+                m_TickRecords.resize(count);
+                readOK = true;
+                for (int i = 0; i < m_TickRecords.size() && readOK; ++i)
+                    readOK = ReadRecord(m_TickRecords[i]);
+            }
+            else if (tag == m_sRepeatTag && ReadVarInt(count) && count > 0)
+            {
+                m_RepeatCount = count - 1;
+                readOK = true;
+            }
+
+            if (!readOK)
+            {
+                g_ConsoleMan.PrintString("ERROR: Replay recording is damaged!");
+                Stop();
+                return;
+            }
+        }
+        m_RecordsReplayed.assign(m_TickRecords.size(), false);
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          EndSimTick
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Marks the end of a sim update. Writes out or checks the recorded
+//                  controller states and scene state hash, as due.
+
+void ReplayMan::EndSimTick()
+{
+    if (m_Mode == REPLAY_OFF)
+        return;
+
+    m_InSimTick = false;
+    ++m_TickCount;
+
+    if (m_Mode == REPLAY_RECORDING)
+    {
+        // Runs of sim updates where nothing changed, most commonly no buttons held at all, only get counted
+        if (m_TickRecords == m_LastTickRecords)
+            ++m_RepeatCount;
+        else
+        {
+            FlushRepeats();
+            m_pOutStream->put(m_sTickTag);
+            WriteVarInt(m_TickRecords.size());
+            for (vector<ControlRecord>::const_iterator itr = m_TickRecords.begin(); itr != m_TickRecords.end(); ++itr)
+                WriteRecord(*itr);
+            m_LastTickRecords.swap(m_TickRecords);
+        }
+
+        if (m_HashInterval > 0 && m_TickCount % m_HashInterval == 0)
+        {
+            FlushRepeats();
+            m_pOutStream->put(m_sHashTag);
+            WriteVarInt(m_TickCount);
+            WriteVarInt(GetStateHash());
+        }
+    }
+    // Hashes and the end are only ever written after a run of repeats has been flushed
+    else if (m_RepeatCount == 0)
+    {
+        unsigned long long tick = 0;
+        unsigned long long hash = 0;
+        if (m_pInStream->peek() == m_sHashTag)
+        {
+            m_pInStream->get();
+            ReadVarInt(tick);
+            ReadVarInt(hash);
+            ++m_HashesChecked;
+            if (tick != m_TickCount || hash != GetStateHash())
+            {
+                if (m_DivergenceCount++ == 0)
+                {
+                    m_FirstDivergentTick = m_TickCount;
+                    char report[256];
+                    sprintf(report, "WARNING: Replay diverged from the recording at sim update %lld!", m_TickCount);
+                    g_ConsoleMan.PrintString(report);
+                }
+            }
+        }
+
+        if (m_pInStream->peek() == m_sEndTag)
+        {
+            m_ReplayFinished = true;
+            Stop();
+        }
+        else if (!m_pInStream->good())
+            Stop();
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RecordControls
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Adds the state of a player controller to the current sim update's
+//                  recording.
+
+void ReplayMan::RecordControls(const ControlRecord &record)
+{
+    if (m_Mode == REPLAY_RECORDING && m_InSimTick)
+        m_TickRecords.push_back(record);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ReplayControls
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the next recorded controller state of a player in the current
+//                  sim update.
+
+bool ReplayMan::ReplayControls(int player, ControlRecord &record)
+{
+    if (m_Mode != REPLAY_PLAYING || !m_InSimTick)
+        return false;
+
+    for (int i = 0; i < m_TickRecords.size(); ++i)
+    {
+        if (!m_RecordsReplayed[i] && m_TickRecords[i].m_Player == player)
+        {
+            m_RecordsReplayed[i] = true;
+            record = m_TickRecords[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          StartRecording
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Writes down the setup of the activity about to be restarted and opens
+//                  the recording.
+
+int ReplayMan::StartRecording()
+{
+    // Write down the activity that RestartActivity is about to clone, or the default one it falls back on
+    const Activity *pActivity = g_ActivityMan.GetStartActivity();
+    if (!pActivity)
+        pActivity = dynamic_cast<const Activity *>(g_PresetMan.GetEntityPreset(g_ActivityMan.GetDefaultActivityType(), g_ActivityMan.GetDefaultActivityName()));
+    if (!pActivity)
+    {
+        g_ConsoleMan.PrintString("ERROR: There is no activity to record!");
+        return -1;
+    }
+
+    string setupPath = m_RecordPath + ".ini";
+    Writer setupWriter(setupPath.c_str());
+    m_pOutStream = new ofstream(m_RecordPath.c_str(), ios_base::out | ios_base::binary | ios_base::trunc);
+    if (!setupWriter.WriterOK() || !m_pOutStream->good())
+    {
+        g_ConsoleMan.PrintString("ERROR: Couldn't open the recording \"" + m_RecordPath + "\" for writing!");
+        return -1;
+    }
+
+    unsigned int seed = time(0);
+    setupWriter.ObjectStart(GetClassName());
+    setupWriter.NewProperty("Seed");
+    setupWriter << seed;
+    setupWriter.NewProperty("DeltaTime");
+    setupWriter << g_TimerMan.GetDeltaTimeSecs();
+    setupWriter.NewProperty("HashInterval");
+    setupWriter << m_HashInterval;
+    // The scene is picked separately from the activity, and only falls back on the activity's if none is
+    if (g_SceneMan.GetSceneToLoad())
+    {
+        setupWriter.NewProperty("Scene");
+        setupWriter << g_SceneMan.GetSceneToLoad()->GetPresetName();
+        setupWriter.NewProperty("PlaceObjects");
+        setupWriter << g_SceneMan.IsPlacingObjects();
+        setupWriter.NewProperty("PlaceUnits");
+        setupWriter << g_SceneMan.IsPlacingUnits();
+    }
+    setupWriter.NewProperty("Activity");
+    setupWriter << pActivity;
+    setupWriter.ObjectEnd();
+
+    m_Mode = REPLAY_RECORDING;
+    OverrideSettings(seed);
+    g_ConsoleMan.PrintString("SYSTEM: Recording to \"" + m_RecordPath + "\"");
+
+    return 0;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          StartReplay
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Reads the recorded activity setup, sets it up to be restarted, and
+//                  opens the recording.
+
+int ReplayMan::StartReplay()
+{
+    string setupPath = m_ReplayPath + ".ini";
+    Reader setupReader(setupPath.c_str(), false, 0, true);
+    m_pInStream = new ifstream(m_ReplayPath.c_str(), ios_base::in | ios_base::binary);
+    if (!setupReader.IsOK() || !m_pInStream->good() || setupReader.ReadPropValue() != GetClassName())
+    {
+        g_ConsoleMan.PrintString("ERROR: Couldn't open the recording \"" + m_ReplayPath + "\" for replaying!");
+        return -1;
+    }
+
+    unsigned int seed = 0;
+    Activity *pActivity = 0;
+    string sceneName;
+    bool placeObjects = true;
+    bool placeUnits = true;
+    while (setupReader.NextProperty())
+    {
+        string propName = setupReader.ReadPropName();
+        if (propName == "Seed")
+            setupReader >> seed;
+        else if (propName == "DeltaTime")
+        {
+            float deltaTime;
+            setupReader >> deltaTime;
+            g_TimerMan.SetDeltaTimeSecs(deltaTime);
+        }
+        else if (propName == "HashInterval")
+            setupReader >> m_HashInterval;
+        else if (propName == "Scene")
+            setupReader >> sceneName;
+        else if (propName == "PlaceObjects")
+            setupReader >> placeObjects;
+        else if (propName == "PlaceUnits")
+            setupReader >> placeUnits;
+        else if (propName == "Activity")
+        {
+            string className;
+            setupReader >> className;
+            const Entity::ClassInfo *pClass = Entity::ClassInfo::GetClass(className);
+            Entity *pEntity = pClass && pClass->IsConcrete() ? pClass->NewInstance() : 0;
+            delete pActivity;
+            pActivity = dynamic_cast<Activity *>(pEntity);
+            if (!pActivity || pEntity->Create(setupReader, false) < 0)
+            {
+                delete pEntity;
+                g_ConsoleMan.PrintString("ERROR: Couldn't read the activity of the recording \"" + m_ReplayPath + "\"!");
+                return -1;
+            }
+        }
+        else if (!propName.empty())
+            setupReader.ReadPropValue();
+    }
+
+    if (!pActivity)
+    {
+        g_ConsoleMan.PrintString("ERROR: The recording \"" + m_ReplayPath + "\" has no activity!");
+        return -1;
+    }
+    if (!sceneName.empty() && g_SceneMan.SetSceneToLoad(sceneName, placeObjects, placeUnits) < 0)
+    {
+        delete pActivity;
+        g_ConsoleMan.PrintString("ERROR: Couldn't find the scene \"" + sceneName + "\" of the recording \"" + m_ReplayPath + "\"!");
+        return -1;
+    }
+    // Ownership is transferred
+    g_ActivityMan.SetStartActivity(pActivity);
+
+    m_Mode = REPLAY_PLAYING;
+    m_ReplayFinished = false;
+    m_HashesChecked = 0;
+    m_DivergenceCount = 0;
+    m_FirstDivergentTick = -1;
+    OverrideSettings(seed);
+    g_ConsoleMan.PrintString("SYSTEM: Replaying \"" + m_ReplayPath + "\"");
+
+    return 0;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          OverrideSettings
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Seeds the random number generator and overrides the settings that
+//                  make the sim depend on real time, remembering the old ones.
+
+void ReplayMan::OverrideSettings(unsigned int seed)
+{
+    m_TickCount = 0;
+    m_RepeatCount = 0;
+    m_TickRecords.clear();
+    m_LastTickRecords.clear();
+
+    m_Seed = seed;
+    SeedRand(seed);
+
+    // Paths coming back from the background worker, terrain changes caught up on as time allows, and scripts
+    // waiting out the Lua time budget, land on different sim updates from run to run, so everything has to be
+    // done on the spot instead
+    if (!m_SettingsOverridden)
+    {
+        m_OldAsyncPathFinding = g_SettingsMan.AsyncPathFinding();
+        m_OldPathFindingBudget = g_SettingsMan.GetPathFindingBudget();
+        m_OldLuaScriptBudget = g_SettingsMan.GetLuaScriptBudget();
+        m_SettingsOverridden = true;
+    }
+    g_SettingsMan.SetAsyncPathFinding(false);
+    g_SettingsMan.SetPathFindingBudget(-1);
+    g_SettingsMan.SetLuaScriptBudget(0);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          FlushRepeats
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Writes out the run of sim updates that repeated the previous one's
+//                  controller states, if there is one.
+
+void ReplayMan::FlushRepeats()
+{
+    if (m_RepeatCount <= 0)
+        return;
+
+    m_pOutStream->put(m_sRepeatTag);
+    WriteVarInt(m_RepeatCount);
+    m_RepeatCount = 0;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetStateHash
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets a hash of the state of all MOs and the terrain.
+
+unsigned int ReplayMan::GetStateHash() const
+{
+    unsigned int hash = HashBytes(&m_TickCount, sizeof(m_TickCount));
+    hash = g_MovableMan.GetStateHash(hash);
+
+    SLTerrain *pTerrain = g_SceneMan.GetTerrain();
+    BITMAP *pMaterial = pTerrain ? pTerrain->GetMaterialBitmap() : 0;
+    if (pMaterial)
+    {
+        for (int y = 0; y < pMaterial->h; ++y)
+            hash = HashBytes(pMaterial->line[y], pMaterial->w, hash);
+    }
+
+    return hash;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          WriteRecord
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Writes a controller state to the recording.
+
+void ReplayMan::WriteRecord(const ControlRecord &record)
+{
+    // Offset so no player (-1) fits in the byte too
+    m_pOutStream->put(static_cast<char>(record.m_Player + 1));
+    WriteVarInt(record.m_States);
+
+    // The analog values are mostly all zero, so only the pairs that aren't get written, flagged in one byte
+    const float *pAnalogs[4] = { record.m_AnalogMove, record.m_AnalogAim, record.m_AnalogCursor, record.m_MouseMovement };
+    unsigned char analogFlags = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        if (pAnalogs[i][0] != 0 || pAnalogs[i][1] != 0)
+            analogFlags |= 1 << i;
+    }
+    m_pOutStream->put(static_cast<char>(analogFlags));
+
+    unsigned int bits;
+    for (int i = 0; i < 4; ++i)
+    {
+        if (!(analogFlags & (1 << i)))
+            continue;
+        for (int axis = 0; axis < 2; ++axis)
+        {
+            memcpy(&bits, &pAnalogs[i][axis], sizeof(bits));
+            for (int byte = 0; byte < 4; ++byte)
+                m_pOutStream->put(static_cast<char>((bits >> (byte * 8)) & 0xFF));
+        }
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ReadRecord
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Reads a controller state from the recording.
+
+bool ReplayMan::ReadRecord(ControlRecord &record)
+{
+    int player = m_pInStream->get();
+    if (player < 0 || !ReadVarInt(record.m_States))
+        return false;
+    record.m_Player = player - 1;
+
+    int analogFlags = m_pInStream->get();
+    if (analogFlags < 0)
+        return false;
+
+    float *pAnalogs[4] = { record.m_AnalogMove, record.m_AnalogAim, record.m_AnalogCursor, record.m_MouseMovement };
+    unsigned int bits;
+    for (int i = 0; i < 4; ++i)
+    {
+        for (int axis = 0; axis < 2; ++axis)
+        {
+            pAnalogs[i][axis] = 0;
+            if (!(analogFlags & (1 << i)))
+                continue;
+
+            bits = 0;
+            for (int byte = 0; byte < 4; ++byte)
+            {
+                int value = m_pInStream->get();
+                if (value < 0)
+                    return false;
+                bits |= static_cast<unsigned int>(value) << (byte * 8);
+            }
+            memcpy(&pAnalogs[i][axis], &bits, sizeof(bits));
+        }
+    }
+    return true;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          WriteVarInt
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Writes an unsigned number to the recording, seven bits per byte.
+
+void ReplayMan::WriteVarInt(unsigned long long value)
+{
+    while (value >= 0x80)
+    {
+        m_pOutStream->put(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    m_pOutStream->put(static_cast<char>(value));
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ReadVarInt
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Reads an unsigned number written by WriteVarInt from the recording.
+
+bool ReplayMan::ReadVarInt(unsigned long long &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        int byte = m_pInStream->get();
+        if (byte < 0)
+            return false;
+        value |= static_cast<unsigned long long>(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+} // namespace RTE
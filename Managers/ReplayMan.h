@@ -0,0 +1,471 @@
+#ifndef _RTEReplayMan_
+#define _RTEReplayMan_
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// File:            ReplayMan.h
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Header file for the ReplayMan class.
+// Project:         Retro Terrain Engine
+// Author(s):
+//
+//
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Inclusions of header files
+
+#include <string>
+#include <vector>
+#include <iosfwd>
+
+#include "Singleton.h"
+#define g_ReplayMan ReplayMan::Instance()
+
+namespace RTE
+{
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Class:           ReplayMan
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     The centralized singleton manager of input recordings. While
+//                  recording, the activity setup and random seed are written to an .ini
+//                  next to the recording, and the player controller states of every sim
+//                  update to the recording itself. While replaying, the same activity is
+//                  started with the same seed, and the recorded states are fed back to
+//                  the player controllers instead of the live input. A hash of the scene
+//                  state is written every so many sim updates and checked on replay, so
+//                  any divergence of the simulation shows up.
+// Parent(s):       Singleton
+// Class history:   10/17/2026  ReplayMan created.
+
+
+class ReplayMan:
+    public Singleton<ReplayMan>
+{
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Public member variable, method and friend function declarations
+
+public:
+
+    // The state of one player controller during one sim update
+    struct ControlRecord
+    {
+        // Which player the controller belongs to
+        int m_Player;
+        // One bit for each Controller::ControlState that is set
+        unsigned long long m_States;
+        // The analog values, as X and Y
+        float m_AnalogMove[2];
+        float m_AnalogAim[2];
+        float m_AnalogCursor[2];
+        float m_MouseMovement[2];
+
+        bool operator==(const ControlRecord &rhs) const;
+        bool operator!=(const ControlRecord &rhs) const { return !(*this == rhs); }
+    };
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Constructor:     ReplayMan
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Constructor method used to instantiate a ReplayMan object in system
+//                  memory. Create() should be called before using the object.
+// Arguments:       None.
+
+    ReplayMan() { Clear(); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Destructor:      ~ReplayMan
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Destructor method used to clean up a ReplayMan object before deletion
+//                  from system memory.
+// Arguments:       None.
+
+    virtual ~ReplayMan() { Destroy(); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Create
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Makes the ReplayMan object ready for use.
+// Arguments:       None.
+// Return value:    An error return value signaling sucess or any particular failure.
+//                  Anything below 0 is an error signal.
+
+    virtual int Create();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Virtual method:  Reset
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Resets the entire ReplayMan, including its inherited members, to
+//                  their default settings or values.
+// Arguments:       None.
+// Return value:    None.
+
+    virtual void Reset() { Clear(); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Destroy
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Finishes any recording or replay in progress and resets (through
+//                  Clear()) the ReplayMan object.
+// Arguments:       None.
+// Return value:    None.
+
+    void Destroy();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Virtual method:  GetClassName
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the class name of this Entity.
+// Arguments:       None.
+// Return value:    A string with the friendly-formatted type name of this object.
+
+    virtual const std::string & GetClassName() const { return m_ClassName; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          SetRecordPath
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Sets the file to record each started activity to, replacing the
+//                  recording of the one before. The setup is written to the same path
+//                  with .ini appended.
+// Arguments:       The path of the recording.
+// Return value:    None.
+
+    void SetRecordPath(const std::string &recordPath) { m_RecordPath = recordPath; m_ReplayPath.clear(); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          SetReplayPath
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Sets the recording to replay instead of the next started activity.
+//                  The setup is read from the same path with .ini appended.
+// Arguments:       The path of the recording.
+// Return value:    None.
+
+    void SetReplayPath(const std::string &replayPath) { m_ReplayPath = replayPath; m_RecordPath.clear(); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsRecording
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Shows whether player input is being recorded.
+// Arguments:       None.
+// Return value:    Whether recording.
+
+    bool IsRecording() const { return m_Mode == REPLAY_RECORDING; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsReplaying
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Shows whether recorded input is being fed to the player controllers.
+// Arguments:       None.
+// Return value:    Whether replaying.
+
+    bool IsReplaying() const { return m_Mode == REPLAY_PLAYING; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsReplayPending
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Shows whether a recording is set to be replayed or is being replayed.
+// Arguments:       None.
+// Return value:    Whether there is a replay to run.
+
+    bool IsReplayPending() const { return !m_ReplayPath.empty() || IsReplaying(); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ReplayFinished
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Shows whether a replay has run through to the end of its recording.
+// Arguments:       None.
+// Return value:    Whether the replay is done.
+
+    bool ReplayFinished() const { return m_ReplayFinished; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetDivergenceCount
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets how many of the recorded state hashes didn't match during the
+//                  replay.
+// Arguments:       None.
+// Return value:    The number of mismatches.
+
+    int GetDivergenceCount() const { return m_DivergenceCount; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          StartActivity
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Starts recording or replaying, if a path has been set, and finishes
+//                  any recording or replay in progress. When recording, writes down the
+//                  activity about to be restarted. When replaying, sets the recorded one
+//                  up to be restarted instead. Either way the random number generator
+//                  is seeded and the settings that make the sim depend on real time are
+//                  overridden. Must be called right before ActivityMan::RestartActivity.
+// Arguments:       None.
+// Return value:    An error return value signaling sucess or any particular failure.
+//                  Anything below 0 is an error signal.
+
+    int StartActivity();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Stop
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Finishes the recording or replay in progress, if any, and puts the
+//                  overridden settings back.
+// Arguments:       None.
+// Return value:    None.
+
+    void Stop();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          BeginSimTick
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Marks the start of a sim update. Seeds the random number generator for
+//                  it, and when replaying, reads the recorded controller states for it.
+// Arguments:       None.
+// Return value:    None.
+
+    void BeginSimTick();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          EndSimTick
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Marks the end of a sim update. Writes out or checks the recorded
+//                  controller states and scene state hash, as due.
+// Arguments:       None.
+// Return value:    None.
+
+    void EndSimTick();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          InSimTick
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Shows whether a sim update is in progress, between BeginSimTick and
+//                  EndSimTick. Controller updates outside of those aren't recorded.
+// Arguments:       None.
+// Return value:    Whether in a sim update.
+
+    bool InSimTick() const { return m_InSimTick; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RecordControls
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Adds the state of a player controller to the current sim update's
+//                  recording.
+// Arguments:       The controller state.
+// Return value:    None.
+
+    void RecordControls(const ControlRecord &record);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ReplayControls
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the next recorded controller state of a player in the current
+//                  sim update. The states of each player are handed out in the order
+//                  they were recorded.
+// Arguments:       The player.
+//                  The record to fill out.
+// Return value:    Whether there was one left.
+
+    bool ReplayControls(int player, ControlRecord &record);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Protected member variable and method declarations
+
+protected:
+
+    enum ReplayMode
+    {
+        REPLAY_OFF = 0,
+        REPLAY_RECORDING,
+        REPLAY_PLAYING
+    };
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          StartRecording
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Writes down the setup of the activity about to be restarted and opens
+//                  the recording.
+// Arguments:       None.
+// Return value:    An error return value signaling sucess or any particular failure.
+//                  Anything below 0 is an error signal.
+
+    int StartRecording();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          StartReplay
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Reads the recorded activity setup, sets it up to be restarted, and
+//                  opens the recording.
+// Arguments:       None.
+// Return value:    An error return value signaling sucess or any particular failure.
+//                  Anything below 0 is an error signal.
+
+    int StartReplay();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          OverrideSettings
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Seeds the random number generator and overrides the settings that
+//                  make the sim depend on real time, remembering the old ones.
+// Arguments:       The seed.
+// Return value:    None.
+
+    void OverrideSettings(unsigned int seed);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          FlushRepeats
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Writes out the run of sim updates that repeated the previous one's
+//                  controller states, if there is one.
+// Arguments:       None.
+// Return value:    None.
+
+    void FlushRepeats();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetStateHash
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets a hash of the state of all MOs and the terrain.
+// Arguments:       None.
+// Return value:    The hash.
+
+    unsigned int GetStateHash() const;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          WriteRecord
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Writes a controller state to the recording.
+// Arguments:       The controller state.
+// Return value:    None.
+
+    void WriteRecord(const ControlRecord &record);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ReadRecord
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Reads a controller state from the recording.
+// Arguments:       The record to fill out.
+// Return value:    Whether it could be read.
+
+    bool ReadRecord(ControlRecord &record);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          WriteVarInt
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Writes an unsigned number to the recording, seven bits per byte.
+// Arguments:       The number.
+// Return value:    None.
+
+    void WriteVarInt(unsigned long long value);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ReadVarInt
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Reads an unsigned number written by WriteVarInt from the recording.
+// Arguments:       The number to fill out.
+// Return value:    Whether it could be read.
+
+    bool ReadVarInt(unsigned long long &value);
+
+
+    // Member variables
+    static const std::string m_ClassName;
+    // The tags starting each entry of a recording
+    static const char m_sTickTag;
+    static const char m_sRepeatTag;
+    static const char m_sHashTag;
+    static const char m_sEndTag;
+    // How many sim updates apart the state hashes are written by default
+    static const int m_sDefaultHashInterval;
+    // The most controller states a single sim update can have, anything more means the recording is damaged
+    static const int m_sMaxTickRecords;
+
+    // What's currently going on
+    ReplayMode m_Mode;
+    // The recording to make or replay when the next activity is started
+    std::string m_RecordPath;
+    std::string m_ReplayPath;
+    // The recording being written or read. Owned
+    std::ofstream *m_pOutStream;
+    std::ifstream *m_pInStream;
+    // How many sim updates apart the state hashes are written
+    int m_HashInterval;
+    // The random seed the recording was made with
+    unsigned int m_Seed;
+    // The number of sim updates since the start
+    long long m_TickCount;
+    // Whether between BeginSimTick and EndSimTick
+    bool m_InSimTick;
+    // The controller states of the current sim update, and of the last one written or read
+    std::vector<ControlRecord> m_TickRecords;
+    std::vector<ControlRecord> m_LastTickRecords;
+    // Which of m_TickRecords have been handed out by ReplayControls
+    std::vector<bool> m_RecordsReplayed;
+    // When recording, the number of sim updates since the last written one that repeated its states. When
+    // replaying, the number of upcoming ones that do
+    long long m_RepeatCount;
+    // How the replay went
+    int m_HashesChecked;
+    int m_DivergenceCount;
+    long long m_FirstDivergentTick;
+    bool m_ReplayFinished;
+    // The settings as they were before being overridden
+    bool m_SettingsOverridden;
+    bool m_OldAsyncPathFinding;
+    float m_OldPathFindingBudget;
+    float m_OldLuaScriptBudget;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Private member variable and method declarations
+
+private:
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Clear
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Clears all the member variables of this ReplayMan, effectively
+//                  resetting the members of this abstraction level only.
+// Arguments:       None.
+// Return value:    None.
+
+    void Clear();
+
+    // Disallow the use of some implicit methods.
+    ReplayMan(const ReplayMan &reference);
+    ReplayMan & operator=(const ReplayMan &rhs);
+
+};
+
+} // namespace RTE
+
+#endif // File
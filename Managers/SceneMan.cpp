@@ -28,6 +28,8 @@
 #include "MOPixel.h"
 #include "Atom.h"
 #include "Material.h"
+#include "ThreadMan.h"
+#include "RotatedSpriteCache.h"
 // Temp
 #include "Controller.h"
 
@@ -36,6 +38,7 @@ using std::string;
 using std::list;
 using std::pair;
 using std::map;
+using std::vector;
 
 #ifdef _WIN32
 #define fmax max
@@ -49,6 +52,7 @@ namespace RTE
 #define COMPACTINGHEIGHT 25
 
 const std::string SceneMan::m_ClassName = "SceneMan";
+const int SceneMan::m_RayBatchChunkSize = 16;
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -89,9 +93,15 @@ void SceneMan::Clear()
     m_pMOColorLayer = 0;
     m_pMOIDLayer = 0;
     m_MOIDDrawings.clear();
+    m_MOColorDrawings.clear();
+    m_MOColorDrawnArea = 0;
     m_PostSceneEffects.clear();
     m_pDebugLayer = 0;
     m_LastRayHitPos.Reset();
+    m_QueuedRays.clear();
+    m_QueuedRaysFirstID = 0;
+    m_CastRays.clear();
+    m_CastRaysFirstID = 0;
 
     m_LayerDrawMode = g_LayerNormal;
 
@@ -196,6 +206,8 @@ int SceneMan::LoadScene(Scene *pNewScene, bool placeObjects, bool placeUnits)
     g_MovableMan.PurgeAllMOs();
     // Clear the post effects
     ClearPostEffects();
+    // The sprite cache hit ratios shown in the performance overlay start over with each scene
+    RotatedSpriteCache::ResetStats();
 
 	g_NetworkServer.LockScene(true);
 
@@ -236,6 +248,10 @@ int SceneMan::LoadScene(Scene *pNewScene, bool placeObjects, bool placeUnits)
     clear_to_color(pBitmap, g_KeyColor);
     m_pMOColorLayer = new SceneLayer();
     m_pMOColorLayer->Create(pBitmap, true, Vector(), m_pCurrentScene->WrapsX(), m_pCurrentScene->WrapsY(), Vector(1.0, 1.0));
+    // MOs only ever cover a small part of the scene, so only composite the parts of this that have anything in them
+    m_pMOColorLayer->SetTrackDirtyTiles(true);
+    m_MOColorDrawings.clear();
+    m_MOColorDrawnArea = 0;
     pBitmap = 0;
 
     // Re-create the MoveableObject:s ID SceneLayer
@@ -585,7 +601,7 @@ bool SceneMan::MOIDClearCheck()
     {
         for (int x = 0; x < pMOIDMap->w; ++x)
         {
-            if ((badMOID = _getpixel(pMOIDMap, x, y)) != g_NoMOID)
+            if ((badMOID = _getpixel16(pMOIDMap, x, y)) != g_NoMOID)
             {
                 g_FrameMan.SaveBitmapToBMP(pMOIDMap, "MOIDCheck");
                 g_FrameMan.SaveBitmapToBMP(m_pMOColorLayer->GetBitmap(), "MOIDCheck");
@@ -934,9 +950,53 @@ void SceneMan::ClearAllMOIDDrawings()
 //                  any MOID data anymore. Sets it all to NoMOID. Will take care of wrapping.
 
 void SceneMan::ClearMOIDRect(int left, int top, int right, int bottom)
+{
+    ClearLayerRect(m_pMOIDLayer->GetBitmap(), left, top, right, bottom, g_NoMOID);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RegisterMOColorDrawing
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Registers an area of the MOColor layer to be cleared the next time the
+//                  layer is cleared. Should be done every time anything is drawn to the
+//                  MOColor layer.
+
+void SceneMan::RegisterMOColorDrawing(const BITMAP *pDrawnBitmap, int left, int top, int right, int bottom)
+{
+    if (!m_pMOColorLayer || pDrawnBitmap != m_pMOColorLayer->GetBitmap() || left > right || top > bottom)
+        return;
+
+    m_MOColorDrawings.push_back(IntRect(left, top, right, bottom));
+    m_MOColorDrawnArea += (long long)(right - left + 1) * (bottom - top + 1);
+    m_pMOColorLayer->RegisterDrawing(left, top, right, bottom);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RegisterMOColorDrawing
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Registers an area of the MOColor layer to be cleared the next time the
+//                  layer is cleared. Should be done every time anything is drawn to the
+//                  MOColor layer.
+
+void SceneMan::RegisterMOColorDrawing(const BITMAP *pDrawnBitmap, const Vector &center, float radius)
+{
+    if (radius != 0)
+        RegisterMOColorDrawing(pDrawnBitmap, floorf(center.m_X - radius), floorf(center.m_Y - radius), ceilf(center.m_X + radius), ceilf(center.m_Y + radius));
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ClearLayerRect
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Fills a rectangle of a scene-wide layer bitmap with a color. Will take
+//                  care of wrapping.
+
+void SceneMan::ClearLayerRect(BITMAP *pLayerBitmap, int left, int top, int right, int bottom, int color)
 {
     // Draw the first unwrapped rect
-    rectfill(m_pMOIDLayer->GetBitmap(), left, top, right, bottom, g_NoMOID);
+    rectfill(pLayerBitmap, left, top, right, bottom, color);
 
     // Draw wrapped rectangles
     if (g_SceneMan.SceneWrapsX())
@@ -947,13 +1007,13 @@ void SceneMan::ClearMOIDRect(int left, int top, int right, int bottom)
         {
             int wrapLeft = left + sceneWidth;
             int wrapRight = sceneWidth - 1;
-            rectfill(m_pMOIDLayer->GetBitmap(), wrapLeft, top, wrapRight, bottom, g_NoMOID);
+            rectfill(pLayerBitmap, wrapLeft, top, wrapRight, bottom, color);
         }
         if (right >= sceneWidth)
         {
             int wrapLeft = 0;
             int wrapRight = right - sceneWidth;
-            rectfill(m_pMOIDLayer->GetBitmap(), wrapLeft, top, wrapRight, bottom, g_NoMOID);
+            rectfill(pLayerBitmap, wrapLeft, top, wrapRight, bottom, color);
         }
     }
     if (g_SceneMan.SceneWrapsY())
@@ -964,13 +1024,13 @@ void SceneMan::ClearMOIDRect(int left, int top, int right, int bottom)
         {
             int wrapTop = top + sceneHeight;
             int wrapBottom = sceneHeight - 1;
-            rectfill(m_pMOIDLayer->GetBitmap(), left, wrapTop, right, wrapBottom, g_NoMOID);
+            rectfill(pLayerBitmap, left, wrapTop, right, wrapBottom, color);
         }
         if (bottom >= sceneHeight)
         {
             int wrapTop = 0;
             int wrapBottom = bottom - sceneHeight;
-            rectfill(m_pMOIDLayer->GetBitmap(), left, wrapTop, right, wrapBottom, g_NoMOID);
+            rectfill(pLayerBitmap, left, wrapTop, right, wrapBottom, color);
         }
     }
 }
@@ -1636,37 +1696,25 @@ void SceneMan::RestoreUnseenBox(const int posX, const int posY, const int width,
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
-// Method:          CastUnseenRay
+// Method:          TraceRay
 //////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Traces along a vector and reveals or hides pixels on the unseen layer of a team
-//                  as long as the accumulated material strengths traced through the terrain
-//                  don't exceed a specific value.
+// Description:     The Bresenham traversal shared by all the Cast*Ray methods. Steps
+//                  along a ray and hands every pixel that isn't skipped to a policy,
+//                  which decides what to look for and when to stop.
 
-bool SceneMan::CastUnseenRay(int team, const Vector &start, const Vector &ray, Vector &endPos, int strengthLimit, int skip, bool reveal)
+template <class RayPolicy>
+bool SceneMan::TraceRay(const Vector &start, const Vector &ray, int skip, bool wrap, RayPolicy &policy)
 {
-#ifdef _DEBUG
-    if (m_pDebugLayer)
-        m_pDebugLayer->LockBitmaps();
-#endif //_DEBUG
-
-    if (!m_pCurrentScene->GetUnseenLayer(team))
-        return false;
-
-    int hitCount = 0, error, dom, sub, domSteps, skipped = skip;
+    int error, dom, sub, domSteps, skipped = skip;
     int intPos[2], delta[2], delta2[2], increment[2];
-    bool affectedAny = false;
-    unsigned char materialID;
-    Material const * foundMaterial;
-    int totalStrength = 0;
-    // Save the projected end of the ray pos
-    endPos = start + ray;
+    bool stopped = false;
 
     intPos[X] = floorf(start.m_X);
     intPos[Y] = floorf(start.m_Y);
     delta[X] = floorf(start.m_X + ray.m_X) - intPos[X];
     delta[Y] = floorf(start.m_Y + ray.m_Y) - intPos[Y];
-    
-    if (delta[X] == 0 &&  delta[Y] == 0)
+
+    if (delta[X] == 0 && delta[Y] == 0)
         return false;
 
     /////////////////////////////////////////////////////
@@ -1704,6 +1752,17 @@ bool SceneMan::CastUnseenRay(int team, const Vector &start, const Vector &ray, V
 
     error = delta2[sub] - delta[dom];
 
+    // Look up the scene wrapping once for the whole ray instead of for every pixel
+    int width = GetSceneWidth();
+    int height = GetSceneHeight();
+    bool wrapX = wrap && SceneWrapsX() && width > 0;
+    bool wrapY = wrap && SceneWrapsY() && height > 0;
+
+#ifdef _DEBUG
+    if (m_pDebugLayer)
+        m_pDebugLayer->LockBitmaps();
+#endif //_DEBUG
+
     /////////////////////////////////////////////////////
     // Bresenham's line drawing algorithm execution
 
@@ -1720,35 +1779,28 @@ bool SceneMan::CastUnseenRay(int team, const Vector &start, const Vector &ray, V
         // Only check pixel if we're not due to skip any, or if this is the last pixel
         if (++skipped > skip || domSteps + 1 == delta[dom])
         {
-            // Scene wrapping
-            g_SceneMan.WrapPosition(intPos[X], intPos[Y]);
-            // Reveal if we can, save the result
-			if (reveal)
-				affectedAny = RevealUnseen(intPos[X], intPos[Y], team) || affectedAny;
-			else
-				affectedAny = RestoreUnseen(intPos[X], intPos[Y], team) || affectedAny;
-
-            // Check the strength of the terrain to see if we can penetrate further
-            materialID = GetTerrMatter(intPos[X], intPos[Y]);
-            // Get the material object
-            foundMaterial = GetMaterialFromID(materialID);
-            // Add the encountered material's strength to the tally
-            totalStrength += foundMaterial->strength;
-            // See if we have hit the limits of our ray's strength
-            if (totalStrength >= strengthLimit)
+            // Scene wrapping, only needed when the ray has actually crossed an edge
+            if (wrapX && (intPos[X] < 0 || intPos[X] >= width))
+                intPos[X] = (intPos[X] % width + width) % width;
+            if (wrapY && (intPos[Y] < 0 || intPos[Y] >= height))
+                intPos[Y] = (intPos[Y] % height + height) % height;
+
+            if (policy.Check(intPos[X], intPos[Y]))
             {
-                // Save the position of the end of the ray where blocked
-                endPos.SetXY(intPos[X], intPos[Y]);
+                stopped = true;
                 break;
             }
-            // Reset skip counter
+
             skipped = 0;
+
 #ifdef _DEBUG
             // Draw debug graphics, if applicable
             if (m_pDebugLayer)
-                m_pDebugLayer->SetPixel(intPos[X], intPos[Y], 13);
+                m_pDebugLayer->SetPixel(intPos[X], intPos[Y], policy.m_DebugColor);
 #endif //_DEBUG
         }
+        else
+            policy.Skip(intPos[X], intPos[Y]);
     }
 
 #ifdef _DEBUG
@@ -1756,273 +1808,392 @@ bool SceneMan::CastUnseenRay(int team, const Vector &start, const Vector &ray, V
         m_pDebugLayer->UnlockBitmaps();
 #endif //_DEBUG
 
-    return affectedAny;
+    policy.m_Traced = true;
+    policy.m_EndPos[X] = intPos[X];
+    policy.m_EndPos[Y] = intPos[Y];
+
+    return stopped;
 }
 
+
 //////////////////////////////////////////////////////////////////////////////////////////
-// Method:          CastSeeRay
-//////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Traces along a vector and reveals pixels on the unseen layer of a team
-//                  as long as the accumulated material strengths traced through the terrain
-//                  don't exceed a specific value.
+// The policies that the Cast*Ray methods run TraceRay with. Check() is called with every
+// pixel that isn't skipped, already wrapped if asked to, and returns whether to stop there.
 
-bool SceneMan::CastSeeRay(int team, const Vector &start, const Vector &ray, Vector &endPos, int strengthLimit, int skip)
+namespace
 {
-	return CastUnseenRay(team, start, ray, endPos, strengthLimit, skip, true);
-}
 
-//////////////////////////////////////////////////////////////////////////////////////////
-// Method:          CastUnseeRay
-//////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Traces along a vector and hides pixels on the unseen layer of a team
-//                  as long as the accumulated material strengths traced through the terrain
-//                  don't exceed a specific value.
+struct RayPolicyBase
+{
+    RayPolicyBase(int debugColor = 13):
+        m_pMaterialBitmap(g_SceneMan.GetTerrain()->GetMaterialBitmap()),
+        m_pMOIDBitmap(g_SceneMan.GetMOIDBitmap()),
+        m_DebugColor(debugColor),
+        m_Traced(false) { m_EndPos[X] = m_EndPos[Y] = 0; }
 
-bool SceneMan::CastUnseeRay(int team, const Vector &start, const Vector &ray, Vector &endPos, int strengthLimit, int skip)
+    // Reads the bitmaps directly when inside them, and leaves the edge cases to SceneMan
+    unsigned char MatterAt(int posX, int posY) const
+    {
+        if (posX >= 0 && posX < m_pMaterialBitmap->w && posY >= 0 && posY < m_pMaterialBitmap->h)
+            return m_pMaterialBitmap->line[posY][posX];
+        return g_SceneMan.GetTerrMatter(posX, posY);
+    }
+
+    MOID MOIDAt(int posX, int posY) const
+    {
+        if (posX >= 0 && posX < m_pMOIDBitmap->w && posY >= 0 && posY < m_pMOIDBitmap->h)
+#if MOID_BITMAP_LAYER_DEPTH == 16
+            return ((unsigned short *)m_pMOIDBitmap->line[posY])[posX];
+#else
+            return m_pMOIDBitmap->line[posY][posX];
+#endif
+        return g_SceneMan.GetMOIDPixel(posX, posY);
+    }
+
+    // Called with the pixels that are skipped over
+    void Skip(int posX, int posY) { }
+
+    BITMAP *m_pMaterialBitmap;
+    BITMAP *m_pMOIDBitmap;
+    // The color of the pixels drawn on the debug layer
+    int m_DebugColor;
+    // Whether the ray was long enough to be traced at all
+    bool m_Traced;
+    // The last pixel the trace got to; where it stopped, if it did
+    int m_EndPos[2];
+};
+
+struct UnseenRayPolicy: public RayPolicyBase
 {
-	return CastUnseenRay(team, start, ray, endPos, strengthLimit, skip, false);
-}
+    UnseenRayPolicy(int team, int strengthLimit, bool reveal): m_Team(team), m_StrengthLimit(strengthLimit), m_Reveal(reveal), m_TotalStrength(0), m_AffectedAny(false) { }
 
+    bool Check(int posX, int posY)
+    {
+        // Reveal if we can, save the result
+        if (m_Reveal)
+            m_AffectedAny = g_SceneMan.RevealUnseen(posX, posY, m_Team) || m_AffectedAny;
+        else
+            m_AffectedAny = g_SceneMan.RestoreUnseen(posX, posY, m_Team) || m_AffectedAny;
 
+        // Add the encountered material's strength to the tally, and see if we have hit the limits of our ray's strength
+        m_TotalStrength += g_SceneMan.GetMaterialFromID(MatterAt(posX, posY))->strength;
+        return m_TotalStrength >= m_StrengthLimit;
+    }
 
-//////////////////////////////////////////////////////////////////////////////////////////
-// Method:          CastMaterialRay
-//////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Traces along a vector and gets the location of the first encountered
-//                  pixel of a specific material in the terrain.
+    int m_Team;
+    int m_StrengthLimit;
+    bool m_Reveal;
+    int m_TotalStrength;
+    bool m_AffectedAny;
+};
 
-bool SceneMan::CastMaterialRay(const Vector &start, const Vector &ray, unsigned char material, Vector &result, int skip, bool wrap)
+struct MaterialRayPolicy: public RayPolicyBase
 {
-#ifdef _DEBUG
-    if (m_pDebugLayer)
-        m_pDebugLayer->LockBitmaps();
-#endif //_DEBUG
+    MaterialRayPolicy(unsigned char material): m_Material(material) { }
 
-    int hitCount = 0, error, dom, sub, domSteps, skipped = skip;
-    int intPos[2], delta[2], delta2[2], increment[2];
-    bool foundPixel = false;
+    bool Check(int posX, int posY) { return MatterAt(posX, posY) == m_Material; }
 
-    intPos[X] = floorf(start.m_X);
-    intPos[Y] = floorf(start.m_Y);
-    delta[X] = floorf(start.m_X + ray.m_X) - intPos[X];
-    delta[Y] = floorf(start.m_Y + ray.m_Y) - intPos[Y];
-    
-    if (delta[X] == 0 &&  delta[Y] == 0)
-        return false;
+    unsigned char m_Material;
+};
 
-    /////////////////////////////////////////////////////
-    // Bresenham's line drawing algorithm preparation
+struct NotMaterialRayPolicy: public RayPolicyBase
+{
+    NotMaterialRayPolicy(unsigned char material, bool checkMOs): m_Material(material), m_CheckMOs(checkMOs) { }
 
-    if (delta[X] < 0)
+    // Either a pixel of another material, or an MO blocking the way
+    bool Check(int posX, int posY) { return MatterAt(posX, posY) != m_Material || (m_CheckMOs && MOIDAt(posX, posY) != g_NoMOID); }
+
+    unsigned char m_Material;
+    bool m_CheckMOs;
+};
+
+struct StrengthSumRayPolicy: public RayPolicyBase
+{
+    StrengthSumRayPolicy(unsigned char ignoreMaterial): m_IgnoreMaterial(ignoreMaterial), m_StrengthSum(0) { }
+
+    bool Check(int posX, int posY)
     {
-        increment[X] = -1;
-        delta[X] = -delta[X];
+        unsigned char materialID = MatterAt(posX, posY);
+        if (materialID != g_MaterialAir && materialID != m_IgnoreMaterial)
+            m_StrengthSum += g_SceneMan.GetMaterialFromID(materialID)->strength;
+        return false;
     }
-    else
-        increment[X] = 1;
 
-    if (delta[Y] < 0)
+    unsigned char m_IgnoreMaterial;
+    float m_StrengthSum;
+};
+
+struct MaxStrengthRayPolicy: public RayPolicyBase
+{
+    MaxStrengthRayPolicy(): m_MaxStrength(0) { }
+
+    bool Check(int posX, int posY)
     {
-        increment[Y] = -1;
-        delta[Y] = -delta[Y];
+        unsigned char materialID = MatterAt(posX, posY);
+        if (materialID != g_MaterialDoor)
+            m_MaxStrength = fmax(m_MaxStrength, g_SceneMan.GetMaterialFromID(materialID)->strength);
+        return false;
     }
-    else
-        increment[Y] = 1;
 
-    // Scale by 2, for better accuracy of the error at the first pixel
-    delta2[X] = delta[X] << 1;
-    delta2[Y] = delta[Y] << 1;
+    float m_MaxStrength;
+};
 
-    // If X is dominant, Y is submissive, and vice versa.
-    if (delta[X] > delta[Y]) {
-        dom = X;
-        sub = Y;
+struct StrengthRayPolicy: public RayPolicyBase
+{
+    StrengthRayPolicy(float strength, unsigned char ignoreMaterial): m_Strength(strength), m_IgnoreMaterial(ignoreMaterial) { }
+
+    bool Check(int posX, int posY)
+    {
+        unsigned char materialID = MatterAt(posX, posY);
+        return materialID != m_IgnoreMaterial && g_SceneMan.GetMaterialFromID(materialID)->strength >= m_Strength;
     }
-    else {
-        dom = Y;
-        sub = X;
+
+    float m_Strength;
+    unsigned char m_IgnoreMaterial;
+};
+
+struct WeaknessRayPolicy: public RayPolicyBase
+{
+    WeaknessRayPolicy(float strength): m_Strength(strength) { }
+
+    bool Check(int posX, int posY) { return g_SceneMan.GetMaterialFromID(MatterAt(posX, posY))->strength <= m_Strength; }
+
+    float m_Strength;
+};
+
+struct MORayPolicy: public RayPolicyBase
+{
+    MORayPolicy(MOID ignoreMOID, int ignoreTeam, unsigned char ignoreMaterial, bool ignoreAllTerrain):
+        RayPolicyBase(120), m_IgnoreMOID(ignoreMOID), m_IgnoreTeam(ignoreTeam), m_IgnoreMaterial(ignoreMaterial), m_IgnoreAllTerrain(ignoreAllTerrain), m_HitMOID(g_NoMOID) { }
+
+    bool Check(int posX, int posY)
+    {
+        // Detect MOIDs
+        MOID hitMOID = MOIDAt(posX, posY);
+        if (hitMOID != g_NoMOID && hitMOID != m_IgnoreMOID && g_MovableMan.GetRootMOID(hitMOID) != m_IgnoreMOID)
+        {
+            // Check if we're supposed to ignore the team of what we hit
+            const MovableObject *pHitMO = 0;
+            if (m_IgnoreTeam != Activity::NOTEAM)
+            {
+                pHitMO = g_MovableMan.GetMOFromID(hitMOID);
+                pHitMO = pHitMO ? pHitMO->GetRootParent() : 0;
+            }
+            // Legit hit, unless we are supposed to ignore this
+            if (!(pHitMO && pHitMO->IgnoresTeamHits() && pHitMO->GetTeam() == m_IgnoreTeam))
+            {
+                m_HitMOID = hitMOID;
+                return true;
+            }
+        }
+
+        // Detect terrain hits
+        if (!m_IgnoreAllTerrain)
+        {
+            unsigned char hitTerrain = MatterAt(posX, posY);
+            if (hitTerrain != g_MaterialAir && hitTerrain != m_IgnoreMaterial)
+                return true;
+        }
+        return false;
     }
 
-    error = delta2[sub] - delta[dom];
+    MOID m_IgnoreMOID;
+    int m_IgnoreTeam;
+    unsigned char m_IgnoreMaterial;
+    bool m_IgnoreAllTerrain;
+    MOID m_HitMOID;
+};
 
-    /////////////////////////////////////////////////////
-    // Bresenham's line drawing algorithm execution
+struct FindMORayPolicy: public RayPolicyBase
+{
+    FindMORayPolicy(MOID targetMOID, unsigned char ignoreMaterial, bool ignoreAllTerrain):
+        RayPolicyBase(120), m_TargetMOID(targetMOID), m_IgnoreMaterial(ignoreMaterial), m_IgnoreAllTerrain(ignoreAllTerrain), m_FoundTarget(false) { }
 
-    for (domSteps = 0; domSteps < delta[dom]; ++domSteps)
+    bool Check(int posX, int posY)
     {
-        intPos[dom] += increment[dom];
-        if (error >= 0)
+        // Detect MOIDs
+        MOID hitMOID = MOIDAt(posX, posY);
+        if (hitMOID == m_TargetMOID || g_MovableMan.GetRootMOID(hitMOID) == m_TargetMOID)
         {
-            intPos[sub] += increment[sub];
-            error -= delta2[dom];
+            m_FoundTarget = true;
+            return true;
         }
-        error += delta2[sub];
 
-        // Only check pixel if we're not due to skip any, or if this is the last pixel
-        if (++skipped > skip || domSteps + 1 == delta[dom])
+        // Detect terrain hits
+        if (!m_IgnoreAllTerrain)
         {
-            // Scene wrapping, if necessary
-            if (wrap)
-                g_SceneMan.WrapPosition(intPos[X], intPos[Y]);
+            unsigned char hitTerrain = MatterAt(posX, posY);
+            if (hitTerrain != g_MaterialAir && hitTerrain != m_IgnoreMaterial)
+                return true;
+        }
+        return false;
+    }
+
+    MOID m_TargetMOID;
+    unsigned char m_IgnoreMaterial;
+    bool m_IgnoreAllTerrain;
+    bool m_FoundTarget;
+};
+
+struct ObstacleRayPolicy: public RayPolicyBase
+{
+    ObstacleRayPolicy(Vector &freePos, MOID ignoreMOID, int ignoreTeam, unsigned char ignoreMaterial):
+        m_FreePos(freePos), m_IgnoreMOID(ignoreMOID), m_IgnoreTeam(ignoreTeam), m_IgnoreMaterial(ignoreMaterial), m_FreeSteps(0) { }
+
+    bool Check(int posX, int posY)
+    {
+        unsigned char checkMat = MatterAt(posX, posY);
+        MOID checkMOID = MOIDAt(posX, posY);
 
-            // See if we found the looked-for pixel of the correct material
-            if (GetTerrMatter(intPos[X], intPos[Y]) == material)
+        // Translate any found MOID into the root MOID of that hit MO
+        if (checkMOID != g_NoMOID)
+        {
+            MovableObject *pHitMO = g_MovableMan.GetMOFromID(checkMOID);
+            if (pHitMO)
             {
-                // Save result and report success
-                foundPixel = true;
-                result.SetXY(intPos[X], intPos[Y]);
-                // Save last ray pos
-                m_LastRayHitPos.SetIntXY(intPos[X], intPos[Y]);
-                break;
+                checkMOID = pHitMO->GetRootID();
+                // Check if we're supposed to ignore the team of what we hit
+                if (m_IgnoreTeam != Activity::NOTEAM)
+                {
+                    pHitMO = pHitMO->GetRootParent();
+                    // We are indeed supposed to ignore this object because of its ignoring of its specific team
+                    if (pHitMO && pHitMO->IgnoresTeamHits() && pHitMO->GetTeam() == m_IgnoreTeam)
+                        checkMOID = g_NoMOID;
+                }
             }
+        }
 
-            skipped = 0;
+        // See if we found the looked-for pixel of the correct material,
+        // Or an MO is blocking the way
+        if ((checkMat != g_MaterialAir && checkMat != m_IgnoreMaterial) || (checkMOID != g_NoMOID && checkMOID != m_IgnoreMOID))
+            return true;
 
-#ifdef _DEBUG
-            // Draw debug graphics, if applicable
-            if (m_pDebugLayer)
-                m_pDebugLayer->SetPixel(intPos[X], intPos[Y], 13);
-#endif //_DEBUG
-        }
+        Skip(posX, posY);
+        return false;
     }
 
-#ifdef _DEBUG
-    if (m_pDebugLayer)
-        m_pDebugLayer->UnlockBitmaps();
-#endif //_DEBUG
+    void Skip(int posX, int posY)
+    {
+        m_FreePos.SetXY(posX, posY);
+        ++m_FreeSteps;
+    }
 
-    return foundPixel;
-}
+    Vector &m_FreePos;
+    MOID m_IgnoreMOID;
+    int m_IgnoreTeam;
+    unsigned char m_IgnoreMaterial;
+    // How many pixels were passed before hitting anything
+    int m_FreeSteps;
+};
+
+} // namespace
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
-// Method:          CastMaterialRay
+// Method:          CastUnseenRay
 //////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Traces along a vector and returns how far along that ray there is an
-//                  encounter with a pixel of a specific material in the terrain.
+// Description:     Traces along a vector and reveals or hides pixels on the unseen layer of a team
+//                  as long as the accumulated material strengths traced through the terrain
+//                  don't exceed a specific value.
 
-float SceneMan::CastMaterialRay(const Vector &start, const Vector &ray, unsigned char material, int skip)
+bool SceneMan::CastUnseenRay(int team, const Vector &start, const Vector &ray, Vector &endPos, int strengthLimit, int skip, bool reveal)
 {
-    Vector result;
-    if (CastMaterialRay(start, ray, material, result, skip))
-    {
-        // Calculate the length between the start and the found material pixel coords
-        result -= start;
-        return result.GetMagnitude();
-    }
+    if (!m_pCurrentScene->GetUnseenLayer(team))
+        return false;
 
-    // Signal that we didn't hit anything
-    return -1;
+    // Save the projected end of the ray pos
+    endPos = start + ray;
+
+    UnseenRayPolicy policy(team, strengthLimit, reveal);
+    // Save the position of the end of the ray where blocked
+    if (TraceRay(start, ray, skip, true, policy))
+        endPos.SetXY(policy.m_EndPos[X], policy.m_EndPos[Y]);
+
+    return policy.m_AffectedAny;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CastSeeRay
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Traces along a vector and reveals pixels on the unseen layer of a team
+//                  as long as the accumulated material strengths traced through the terrain
+//                  don't exceed a specific value.
+
+bool SceneMan::CastSeeRay(int team, const Vector &start, const Vector &ray, Vector &endPos, int strengthLimit, int skip)
+{
+	return CastUnseenRay(team, start, ray, endPos, strengthLimit, skip, true);
+}
 
 //////////////////////////////////////////////////////////////////////////////////////////
-// Method:          CastNotMaterialRay
+// Method:          CastUnseeRay
 //////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Traces along a vector and gets the location of the first encountered
-//                  pixel that is NOT of a specific material in the scene's terrain.
+// Description:     Traces along a vector and hides pixels on the unseen layer of a team
+//                  as long as the accumulated material strengths traced through the terrain
+//                  don't exceed a specific value.
 
-bool SceneMan::CastNotMaterialRay(const Vector &start, const Vector &ray, unsigned char material, Vector &result, int skip, bool checkMOs)
+bool SceneMan::CastUnseeRay(int team, const Vector &start, const Vector &ray, Vector &endPos, int strengthLimit, int skip)
 {
-#ifdef _DEBUG
-    if (m_pDebugLayer)
-        m_pDebugLayer->LockBitmaps();
-#endif //_DEBUG
+	return CastUnseenRay(team, start, ray, endPos, strengthLimit, skip, false);
+}
 
-    int hitCount = 0, error, dom, sub, domSteps, skipped = skip;
-    int intPos[2], delta[2], delta2[2], increment[2];
-    bool foundPixel = false;
 
-    intPos[X] = floorf(start.m_X);
-    intPos[Y] = floorf(start.m_Y);
-    delta[X] = floorf(start.m_X + ray.m_X) - intPos[X];
-    delta[Y] = floorf(start.m_Y + ray.m_Y) - intPos[Y];
-
-    if (delta[X] == 0 &&  delta[Y] == 0)
-        return false;
-
-    /////////////////////////////////////////////////////
-    // Bresenham's line drawing algorithm preparation
-
-    if (delta[X] < 0)
-    {
-        increment[X] = -1;
-        delta[X] = -delta[X];
-    }
-    else
-        increment[X] = 1;
 
-    if (delta[Y] < 0)
-    {
-        increment[Y] = -1;
-        delta[Y] = -delta[Y];
-    }
-    else
-        increment[Y] = 1;
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CastMaterialRay
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Traces along a vector and gets the location of the first encountered
+//                  pixel of a specific material in the terrain.
 
-    // Scale by 2, for better accuracy of the error at the first pixel
-    delta2[X] = delta[X] << 1;
-    delta2[Y] = delta[Y] << 1;
+bool SceneMan::CastMaterialRay(const Vector &start, const Vector &ray, unsigned char material, Vector &result, int skip, bool wrap)
+{
+    MaterialRayPolicy policy(material);
+    if (!TraceRay(start, ray, skip, wrap, policy))
+        return false;
 
-    // If X is dominant, Y is submissive, and vice versa.
-    if (delta[X] > delta[Y]) {
-        dom = X;
-        sub = Y;
-    }
-    else {
-        dom = Y;
-        sub = X;
-    }
+    // Save result and last ray pos
+    result.SetXY(policy.m_EndPos[X], policy.m_EndPos[Y]);
+    m_LastRayHitPos.SetIntXY(policy.m_EndPos[X], policy.m_EndPos[Y]);
+    return true;
+}
 
-    error = delta2[sub] - delta[dom];
 
-    /////////////////////////////////////////////////////
-    // Bresenham's line drawing algorithm execution
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CastMaterialRay
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Traces along a vector and returns how far along that ray there is an
+//                  encounter with a pixel of a specific material in the terrain.
 
-    for (domSteps = 0; domSteps < delta[dom]; ++domSteps)
+float SceneMan::CastMaterialRay(const Vector &start, const Vector &ray, unsigned char material, int skip)
+{
+    Vector result;
+    if (CastMaterialRay(start, ray, material, result, skip))
     {
-        intPos[dom] += increment[dom];
-        if (error >= 0)
-        {
-            intPos[sub] += increment[sub];
-            error -= delta2[dom];
-        }
-        error += delta2[sub];
+        // Calculate the length between the start and the found material pixel coords
+        result -= start;
+        return result.GetMagnitude();
+    }
 
-        // Only check pixel if we're not due to skip any, or if this is the last pixel
-        if (++skipped > skip || domSteps + 1 == delta[dom])
-        {
-            // Scene wrapping, if necessary
-            g_SceneMan.WrapPosition(intPos[X], intPos[Y]);
+    // Signal that we didn't hit anything
+    return -1;
+}
 
-            // See if we found the looked-for pixel of the correct material,
-            // Or an MO is blocking the way
-            if (GetTerrMatter(intPos[X], intPos[Y]) != material ||
-                (checkMOs && g_SceneMan.GetMOIDPixel(intPos[X], intPos[Y]) != g_NoMOID))
-            {
-                // Save result and report success
-                foundPixel = true;
-                result.SetXY(intPos[X], intPos[Y]);
-                // Save last ray pos
-                m_LastRayHitPos.SetIntXY(intPos[X], intPos[Y]);
-                break;
-            }
 
-            skipped = 0;
-#ifdef _DEBUG
-            // Draw debug graphics, if applicable
-            if (m_pDebugLayer)
-                m_pDebugLayer->SetPixel(intPos[X], intPos[Y], 13);
-#endif //_DEBUG
-        }
-    }
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CastNotMaterialRay
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Traces along a vector and gets the location of the first encountered
+//                  pixel that is NOT of a specific material in the scene's terrain.
 
-#ifdef _DEBUG
-    if (m_pDebugLayer)
-        m_pDebugLayer->UnlockBitmaps();
-#endif //_DEBUG
+bool SceneMan::CastNotMaterialRay(const Vector &start, const Vector &ray, unsigned char material, Vector &result, int skip, bool checkMOs)
+{
+    NotMaterialRayPolicy policy(material, checkMOs);
+    if (!TraceRay(start, ray, skip, true, policy))
+        return false;
 
-    return foundPixel;
+    // Save result and last ray pos
+    result.SetXY(policy.m_EndPos[X], policy.m_EndPos[Y]);
+    m_LastRayHitPos.SetIntXY(policy.m_EndPos[X], policy.m_EndPos[Y]);
+    return true;
 }
 
 
@@ -2055,88 +2226,9 @@ float SceneMan::CastNotMaterialRay(const Vector &start, const Vector &ray, unsig
 
 float SceneMan::CastStrengthSumRay(const Vector &start, const Vector &end, int skip, unsigned char ignoreMaterial)
 {
-    Vector ray = g_SceneMan.ShortestDistance(start, end);
-    float strengthSum = 0;
-
-    int error, dom, sub, domSteps, skipped = skip;
-    int intPos[2], delta[2], delta2[2], increment[2];
-    bool foundPixel = false;
-    unsigned char materialID;
-    Material foundMaterial;
-
-    intPos[X] = floorf(start.m_X);
-    intPos[Y] = floorf(start.m_Y);
-    delta[X] = floorf(start.m_X + ray.m_X) - intPos[X];
-    delta[Y] = floorf(start.m_Y + ray.m_Y) - intPos[Y];
-    
-    if (delta[X] == 0 &&  delta[Y] == 0)
-        return false;
-
-    /////////////////////////////////////////////////////
-    // Bresenham's line drawing algorithm preparation
-
-    if (delta[X] < 0)
-    {
-        increment[X] = -1;
-        delta[X] = -delta[X];
-    }
-    else
-        increment[X] = 1;
-
-    if (delta[Y] < 0)
-    {
-        increment[Y] = -1;
-        delta[Y] = -delta[Y];
-    }
-    else
-        increment[Y] = 1;
-
-    // Scale by 2, for better accuracy of the error at the first pixel
-    delta2[X] = delta[X] << 1;
-    delta2[Y] = delta[Y] << 1;
-
-    // If X is dominant, Y is submissive, and vice versa.
-    if (delta[X] > delta[Y]) {
-        dom = X;
-        sub = Y;
-    }
-    else
-    {
-        dom = Y;
-        sub = X;
-    }
-
-    error = delta2[sub] - delta[dom];
-
-    /////////////////////////////////////////////////////
-    // Bresenham's line drawing algorithm execution
-
-    for (domSteps = 0; domSteps < delta[dom]; ++domSteps)
-    {
-        intPos[dom] += increment[dom];
-        if (error >= 0)
-        {
-            intPos[sub] += increment[sub];
-            error -= delta2[dom];
-        }
-        error += delta2[sub];
-
-        // Only check pixel if we're not due to skip any, or if this is the last pixel
-        if (++skipped > skip || domSteps + 1 == delta[dom])
-        {
-            // Scene wrapping, if necessary
-            g_SceneMan.WrapPosition(intPos[X], intPos[Y]);
-
-            // Sum all strengths
-            materialID = GetTerrMatter(intPos[X], intPos[Y]);
-            if (materialID != g_MaterialAir && materialID != ignoreMaterial)
-                strengthSum += GetMaterialFromID(materialID)->strength;
-
-            skipped = 0;
-        }
-    }
-
-    return strengthSum;
+    StrengthSumRayPolicy policy(ignoreMaterial);
+    TraceRay(start, g_SceneMan.ShortestDistance(start, end), skip, true, policy);
+    return policy.m_StrengthSum;
 }
 
 
@@ -2149,88 +2241,9 @@ float SceneMan::CastStrengthSumRay(const Vector &start, const Vector &end, int s
 
 float SceneMan::CastMaxStrengthRay(const Vector &start, const Vector &end, int skip)
 {
-    Vector ray = g_SceneMan.ShortestDistance(start, end);
-    float maxStrength = 0;
-
-    int error, dom, sub, domSteps, skipped = skip;
-    int intPos[2], delta[2], delta2[2], increment[2];
-    bool foundPixel = false;
-    unsigned char materialID;
-    Material foundMaterial;
-
-    intPos[X] = floorf(start.m_X);
-    intPos[Y] = floorf(start.m_Y);
-    delta[X] = floorf(start.m_X + ray.m_X) - intPos[X];
-    delta[Y] = floorf(start.m_Y + ray.m_Y) - intPos[Y];
-    
-    if (delta[X] == 0 &&  delta[Y] == 0)
-        return false;
-
-    /////////////////////////////////////////////////////
-    // Bresenham's line drawing algorithm preparation
-
-    if (delta[X] < 0)
-    {
-        increment[X] = -1;
-        delta[X] = -delta[X];
-    }
-    else
-        increment[X] = 1;
-
-    if (delta[Y] < 0)
-    {
-        increment[Y] = -1;
-        delta[Y] = -delta[Y];
-    }
-    else
-        increment[Y] = 1;
-
-    // Scale by 2, for better accuracy of the error at the first pixel
-    delta2[X] = delta[X] << 1;
-    delta2[Y] = delta[Y] << 1;
-
-    // If X is dominant, Y is submissive, and vice versa.
-    if (delta[X] > delta[Y]) {
-        dom = X;
-        sub = Y;
-    }
-    else
-    {
-        dom = Y;
-        sub = X;
-    }
-
-    error = delta2[sub] - delta[dom];
-
-    /////////////////////////////////////////////////////
-    // Bresenham's line drawing algorithm execution
-
-    for (domSteps = 0; domSteps < delta[dom]; ++domSteps)
-    {
-        intPos[dom] += increment[dom];
-        if (error >= 0)
-        {
-            intPos[sub] += increment[sub];
-            error -= delta2[dom];
-        }
-        error += delta2[sub];
-
-        // Only check pixel if we're not due to skip any, or if this is the last pixel
-        if (++skipped > skip || domSteps + 1 == delta[dom])
-        {
-            // Scene wrapping, if necessary
-            g_SceneMan.WrapPosition(intPos[X], intPos[Y]);
-
-            // Sum all strengths
-            materialID = GetTerrMatter(intPos[X], intPos[Y]);
-            if (materialID != g_MaterialDoor)
-                maxStrength = fmax(maxStrength, GetMaterialFromID(materialID)->strength);
-
-            skipped = 0;
-        }
-    }
-    
-    return maxStrength;
+    MaxStrengthRayPolicy policy;
+    TraceRay(start, g_SceneMan.ShortestDistance(start, end), skip, true, policy);
+    return policy.m_MaxStrength;
 }
 
 
@@ -2244,116 +2257,15 @@ float SceneMan::CastMaxStrengthRay(const Vector &start, const Vector &end, int s
 
 bool SceneMan::CastStrengthRay(const Vector &start, const Vector &ray, float strength, Vector &result, int skip, unsigned char ignoreMaterial, bool wrap)
 {
-#ifdef _DEBUG
-    if (m_pDebugLayer)
-        m_pDebugLayer->LockBitmaps();
-#endif //_DEBUG
+    StrengthRayPolicy policy(strength, ignoreMaterial);
+    bool foundPixel = TraceRay(start, ray, skip, wrap, policy);
 
-    int hitCount = 0, error, dom, sub, domSteps, skipped = skip;
-    int intPos[2], delta[2], delta2[2], increment[2];
-    bool foundPixel = false;
-    unsigned char materialID;
-    Material const * foundMaterial;
-
-    intPos[X] = floorf(start.m_X);
-    intPos[Y] = floorf(start.m_Y);
-    delta[X] = floorf(start.m_X + ray.m_X) - intPos[X];
-    delta[Y] = floorf(start.m_Y + ray.m_Y) - intPos[Y];
-    
-    if (delta[X] == 0 &&  delta[Y] == 0)
-        return false;
-
-    /////////////////////////////////////////////////////
-    // Bresenham's line drawing algorithm preparation
-
-    if (delta[X] < 0)
-    {
-        increment[X] = -1;
-        delta[X] = -delta[X];
-    }
-    else
-        increment[X] = 1;
-
-    if (delta[Y] < 0)
-    {
-        increment[Y] = -1;
-        delta[Y] = -delta[Y];
-    }
-    else
-        increment[Y] = 1;
-
-    // Scale by 2, for better accuracy of the error at the first pixel
-    delta2[X] = delta[X] << 1;
-    delta2[Y] = delta[Y] << 1;
-
-    // If X is dominant, Y is submissive, and vice versa.
-    if (delta[X] > delta[Y]) {
-        dom = X;
-        sub = Y;
-    }
-    else {
-        dom = Y;
-        sub = X;
-    }
-
-    error = delta2[sub] - delta[dom];
-
-    /////////////////////////////////////////////////////
-    // Bresenham's line drawing algorithm execution
-
-    for (domSteps = 0; domSteps < delta[dom]; ++domSteps)
-    {
-        intPos[dom] += increment[dom];
-        if (error >= 0)
-        {
-            intPos[sub] += increment[sub];
-            error -= delta2[dom];
-        }
-        error += delta2[sub];
-
-        // Only check pixel if we're not due to skip any, or if this is the last pixel
-        if (++skipped > skip || domSteps + 1 == delta[dom])
-        {
-            // Scene wrapping, if necessary
-            if (wrap)
-                g_SceneMan.WrapPosition(intPos[X], intPos[Y]);
-
-            materialID = GetTerrMatter(intPos[X], intPos[Y]);
-            // Ignore the ignore material
-            if (materialID != ignoreMaterial)
-            {
-                // Get the material object
-                foundMaterial = GetMaterialFromID(materialID);
-
-                // See if we found a pixel of equal or more strength than the threshold
-                if (foundMaterial->strength >= strength)
-                {
-                    // Save result and report success
-                    foundPixel = true;
-                    result.SetXY(intPos[X], intPos[Y]);
-                    // Save last ray pos
-                    m_LastRayHitPos.SetIntXY(intPos[X], intPos[Y]);
-                    break;
-                }
-            }
-            skipped = 0;
-
-#ifdef _DEBUG
-            // Draw debug graphics, if applicable
-            if (m_pDebugLayer)
-                m_pDebugLayer->SetPixel(intPos[X], intPos[Y], 13);
-#endif //_DEBUG
-        }
-    }
-
-#ifdef _DEBUG
-    if (m_pDebugLayer)
-        m_pDebugLayer->UnlockBitmaps();
-#endif //_DEBUG
-
-    // If no pixel of sufficient strength was found, set the result to the final tried position
-    if (!foundPixel)
-        result.SetXY(intPos[X], intPos[Y]);
+    // If no pixel of sufficient strength was found, this is the final tried position
+    if (policy.m_Traced)
+        result.SetXY(policy.m_EndPos[X], policy.m_EndPos[Y]);
+    // Save last ray pos
+    if (foundPixel)
+        m_LastRayHitPos.SetIntXY(policy.m_EndPos[X], policy.m_EndPos[Y]);
 
     return foundPixel;
 }
@@ -2366,260 +2278,37 @@ bool SceneMan::CastStrengthRay(const Vector &start, const Vector &ray, float str
 //                  encounter with a pixel of a material with strength less than or equal
 //                  to a specific value.
 
-bool SceneMan::CastWeaknessRay(const Vector &start, const Vector &ray, float strength, Vector &result, int skip, bool wrap)
-{
-#ifdef _DEBUG
-    if (m_pDebugLayer)
-        m_pDebugLayer->LockBitmaps();
-#endif //_DEBUG
-
-    int hitCount = 0, error, dom, sub, domSteps, skipped = skip;
-    int intPos[2], delta[2], delta2[2], increment[2];
-    bool foundPixel = false;
-    unsigned char materialID;
-    Material const *foundMaterial;
-
-    intPos[X] = floorf(start.m_X);
-    intPos[Y] = floorf(start.m_Y);
-    delta[X] = floorf(start.m_X + ray.m_X) - intPos[X];
-    delta[Y] = floorf(start.m_Y + ray.m_Y) - intPos[Y];
-    
-    if (delta[X] == 0 &&  delta[Y] == 0)
-        return false;
-
-    /////////////////////////////////////////////////////
-    // Bresenham's line drawing algorithm preparation
-
-    if (delta[X] < 0)
-    {
-        increment[X] = -1;
-        delta[X] = -delta[X];
-    }
-    else
-        increment[X] = 1;
-
-    if (delta[Y] < 0)
-    {
-        increment[Y] = -1;
-        delta[Y] = -delta[Y];
-    }
-    else
-        increment[Y] = 1;
-
-    // Scale by 2, for better accuracy of the error at the first pixel
-    delta2[X] = delta[X] << 1;
-    delta2[Y] = delta[Y] << 1;
-
-    // If X is dominant, Y is submissive, and vice versa.
-    if (delta[X] > delta[Y]) {
-        dom = X;
-        sub = Y;
-    }
-    else {
-        dom = Y;
-        sub = X;
-    }
-
-    error = delta2[sub] - delta[dom];
-
-    /////////////////////////////////////////////////////
-    // Bresenham's line drawing algorithm execution
-
-    for (domSteps = 0; domSteps < delta[dom]; ++domSteps)
-    {
-        intPos[dom] += increment[dom];
-        if (error >= 0)
-        {
-            intPos[sub] += increment[sub];
-            error -= delta2[dom];
-        }
-        error += delta2[sub];
-
-        // Only check pixel if we're not due to skip any, or if this is the last pixel
-        if (++skipped > skip || domSteps + 1 == delta[dom])
-        {
-            // Scene wrapping, if necessary
-            if (wrap)
-                g_SceneMan.WrapPosition(intPos[X], intPos[Y]);
-
-            materialID = GetTerrMatter(intPos[X], intPos[Y]);
-            foundMaterial = GetMaterialFromID(materialID);
-
-            // See if we found a pixel of equal or less strength than the threshold
-            if (foundMaterial->strength <= strength)
-            {
-                // Save result and report success
-                foundPixel = true;
-                result.SetXY(intPos[X], intPos[Y]);
-                // Save last ray pos
-                m_LastRayHitPos.SetIntXY(intPos[X], intPos[Y]);
-                break;
-            }
-
-            skipped = 0;
-
-#ifdef _DEBUG
-            // Draw debug graphics, if applicable
-            if (m_pDebugLayer)
-                m_pDebugLayer->SetPixel(intPos[X], intPos[Y], 13);
-#endif //_DEBUG
-        }
-    }
-
-#ifdef _DEBUG
-    if (m_pDebugLayer)
-        m_pDebugLayer->UnlockBitmaps();
-#endif //_DEBUG
-
-    // If no pixel of sufficient strength was found, set the result to the final tried position
-    if (!foundPixel)
-        result.SetXY(intPos[X], intPos[Y]);
-
-    return foundPixel;
-}
-
-
-//////////////////////////////////////////////////////////////////////////////////////////
-// Method:          CastMORay
-//////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Traces along a vector and returns MOID of the first non-ignored
-//                  non-NoMOID MO encountered. If a non-air terrain pixel is encountered
-//                  first, 0 will be returned.
-
-MOID SceneMan::CastMORay(const Vector &start, const Vector &ray, MOID ignoreMOID, int ignoreTeam, unsigned char ignoreMaterial, bool ignoreAllTerrain, int skip)
-{
-#ifdef _DEBUG
-    if (m_pDebugLayer)
-        m_pDebugLayer->LockBitmaps();
-#endif //_DEBUG
-
-    int hitCount = 0, error, dom, sub, domSteps, skipped = skip;
-    int intPos[2], delta[2], delta2[2], increment[2];
-    MOID hitMOID = g_NoMOID;
-    unsigned char hitTerrain = 0;
-
-    intPos[X] = floorf(start.m_X);
-    intPos[Y] = floorf(start.m_Y);
-    delta[X] = floorf(start.m_X + ray.m_X) - intPos[X];
-    delta[Y] = floorf(start.m_Y + ray.m_Y) - intPos[Y];
-    
-    if (delta[X] == 0 && delta[Y] == 0)
-        return g_NoMOID;
-
-    /////////////////////////////////////////////////////
-    // Bresenham's line drawing algorithm preparation
-
-    if (delta[X] < 0)
-    {
-        increment[X] = -1;
-        delta[X] = -delta[X];
-    }
-    else
-        increment[X] = 1;
-
-    if (delta[Y] < 0)
-    {
-        increment[Y] = -1;
-        delta[Y] = -delta[Y];
-    }
-    else
-        increment[Y] = 1;
-
-    // Scale by 2, for better accuracy of the error at the first pixel
-    delta2[X] = delta[X] << 1;
-    delta2[Y] = delta[Y] << 1;
-
-    // If X is dominant, Y is submissive, and vice versa.
-    if (delta[X] > delta[Y]) {
-        dom = X;
-        sub = Y;
-    }
-    else {
-        dom = Y;
-        sub = X;
-    }
-
-    error = delta2[sub] - delta[dom];
-
-    /////////////////////////////////////////////////////
-    // Bresenham's line drawing algorithm execution
-
-    for (domSteps = 0; domSteps < delta[dom]; ++domSteps)
-    {
-        intPos[dom] += increment[dom];
-        if (error >= 0)
-        {
-            intPos[sub] += increment[sub];
-            error -= delta2[dom];
-        }
-        error += delta2[sub];
-
-        // Only check pixel if we're not due to skip any, or if this is the last pixel
-        if (++skipped > skip || domSteps + 1 == delta[dom])
-        {
-
-            // Scene wrapping, if necessary
-            g_SceneMan.WrapPosition(intPos[X], intPos[Y]);
-
-            // Detect MOIDs
-            hitMOID = GetMOIDPixel(intPos[X], intPos[Y]);
-            if (hitMOID != g_NoMOID && hitMOID != ignoreMOID && g_MovableMan.GetRootMOID(hitMOID) != ignoreMOID)
-            {
-                // Check if we're supposed to ignore the team of what we hit
-                if (ignoreTeam != Activity::NOTEAM)
-                {
-                    const MovableObject *pHitMO = g_MovableMan.GetMOFromID(hitMOID);
-                    pHitMO = pHitMO ? pHitMO->GetRootParent() : 0;
-                    // Yup, we are supposed to ignore this!
-                    if (pHitMO && pHitMO->IgnoresTeamHits() && pHitMO->GetTeam() == ignoreTeam)
-                    {
-                        ;
-                    }
-                    else
-                    {
-                        // Save last ray pos
-                        m_LastRayHitPos.SetIntXY(intPos[X], intPos[Y]);
-                        return hitMOID;
-                    }
-                }
-                // Legit hit
-                else
-                {
-                    // Save last ray pos
-                    m_LastRayHitPos.SetIntXY(intPos[X], intPos[Y]);
-                    return hitMOID;
-                }
-            }
+bool SceneMan::CastWeaknessRay(const Vector &start, const Vector &ray, float strength, Vector &result, int skip, bool wrap)
+{
+    WeaknessRayPolicy policy(strength);
+    bool foundPixel = TraceRay(start, ray, skip, wrap, policy);
 
-            // Detect terrain hits
-            if (!ignoreAllTerrain)
-            {
-                hitTerrain = g_SceneMan.GetTerrMatter(intPos[X], intPos[Y]);
-                if (hitTerrain != g_MaterialAir && hitTerrain != ignoreMaterial)
-                {
-                    // Save last ray pos
-                    m_LastRayHitPos.SetIntXY(intPos[X], intPos[Y]);
-                    return g_NoMOID;
-                }
-            }
+    // If no pixel of sufficient strength was found, this is the final tried position
+    if (policy.m_Traced)
+        result.SetXY(policy.m_EndPos[X], policy.m_EndPos[Y]);
+    // Save last ray pos
+    if (foundPixel)
+        m_LastRayHitPos.SetIntXY(policy.m_EndPos[X], policy.m_EndPos[Y]);
 
-            skipped = 0;
+    return foundPixel;
+}
 
-#ifdef _DEBUG
-            // Draw debug graphics, if applicable
-            if (m_pDebugLayer)
-                m_pDebugLayer->SetPixel(intPos[X], intPos[Y], 120);
-#endif //_DEBUG
-        }
-    }
 
-#ifdef _DEBUG
-    if (m_pDebugLayer)
-        m_pDebugLayer->UnlockBitmaps();
-#endif //_DEBUG
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CastMORay
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Traces along a vector and returns MOID of the first non-ignored
+//                  non-NoMOID MO encountered. If a non-air terrain pixel is encountered
+//                  first, 0 will be returned.
 
-    // Didn't hit anything but air
-    return g_NoMOID;
+MOID SceneMan::CastMORay(const Vector &start, const Vector &ray, MOID ignoreMOID, int ignoreTeam, unsigned char ignoreMaterial, bool ignoreAllTerrain, int skip)
+{
+    MORayPolicy policy(ignoreMOID, ignoreTeam, ignoreMaterial, ignoreAllTerrain);
+    // Save last ray pos if we hit either an MO or terrain
+    if (TraceRay(start, ray, skip, true, policy))
+        m_LastRayHitPos.SetIntXY(policy.m_EndPos[X], policy.m_EndPos[Y]);
+
+    return policy.m_HitMOID;
 }
 
 
@@ -2630,271 +2319,194 @@ MOID SceneMan::CastMORay(const Vector &start, const Vector &ray, MOID ignoreMOID
 
 bool SceneMan::CastFindMORay(const Vector &start, const Vector &ray, MOID targetMOID, Vector &resultPos, unsigned char ignoreMaterial, bool ignoreAllTerrain, int skip)
 {
-#ifdef _DEBUG
-    if (m_pDebugLayer)
-        m_pDebugLayer->LockBitmaps();
-#endif //_DEBUG
-
-    int hitCount = 0, error, dom, sub, domSteps, skipped = skip;;
-    int intPos[2], delta[2], delta2[2], increment[2];
-    MOID hitMOID = g_NoMOID;
-    unsigned char hitTerrain = 0;
+    FindMORayPolicy policy(targetMOID, ignoreMaterial, ignoreAllTerrain);
+    if (!TraceRay(start, ray, skip, true, policy))
+        return false;
 
-    intPos[X] = floorf(start.m_X);
-    intPos[Y] = floorf(start.m_Y);
-    delta[X] = floorf(start.m_X + ray.m_X) - intPos[X];
-    delta[Y] = floorf(start.m_Y + ray.m_Y) - intPos[Y];
-    
-    if (delta[X] == 0 && delta[Y] == 0)
-        return g_NoMOID;
+    // Save last ray pos if we hit either the target or terrain
+    m_LastRayHitPos.SetIntXY(policy.m_EndPos[X], policy.m_EndPos[Y]);
+    if (policy.m_FoundTarget)
+        resultPos.SetXY(policy.m_EndPos[X], policy.m_EndPos[Y]);
 
-    /////////////////////////////////////////////////////
-    // Bresenham's line drawing algorithm preparation
+    return policy.m_FoundTarget;
+}
 
-    if (delta[X] < 0)
-    {
-        increment[X] = -1;
-        delta[X] = -delta[X];
-    }
-    else
-        increment[X] = 1;
 
-    if (delta[Y] < 0)
-    {
-        increment[Y] = -1;
-        delta[Y] = -delta[Y];
-    }
-    else
-        increment[Y] = 1;
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CastObstacleRay
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Traces along a vector and returns the length of how far the trace went
+//                  without hitting any non-ignored terrain material or MOID at all.
 
-    // Scale by 2, for better accuracy of the error at the first pixel
-    delta2[X] = delta[X] << 1;
-    delta2[Y] = delta[Y] << 1;
+float SceneMan::CastObstacleRay(const Vector &start, const Vector &ray, Vector &obstaclePos, Vector &freePos, MOID ignoreMOID, int ignoreTeam, unsigned char ignoreMaterial, int skip)
+{
+    bool hitObstacle = false;
+    float distance = TraceObstacleRay(start, ray, obstaclePos, freePos, ignoreMOID, ignoreTeam, ignoreMaterial, skip, hitObstacle);
 
-    // If X is dominant, Y is submissive, and vice versa.
-    if (delta[X] > delta[Y]) {
-        dom = X;
-        sub = Y;
-    }
-    else {
-        dom = Y;
-        sub = X;
-    }
+    // Save last ray pos
+    if (hitObstacle)
+        m_LastRayHitPos.SetIntXY(floorf(obstaclePos.m_X), floorf(obstaclePos.m_Y));
 
-    error = delta2[sub] - delta[dom];
+    return distance;
+}
 
-    /////////////////////////////////////////////////////
-    // Bresenham's line drawing algorithm execution
 
-    for (domSteps = 0; domSteps < delta[dom]; ++domSteps)
-    {
-        intPos[dom] += increment[dom];
-        if (error >= 0)
-        {
-            intPos[sub] += increment[sub];
-            error -= delta2[dom];
-        }
-        error += delta2[sub];
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          TraceObstacleRay
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Does the actual work of CastObstacleRay, without touching any state
+//                  of this so it can be run for many rays at once.
 
-        // Only check pixel if we're not due to skip any, or if this is the last pixel
-        if (++skipped > skip || domSteps + 1 == delta[dom])
-        {
-            // Scene wrapping, if necessary
-            g_SceneMan.WrapPosition(intPos[X], intPos[Y]);
+float SceneMan::TraceObstacleRay(const Vector &start, const Vector &ray, Vector &obstaclePos, Vector &freePos, MOID ignoreMOID, int ignoreTeam, unsigned char ignoreMaterial, int skip, bool &hitObstacle)
+{
+    // The fraction of a pixel that we start from, to be added to the integer result positions for accuracy
+    Vector startFraction(start.m_X - floorf(start.m_X), start.m_Y - floorf(start.m_Y));
 
-            // Detect MOIDs
-            hitMOID = GetMOIDPixel(intPos[X], intPos[Y]);
-            if (hitMOID == targetMOID || g_MovableMan.GetRootMOID(hitMOID) == targetMOID)
-            {
-                // Found target MOID, so save result and report success
-                resultPos.SetXY(intPos[X], intPos[Y]);
-                // Save last ray pos
-                m_LastRayHitPos.SetIntXY(intPos[X], intPos[Y]);
-                return true;
-            }
+    ObstacleRayPolicy policy(freePos, ignoreMOID, ignoreTeam, ignoreMaterial);
+    hitObstacle = TraceRay(start, ray, skip, true, policy);
 
-            // Detect terrain hits
-            if (!ignoreAllTerrain)
-            {
-                hitTerrain = g_SceneMan.GetTerrMatter(intPos[X], intPos[Y]);
-                if (hitTerrain != g_MaterialAir && hitTerrain != ignoreMaterial)
-                {
-                    // Save last ray pos
-                    m_LastRayHitPos.SetIntXY(intPos[X], intPos[Y]);
-                    return false;
-                }
-            }
+    // A ray too short to trace counts as an obstacle right at the start
+    if (!policy.m_Traced)
+        return 0;
 
-            skipped = 0;
+    // Add the pixel fraction to the free position if there were any free pixels
+    if (policy.m_FreeSteps != 0)
+        freePos += startFraction;
 
-#ifdef _DEBUG
-            // Draw debug graphics, if applicable
-            if (m_pDebugLayer)
-                m_pDebugLayer->SetPixel(intPos[X], intPos[Y], 120);
-#endif //_DEBUG
-        }
+    if (hitObstacle)
+    {
+        // Add the pixel fraction to the obstacle position, to acoid losing precision
+        obstaclePos.SetXY(policy.m_EndPos[X], policy.m_EndPos[Y]);
+        obstaclePos += startFraction;
+        // If there was an obstacle on the start position, return 0 as the distance to obstacle
+        if (policy.m_FreeSteps == 0)
+            return 0;
+        // Calculate the length between the start and the found material pixel coords
+        else
+            return g_SceneMan.ShortestDistance(obstaclePos, start).GetMagnitude();
     }
 
-#ifdef _DEBUG
-    if (m_pDebugLayer)
-        m_pDebugLayer->UnlockBitmaps();
-#endif //_DEBUG
-
-    // Didn't hit the target
-    return false;
+    // Didn't hit anything but air
+    return -1.0;
 }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
-// Method:          CastObstacleRay
+// Method:          QueueMORay
 //////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Traces along a vector and returns the length of how far the trace went
-//                  without hitting any non-ignored terrain material or MOID at all.
+// Description:     Queues a ray to be cast like CastMORay, along with all the others in
+//                  the next CastRayBatch.
 
-float SceneMan::CastObstacleRay(const Vector &start, const Vector &ray, Vector &obstaclePos, Vector &freePos, MOID ignoreMOID, int ignoreTeam, unsigned char ignoreMaterial, int skip)
+int SceneMan::QueueMORay(const Vector &start, const Vector &ray, const MovableObject *pIgnoreMO, int ignoreTeam, unsigned char ignoreMaterial, bool ignoreAllTerrain, int skip)
 {
-#ifdef _DEBUG
-    if (m_pDebugLayer)
-        m_pDebugLayer->LockBitmaps();
-#endif //_DEBUG
-
-    int hitCount = 0, error, dom, sub, domSteps, skipped = skip;
-    int intPos[2], delta[2], delta2[2], increment[2];
-    bool hitObstacle = false;
-
-    intPos[X] = floorf(start.m_X);
-    intPos[Y] = floorf(start.m_Y);
-    delta[X] = floorf(start.m_X + ray.m_X) - intPos[X];
-    delta[Y] = floorf(start.m_Y + ray.m_Y) - intPos[Y];
-    // The fraction of a pixel that we start from, to be added to the integer result positions for accuracy
-    Vector startFraction(start.m_X - intPos[X], start.m_Y - intPos[Y]);
+    BatchedRay newRay;
+    newRay.m_Type = BatchedRay::MORAY;
+    newRay.m_Start = start;
+    newRay.m_Ray = ray;
+    newRay.m_pIgnoreMO = pIgnoreMO;
+    newRay.m_IgnoreMOID = g_NoMOID;
+    newRay.m_IgnoreTeam = ignoreTeam;
+    newRay.m_IgnoreMaterial = ignoreMaterial;
+    newRay.m_IgnoreAllTerrain = ignoreAllTerrain;
+    newRay.m_Skip = skip;
+    m_QueuedRays.push_back(newRay);
 
-    if (delta[X] == 0 && delta[Y] == 0)
-        return false;
+    // IDs only ever count up, wrapping around at the top of the positive range. Unsigned so the sum can't overflow
+    return static_cast<int>((static_cast<unsigned int>(m_QueuedRaysFirstID) + m_QueuedRays.size() - 1) & 0x7FFFFFFF);
+}
 
-    /////////////////////////////////////////////////////
-    // Bresenham's line drawing algorithm preparation
 
-    if (delta[X] < 0)
-    {
-        increment[X] = -1;
-        delta[X] = -delta[X];
-    }
-    else
-        increment[X] = 1;
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          QueueObstacleRay
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Queues a ray to be cast like CastObstacleRay, along with all the
+//                  others in the next CastRayBatch.
 
-    if (delta[Y] < 0)
-    {
-        increment[Y] = -1;
-        delta[Y] = -delta[Y];
-    }
-    else
-        increment[Y] = 1;
+int SceneMan::QueueObstacleRay(const Vector &start, const Vector &ray, const MovableObject *pIgnoreMO, int ignoreTeam, unsigned char ignoreMaterial, int skip)
+{
+    int rayID = QueueMORay(start, ray, pIgnoreMO, ignoreTeam, ignoreMaterial, false, skip);
+    m_QueuedRays.back().m_Type = BatchedRay::OBSTACLERAY;
+    return rayID;
+}
 
-    // Scale by 2, for better accuracy of the error at the first pixel
-    delta2[X] = delta[X] << 1;
-    delta2[Y] = delta[Y] << 1;
 
-    // If X is dominant, Y is submissive, and vice versa.
-    if (delta[X] > delta[Y]) {
-        dom = X;
-        sub = Y;
-    }
-    else {
-        dom = Y;
-        sub = X;
-    }
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CastRayBatch
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Casts all the rays queued since the last call in one go, spread over
+//                  the ThreadMan workers.
 
-    error = delta2[sub] - delta[dom];
+void SceneMan::CastRayBatch()
+{
+    m_CastRays.swap(m_QueuedRays);
+    m_CastRaysFirstID = m_QueuedRaysFirstID;
+    m_QueuedRaysFirstID = static_cast<int>((static_cast<unsigned int>(m_QueuedRaysFirstID) + m_CastRays.size()) & 0x7FFFFFFF);
+    m_QueuedRays.clear();
 
-    /////////////////////////////////////////////////////
-    // Bresenham's line drawing algorithm execution
+    if (m_CastRays.empty() || !m_pCurrentScene)
+        return;
 
-    for (domSteps = 0; domSteps < delta[dom]; ++domSteps)
-    {
-        intPos[dom] += increment[dom];
-        if (error >= 0)
-        {
-            intPos[sub] += increment[sub];
-            error -= delta2[dom];
-        }
-        error += delta2[sub];
+    // The ignored MOs may have new MOIDs since their rays were queued, or be gone altogether
+    for (vector<BatchedRay>::iterator itr = m_CastRays.begin(); itr != m_CastRays.end(); ++itr)
+        itr->m_IgnoreMOID = itr->m_pIgnoreMO && g_MovableMan.ValidMO(itr->m_pIgnoreMO) ? itr->m_pIgnoreMO->GetRootID() : g_NoMOID;
 
-        // Only check pixel if we're not due to skip any, or if this is the last pixel
-        if (++skipped > skip || domSteps + 1 == delta[dom])
-        {
-            // Scene wrapping, if necessary
-            g_SceneMan.WrapPosition(intPos[X], intPos[Y]);
+    int chunkCount = (m_CastRays.size() + m_RayBatchChunkSize - 1) / m_RayBatchChunkSize;
+#ifdef _DEBUG
+    // The debug layer drawing of the rays isn't thread safe
+    for (int chunk = 0; chunk < chunkCount; ++chunk)
+        CastBatchedRays(chunk);
+#else
+    g_ThreadMan.RunParallelJobs(chunkCount, std::bind(&SceneMan::CastBatchedRays, this, std::placeholders::_1));
+#endif
+}
 
-            unsigned char checkMat = GetTerrMatter(intPos[X], intPos[Y]);
-            MOID checkMOID = GetMOIDPixel(intPos[X], intPos[Y]);
 
-            // Translate any found MOID into the root MOID of that hit MO
-            if (checkMOID != g_NoMOID)
-            {
-                MovableObject *pHitMO = g_MovableMan.GetMOFromID(checkMOID);
-                if (pHitMO)
-                {
-                    checkMOID = pHitMO->GetRootID();
-                    // Check if we're supposed to ignore the team of what we hit
-                    if (ignoreTeam != Activity::NOTEAM)
-                    {
-                        pHitMO = pHitMO->GetRootParent();
-                        // We are indeed supposed to ignore this object because of its ignoring of its specific team
-                        if (pHitMO && pHitMO->IgnoresTeamHits() && pHitMO->GetTeam() == ignoreTeam)
-                            checkMOID = g_NoMOID;
-                    }
-                }
-            }
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CastBatchedRays
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Casts one chunk of the rays of the current batch.
 
-            // See if we found the looked-for pixel of the correct material,
-            // Or an MO is blocking the way
-            if ((checkMat != g_MaterialAir && checkMat != ignoreMaterial) || (checkMOID != g_NoMOID && checkMOID != ignoreMOID))
-            {
-                hitObstacle = true;
-                obstaclePos.SetXY(intPos[X], intPos[Y]);
-                // Save last ray pos
-                m_LastRayHitPos.SetIntXY(intPos[X], intPos[Y]);
-                break;
-            }
-            else
-                freePos.SetXY(intPos[X], intPos[Y]);
+void SceneMan::CastBatchedRays(int chunk)
+{
+    int rayIndex = chunk * m_RayBatchChunkSize;
+    int lastIndex = MIN(rayIndex + m_RayBatchChunkSize, (int)m_CastRays.size());
 
-            skipped = 0;
+    for (; rayIndex < lastIndex; ++rayIndex)
+    {
+        BatchedRay &ray = m_CastRays[rayIndex];
+        ray.m_HitMOID = g_NoMOID;
+        ray.m_HitPos.Reset();
+        ray.m_FreePos = ray.m_Start;
+        ray.m_Distance = -1.0;
 
-#ifdef _DEBUG
-            // Draw debug graphics, if applicable
-            if (m_pDebugLayer)
-                m_pDebugLayer->SetPixel(intPos[X], intPos[Y], 13);
-#endif //_DEBUG
+        if (ray.m_Type == BatchedRay::MORAY)
+        {
+            MORayPolicy policy(ray.m_IgnoreMOID, ray.m_IgnoreTeam, ray.m_IgnoreMaterial, ray.m_IgnoreAllTerrain);
+            if (TraceRay(ray.m_Start, ray.m_Ray, ray.m_Skip, true, policy))
+                ray.m_HitPos.SetIntXY(policy.m_EndPos[X], policy.m_EndPos[Y]);
+            ray.m_HitMOID = policy.m_HitMOID;
         }
         else
-            freePos.SetXY(intPos[X], intPos[Y]);
+        {
+            bool hitObstacle = false;
+            ray.m_Distance = TraceObstacleRay(ray.m_Start, ray.m_Ray, ray.m_HitPos, ray.m_FreePos, ray.m_IgnoreMOID, ray.m_IgnoreTeam, ray.m_IgnoreMaterial, ray.m_Skip, hitObstacle);
+        }
     }
+}
 
-#ifdef _DEBUG
-    if (m_pDebugLayer)
-        m_pDebugLayer->UnlockBitmaps();
-#endif //_DEBUG
 
-    // Add the pixel fraction to the free position if there were any free pixels
-    if (domSteps != 0)
-        freePos += startFraction;
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetBatchedRay
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets a ray cast by the last CastRayBatch, with its results.
 
-    if (hitObstacle)
-    {
-        // Add the pixel fraction to the obstacle position, to acoid losing precision
-        obstaclePos += startFraction;
-        // If there was an obstacle on the start position, return 0 as the distance to obstacle
-        if (domSteps == 0)
-            return 0;
-        // Calculate the length between the start and the found material pixel coords
-        else
-            return g_SceneMan.ShortestDistance(obstaclePos, start).GetMagnitude();
-    }
+const BatchedRay * SceneMan::GetBatchedRay(int rayID) const
+{
+    if (rayID < 0)
+        return 0;
 
-    // Didn't hit anything but air
-    return -1.0;
+    int rayIndex = static_cast<int>((static_cast<unsigned int>(rayID) - static_cast<unsigned int>(m_CastRaysFirstID)) & 0x7FFFFFFF);
+    return rayIndex < (int)m_CastRays.size() ? &m_CastRays[rayIndex] : 0;
 }
 
 
@@ -3870,7 +3482,18 @@ void SceneMan::ClearMOColorLayer()
 {
     SLICK_PROFILE(0xFF454621);
 
-    clear_to_color(m_pMOColorLayer->GetBitmap(), g_KeyColor);
+    // Only clear what was drawn since the last clear, unless that adds up to most of the layer anyway
+    BITMAP *pMOColorBitmap = m_pMOColorLayer->GetBitmap();
+    if (m_MOColorDrawnArea * 2 >= (long long)pMOColorBitmap->w * pMOColorBitmap->h)
+        clear_to_color(pMOColorBitmap, g_KeyColor);
+    else
+    {
+        for (vector<IntRect>::iterator itr = m_MOColorDrawings.begin(); itr != m_MOColorDrawings.end(); ++itr)
+            ClearLayerRect(pMOColorBitmap, itr->m_Left, itr->m_Top, itr->m_Right, itr->m_Bottom, g_KeyColor);
+    }
+    m_MOColorDrawings.clear();
+    m_MOColorDrawnArea = 0;
+    m_pMOColorLayer->ClearDirtyTiles();
 
 #ifdef _DEBUG
     clear_to_color(m_pDebugLayer->GetBitmap(), g_KeyColor);
@@ -19,6 +19,7 @@
 #include <string>
 #include <list>
 #include <queue>
+#include <vector>
 
 
 // *** TEMP
@@ -113,6 +114,45 @@ struct IntRect
 };
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Struct:          BatchedRay
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     A ray queued with SceneMan to be cast along with all the others in the
+//                  next CastRayBatch, and the results of that.
+// Parent(s):       None.
+// Class history:   10/17/2026 BatchedRay created.
+
+struct BatchedRay
+{
+    enum RayType
+    {
+        MORAY = 0,
+        OBSTACLERAY
+    };
+
+    // What kind of ray this is, and the arguments it was queued with
+    RayType m_Type;
+    Vector m_Start;
+    Vector m_Ray;
+    const MovableObject *m_pIgnoreMO;
+    // The root MOID of the ignored MO, only worked out when the ray is cast since MOIDs are registered anew every frame
+    MOID m_IgnoreMOID;
+    int m_IgnoreTeam;
+    unsigned char m_IgnoreMaterial;
+    bool m_IgnoreAllTerrain;
+    int m_Skip;
+
+    // The MOID that an MO ray hit
+    MOID m_HitMOID;
+    // Where the ray hit something, or where an obstacle ray was blocked
+    Vector m_HitPos;
+    // The last free position an obstacle ray passed through
+    Vector m_FreePos;
+    // How far an obstacle ray got, as CastObstacleRay returns it
+    float m_Distance;
+};
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Class:           SceneMan
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -246,6 +286,28 @@ public:
     virtual const Scene * GetSceneToLoad() { return m_pSceneToLoad; }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsPlacingObjects
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Shows whether the Scene to be loaded will apply the SceneObject:s
+//                  placed in its definition.
+// Arguments:       None.
+// Return value:    Whether objects will be placed.
+
+    bool IsPlacingObjects() const { return m_PlaceObjects; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsPlacingUnits
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Shows whether the Scene to be loaded will deploy the units placed in
+//                  its definition.
+// Arguments:       None.
+// Return value:    Whether units will be placed.
+
+    bool IsPlacingUnits() const { return m_PlaceUnits; }
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Virtual method:  LoadScene
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -856,6 +918,34 @@ public:
     void ClearAllMOIDDrawings();
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RegisterMOColorDrawing
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Registers an area of the MOColor layer to be cleared the next time the
+//                  layer is cleared. Should be done every time anything is drawn to the
+//                  MOColor layer, or it may neither show up nor get cleared.
+// Arguments:       The bitmap that was drawn to. If it isn't the MOColor layer, nothing
+//                  is registered, so this can be called regardless of the drawing target.
+//                  The coordinates of the drawn area on the MOColor layer, inclusive.
+// Return value:    None.
+
+    void RegisterMOColorDrawing(const BITMAP *pDrawnBitmap, int left, int top, int right, int bottom);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RegisterMOColorDrawing
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Registers an area of the MOColor layer to be cleared the next time the
+//                  layer is cleared. Should be done every time anything is drawn to the
+//                  MOColor layer, or it may neither show up nor get cleared.
+// Arguments:       The bitmap that was drawn to. If it isn't the MOColor layer, nothing
+//                  is registered, so this can be called regardless of the drawing target.
+//                  The center coordinates and a radius around it of the drawn area.
+// Return value:    None.
+
+    void RegisterMOColorDrawing(const BITMAP *pDrawnBitmap, const Vector &center, float radius);
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          ClearMOIDRect
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1368,6 +1458,98 @@ public:
     const Vector & GetLastRayHitPos() { return m_LastRayHitPos; }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          QueueMORay
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Queues a ray to be cast like CastMORay, along with all the others in
+//                  the next CastRayBatch. This happens at the start of the next frame's
+//                  MO updates, so the results can be picked up in the next AI update.
+// Arguments:       The same as for CastMORay, except that the MO to ignore is given
+//                  itself instead of its MOID, which may have changed by the time the
+//                  ray is cast. All of the MO's parts are ignored. 0 ignores none.
+// Return value:    The ID to get the results of the ray with after it has been cast.
+
+    int QueueMORay(const Vector &start, const Vector &ray, const MovableObject *pIgnoreMO = 0, int ignoreTeam = Activity::NOTEAM, unsigned char ignoreMaterial = 0, bool ignoreAllTerrain = false, int skip = 0);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          QueueObstacleRay
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Queues a ray to be cast like CastObstacleRay, along with all the
+//                  others in the next CastRayBatch.
+// Arguments:       The same as for CastObstacleRay, minus the result positions, and with
+//                  the MO to ignore given like for QueueMORay.
+// Return value:    The ID to get the results of the ray with after it has been cast.
+
+    int QueueObstacleRay(const Vector &start, const Vector &ray, const MovableObject *pIgnoreMO = 0, int ignoreTeam = Activity::NOTEAM, unsigned char ignoreMaterial = 0, int skip = 0);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CastRayBatch
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Casts all the rays queued since the last call in one go, spread over
+//                  the ThreadMan workers. Their results replace the ones of the previous
+//                  batch. LockScene() must be called before using this method.
+// Arguments:       None.
+// Return value:    None.
+
+    void CastRayBatch();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetBatchedRay
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets a ray cast by the last CastRayBatch, with its results. MOIDs are
+//                  only valid during the frame the batch was cast in.
+// Arguments:       The ID the ray was queued with.
+// Return value:    The cast ray, or 0 if it hasn't been cast yet or was cast by an older
+//                  batch.
+
+    const BatchedRay * GetBatchedRay(int rayID) const;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetBatchedRayMOID
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the MOID a ray cast by the last CastRayBatch hit.
+// Arguments:       The ID the ray was queued with.
+// Return value:    The hit MOID, or g_NoMOID if nothing was hit or the ray isn't available.
+
+    MOID GetBatchedRayMOID(int rayID) const { const BatchedRay *pRay = GetBatchedRay(rayID); return pRay ? pRay->m_HitMOID : g_NoMOID; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetBatchedRayHitPos
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets where a ray cast by the last CastRayBatch hit something.
+// Arguments:       The ID the ray was queued with.
+// Return value:    The hit position, or a zero vector if nothing was hit.
+
+    Vector GetBatchedRayHitPos(int rayID) const { const BatchedRay *pRay = GetBatchedRay(rayID); return pRay ? pRay->m_HitPos : Vector(); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetBatchedRayFreePos
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the last free position an obstacle ray cast by the last
+//                  CastRayBatch passed through.
+// Arguments:       The ID the ray was queued with.
+// Return value:    The last free position, or the start of the ray if there was none.
+
+    Vector GetBatchedRayFreePos(int rayID) const { const BatchedRay *pRay = GetBatchedRay(rayID); return pRay ? pRay->m_FreePos : Vector(); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetBatchedRayDistance
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets how far an obstacle ray cast by the last CastRayBatch got.
+// Arguments:       The ID the ray was queued with.
+// Return value:    The distance to the obstacle as CastObstacleRay returns it, or < 0 if
+//                  nothing was hit or the ray isn't available.
+
+    float GetBatchedRayDistance(int rayID) const { const BatchedRay *pRay = GetBatchedRay(rayID); return pRay ? pRay->m_Distance : -1.0; }
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          FindAltitude
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1747,7 +1929,8 @@ public:
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          ClearMOColorLayer
 //////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Clears the color MO layer. Should be done every frame.
+// Description:     Clears the color MO layer. Should be done every frame. Only the areas
+//                  registered with RegisterMOColorDrawing since the last clear are cleared.
 // Arguments:       None.
 // Return value:    None.
 
@@ -1799,8 +1982,9 @@ public:
 // Method:          RegisterTerrainChange
 //////////////////////////////////////////////////////////////////////////////////////////
 // Description:     Registers terrain change event for the network server to be then sent to clients.
+//					The changed tiles are sent with what's on the terrain by then.
 // Arguments:       x,y - scene coordinates of change, w,h - size of the changed region, 
-//					color - changed color for one-pixel events, 
+//					color - changed color for one-pixel events, no longer used, 
 //					back - if true, then background bitmap was changed if false then foreground.
 // Return value:    None.
 
@@ -1824,6 +2008,19 @@ public:
 
 protected:
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ClearLayerRect
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Fills a rectangle of a scene-wide layer bitmap with a color. Will take
+//                  care of wrapping.
+// Arguments:       The scene-wide bitmap to fill in.
+//                  The corners of the rectangle, inclusive.
+//                  The color to fill with.
+// Return value:    None.
+
+    void ClearLayerRect(BITMAP *pLayerBitmap, int left, int top, int right, int bottom, int color);
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          GetPostScreenEffects
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1877,6 +2074,10 @@ protected:
     SceneLayer *m_pMOIDLayer;
     // All the areas drawn within on the MOID layer since last Update
     std::list<IntRect> m_MOIDDrawings;
+    // All the areas drawn within on the MOColor layer since it was last cleared. A vector, since there is one per drawn particle
+    std::vector<IntRect> m_MOColorDrawings;
+    // The total area of m_MOColorDrawings, overlaps counted twice; when it gets large, the whole layer is cleared at once instead
+    long long m_MOColorDrawnArea;
     // All post-processing effects registered for this draw frame in the scene. Vector in scene coordinates, BITMAPs not owned
     std::list<PostEffect> m_PostSceneEffects;
     // All the areas to do post glow pixel effects on, in scene coordinates
@@ -1886,6 +2087,12 @@ protected:
     SceneLayer *m_pDebugLayer;
     // The absolute end position of the last ray cast
     Vector m_LastRayHitPos;
+    // The rays queued since the last CastRayBatch, and the ID of the first of them
+    std::vector<BatchedRay> m_QueuedRays;
+    int m_QueuedRaysFirstID;
+    // The rays cast by the last CastRayBatch, and the ID of the first of them
+    std::vector<BatchedRay> m_CastRays;
+    int m_CastRaysFirstID;
     // The mode we're drawing layers in to the screen
     int m_LayerDrawMode;
 
@@ -1963,6 +2170,51 @@ private:
     void Clear();
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          TraceRay
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     The Bresenham traversal shared by all the Cast*Ray methods. Steps
+//                  along a ray and hands every pixel that isn't skipped to a policy,
+//                  whose Check(x, y) decides whether to stop there. Skipped pixels are
+//                  passed to its Skip(x, y). Afterwards the policy's m_Traced and
+//                  m_EndPos hold whether there was anything to trace and where it ended.
+// Arguments:       The starting position.
+//                  The vector to trace along.
+//                  For every pixel checked, how many to skip before the next check.
+//                  Whether to wrap the checked positions around the scene.
+//                  The policy to check the pixels with.
+// Return value:    Whether the policy stopped the trace.
+
+    template <class RayPolicy>
+    bool TraceRay(const Vector &start, const Vector &ray, int skip, bool wrap, RayPolicy &policy);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          TraceObstacleRay
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Does the actual work of CastObstacleRay, without touching any state
+//                  of this so it can be run for many rays at once.
+// Arguments:       The same as for CastObstacleRay.
+//                  Set to whether an obstacle was hit.
+// Return value:    The same as for CastObstacleRay.
+
+    float TraceObstacleRay(const Vector &start, const Vector &ray, Vector &obstaclePos, Vector &freePos, MOID ignoreMOID, int ignoreTeam, unsigned char ignoreMaterial, int skip, bool &hitObstacle);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CastBatchedRays
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Casts one chunk of the rays of the current batch.
+// Arguments:       The index of the chunk of m_RayBatchChunkSize rays.
+// Return value:    None.
+
+    void CastBatchedRays(int chunk);
+
+
+    // How many rays each job of CastRayBatch casts
+    static const int m_RayBatchChunkSize;
+
+
     // Disallow the use of some implicit methods.
     SceneMan(const SceneMan &reference);
     SceneMan & operator=(const SceneMan &rhs);
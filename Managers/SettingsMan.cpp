@@ -69,6 +69,7 @@ void SettingsMan::Clear()
 	m_EndlessMode = false;
 	m_PrintDebugInfo = false;
 	m_PreciseCollisions = true;
+	m_ParallelParticleTravel = true;
 	m_ForceSafeGfxDriver = false;
 	m_ForceSoftwareGfxDriver = false;
 	m_ForceSafeGfxDriver = false;
@@ -94,9 +95,18 @@ void SettingsMan::Clear()
 	m_ServerTransmitAsBoxes = true;
 	m_ServerBoxWidth = 32;
 	m_ServerBoxHeight = 44;
+	m_ServerUseDeltaCompression = true;
+	m_ServerKeyframeInterval = 150;
+	m_ServerBoxRefreshInterval = 30;
 
 	m_UseNATService = false;
 	m_DisableLoadingScreen = false;
+	m_RotatedSpriteCacheSize = 32;
+	m_UseParticleStore = true;
+	m_AsyncPathFinding = true;
+	m_PathFindingBudget = 1.0;
+	m_ThreadedPostProcessing = true;
+	m_LuaScriptBudget = 0;
 
 	m_AudioChannels = 32;
 
@@ -258,6 +268,8 @@ int SettingsMan::ReadProperty(std::string propName, Reader &reader)
     }
 	else if (propName == "PreciseCollisions")
 		reader >> m_PreciseCollisions;
+	else if (propName == "ParallelParticleTravel")
+		reader >> m_ParallelParticleTravel;
 	else if (propName == "RealToSimCap")
     {
         float cap;
@@ -328,6 +340,12 @@ int SettingsMan::ReadProperty(std::string propName, Reader &reader)
 		reader >> m_ServerBoxWidth;
 	else if (propName == "ServerBoxHeight")
 		reader >> m_ServerBoxHeight;
+	else if (propName == "ServerUseDeltaCompression")
+		reader >> m_ServerUseDeltaCompression;
+	else if (propName == "ServerKeyframeInterval")
+		reader >> m_ServerKeyframeInterval;
+	else if (propName == "ServerBoxRefreshInterval")
+		reader >> m_ServerBoxRefreshInterval;
 	else if (propName == "ClientInputFps")
 		reader >> m_ClientInputFps;
 	else if (propName == "UseNATService")
@@ -346,6 +364,18 @@ int SettingsMan::ReadProperty(std::string propName, Reader &reader)
 		reader >> m_AudioChannels;
 	else if (propName == "DisableLoadingScreen")
 		reader >> m_DisableLoadingScreen;
+	else if (propName == "RotatedSpriteCacheSize")
+		reader >> m_RotatedSpriteCacheSize;
+	else if (propName == "UseParticleStore")
+		reader >> m_UseParticleStore;
+	else if (propName == "AsyncPathFinding")
+		reader >> m_AsyncPathFinding;
+	else if (propName == "PathFindingBudget")
+		reader >> m_PathFindingBudget;
+	else if (propName == "ThreadedPostProcessing")
+		reader >> m_ThreadedPostProcessing;
+	else if (propName == "LuaScriptBudget")
+		reader >> m_LuaScriptBudget;
 	else if (propName == "SoundVolume")
     {
         int volume = 0;
@@ -470,6 +500,8 @@ int SettingsMan::Save(Writer &writer) const
     writer << g_TimerMan.GetRealToSimCap();
 	writer.NewProperty("PreciseCollisions");
 	writer << m_PreciseCollisions;
+	writer.NewProperty("ParallelParticleTravel");
+	writer << m_ParallelParticleTravel;
     writer.NewProperty("HSplitScreen");
     writer << g_FrameMan.GetHSplit();
     writer.NewProperty("VSplitScreen");
@@ -536,6 +568,12 @@ int SettingsMan::Save(Writer &writer) const
 	writer << m_ServerBoxWidth;
 	writer.NewProperty("ServerBoxHeight");
 	writer << m_ServerBoxHeight;
+	writer.NewProperty("ServerUseDeltaCompression");
+	writer << m_ServerUseDeltaCompression;
+	writer.NewProperty("ServerKeyframeInterval");
+	writer << m_ServerKeyframeInterval;
+	writer.NewProperty("ServerBoxRefreshInterval");
+	writer << m_ServerBoxRefreshInterval;
 	writer.NewProperty("ClientInputFps");
 	writer << m_ClientInputFps;
 	writer.NewProperty("UseNATService");
@@ -566,6 +604,18 @@ int SettingsMan::Save(Writer &writer) const
 	
 	writer.NewProperty("DisableLoadingScreen");
 	writer << m_DisableLoadingScreen;
+	writer.NewProperty("RotatedSpriteCacheSize");
+	writer << m_RotatedSpriteCacheSize;
+	writer.NewProperty("UseParticleStore");
+	writer << m_UseParticleStore;
+	writer.NewProperty("AsyncPathFinding");
+	writer << m_AsyncPathFinding;
+	writer.NewProperty("PathFindingBudget");
+	writer << m_PathFindingBudget;
+	writer.NewProperty("ThreadedPostProcessing");
+	writer << m_ThreadedPostProcessing;
+	writer.NewProperty("LuaScriptBudget");
+	writer << m_LuaScriptBudget;
 
 	writer.NewProperty("AudioChannels");
 	writer << m_AudioChannels;
@@ -326,6 +326,28 @@ public:
 	void SetPreciseCollisions(bool newValue) { m_PreciseCollisions = newValue; }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:  ParallelParticleTravel
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Whether simple particles that can't hit anything this frame are moved
+//					on the ThreadMan worker threads(true), or all particles travel serially(false)
+// Arguments:       None.
+// Return value:    True if particle travel is spread over the worker threads
+
+	bool ParallelParticleTravel() const { return m_ParallelParticleTravel; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:  SetParallelParticleTravel
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Sets whether simple particles that can't hit anything this frame are
+//					moved on the ThreadMan worker threads
+// Arguments:       Whether to travel particles in parallel.
+// Return value:    None
+
+	void SetParallelParticleTravel(bool newValue) { m_ParallelParticleTravel = newValue; }
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:			ModsInstalledLastTime
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -618,6 +640,25 @@ public:
 	//  
 	int GetServerBoxHeight() const { return m_ServerBoxHeight; }
 
+	//////////////////////////////////////////////////////////////////////////////////////////
+	// Method:			GetServerUseDeltaCompression
+	//////////////////////////////////////////////////////////////////////////////////////////
+	//  Whether boxes unchanged since the previous frame are skipped and changed boxes are
+	//	sent as XOR deltas against the last keyframe acknowledged by the client.
+	bool GetServerUseDeltaCompression() const { return m_ServerUseDeltaCompression; }
+
+	//////////////////////////////////////////////////////////////////////////////////////////
+	// Method:			GetServerKeyframeInterval
+	//////////////////////////////////////////////////////////////////////////////////////////
+	//  How many frames pass before the delta reference keyframe is refreshed.
+	int GetServerKeyframeInterval() const { return m_ServerKeyframeInterval; }
+
+	//////////////////////////////////////////////////////////////////////////////////////////
+	// Method:			GetServerBoxRefreshInterval
+	//////////////////////////////////////////////////////////////////////////////////////////
+	//  How many frames an unchanged box may go unsent, so lost boxes are eventually repaired.
+	int GetServerBoxRefreshInterval() const { return m_ServerBoxRefreshInterval; }
+
 	bool GetUseNATService() { return m_UseNATService; }
 
 	std::string & GetNATServiceAddress() { return m_NATServiceAddress; }
@@ -640,6 +681,30 @@ public:
 
 	bool DisableLoadingScreen() { return m_DisableLoadingScreen; }
 
+	// How many megabytes the cache of pre-rotated sprites may use; 0 disables it
+	int GetRotatedSpriteCacheSize() const { return m_RotatedSpriteCacheSize; }
+
+	// Whether the simplest free flying particles are kept packed in the ParticleStore instead of as full MOs
+	bool UseParticleStore() const { return m_UseParticleStore; }
+
+	// Whether actors' paths are worked out by the background path worker instead of on the spot
+	bool AsyncPathFinding() const { return m_AsyncPathFinding; }
+
+	void SetAsyncPathFinding(bool asyncPathFinding) { m_AsyncPathFinding = asyncPathFinding; }
+
+	// How long the pathfinding may spend catching up on terrain changes each frame, in ms
+	float GetPathFindingBudget() const { return m_PathFindingBudget; }
+
+	// Whether the post processing of each frame runs on its own thread while the next frame is simulated and drawn
+	bool ThreadedPostProcessing() const { return m_ThreadedPostProcessing; }
+
+	void SetPathFindingBudget(float budget) { m_PathFindingBudget = budget; }
+
+	// How long Lua scripts may take each sim update while the sim is running behind before low priority ones wait, in ms. 0 means no limit
+	float GetLuaScriptBudget() const { return m_LuaScriptBudget; }
+
+	void SetLuaScriptBudget(float budget) { m_LuaScriptBudget = budget; }
+
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // Protected member variable and method declarations
@@ -672,6 +737,8 @@ protected:
 	//Whether CC uses additional Draws during MO's PreTravel and PostTravel to 
 	//update MO layer this frame with more precision(true), or it just uses data from the last frame with less precision(false)
 	bool m_PreciseCollisions;
+	// Whether simple particles that can't hit anything this frame travel on the worker threads
+	bool m_ParallelParticleTravel;
 	// Whether we should try using software-mode drivers
 	bool m_ForceSoftwareGfxDriver;
 	// Whether we should try using safe-mode drivers
@@ -711,6 +778,12 @@ protected:
 
 	int m_ServerBoxHeight;
 
+	bool m_ServerUseDeltaCompression;
+
+	int m_ServerKeyframeInterval;
+
+	int m_ServerBoxRefreshInterval;
+
 	bool m_UseNATService;
 
 	std::string m_NATServiceAddress;
@@ -727,6 +800,17 @@ protected:
 
 	bool m_DisableLoadingScreen;
 
+	int m_RotatedSpriteCacheSize;
+
+	bool m_UseParticleStore;
+
+	bool m_AsyncPathFinding;
+	float m_PathFindingBudget;
+
+	bool m_ThreadedPostProcessing;
+
+	float m_LuaScriptBudget;
+
     // The coordinates of all the license pixels in the hidden license file (base.rte/oldpal.bmp)
     std::list<Vector> m_LicensePixels;
     // List of the module names we were subscribed to last time the game was started
@@ -14,13 +14,13 @@
 
 #include "ThreadMan.h"
 
+#include <algorithm>
+
 using namespace std;
 
 namespace RTE
 {
 
-#define DELTABUFFERSIZE 30
-
 const string ThreadMan::m_ClassName = "ThreadMan";
 
 
@@ -32,6 +32,9 @@ const string ThreadMan::m_ClassName = "ThreadMan";
 
 void ThreadMan::Clear()
 {
+    m_Workers.clear();
+    m_Batches.clear();
+    m_Quit = false;
 }
 
 
@@ -42,8 +45,12 @@ void ThreadMan::Clear()
 
 int ThreadMan::Create()
 {
+    // Leave one hardware thread for the calling thread, which also takes part in the work
+    int workerCount = (int)thread::hardware_concurrency() - 1;
+    for (int i = 0; i < workerCount; ++i)
+        m_Workers.push_back(thread(&ThreadMan::WorkerLoop, this));
 
-	return 0;
+    return 0;
 }
 
 
@@ -54,9 +61,108 @@ int ThreadMan::Create()
 
 void ThreadMan::Destroy()
 {
-
+    {
+        lock_guard<mutex> lock(m_JobMutex);
+        m_Quit = true;
+    }
+    m_JobPosted.notify_all();
+
+    for (vector<thread>::iterator itr = m_Workers.begin(); itr != m_Workers.end(); ++itr)
+    {
+        if (itr->joinable())
+            itr->join();
+    }
 
     Clear();
 }
 
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RunParallelJobs
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Runs a job function once for every index in [0, jobCount), spread
+//                  out over the worker threads and the calling thread.
+
+void ThreadMan::RunParallelJobs(int jobCount, const function<void(int)> &job)
+{
+    if (jobCount <= 0)
+        return;
+
+    // No point in waking anyone up for a single job, or if there is nobody to wake
+    if (m_Workers.empty() || jobCount == 1)
+    {
+        for (int i = 0; i < jobCount; ++i)
+            job(i);
+        return;
+    }
+
+    JobBatch batch;
+    batch.pJob = &job;
+    batch.NextJob = 0;
+    batch.JobCount = jobCount;
+    batch.JobsRemaining = jobCount;
+
+    unique_lock<mutex> lock(m_JobMutex);
+    m_Batches.push_back(&batch);
+    m_JobPosted.notify_all();
+
+    // Help out instead of just waiting around, but only with our own batch so we don't get held up by others
+    RunAvailableJobs(lock, &batch);
+
+    while (batch.JobsRemaining > 0)
+        m_JobsDone.wait(lock);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RunAvailableJobs
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Takes and runs jobs of a batch until there are none left to hand
+//                  out, then removes it from the queue.
+
+void ThreadMan::RunAvailableJobs(unique_lock<mutex> &lock, JobBatch *pBatch)
+{
+    while (pBatch->NextJob < pBatch->JobCount)
+    {
+        int jobIndex = pBatch->NextJob++;
+
+        // Last job handed out, nobody else needs to find this batch anymore
+        if (pBatch->NextJob == pBatch->JobCount)
+        {
+            deque<JobBatch *>::iterator itr = find(m_Batches.begin(), m_Batches.end(), pBatch);
+            if (itr != m_Batches.end())
+                m_Batches.erase(itr);
+        }
+
+        lock.unlock();
+        (*pBatch->pJob)(jobIndex);
+        lock.lock();
+
+        // The batch may be gone from the caller's stack right after this, don't touch it again
+        if (--pBatch->JobsRemaining == 0)
+        {
+            m_JobsDone.notify_all();
+            return;
+        }
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          WorkerLoop
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     The function each worker thread runs until told to quit.
+
+void ThreadMan::WorkerLoop()
+{
+    unique_lock<mutex> lock(m_JobMutex);
+    while (!m_Quit)
+    {
+        if (!m_Batches.empty())
+            RunAvailableJobs(lock, m_Batches.front());
+        else
+            m_JobPosted.wait(lock);
+    }
+}
+
 } // namespace RTE
\ No newline at end of file
@@ -14,13 +14,13 @@
 //////////////////////////////////////////////////////////////////////////////////////////
 // Inclusions of header files
 
-#include "global_types.h"
-
-
 #include <string>
 #include <deque>
-
-//#include <boost/thread.hpp>
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #include "Singleton.h"
 #define g_ThreadMan ThreadMan::Instance()
@@ -31,7 +31,8 @@ namespace RTE
 //////////////////////////////////////////////////////////////////////////////////////////
 // Class:           ThreadMan
 //////////////////////////////////////////////////////////////////////////////////////////
-// Description:     The centralized singleton manager of all threads.
+// Description:     The centralized singleton manager of all threads. Owns a small pool
+//                  of worker threads that can be handed batches of independent jobs.
 // Parent(s):       Singleton
 // Class history:   03/29/2014  ThreadMan created.
 
@@ -54,7 +55,7 @@ public:
 //                  memory. Create() should be called before using the object.
 // Arguments:       None.
 
-    ThreadMan() { Clear(); Create(); }
+    ThreadMan() { Clear(); }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -108,14 +109,67 @@ public:
 
     virtual const std::string & GetClassName() const { return m_ClassName; }
 
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetWorkerCount
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the number of worker threads in the pool, not counting the
+//                  calling thread which also takes part in RunParallelJobs.
+// Arguments:       None.
+// Return value:    The number of worker threads. 0 means everything runs serially.
+
+    int GetWorkerCount() const { return m_Workers.size(); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RunParallelJobs
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Runs a job function once for every index in [0, jobCount), spread
+//                  out over the worker threads and the calling thread. Blocks until all
+//                  the jobs have finished. Jobs must not touch shared state that other
+//                  jobs write to, and must not call RunParallelJobs themselves.
+//                  Several threads may run batches at the same time, the workers take
+//                  them on in the order they were posted.
+// Arguments:       The number of jobs to run.
+//                  The function to run for each job, called with the job index.
+// Return value:    None.
+
+    void RunParallelJobs(int jobCount, const std::function<void(int)> &job);
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Protected member variable and method declarations
 
 protected:
 
+    // One call to RunParallelJobs, lives on the stack of the calling thread
+    struct JobBatch
+    {
+        // The job function to run
+        const std::function<void(int)> *pJob;
+        // Index of the next job to be handed out
+        int NextJob;
+        // Total number of jobs
+        int JobCount;
+        // Number of jobs that haven't finished yet
+        int JobsRemaining;
+    };
+
     // Member variables
     static const std::string m_ClassName;
 
+    // The worker threads of the pool
+    std::vector<std::thread> m_Workers;
+    // Guards all the job state below
+    std::mutex m_JobMutex;
+    // Signalled when a new batch of jobs is posted, or when the workers should quit
+    std::condition_variable m_JobPosted;
+    // Signalled when the last job of any batch has finished
+    std::condition_variable m_JobsDone;
+    // Batches which still have jobs to hand out, oldest first
+    std::deque<JobBatch *> m_Batches;
+    // Whether the workers have been told to exit
+    bool m_Quit;
+
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -133,6 +187,29 @@ private:
 
     void Clear();
 
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          WorkerLoop
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     The function each worker thread runs until told to quit.
+// Arguments:       None.
+// Return value:    None.
+
+    void WorkerLoop();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RunAvailableJobs
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Takes and runs jobs of a batch until there are none left to hand out,
+//                  then removes it from the queue. m_JobMutex must be held by the caller
+//                  through lock, and is held again on return.
+// Arguments:       The lock held on m_JobMutex.
+//                  The batch to run jobs of.
+// Return value:    None.
+
+    void RunAvailableJobs(std::unique_lock<std::mutex> &lock, JobBatch *pBatch);
+
     // Disallow the use of some implicit methods.
     ThreadMan(const ThreadMan &reference);
     ThreadMan & operator=(const ThreadMan &rhs);
@@ -71,6 +71,7 @@ void TimerMan::Clear()
     // This gets dynamically turned on for short periods when sim gets heavy (explosions) and slomo effect is appropriate
     m_OneSimUpdatePerFrame = false;
     m_SimSpeedLimited = true;
+    m_FixedSimUpdates = false;
 }
 
 
@@ -204,7 +205,11 @@ int64_t TimerMan::GetAbsoulteTime()
 	ticks = tickReading.QuadPart;
 #elif defined(__APPLE__)
 	ticks = mach_absolute_time();
-#endif // defined(__APPLE__)
+#elif defined(__unix__)
+	timespec my_TimeSpec;
+	clock_gettime(CLOCK_MONOTONIC, &my_TimeSpec);
+	ticks = (int64_t)((my_TimeSpec.tv_sec * 1000000) + (my_TimeSpec.tv_nsec / 1000));
+#endif // defined(__unix__)
 	
 	ticks *= 1000000;
 	ticks /= m_TicksPerSecond;
@@ -273,6 +278,13 @@ void TimerMan::Update()
         // Reset the counter of sim updates since the last drawn.. it will always be 0 since every update results in a drawn frame
         m_SimUpdatesSinceDrawn = -1;
     }
+
+    // Put exactly one delta time in there, whether more or less real time has passed
+    if (m_FixedSimUpdates)
+    {
+        m_SimAccumulator = m_SimPaused ? 0 : m_DeltaTime;
+        m_SimUpdatesSinceDrawn = -1;
+    }
 /*
 #ifdef _DEBUG
     // Override the accumulator and just put one delta time in there so sim updates only once per frame
@@ -335,6 +335,30 @@ public:
     bool IsOneSimUpdatePerFrame() const { return m_OneSimUpdatePerFrame; }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          SetFixedSimUpdates
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Sets whether to run exactly one sim update for each graphics frame, as
+//                  fast as the frames can be made, no matter how much real time passes.
+//                  Makes the amount of simulation per frame the same from run to run,
+//                  for benchmarking.
+// Arguments:       Whether the sim should be stepped once per frame regardless of real time.
+// Return value:    None.
+
+    void SetFixedSimUpdates(bool fixedUpdates = true) { m_FixedSimUpdates = fixedUpdates; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsFixedSimUpdates
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Shows whether exactly one sim update is run for each graphics frame,
+//                  no matter how much real time passes.
+// Arguments:       None.
+// Return value:    Whether the sim is stepped once per frame regardless of real time.
+
+    bool IsFixedSimUpdates() const { return m_FixedSimUpdates; }
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          SetSimSpeedLimited
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -468,6 +492,8 @@ protected:
     bool m_SimPaused;
     // Whether to force this to artifically make time for only one single sim update for the graphics frame. Useful for debugging or profiling.
     bool m_OneSimUpdatePerFrame;
+    // Whether to run exactly one sim update per frame no matter how much real time has passed
+    bool m_FixedSimUpdates;
     // Whether the simulation is limted to going at 1.0x and not faster
     bool m_SimSpeedLimited;
 
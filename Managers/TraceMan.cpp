@@ -0,0 +1,351 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// File:            TraceMan.cpp
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Source file for the TraceMan class.
+// Project:         Retro Terrain Engine
+// Author(s):
+//
+//
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Inclusions of header files
+
+#include "TraceMan.h"
+#include "TimerMan.h"
+#include "ConsoleMan.h"
+#include "DDTTools.h"
+
+#include <fstream>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#if defined(_MSC_VER)
+#define TRACE_THREAD_LOCAL __declspec(thread)
+#else
+#define TRACE_THREAD_LOCAL __thread
+#endif
+
+using namespace std;
+
+namespace RTE
+{
+
+const string TraceMan::m_ClassName = "TraceMan";
+const string TraceMan::m_sDefaultTracePath = "Trace.json";
+
+// How many events each thread keeps, the oldest are overwritten by the newest once full
+const int TraceBufferSize = 1 << 16;
+
+// A scope recorded by a TraceScope
+struct TraceEvent
+{
+    const char *m_Function;
+    const char *m_Name;
+    long long m_Start;
+    long long m_End;
+};
+
+// The ring buffer of events recorded by one thread. The mutex is only ever contended
+// while the trace is written, so recording stays cheap
+struct TraceBuffer
+{
+    TraceBuffer(int threadIndex, bool mainThread): m_ThreadIndex(threadIndex), m_MainThread(mainThread), m_Events(TraceBufferSize), m_RecordedCount(0) { }
+
+    int m_ThreadIndex;
+    bool m_MainThread;
+    mutex m_Mutex;
+    vector<TraceEvent> m_Events;
+    // How many events have been recorded since the capture started, including overwritten ones
+    unsigned long long m_RecordedCount;
+};
+
+// Whether TraceScopes are recorded, read by all threads
+atomic<bool> Tracing(false);
+// The buffers of all threads which have recorded anything, guarded by the mutex
+mutex TraceBuffersMutex;
+vector<TraceBuffer *> TraceBuffers;
+// The thread TraceMan was created on
+thread::id MainThreadID;
+// The buffer of the calling thread, made the first time it records anything
+TRACE_THREAD_LOCAL TraceBuffer *ThreadTraceBuffer = 0;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Constructor:     TraceScope
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Constructor method used to start measuring a scope.
+
+TraceScope::TraceScope(const char *function, const char *name):
+    m_Function(function),
+    m_Name(name),
+    m_Start(Tracing.load(memory_order_relaxed) ? g_TimerMan.GetAbsoulteTime() : -1)
+{
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Destructor:      ~TraceScope
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Destructor method used to record the scope as it ends.
+
+TraceScope::~TraceScope()
+{
+    if (m_Start >= 0 && Tracing.load(memory_order_relaxed))
+        TraceMan::RecordEvent(m_Function, m_Name, m_Start, g_TimerMan.GetAbsoulteTime());
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Clear
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Clears all the member variables of this TraceMan, effectively
+//                  resetting the members of this abstraction level only.
+
+void TraceMan::Clear()
+{
+    m_TracePath = m_sDefaultTracePath;
+    m_CapturePending = false;
+    m_Capturing = false;
+    m_FramesLeft = 0;
+    m_FrameCount = 0;
+    m_CaptureStart = 0;
+    m_FrameStart = 0;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Create
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Makes the TraceMan object ready for use.
+
+int TraceMan::Create()
+{
+    MainThreadID = this_thread::get_id();
+    return 0;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Destroy
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Writes any capture in progress, frees the event buffers of all threads
+//                  and resets (through Clear()) the TraceMan object.
+
+void TraceMan::Destroy()
+{
+    if (m_Capturing)
+        StopCapture();
+
+    {
+        lock_guard<mutex> buffersLock(TraceBuffersMutex);
+        for (vector<TraceBuffer *>::iterator itr = TraceBuffers.begin(); itr != TraceBuffers.end(); ++itr)
+            delete *itr;
+        TraceBuffers.clear();
+    }
+    // Only this thread's own pointer can be reset, which is why all others must be done by now
+    ThreadTraceBuffer = 0;
+
+    Clear();
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          StartCapture
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Starts capturing a trace at the beginning of the next frame.
+
+int TraceMan::StartCapture(int frameCount, const string &tracePath)
+{
+    if (IsCapturing())
+    {
+        g_ConsoleMan.PrintString("ERROR: A trace is already being captured!");
+        return -1;
+    }
+
+    m_TracePath = tracePath.empty() ? m_sDefaultTracePath : tracePath;
+    m_FramesLeft = MAX(frameCount, 0);
+    m_CapturePending = true;
+
+    return 0;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          StopCapture
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Stops capturing and writes the trace captured so far.
+
+int TraceMan::StopCapture()
+{
+    // Never started, so there's nothing to write
+    if (m_CapturePending)
+    {
+        m_CapturePending = false;
+        return 0;
+    }
+    if (!m_Capturing)
+    {
+        g_ConsoleMan.PrintString("ERROR: No trace is being captured!");
+        return -1;
+    }
+
+    Tracing.store(false);
+    m_Capturing = false;
+
+    return WriteTrace();
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Update
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Starts or stops the capture at a frame boundary.
+
+void TraceMan::Update()
+{
+    if (m_Capturing)
+    {
+        // Each frame is an event of its own too, so they're easy to tell apart in the viewer
+        long long frameEnd = g_TimerMan.GetAbsoulteTime();
+        RecordEvent("Frame", 0, m_FrameStart, frameEnd);
+        m_FrameStart = frameEnd;
+        ++m_FrameCount;
+
+        if (m_FramesLeft > 0 && --m_FramesLeft == 0)
+            StopCapture();
+    }
+    else if (m_CapturePending)
+    {
+        // Whatever is left over from the last capture is thrown out
+        {
+            lock_guard<mutex> buffersLock(TraceBuffersMutex);
+            for (vector<TraceBuffer *>::iterator itr = TraceBuffers.begin(); itr != TraceBuffers.end(); ++itr)
+            {
+                lock_guard<mutex> bufferLock((*itr)->m_Mutex);
+                (*itr)->m_RecordedCount = 0;
+            }
+        }
+
+        m_CapturePending = false;
+        m_Capturing = true;
+        m_FrameCount = 0;
+        m_CaptureStart = m_FrameStart = g_TimerMan.GetAbsoulteTime();
+        Tracing.store(true);
+
+        g_ConsoleMan.PrintString("SYSTEM: Capturing a trace to \"" + m_TracePath + "\"");
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   IsTracing
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Shows whether TraceScopes are being recorded right now.
+
+bool TraceMan::IsTracing()
+{
+    return Tracing.load(memory_order_relaxed);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   RecordEvent
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Records a finished scope into the event buffer of the calling thread.
+
+void TraceMan::RecordEvent(const char *function, const char *name, long long start, long long end)
+{
+    if (!ThreadTraceBuffer)
+    {
+        lock_guard<mutex> buffersLock(TraceBuffersMutex);
+        ThreadTraceBuffer = new TraceBuffer(TraceBuffers.size(), this_thread::get_id() == MainThreadID);
+        TraceBuffers.push_back(ThreadTraceBuffer);
+    }
+
+    lock_guard<mutex> bufferLock(ThreadTraceBuffer->m_Mutex);
+    TraceEvent &event = ThreadTraceBuffer->m_Events[ThreadTraceBuffer->m_RecordedCount % TraceBufferSize];
+    event.m_Function = function;
+    event.m_Name = name;
+    event.m_Start = start;
+    event.m_End = end;
+    ++ThreadTraceBuffer->m_RecordedCount;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          WriteTrace
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Writes the events recorded by all threads to the trace file.
+
+int TraceMan::WriteTrace()
+{
+    ofstream trace(m_TracePath.c_str(), ios_base::out | ios_base::trunc);
+    if (!trace.good())
+    {
+        g_ConsoleMan.PrintString("ERROR: Couldn't open the trace \"" + m_TracePath + "\" for writing!");
+        return -1;
+    }
+
+    // The names are all string literals and function names, so they need no escaping
+    trace << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    unsigned long long eventCount = 0;
+    unsigned long long overwrittenCount = 0;
+    {
+        lock_guard<mutex> buffersLock(TraceBuffersMutex);
+        for (vector<TraceBuffer *>::iterator itr = TraceBuffers.begin(); itr != TraceBuffers.end(); ++itr)
+        {
+            TraceBuffer *pBuffer = *itr;
+            lock_guard<mutex> bufferLock(pBuffer->m_Mutex);
+
+            if (itr != TraceBuffers.begin())
+                trace << ",\n";
+            trace << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << pBuffer->m_ThreadIndex << ",\"args\":{\"name\":\"";
+            if (pBuffer->m_MainThread)
+                trace << "Main";
+            else
+                trace << "Worker " << pBuffer->m_ThreadIndex;
+            trace << "\"}}";
+
+            // Once the ring buffer is full, the oldest event is the one after the newest
+            unsigned long long first = pBuffer->m_RecordedCount > TraceBufferSize ? pBuffer->m_RecordedCount - TraceBufferSize : 0;
+            overwrittenCount += first;
+            for (unsigned long long recorded = first; recorded < pBuffer->m_RecordedCount; ++recorded)
+            {
+                const TraceEvent &event = pBuffer->m_Events[recorded % TraceBufferSize];
+                // Scopes which started before the capture did are only partly measured
+                if (event.m_Start < m_CaptureStart)
+                    continue;
+
+                trace << ",\n{\"name\":\"" << event.m_Function;
+                if (event.m_Name)
+                    trace << ": " << event.m_Name;
+                trace << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << pBuffer->m_ThreadIndex;
+                trace << ",\"ts\":" << event.m_Start - m_CaptureStart << ",\"dur\":" << event.m_End - event.m_Start << "}";
+                ++eventCount;
+            }
+        }
+    }
+    trace << "\n]}\n";
+
+    if (!trace.good())
+    {
+        g_ConsoleMan.PrintString("ERROR: Couldn't write the trace \"" + m_TracePath + "\"!");
+        return -1;
+    }
+
+    char report[512];
+    sprintf(report, "SYSTEM: Trace of %i frames with %llu events written to \"%s\"", m_FrameCount, eventCount, m_TracePath.c_str());
+    g_ConsoleMan.PrintString(report);
+    if (overwrittenCount > 0)
+    {
+        sprintf(report, "SYSTEM: The oldest %llu events were overwritten, capture fewer frames to keep them all", overwrittenCount);
+        g_ConsoleMan.PrintString(report);
+    }
+
+    return 0;
+}
+
+} // namespace RTE
@@ -0,0 +1,243 @@
+#ifndef _RTETraceMan_
+#define _RTETraceMan_
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// File:            TraceMan.h
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Header file for the TraceMan class.
+// Project:         Retro Terrain Engine
+// Author(s):
+//
+//
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Inclusions of header files
+
+#include <string>
+
+#include "Singleton.h"
+#define g_TraceMan TraceMan::Instance()
+
+namespace RTE
+{
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Class:           TraceMan
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     The centralized singleton manager of trace captures. While capturing,
+//                  every TraceScope made by the SLICK_PROFILE macros records the time it
+//                  started and ended into a ring buffer of the thread it ran on. After a
+//                  set number of frames, the events of all threads are written to a
+//                  Chrome Trace Event JSON file, which chrome://tracing or Perfetto can
+//                  show. Captures are started from the console or the command line.
+// Parent(s):       Singleton
+// Class history:   10/17/2026  TraceMan created.
+
+
+class TraceMan:
+    public Singleton<TraceMan>
+{
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Public member variable, method and friend function declarations
+
+public:
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Constructor:     TraceMan
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Constructor method used to instantiate a TraceMan object in system
+//                  memory. Create() should be called before using the object.
+// Arguments:       None.
+
+    TraceMan() { Clear(); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Destructor:      ~TraceMan
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Destructor method used to clean up a TraceMan object before deletion
+//                  from system memory.
+// Arguments:       None.
+
+    virtual ~TraceMan() { Destroy(); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Create
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Makes the TraceMan object ready for use. Must be called on the main
+//                  thread, so its events can be told apart from the worker threads'.
+// Arguments:       None.
+// Return value:    An error return value signaling sucess or any particular failure.
+//                  Anything below 0 is an error signal.
+
+    virtual int Create();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Virtual method:  Reset
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Resets the entire TraceMan, including its inherited members, to
+//                  their default settings or values.
+// Arguments:       None.
+// Return value:    None.
+
+    virtual void Reset() { Clear(); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Destroy
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Writes any capture in progress, frees the event buffers of all threads
+//                  and resets (through Clear()) the TraceMan object. All other threads
+//                  which traced anything must have been stopped by now.
+// Arguments:       None.
+// Return value:    None.
+
+    void Destroy();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Virtual method:  GetClassName
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the class name of this Entity.
+// Arguments:       None.
+// Return value:    A string with the friendly-formatted type name of this object.
+
+    virtual const std::string & GetClassName() const { return m_ClassName; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          StartCapture
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Starts capturing a trace at the beginning of the next frame.
+// Arguments:       How many whole frames to capture. 0 or less captures until
+//                  StopCapture is called.
+//                  The file to write the trace to once done. An empty string writes it
+//                  to the default file.
+// Return value:    An error return value signaling sucess or any particular failure.
+//                  Anything below 0 is an error signal.
+
+    int StartCapture(int frameCount, const std::string &tracePath);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          StopCapture
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Stops capturing and writes the trace captured so far.
+// Arguments:       None.
+// Return value:    An error return value signaling sucess or any particular failure.
+//                  Anything below 0 is an error signal.
+
+    int StopCapture();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsCapturing
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Shows whether a capture is in progress or about to start.
+// Arguments:       None.
+// Return value:    Whether capturing.
+
+    bool IsCapturing() const { return m_CapturePending || m_Capturing; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Update
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Starts or stops the capture at a frame boundary. Must be called once
+//                  at the beginning of every frame, outside any traced scope.
+// Arguments:       None.
+// Return value:    None.
+
+    void Update();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   IsTracing
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Shows whether TraceScopes are being recorded right now. Can be called
+//                  from any thread.
+// Arguments:       None.
+// Return value:    Whether tracing.
+
+    static bool IsTracing();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   RecordEvent
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Records a finished scope into the event buffer of the calling thread.
+//                  Can be called from any thread.
+// Arguments:       The names of the function and of the scope within it, which may be 0.
+//                  The absolute times the scope started and ended, in microseconds.
+// Return value:    None.
+
+    static void RecordEvent(const char *function, const char *name, long long start, long long end);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Protected member variable and method declarations
+
+protected:
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          WriteTrace
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Writes the events recorded by all threads to the trace file.
+// Arguments:       None.
+// Return value:    An error return value signaling sucess or any particular failure.
+//                  Anything below 0 is an error signal.
+
+    int WriteTrace();
+
+
+    // Member variables
+    static const std::string m_ClassName;
+    // The trace file written when no other is set
+    static const std::string m_sDefaultTracePath;
+
+    // The file to write the current capture to
+    std::string m_TracePath;
+    // Whether a capture starts at the beginning of the next frame
+    bool m_CapturePending;
+    // Whether a capture is in progress
+    bool m_Capturing;
+    // How many frames of the capture are left, 0 or less if it goes on until stopped
+    int m_FramesLeft;
+    // How many frames have been captured
+    int m_FrameCount;
+    // The absolute times the capture and the current frame of it started, in microseconds
+    long long m_CaptureStart;
+    long long m_FrameStart;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Private member variable and method declarations
+
+private:
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Clear
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Clears all the member variables of this TraceMan, effectively
+//                  resetting the members of this abstraction level only.
+// Arguments:       None.
+// Return value:    None.
+
+    void Clear();
+
+    // Disallow the use of some implicit methods.
+    TraceMan(const TraceMan &reference);
+    TraceMan & operator=(const TraceMan &rhs);
+
+};
+
+} // namespace RTE
+
+#endif // File
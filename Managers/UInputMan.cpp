@@ -803,6 +803,10 @@ int UInputMan::Create()
 //    if (!g_FrameMan.IsFullscreen())
 //        rest(500);
 
+    // A headless server has no window to take local input from, all input arrives over the network
+    if (g_FrameMan.IsHeadless())
+        return 0;
+
     // Get the Allegro keyboard going
     install_keyboard();
     // Hack to not have the keyboard lose focus permanently when window is started without focus
@@ -33,6 +33,14 @@ namespace RTE
 void SeedRand() { srand(time(0)); }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Global function: SeedRand
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Seeds the rand with a given seed, so the same sequence comes out again.
+
+void SeedRand(unsigned int seed) { srand(seed); }
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Global function: PosRand
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -347,6 +355,23 @@ bool ASCIIFileContainsString(string filePath, string findString)
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Global function: HashBytes
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Folds a block of memory into a running 32-bit FNV-1a hash.
+
+unsigned int HashBytes(const void *pData, size_t size, unsigned int hash)
+{
+    const unsigned char *pByte = static_cast<const unsigned char *>(pData);
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= pByte[i];
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+
 ///////////////////////////
 // Commence ugly hacking
 
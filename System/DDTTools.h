@@ -16,6 +16,7 @@
 
 #include <DebugTool/DebugTool.h>
 #include <Profiler/Profiler.h>
+#include "TraceScope.h"
 
 struct TexMapTable;
 
@@ -43,6 +44,14 @@ class Vector;
 void SeedRand();
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Global function: SeedRand
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Seeds the rand with a given seed, so the same sequence comes out again.
+
+void SeedRand(unsigned int seed);
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Global function: PosRand
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -199,6 +208,18 @@ std::string XTEADecrypt(std::string encrypted, std::string keyString, int numRou
 
 bool ASCIIFileContainsString(std::string filePath, std::string findString);
 
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Global function: HashBytes
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Folds a block of memory into a running 32-bit FNV-1a hash.
+// Arguments:       The memory to hash.
+//                  Its size in bytes.
+//                  The hash so far, to chain several blocks together.
+// Return value:    The new hash.
+
+unsigned int HashBytes(const void *pData, size_t size, unsigned int hash = 2166136261U);
+
 /*
 //////////////////////////////////////////////////////////////////////////////////////////
 // Global function: DrawMaterial
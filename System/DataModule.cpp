@@ -46,6 +46,9 @@ void DataModule::Clear()
     m_PresetList.clear();
 	m_EntityList.clear();
     m_TypeMap.clear();
+    m_PresetIndex.clear();
+    m_GroupIndex.clear();
+    m_GroupIndexChanges = Entity::GetPresetGroupChanges();
     for (int i = 0; i < NUM_PALETTE_ENTRIES; ++i)
         m_MaterialMappings[i] = 0;
 	m_ScanFolderContents = false;
@@ -409,6 +412,8 @@ bool DataModule::AddEntityPreset(Entity *pEntToAdd, bool overwriteSame, string r
             pEntToAdd->Clone(pExistingEntity);
             // Make sure the existing one is still marked as the Original Preset
             pExistingEntity->m_IsOriginalPreset = true;
+            // The new definition may be in different groups than the old one was
+            m_GroupIndexChanges = -1;
             // Alter the instance entry to reflect the data file location of the new definition
             if (readFromFile != "Same")
             {
@@ -485,22 +490,7 @@ bool DataModule::AddEntityPreset(Entity *pEntToAdd, bool overwriteSame, string r
 
 const Entity * DataModule::GetEntityPreset(string exactType, string instance)
 {
-    if (instance == "None" || instance.empty())
-        return 0;
-
-    map<string, list<pair<string, Entity *> > >::iterator clsItr = m_TypeMap.find(exactType);
-    if (clsItr == m_TypeMap.end())
-        return 0;
-
-    // Find an instance of that EXACT type and name
-    for (list<pair<string, Entity *> >::iterator instItr = (*clsItr).second.begin(); instItr != (*clsItr).second.end(); ++instItr)
-    {
-        // Check that the type is really the exact same as asked for; there may be others which are actually more derived types
-        if ((*instItr).first == instance && (*instItr).second->GetClassName() == exactType)
-            return (*instItr).second;
-    }
-
-    return 0;
+    return GetEntityIfExactType(exactType, instance);
 }
 
 
@@ -514,20 +504,7 @@ string DataModule::GetEntityDataLocation(std::string exactType, std::string inst
     if (instance == "None" || instance.empty())
         return "";
 
-    map<string, list<pair<string, Entity *> > >::iterator clsItr = m_TypeMap.find(exactType);
-    if (clsItr == m_TypeMap.end())
-        return "";
-
-    Entity *pFoundEnt = 0;
-
-    // Find an instance of that EXACT type and name
-    for (list<pair<string, Entity *> >::iterator instItr = (*clsItr).second.begin(); instItr != (*clsItr).second.end(); ++instItr)
-    {
-        // Check that the type is really the exact same as asked for; there may be others which are actually more derived types
-        if ((*instItr).first == instance && (*instItr).second->GetClassName() == exactType)
-            pFoundEnt = (*instItr).second;
-    }
-
+    Entity *pFoundEnt = GetEntityIfExactType(exactType, instance);
     if (!pFoundEnt)
         return "";
 
@@ -583,43 +560,40 @@ bool DataModule::GetAllOfGroup(list<Entity *> &entityList, string group, string
     if (group.empty())
         return false;
 
+    // Some preset has changed its groups since the index was built
+    if (m_GroupIndexChanges != Entity::GetPresetGroupChanges())
+        RebuildGroupIndex();
+
+    unordered_map<string, vector<Entity *> >::const_iterator grpItr = m_GroupIndex.find(group);
+    if (grpItr == m_GroupIndex.end())
+        return false;
+
     bool foundAny = false;
 
-    // Look in all classes, so only look in the Entity level, which includes all!
+    // Look in all classes
     if (type.empty() || type == "All")
     {
-        map<string, list<pair<string, Entity *> > >::iterator clsItr = m_TypeMap.find("Entity");
-        if (clsItr == m_TypeMap.end())
-            return false;
-
-        // Go through only the Entity typelist since it should contain all entitys in this DataModule
-        for (list<pair<string, Entity *> >::iterator instItr = clsItr->second.begin(); instItr != clsItr->second.end(); ++instItr)
+        for (vector<Entity *>::const_iterator instItr = grpItr->second.begin(); instItr != grpItr->second.end(); ++instItr)
         {
             // Get the grouped entitys, without transferring ownership
-            if (instItr->second->IsInGroup(group))
-            {
-                entityList.push_back(instItr->second);
-                foundAny = true;
-            }
+            entityList.push_back(*instItr);
+            foundAny = true;
         }
     }
     // Look only in one specific class (which will get all derived classes' entitys too!)
     else
     {
-        // Look for the class entry
-        map<string, list<pair<string, Entity *> > >::iterator clsItr = m_TypeMap.find(type);
-        if (clsItr == m_TypeMap.end())
-            return 0;
-
-        AAssert(!clsItr->second.empty(), "DataModule has class entry without instances in its map!?");
-
-        for (list<pair<string, Entity *> >::iterator instItr = clsItr->second.begin(); instItr != clsItr->second.end(); ++instItr)
+        for (vector<Entity *>::const_iterator instItr = grpItr->second.begin(); instItr != grpItr->second.end(); ++instItr)
         {
-            // Get the grouped entitys, without transferring ownership
-            if (instItr->second->IsInGroup(group))
+            // Walk up the class hierarchy of the grouped entity to see if it is of, or derived from, the asked for class
+            for (const Entity::ClassInfo *pClass = &((*instItr)->GetClass()); pClass != 0; pClass = pClass->GetParent())
             {
-                entityList.push_back(instItr->second);
-                foundAny = true;
+                if (pClass->GetName() == type)
+                {
+                    entityList.push_back(*instItr);
+                    foundAny = true;
+                    break;
+                }
             }
         }
     }
@@ -706,24 +680,14 @@ Entity * DataModule::GetEntityIfExactType(const std::string &exactType, const st
     if (exactType.empty() || instanceName == "None" || instanceName.empty())
         return 0;
 
-    map<string, list<pair<string, Entity *> > >::iterator clsItr = m_TypeMap.find(exactType);
-    // We didn't find any instances of this class, so report false
-    if (clsItr == m_TypeMap.end())
+    unordered_map<string, unordered_map<string, Entity *> >::const_iterator clsItr = m_PresetIndex.find(exactType);
+    // We didn't find any instances of this exact class, so report false
+    if (clsItr == m_PresetIndex.end())
         return 0;
-    // We found that instances of the same type exist
-    else
-    {
-        // See if there already is an instance of that class and name
-        // Find an instance of that EXACT type and name
-        for (list<pair<string, Entity *> >::iterator instItr = (*clsItr).second.begin(); instItr != (*clsItr).second.end(); ++instItr)
-        {
-            // Check that the type is really the exact same as asked for; there may be others which are actually more derived types
-            if ((*instItr).first == instanceName && (*instItr).second->GetClassName() == exactType)
-                return (*instItr).second;
-        }
-    }
 
-    return 0;
+    // See if there already is an instance of that EXACT class and name
+    unordered_map<string, Entity *>::const_iterator instItr = clsItr->second.find(instanceName);
+    return instItr != clsItr->second.end() ? instItr->second : 0;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -762,8 +726,50 @@ bool DataModule::AddToTypeMap(Entity *pEntToAdd)
         }
     }
 
+    // Only one preset of each exact class and name is ever added, see above
+    m_PresetIndex[pEntToAdd->GetClassName()][pEntToAdd->GetPresetName()] = pEntToAdd;
+
+    // Keep the group index current unless it is going to be rebuilt anyway
+    if (m_GroupIndexChanges == Entity::GetPresetGroupChanges())
+        AddToGroupIndex(pEntToAdd);
+
     // Signal that we successfully added the instance
     return true;
 }
 
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          AddToGroupIndex
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Appends a preset instance to the member lists of every group it is in.
+
+void DataModule::AddToGroupIndex(Entity *pEntToAdd)
+{
+    const list<string> *pGroupList = pEntToAdd->GetGroupList();
+    for (list<string>::const_iterator gItr = pGroupList->begin(); gItr != pGroupList->end(); ++gItr)
+        m_GroupIndex[*gItr].push_back(pEntToAdd);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RebuildGroupIndex
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Rebuilds the group member lists from scratch, in the order the presets
+//                  were added to this.
+
+void DataModule::RebuildGroupIndex()
+{
+    m_GroupIndex.clear();
+
+    // The Entity typelist has every preset of this, in the order they were added
+    map<string, list<pair<string, Entity *> > >::iterator clsItr = m_TypeMap.find("Entity");
+    if (clsItr != m_TypeMap.end())
+    {
+        for (list<pair<string, Entity *> >::iterator instItr = clsItr->second.begin(); instItr != clsItr->second.end(); ++instItr)
+            AddToGroupIndex(instItr->second);
+    }
+
+    m_GroupIndexChanges = Entity::GetPresetGroupChanges();
+}
+
 } // namespace RTE
\ No newline at end of file
@@ -19,6 +19,8 @@
 #include <string>
 #include <map>
 #include <list>
+#include <vector>
+#include <unordered_map>
 
 struct DATAFILE;
 struct BITMAP;
@@ -489,6 +491,27 @@ protected:
     bool AddToTypeMap(Entity *pEntToAdd);
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          AddToGroupIndex
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Appends a preset instance to the member lists of every group it is in.
+// Arguments:       The preset instance to add. Ownership is NOT transferred!
+// Return value:    None.
+
+    void AddToGroupIndex(Entity *pEntToAdd);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RebuildGroupIndex
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Rebuilds the group member lists from scratch, in the order the presets
+//                  were added to this. Needed whenever a preset's groups have changed.
+// Arguments:       None.
+// Return value:    None.
+
+    void RebuildGroupIndex();
+
+
     static const std::string m_ClassName;
 
     // File/folder name of the data module, eg "MyMod.rte"
@@ -520,6 +543,13 @@ protected:
     // There can be multiple entries of the same instance name in any of the type submaps, but only ONE whose exact class is that of the typelist!
     // The Entity instaces are NOT owned by this map.
     std::map<std::string, std::list<std::pair<std::string, Entity *> > > m_TypeMap;
+    // Map of <EXACT class names and <map of preset names and the one Entity instance of that exact class and name> >
+    // Lets presets be found without walking the typelists above. The Entity instances are NOT owned by this map.
+    std::unordered_map<std::string, std::unordered_map<std::string, Entity *> > m_PresetIndex;
+    // All presets of this which are in each group, in the order they were added. The Entity instances are NOT owned here.
+    std::unordered_map<std::string, std::vector<Entity *> > m_GroupIndex;
+    // The Entity::GetPresetGroupChanges() count the group index is up to date with; -1 if it needs rebuilding regardless
+    int m_GroupIndexChanges;
 
     // List of all Entity groups ever registered in this, all uniques
     std::list<std::string> m_GroupRegister;
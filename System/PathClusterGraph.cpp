@@ -0,0 +1,565 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// File:            PathClusterGraph.cpp
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Source file for the PathClusterGraph class.
+// Project:         Retro Terrain Engine
+// Author(s):
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Inclusions of header files
+
+#include "PathClusterGraph.h"
+#include <algorithm>
+#include <queue>
+#include <unordered_map>
+#include <unordered_set>
+#include <cfloat>
+#include <cstdlib>
+
+using namespace std;
+
+namespace RTE
+{
+
+const int PathClusterGraph::m_sClusterSize = 10;
+const int PathClusterGraph::m_sMaxSingleCrossingLength = 5;
+
+// A node to search from, and the cost to it or estimated total through it to order the open list by
+typedef pair<float, int> OpenNode;
+typedef priority_queue<OpenNode, vector<OpenNode>, greater<OpenNode> > OpenList;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Function:        OppositeDirection
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the PathNode::Direction pointing the other way.
+
+static int OppositeDirection(int direction)
+{
+    return direction < PathNode::UPRIGHT ? (direction + 2) % 4 : PathNode::UPRIGHT + (direction - PathNode::UPRIGHT + 2) % 4;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Constructor:     PathClusterGraph
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Sets up the clusters over a snapshot's nodes.
+
+PathClusterGraph::PathClusterGraph(const vector<PathGraphSnapshot::SnapshotNode> &nodes, int nodeXCount, int nodeYCount, bool wrapsX, bool wrapsY, float digStrength):
+    m_Nodes(nodes)
+{
+    m_NodeXCount = nodeXCount;
+    m_NodeYCount = nodeYCount;
+    m_WrapsX = wrapsX;
+    m_WrapsY = wrapsY;
+    m_DigStrength = digStrength;
+
+    m_ClusterXCount = (m_NodeXCount + m_sClusterSize - 1) / m_sClusterSize;
+    m_ClusterYCount = (m_NodeYCount + m_sClusterSize - 1) / m_sClusterSize;
+    m_Clusters.resize(m_ClusterXCount * m_ClusterYCount);
+    for (int clusterX = 0; clusterX < m_ClusterXCount; ++clusterX)
+    {
+        for (int clusterY = 0; clusterY < m_ClusterYCount; ++clusterY)
+        {
+            Cluster &cluster = m_Clusters[clusterX * m_ClusterYCount + clusterY];
+            cluster.m_FirstX = clusterX * m_sClusterSize;
+            cluster.m_FirstY = clusterY * m_sClusterSize;
+            cluster.m_Width = MIN(m_sClusterSize, m_NodeXCount - cluster.m_FirstX);
+            cluster.m_Height = MIN(m_sClusterSize, m_NodeYCount - cluster.m_FirstY);
+            cluster.m_Dirty = true;
+        }
+    }
+    m_RightCrossings.resize(m_Clusters.size());
+    m_LowerCrossings.resize(m_Clusters.size());
+    m_AnyDirty = !m_Clusters.empty();
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          MarkNodeChanged
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Marks the clusters that a node's costs matter to as needing to be
+//                  worked out again before the next path.
+
+void PathClusterGraph::MarkNodeChanged(int nodeIndex)
+{
+    // The neighbours get worked out again along with it, as they share its borders
+    m_Clusters[GetClusterOf(nodeIndex)].m_Dirty = true;
+    m_AnyDirty = true;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Solve
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Finds a path between two nodes over the cluster entrances, after
+//                  working out any clusters that have changed.
+
+int PathClusterGraph::Solve(int startNode, int endNode, vector<int> &nodePath, float &totalCostResult)
+{
+    nodePath.clear();
+    totalCostResult = 0;
+
+    RebuildDirtyClusters();
+
+    int startCluster = GetClusterOf(startNode);
+    int endCluster = GetClusterOf(endNode);
+    const Cluster &start = m_Clusters[startCluster];
+    const Cluster &end = m_Clusters[endCluster];
+
+    // How to get from the start to the entrances of its cluster, and from the entrances of the end's cluster to the end
+    vector<float> startCosts;
+    vector<int> startLinks;
+    SearchCluster(startCluster, startNode, false, startCosts, startLinks);
+    vector<float> endCosts;
+    vector<int> endLinks;
+    SearchCluster(endCluster, endNode, true, endCosts, endLinks);
+
+    // A* over the entrances, starting from all the ones of the start's cluster at once
+    unordered_map<int, float> bestCosts;
+    unordered_map<int, int> cameFrom;
+    unordered_set<int> closed;
+    OpenList open;
+    for (vector<int>::const_iterator itr = start.m_Entrances.begin(); itr != start.m_Entrances.end(); ++itr)
+    {
+        float cost = startCosts[GetLocalIndex(start, *itr)];
+        if (cost < FLT_MAX)
+        {
+            bestCosts[*itr] = cost;
+            cameFrom[*itr] = -1;
+            open.push(OpenNode(cost + EstimateCost(*itr, endNode), *itr));
+        }
+    }
+
+    float goalCost = FLT_MAX;
+    int lastEntrance = -1;
+    vector<pair<int, float> > steps;
+    while (!open.empty())
+    {
+        OpenNode current = open.top();
+        open.pop();
+        // Nothing left can beat the best way to the end found so far
+        if (current.first >= goalCost)
+            break;
+
+        int node = current.second;
+        if (!closed.insert(node).second)
+            continue;
+
+        float cost = bestCosts[node];
+        int clusterIndex = GetClusterOf(node);
+        const Cluster &cluster = m_Clusters[clusterIndex];
+        if (clusterIndex == endCluster && cost + endCosts[GetLocalIndex(end, node)] < goalCost)
+        {
+            goalCost = cost + endCosts[GetLocalIndex(end, node)];
+            lastEntrance = node;
+        }
+
+        int entrance = GetEntranceIndex(cluster, node);
+        if (entrance < 0)
+            continue;
+
+        // Across the cluster to its other entrances, and over its borders
+        steps.clear();
+        int entranceCount = cluster.m_Entrances.size();
+        for (int other = 0; other < entranceCount; ++other)
+        {
+            float stepCost = cluster.m_EntranceCosts[entrance * entranceCount + other];
+            if (other != entrance && stepCost < FLT_MAX)
+                steps.push_back(make_pair(cluster.m_Entrances[other], stepCost));
+        }
+        steps.insert(steps.end(), cluster.m_CrossingEdges[entrance].begin(), cluster.m_CrossingEdges[entrance].end());
+
+        for (vector<pair<int, float> >::iterator itr = steps.begin(); itr != steps.end(); ++itr)
+        {
+            if (closed.count(itr->first))
+                continue;
+            float nextCost = cost + itr->second;
+            unordered_map<int, float>::iterator bestItr = bestCosts.find(itr->first);
+            if (bestItr == bestCosts.end() || nextCost < bestItr->second)
+            {
+                bestCosts[itr->first] = nextCost;
+                cameFrom[itr->first] = node;
+                open.push(OpenNode(nextCost + EstimateCost(itr->first, endNode), itr->first));
+            }
+        }
+    }
+
+    if (lastEntrance < 0)
+        return MicroPather::NO_SOLUTION;
+
+    vector<int> entrances;
+    for (int node = lastEntrance; node >= 0; node = cameFrom[node])
+        entrances.push_back(node);
+    reverse(entrances.begin(), entrances.end());
+
+    // Fill in the nodes between the entrances; the start search links lead back to the start
+    vector<int> stretch;
+    for (int node = entrances.front(); node != startNode; node = startLinks[GetLocalIndex(start, node)])
+        stretch.push_back(node);
+    stretch.push_back(startNode);
+    nodePath.assign(stretch.rbegin(), stretch.rend());
+
+    for (int i = 1; i < entrances.size(); ++i)
+    {
+        int clusterIndex = GetClusterOf(entrances[i - 1]);
+        // Entrances in different clusters are adjacent across a border
+        if (clusterIndex != GetClusterOf(entrances[i]))
+        {
+            nodePath.push_back(entrances[i]);
+            continue;
+        }
+
+        // The links kept from searching the cluster lead back to the previous entrance
+        const Cluster &cluster = m_Clusters[clusterIndex];
+        const vector<int> &links = cluster.m_EntranceLinks[GetEntranceIndex(cluster, entrances[i - 1])];
+        stretch.clear();
+        for (int node = entrances[i]; node != entrances[i - 1]; node = links[GetLocalIndex(cluster, node)])
+            stretch.push_back(node);
+        nodePath.insert(nodePath.end(), stretch.rbegin(), stretch.rend());
+    }
+
+    // The end search links lead on to the end
+    for (int node = entrances.back(); node != endNode;)
+    {
+        node = endLinks[GetLocalIndex(end, node)];
+        nodePath.push_back(node);
+    }
+
+    totalCostResult = goalCost;
+    return MicroPather::SOLVED;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   IsLongPath
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Shows whether two nodes are far enough apart that going through the
+//                  clusters pays off.
+
+bool PathClusterGraph::IsLongPath(int startNode, int endNode, int nodeXCount, int nodeYCount, bool wrapsX, bool wrapsY)
+{
+    int clusterXCount = (nodeXCount + m_sClusterSize - 1) / m_sClusterSize;
+    int clusterYCount = (nodeYCount + m_sClusterSize - 1) / m_sClusterSize;
+    int stepsX = abs((startNode / nodeYCount) / m_sClusterSize - (endNode / nodeYCount) / m_sClusterSize);
+    int stepsY = abs((startNode % nodeYCount) / m_sClusterSize - (endNode % nodeYCount) / m_sClusterSize);
+    if (wrapsX)
+        stepsX = MIN(stepsX, clusterXCount - stepsX);
+    if (wrapsY)
+        stepsY = MIN(stepsY, clusterYCount - stepsY);
+
+    return MAX(stepsX, stepsY) >= 2;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RebuildDirtyClusters
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Finds the border crossings around all dirty clusters again, and works
+//                  out the entrances and their costs anew for those clusters and the
+//                  ones next to them.
+
+void PathClusterGraph::RebuildDirtyClusters()
+{
+    if (!m_AnyDirty)
+        return;
+
+    vector<bool> toBuild(m_Clusters.size(), false);
+    for (int clusterIndex = 0; clusterIndex < m_Clusters.size(); ++clusterIndex)
+    {
+        if (!m_Clusters[clusterIndex].m_Dirty)
+            continue;
+        toBuild[clusterIndex] = true;
+
+        int right = GetNeighborCluster(clusterIndex, 1, 0);
+        if (right >= 0)
+        {
+            FindCrossings(clusterIndex, right, true, m_RightCrossings[clusterIndex]);
+            toBuild[right] = true;
+        }
+        int lower = GetNeighborCluster(clusterIndex, 0, 1);
+        if (lower >= 0)
+        {
+            FindCrossings(clusterIndex, lower, false, m_LowerCrossings[clusterIndex]);
+            toBuild[lower] = true;
+        }
+        // Dirty neighbours do their own right and lower borders
+        int left = GetNeighborCluster(clusterIndex, -1, 0);
+        if (left >= 0)
+        {
+            if (!m_Clusters[left].m_Dirty)
+                FindCrossings(left, clusterIndex, true, m_RightCrossings[left]);
+            toBuild[left] = true;
+        }
+        int upper = GetNeighborCluster(clusterIndex, 0, -1);
+        if (upper >= 0)
+        {
+            if (!m_Clusters[upper].m_Dirty)
+                FindCrossings(upper, clusterIndex, false, m_LowerCrossings[upper]);
+            toBuild[upper] = true;
+        }
+    }
+
+    for (int clusterIndex = 0; clusterIndex < m_Clusters.size(); ++clusterIndex)
+    {
+        if (toBuild[clusterIndex])
+            BuildCluster(clusterIndex);
+    }
+    m_AnyDirty = false;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          FindCrossings
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Picks where a border between two clusters should be crossed.
+
+void PathClusterGraph::FindCrossings(int clusterA, int clusterB, bool vertical, vector<Crossing> &crossings) const
+{
+    crossings.clear();
+
+    const Cluster &sideA = m_Clusters[clusterA];
+    const Cluster &sideB = m_Clusters[clusterB];
+    int length = vertical ? sideA.m_Height : sideA.m_Width;
+    int direction = vertical ? PathNode::RIGHT : PathNode::DOWN;
+
+    // The strength of what's in the way of crossing at each place along the border, whichever way
+    vector<Crossing> border(length);
+    vector<float> strengths(length);
+    for (int i = 0; i < length; ++i)
+    {
+        if (vertical)
+        {
+            border[i].m_NodeA = (sideA.m_FirstX + sideA.m_Width - 1) * m_NodeYCount + sideA.m_FirstY + i;
+            border[i].m_NodeB = sideB.m_FirstX * m_NodeYCount + sideB.m_FirstY + i;
+        }
+        else
+        {
+            border[i].m_NodeA = (sideA.m_FirstX + i) * m_NodeYCount + sideA.m_FirstY + sideA.m_Height - 1;
+            border[i].m_NodeB = (sideB.m_FirstX + i) * m_NodeYCount + sideB.m_FirstY;
+        }
+        const PathGraphSnapshot::SnapshotNode &nodeA = m_Nodes[border[i].m_NodeA];
+        const PathGraphSnapshot::SnapshotNode &nodeB = m_Nodes[border[i].m_NodeB];
+        if (nodeA.m_Adjacent[direction] == border[i].m_NodeB)
+            strengths[i] = MAX(nodeA.m_Costs[direction], nodeB.m_Costs[OppositeDirection(direction)]);
+        else
+            strengths[i] = FLT_MAX;
+    }
+
+    // Whether the border can be followed to the next place along it on both sides, without digging through anything too hard
+    int along = vertical ? PathNode::DOWN : PathNode::RIGHT;
+    vector<bool> linkedToNext(length, false);
+    for (int i = 0; i < length - 1; ++i)
+    {
+        const PathGraphSnapshot::SnapshotNode &nodeA = m_Nodes[border[i].m_NodeA];
+        const PathGraphSnapshot::SnapshotNode &nodeB = m_Nodes[border[i].m_NodeB];
+        linkedToNext[i] = nodeA.m_Adjacent[along] == border[i + 1].m_NodeA && nodeA.m_Costs[along] <= m_DigStrength && nodeB.m_Adjacent[along] == border[i + 1].m_NodeB && nodeB.m_Costs[along] <= m_DigStrength;
+    }
+
+    for (int first = 0; first < length;)
+    {
+        if (strengths[first] == FLT_MAX)
+        {
+            ++first;
+            continue;
+        }
+
+        // Stretches that can be dug through end where the border can't be followed, so every place in one is as good as any other
+        bool diggable = strengths[first] <= m_DigStrength;
+        int last = first;
+        while (last + 1 < length && strengths[last + 1] < FLT_MAX && (strengths[last + 1] <= m_DigStrength) == diggable && (!diggable || linkedToNext[last]))
+            ++last;
+
+        if (!diggable)
+        {
+            int cheapest = first;
+            for (int i = first + 1; i <= last; ++i)
+            {
+                if (strengths[i] < strengths[cheapest])
+                    cheapest = i;
+            }
+            crossings.push_back(border[cheapest]);
+        }
+        else if (last - first + 1 > m_sMaxSingleCrossingLength)
+        {
+            crossings.push_back(border[first]);
+            crossings.push_back(border[last]);
+        }
+        else
+            crossings.push_back(border[(first + last) / 2]);
+
+        first = last + 1;
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          BuildCluster
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Collects the entrances of a cluster from the crossings on its borders,
+//                  and works out the least costs between them within the cluster.
+
+void PathClusterGraph::BuildCluster(int clusterIndex)
+{
+    Cluster &cluster = m_Clusters[clusterIndex];
+    cluster.m_Entrances.clear();
+    cluster.m_CrossingEdges.clear();
+
+    // This cluster's own right and lower borders have it on side A, its left and upper neighbours' have it on side B
+    int left = GetNeighborCluster(clusterIndex, -1, 0);
+    int upper = GetNeighborCluster(clusterIndex, 0, -1);
+    const vector<Crossing> *pBorders[4] = { &m_RightCrossings[clusterIndex], &m_LowerCrossings[clusterIndex], left >= 0 ? &m_RightCrossings[left] : 0, upper >= 0 ? &m_LowerCrossings[upper] : 0 };
+    const int borderDirections[4] = { PathNode::RIGHT, PathNode::DOWN, PathNode::LEFT, PathNode::UP };
+
+    for (int border = 0; border < 4; ++border)
+    {
+        if (!pBorders[border])
+            continue;
+
+        for (vector<Crossing>::const_iterator itr = pBorders[border]->begin(); itr != pBorders[border]->end(); ++itr)
+        {
+            int from = border < 2 ? itr->m_NodeA : itr->m_NodeB;
+            int to = border < 2 ? itr->m_NodeB : itr->m_NodeA;
+
+            int entrance = GetEntranceIndex(cluster, from);
+            if (entrance < 0)
+            {
+                entrance = cluster.m_Entrances.size();
+                cluster.m_Entrances.push_back(from);
+                cluster.m_CrossingEdges.push_back(vector<pair<int, float> >());
+            }
+            float cost = PathFinder::GetAdjacentCost(borderDirections[border], m_Nodes[from].m_Costs[borderDirections[border]], m_DigStrength);
+            cluster.m_CrossingEdges[entrance].push_back(make_pair(to, cost));
+        }
+    }
+
+    int entranceCount = cluster.m_Entrances.size();
+    cluster.m_EntranceCosts.resize(entranceCount * entranceCount);
+    cluster.m_EntranceLinks.resize(entranceCount);
+    vector<float> costs;
+    for (int from = 0; from < entranceCount; ++from)
+    {
+        SearchCluster(clusterIndex, cluster.m_Entrances[from], false, costs, cluster.m_EntranceLinks[from]);
+        for (int to = 0; to < entranceCount; ++to)
+            cluster.m_EntranceCosts[from * entranceCount + to] = costs[GetLocalIndex(cluster, cluster.m_Entrances[to])];
+    }
+
+    cluster.m_Dirty = false;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          SearchCluster
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Finds the least costs between one node and all others of the same
+//                  cluster, without leaving the cluster.
+
+void PathClusterGraph::SearchCluster(int clusterIndex, int sourceNode, bool towards, vector<float> &costs, vector<int> &links) const
+{
+    const Cluster &cluster = m_Clusters[clusterIndex];
+    costs.assign(cluster.m_Width * cluster.m_Height, FLT_MAX);
+    links.assign(cluster.m_Width * cluster.m_Height, -1);
+
+    // Plain Dijkstra; the clusters are small enough that a heuristic wouldn't save much
+    OpenList open;
+    costs[GetLocalIndex(cluster, sourceNode)] = 0;
+    open.push(OpenNode(0, sourceNode));
+    while (!open.empty())
+    {
+        OpenNode current = open.top();
+        open.pop();
+        int node = current.second;
+        if (current.first > costs[GetLocalIndex(cluster, node)])
+            continue;
+
+        for (int direction = 0; direction < PathNode::DIRECTIONCOUNT; ++direction)
+        {
+            int adjacent = m_Nodes[node].m_Adjacent[direction];
+            if (adjacent < 0 || GetClusterOf(adjacent) != clusterIndex)
+                continue;
+
+            // Searching towards the node means going the other way, from the adjacent node to this
+            float stepCost;
+            if (towards)
+                stepCost = PathFinder::GetAdjacentCost(OppositeDirection(direction), m_Nodes[adjacent].m_Costs[OppositeDirection(direction)], m_DigStrength);
+            else
+                stepCost = PathFinder::GetAdjacentCost(direction, m_Nodes[node].m_Costs[direction], m_DigStrength);
+
+            float cost = current.first + stepCost;
+            int adjacentLocal = GetLocalIndex(cluster, adjacent);
+            if (cost < costs[adjacentLocal])
+            {
+                costs[adjacentLocal] = cost;
+                links[adjacentLocal] = node;
+                open.push(OpenNode(cost, adjacent));
+            }
+        }
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetNeighborCluster
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the cluster next to another, wrapping if the scene does.
+
+int PathClusterGraph::GetNeighborCluster(int clusterIndex, int stepX, int stepY) const
+{
+    int clusterX = clusterIndex / m_ClusterYCount + stepX;
+    int clusterY = clusterIndex % m_ClusterYCount + stepY;
+
+    if (clusterX < 0 || clusterX >= m_ClusterXCount)
+    {
+        if (!m_WrapsX)
+            return -1;
+        clusterX = (clusterX + m_ClusterXCount) % m_ClusterXCount;
+    }
+    if (clusterY < 0 || clusterY >= m_ClusterYCount)
+    {
+        if (!m_WrapsY)
+            return -1;
+        clusterY = (clusterY + m_ClusterYCount) % m_ClusterYCount;
+    }
+
+    // A scene only one cluster across has no borders to cross that way
+    int neighbor = clusterX * m_ClusterYCount + clusterY;
+    return neighbor != clusterIndex ? neighbor : -1;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetEntranceIndex
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets which of a cluster's entrances a node is.
+
+int PathClusterGraph::GetEntranceIndex(const Cluster &cluster, int nodeIndex) const
+{
+    for (int entrance = 0; entrance < cluster.m_Entrances.size(); ++entrance)
+    {
+        if (cluster.m_Entrances[entrance] == nodeIndex)
+            return entrance;
+    }
+    return -1;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          EstimateCost
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the least possible cost between two nodes, if it all was air.
+
+float PathClusterGraph::EstimateCost(int fromNode, int toNode) const
+{
+    int stepsX = abs(fromNode / m_NodeYCount - toNode / m_NodeYCount);
+    int stepsY = abs(fromNode % m_NodeYCount - toNode % m_NodeYCount);
+    if (m_WrapsX)
+        stepsX = MIN(stepsX, m_NodeXCount - stepsX);
+    if (m_WrapsY)
+        stepsY = MIN(stepsY, m_NodeYCount - stepsY);
+
+    // Straight steps cost 1 and diagonal ones 1.4 through air, same as in GetAdjacentCost
+    return MAX(stepsX, stepsY) + 0.4F * MIN(stepsX, stepsY);
+}
+
+} // namespace RTE
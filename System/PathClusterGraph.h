@@ -0,0 +1,293 @@
+#ifndef _RTEPATHCLUSTERGRAPH_
+#define _RTEPATHCLUSTERGRAPH_
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// File:            PathClusterGraph.h
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Header file for the PathClusterGraph class.
+// Project:         Retro Terrain Engine
+// Author(s):
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Inclusions of header files
+
+#include <vector>
+#include <utility>
+#include "PathFinder.h"
+
+namespace RTE
+{
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Class:           PathClusterGraph
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     A coarse graph laid over the nodes of a PathGraphSnapshot, for finding
+//                  long paths without searching every node in between (HPA*). The nodes
+//                  are split into square clusters, and a few entrance nodes are picked
+//                  along each border between clusters where it can be crossed. The least
+//                  costs between all entrances of a cluster are worked out once, by
+//                  searching only that cluster, and kept until costs in or next to it
+//                  change. Long paths are then found over the entrances alone, and each
+//                  step filled back in with the node paths kept from those searches.
+//                  The costs depend on what can be dug through, so there is one of these
+//                  per dig strength.
+// Parent(s):       None.
+// Class history:   10/17/2026 PathClusterGraph created.
+
+class PathClusterGraph
+{
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Public member variable, method and friend function declarations
+
+public:
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Constructor:     PathClusterGraph
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Sets up the clusters over a snapshot's nodes. The clusters aren't
+//                  worked out until first needed.
+// Arguments:       The snapshot's nodes. Must outlive this, and never be resized.
+//                  The number of node columns and rows.
+//                  Whether the scene wraps in either direction.
+//                  What material strength the paths are capable of digging trough.
+
+    PathClusterGraph(const std::vector<PathGraphSnapshot::SnapshotNode> &nodes, int nodeXCount, int nodeYCount, bool wrapsX, bool wrapsY, float digStrength);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetDigStrength
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets what material strength the paths are capable of digging trough.
+// Arguments:       None.
+// Return value:    The dig strength.
+
+    float GetDigStrength() const { return m_DigStrength; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          MarkNodeChanged
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Marks the clusters that a node's costs matter to as needing to be
+//                  worked out again before the next path.
+// Arguments:       The index of the node whose costs changed.
+// Return value:    None.
+
+    void MarkNodeChanged(int nodeIndex);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Solve
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Finds a path between two nodes over the cluster entrances, after
+//                  working out any clusters that have changed.
+// Arguments:       The indices of the start and end nodes.
+//                  A vector which will be filled out with the indices of the nodes along
+//                  the path, start and end included.
+//                  The total difficulty cost of the path.
+// Return value:    Success or failure, expressed as MicroPather's SOLVED or NO_SOLUTION.
+
+    int Solve(int startNode, int endNode, std::vector<int> &nodePath, float &totalCostResult);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   IsLongPath
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Shows whether two nodes are far enough apart that going through the
+//                  clusters pays off; at least one whole cluster has to lie between them.
+// Arguments:       The indices of the two nodes.
+//                  The number of node columns and rows.
+//                  Whether the scene wraps in either direction.
+// Return value:    Whether the path should go through the clusters.
+
+    static bool IsLongPath(int startNode, int endNode, int nodeXCount, int nodeYCount, bool wrapsX, bool wrapsY);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Protected member variable and method declarations
+
+protected:
+
+    // A square of nodes and the entrances along its borders
+    struct Cluster
+    {
+        // The node column and row of the upper left node, and the size in nodes
+        int m_FirstX;
+        int m_FirstY;
+        int m_Width;
+        int m_Height;
+        // The node indices of the entrances
+        std::vector<int> m_Entrances;
+        // The edges from each entrance over into neighbouring clusters, as node index and cost
+        std::vector<std::vector<std::pair<int, float> > > m_CrossingEdges;
+        // The least costs from each entrance to each other, at [from * entrance count + to]
+        std::vector<float> m_EntranceCosts;
+        // For each entrance, the node before each node of the cluster on the cheapest way there from the entrance, by local index
+        std::vector<std::vector<int> > m_EntranceLinks;
+        // Whether this needs to be worked out again
+        bool m_Dirty;
+    };
+
+    // A pair of adjacent nodes on either side of a cluster border, where it's crossed
+    struct Crossing
+    {
+        // The node on the left or upper side
+        int m_NodeA;
+        // The node on the right or lower side
+        int m_NodeB;
+    };
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RebuildDirtyClusters
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Finds the border crossings around all dirty clusters again, and works
+//                  out the entrances and their costs anew for those clusters and the
+//                  ones next to them.
+// Arguments:       None.
+// Return value:    None.
+
+    void RebuildDirtyClusters();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          FindCrossings
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Picks where a border between two clusters should be crossed. Each
+//                  stretch where it can be dug through, and followed along on both
+//                  sides, gets a crossing in its middle, or one at each end if it's long.
+//                  Each stretch where it can't gets one at its cheapest place, so no
+//                  cluster is ever cut off.
+// Arguments:       The index of the cluster on the left or upper side.
+//                  The index of the cluster on the right or lower side.
+//                  Whether the border runs vertically, ie the clusters are side by side.
+//                  The vector to fill with the crossings.
+// Return value:    None.
+
+    void FindCrossings(int clusterA, int clusterB, bool vertical, std::vector<Crossing> &crossings) const;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          BuildCluster
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Collects the entrances of a cluster from the crossings on its borders,
+//                  and works out the least costs between them within the cluster.
+// Arguments:       The index of the cluster.
+// Return value:    None.
+
+    void BuildCluster(int clusterIndex);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          SearchCluster
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Finds the least costs between one node and all others of the same
+//                  cluster, without leaving the cluster.
+// Arguments:       The index of the cluster.
+//                  The index of the node to search from.
+//                  Whether to search for the costs towards the node instead of from it.
+//                  The vector to fill with the cost for each node of the cluster, by local
+//                  index. FLT_MAX where it can't be reached.
+//                  The vector to fill with the node index of the next node towards the
+//                  searched one for each node of the cluster, by local index. -1 for the
+//                  searched node itself and where it can't be reached.
+// Return value:    None.
+
+    void SearchCluster(int clusterIndex, int sourceNode, bool towards, std::vector<float> &costs, std::vector<int> &links) const;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetClusterOf
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the cluster a node is in.
+// Arguments:       The node index.
+// Return value:    The cluster index.
+
+    int GetClusterOf(int nodeIndex) const { return ((nodeIndex / m_NodeYCount) / m_sClusterSize) * m_ClusterYCount + (nodeIndex % m_NodeYCount) / m_sClusterSize; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetLocalIndex
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the index of a node within its cluster.
+// Arguments:       The cluster.
+//                  The node index.
+// Return value:    The local index, counting down each column of the cluster.
+
+    int GetLocalIndex(const Cluster &cluster, int nodeIndex) const { return (nodeIndex / m_NodeYCount - cluster.m_FirstX) * cluster.m_Height + (nodeIndex % m_NodeYCount - cluster.m_FirstY); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetNeighborCluster
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the cluster next to another, wrapping if the scene does.
+// Arguments:       The index of the cluster.
+//                  The number of clusters to step right and down, -1 to 1.
+// Return value:    The index of the neighbouring cluster, or -1 if there is none.
+
+    int GetNeighborCluster(int clusterIndex, int stepX, int stepY) const;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetEntranceIndex
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets which of a cluster's entrances a node is.
+// Arguments:       The cluster.
+//                  The node index.
+// Return value:    The entrance index, or -1 if the node isn't one.
+
+    int GetEntranceIndex(const Cluster &cluster, int nodeIndex) const;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          EstimateCost
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the least possible cost between two nodes, if it all was air.
+// Arguments:       The indices of the two nodes.
+// Return value:    The estimated cost.
+
+    float EstimateCost(int fromNode, int toNode) const;
+
+
+    // The width and height of each cluster, in nodes
+    static const int m_sClusterSize;
+    // The longest stretch of a border to be crossed at a single place
+    static const int m_sMaxSingleCrossingLength;
+
+    // The snapshot's nodes
+    const std::vector<PathGraphSnapshot::SnapshotNode> &m_Nodes;
+    int m_NodeXCount;
+    int m_NodeYCount;
+    bool m_WrapsX;
+    bool m_WrapsY;
+    // What material strength the paths are capable of digging trough
+    float m_DigStrength;
+    // All clusters, counting down each column from the left
+    std::vector<Cluster> m_Clusters;
+    int m_ClusterXCount;
+    int m_ClusterYCount;
+    // The crossings of each cluster's right and lower borders
+    std::vector<std::vector<Crossing> > m_RightCrossings;
+    std::vector<std::vector<Crossing> > m_LowerCrossings;
+    // Whether any cluster is dirty
+    bool m_AnyDirty;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Private member variable and method declarations
+
+private:
+
+    // Disallow the use of some implicit methods.
+    PathClusterGraph(const PathClusterGraph &reference);
+    PathClusterGraph & operator=(const PathClusterGraph &rhs);
+
+};
+
+} // namespace RTE
+
+#endif // File
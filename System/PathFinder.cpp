@@ -12,15 +12,223 @@
 // Inclusions of header files
 
 #include "PathFinder.h"
+#include "PathClusterGraph.h"
 #include "DDTTools.h"
 #include "SceneMan.h"
 #include "Scene.h"
+#include "TimerMan.h"
 
 using namespace std;
 
 namespace RTE
 {
 
+int PathFinder::m_sNextRequestID = 0;
+const int PathGraphSnapshot::m_sMaxClusterGraphs = 4;
+
+// Base cost of going to each adjacent node, and how much the material strength along the way adds when it can or can't be dug through, in PathNode::Direction order
+// Digging upwards is four times more expensive, and three times at 45 degrees
+static const double s_aBaseCosts[PathNode::DIRECTIONCOUNT] = { 1, 1, 1, 1, 1.4, 1.4, 1.4, 1.4 };
+static const double s_aStrengthScales[PathNode::DIRECTIONCOUNT] = { 4, 1, 1, 1, 4.2, 1.4, 1.4, 4.2 };
+static const double s_aUndiggableScales[PathNode::DIRECTIONCOUNT] = { 2000, 1000, 1000, 1000, 2828, 1414, 1414, 2828 };
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Constructor:     PathGraphSnapshot
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Copies the positions, adjacency and costs of a node grid.
+
+PathGraphSnapshot::PathGraphSnapshot(const vector<vector<PathNode *> > &nodeGrid, int sceneWidth, int sceneHeight, bool wrapsX, bool wrapsY, unsigned int allocate)
+{
+    m_SceneWidth = sceneWidth;
+    m_SceneHeight = sceneHeight;
+    m_WrapsX = wrapsX;
+    m_WrapsY = wrapsY;
+    m_DigStrength = 1;
+    m_PatherOutdated = false;
+    m_NodeXCount = nodeGrid.size();
+    m_NodeYCount = nodeGrid.empty() ? 0 : nodeGrid[0].size();
+
+    int nodeCount = 0;
+    for (int x = 0; x < nodeGrid.size(); ++x)
+        nodeCount += nodeGrid[x].size();
+    m_Nodes.resize(nodeCount);
+
+    for (int x = 0; x < nodeGrid.size(); ++x)
+    {
+        for (int y = 0; y < nodeGrid[x].size(); ++y)
+        {
+            const PathNode *pNode = nodeGrid[x][y];
+            SnapshotNode &node = m_Nodes[pNode->m_Index];
+            node.m_Pos = pNode->m_Pos;
+            pNode->GetCosts(node.m_Costs);
+            for (int direction = 0; direction < PathNode::DIRECTIONCOUNT; ++direction)
+                node.m_Adjacent[direction] = pNode->GetAdjacent(direction) ? pNode->GetAdjacent(direction)->m_Index : -1;
+        }
+    }
+
+    m_pPather = new MicroPather(this, allocate);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Destructor:      ~PathGraphSnapshot
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Destructor method used to clean up a PathGraphSnapshot.
+
+PathGraphSnapshot::~PathGraphSnapshot()
+{
+    for (list<PathClusterGraph *>::iterator itr = m_ClusterGraphs.begin(); itr != m_ClusterGraphs.end(); ++itr)
+        delete *itr;
+    delete m_pPather;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ApplyCosts
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Brings the costs of some nodes up to date with the real grid.
+
+void PathGraphSnapshot::ApplyCosts(const vector<PathNodeCosts> &costs)
+{
+    for (vector<PathNodeCosts>::const_iterator itr = costs.begin(); itr != costs.end(); ++itr)
+    {
+        for (int direction = 0; direction < PathNode::DIRECTIONCOUNT; ++direction)
+            m_Nodes[itr->m_NodeIndex].m_Costs[direction] = itr->m_Costs[direction];
+        for (list<PathClusterGraph *>::iterator gItr = m_ClusterGraphs.begin(); gItr != m_ClusterGraphs.end(); ++gItr)
+            (*gItr)->MarkNodeChanged(itr->m_NodeIndex);
+    }
+    if (!costs.empty())
+        m_PatherOutdated = true;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Solve
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Finds the least difficult path between two nodes, with some costs
+//                  temporarily replaced for just this path.
+
+int PathGraphSnapshot::Solve(int startNode, int endNode, float digStrength, const vector<PathNodeCosts> &costPatch, vector<Vector> &nodePath, float &totalCostResult)
+{
+    // Swap in the patched costs, keeping the real ones to put back after
+    vector<PathNodeCosts> replacedCosts;
+    for (vector<PathNodeCosts>::const_iterator itr = costPatch.begin(); itr != costPatch.end(); ++itr)
+    {
+        PathNodeCosts replaced;
+        replaced.m_NodeIndex = itr->m_NodeIndex;
+        for (int direction = 0; direction < PathNode::DIRECTIONCOUNT; ++direction)
+            replaced.m_Costs[direction] = m_Nodes[itr->m_NodeIndex].m_Costs[direction];
+        replacedCosts.push_back(replaced);
+    }
+    ApplyCosts(costPatch);
+
+    nodePath.clear();
+    int result = MicroPather::NO_SOLUTION;
+
+    // Long paths go over the clusters first, which only fails if the scene is cut in two
+    if (PathClusterGraph::IsLongPath(startNode, endNode, m_NodeXCount, m_NodeYCount, m_WrapsX, m_WrapsY))
+    {
+        vector<int> clusterPath;
+        result = GetClusterGraph(digStrength)->Solve(startNode, endNode, clusterPath, totalCostResult);
+        for (vector<int>::iterator itr = clusterPath.begin(); itr != clusterPath.end(); ++itr)
+            nodePath.push_back(m_Nodes[*itr].m_Pos);
+    }
+
+    if (result != MicroPather::SOLVED)
+    {
+        // The pather caches costs, and also needs resetting if digging through something different than last time
+        if (m_PatherOutdated || digStrength != m_DigStrength)
+        {
+            m_pPather->Reset();
+            m_PatherOutdated = false;
+        }
+        m_DigStrength = digStrength;
+
+        vector<void *> statePath;
+        result = m_pPather->Solve((void *)(&m_Nodes[startNode]), (void *)(&m_Nodes[endNode]), &statePath, &totalCostResult);
+
+        nodePath.clear();
+        for (vector<void *>::iterator itr = statePath.begin(); itr != statePath.end(); ++itr)
+            nodePath.push_back(((SnapshotNode *)(*itr))->m_Pos);
+    }
+
+    // Put the real costs back in reverse, in case the patch has the same node more than once
+    if (!replacedCosts.empty())
+        ApplyCosts(vector<PathNodeCosts>(replacedCosts.rbegin(), replacedCosts.rend()));
+
+    return result;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetClusterGraph
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the cluster graph for a dig strength, making it if there isn't one
+//                  yet.
+
+PathClusterGraph * PathGraphSnapshot::GetClusterGraph(float digStrength)
+{
+    for (list<PathClusterGraph *>::iterator itr = m_ClusterGraphs.begin(); itr != m_ClusterGraphs.end(); ++itr)
+    {
+        if ((*itr)->GetDigStrength() == digStrength)
+        {
+            // Move it to the front so it's the last to be dropped
+            m_ClusterGraphs.splice(m_ClusterGraphs.begin(), m_ClusterGraphs, itr);
+            return m_ClusterGraphs.front();
+        }
+    }
+
+    if (m_ClusterGraphs.size() >= m_sMaxClusterGraphs)
+    {
+        delete m_ClusterGraphs.back();
+        m_ClusterGraphs.pop_back();
+    }
+    m_ClusterGraphs.push_front(new PathClusterGraph(m_Nodes, m_NodeXCount, m_NodeYCount, m_WrapsX, m_WrapsY, digStrength));
+    return m_ClusterGraphs.front();
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          LeastCostEstimate
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Implementation of the abstract interface of Graph. Gets the least
+//                  possible cost to get from node A to B, if it all was air.
+
+float PathGraphSnapshot::LeastCostEstimate(void *pStartState, void *pEndState)
+{
+    // Same as SceneMan::ShortestDistance, with the scene as it was when the snapshot was made
+    Vector distance = ((SnapshotNode *)pEndState)->m_Pos - ((SnapshotNode *)pStartState)->m_Pos;
+    if (m_WrapsX && fabs(distance.m_X) > m_SceneWidth / 2)
+        distance.m_X -= distance.m_X > 0 ? m_SceneWidth : -m_SceneWidth;
+    if (m_WrapsY && fabs(distance.m_Y) > m_SceneHeight / 2)
+        distance.m_Y -= distance.m_Y > 0 ? m_SceneHeight : -m_SceneHeight;
+    return distance.GetMagnitude();
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          AdjacentCost
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Implementation of the abstract interface of Graph. Gets the cost to go
+//                  to any adjacent node of the one passed in.
+
+void PathGraphSnapshot::AdjacentCost(void *pState, vector<micropather::StateCost> *pAdjacentList)
+{
+    SnapshotNode *pNode = (SnapshotNode *)pState;
+    micropather::StateCost adjCost;
+
+    for (int direction = 0; direction < PathNode::DIRECTIONCOUNT; ++direction)
+    {
+        if (pNode->m_Adjacent[direction] >= 0)
+        {
+            adjCost.cost = PathFinder::GetAdjacentCost(direction, pNode->m_Costs[direction], m_DigStrength);
+            adjCost.state = (void *)(&m_Nodes[pNode->m_Adjacent[direction]]);
+            pAdjacentList->push_back(adjCost);
+        }
+    }
+}
+
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          Clear
@@ -34,6 +242,14 @@ void PathFinder::Clear()
     m_NodeDimension = 20;
     m_DigStrenght = 1;
     m_pPather = 0;
+    m_OutdatedNodes.clear();
+    m_pSnapshot = 0;
+    m_Requests.clear();
+    m_Results.clear();
+    m_SolvingRequestID = -1;
+    m_CancelledRequests.clear();
+    m_CostHandOvers.clear();
+    m_QuitWorker = false;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -71,7 +287,7 @@ int PathFinder::Create(Scene *pScene, int nodeDimension, unsigned int allocate)
             if (nodePos.m_Y >= sceneHeight)
                 nodePos.m_Y = sceneHeight - 1;
             // Create the new node with its in-scene position in the center of it
-            pNode = new PathNode(nodePos);
+            pNode = new PathNode(nodePos, x * nodeYCount + y);
             // Move current position down for the next node in the column
             nodePos.m_Y += nodeDimension;
             // Add the newly created node to the column, transferring ownership to it
@@ -145,6 +361,11 @@ int PathFinder::Create(Scene *pScene, int nodeDimension, unsigned int allocate)
     // Set up all the costs between all nodes
     RecalculateAllCosts();
 
+    // Give the background path worker its own copy of the grid to solve against, and start it
+    m_pSnapshot = new PathGraphSnapshot(m_NodeGrid, sceneWidth, sceneHeight, pScene->WrapsX(), pScene->WrapsY(), allocate);
+    m_CostHandOvers.clear();
+    m_Worker = thread(&PathFinder::WorkerLoop, this);
+
     return 0;
 }
 
@@ -156,6 +377,16 @@ int PathFinder::Create(Scene *pScene, int nodeDimension, unsigned int allocate)
 
 void PathFinder::Destroy()
 {
+    // Stop the background path worker before anything it uses goes away
+    {
+        lock_guard<mutex> lock(m_RequestMutex);
+        m_QuitWorker = true;
+    }
+    m_RequestPosted.notify_all();
+    if (m_Worker.joinable())
+        m_Worker.join();
+    delete m_pSnapshot;
+
     for (int x = 0; x < m_NodeGrid.size(); ++x)
     {
         for (int y = 0; y < m_NodeGrid[x].size(); ++y)
@@ -183,6 +414,7 @@ void PathFinder::RecalculateAllCosts()
     DAssert(g_SceneMan.GetScene(), "Scene doesn't exist or isn't loaded when recalculating PathFinder!");
 
     PathNode *pNode = 0;
+    vector<PathNode *> allNodes;
     for (int x = 0; x < m_NodeGrid.size(); ++x)
     {
         // Update all the costs going out from each node
@@ -190,13 +422,16 @@ void PathFinder::RecalculateAllCosts()
         {
             pNode = m_NodeGrid[x][y];
             UpdateNodeCosts(pNode);
-            // Should reset the changed flag since we're about to reset the pather
-            pNode->m_IsChanged = false;
+            // Nothing is outdated anymore
+            pNode->m_IsOutdated = false;
+            allNodes.push_back(pNode);
         }
     }
+    m_OutdatedNodes.clear();
 
     // Reset the pather when costs change, as per the docs
     m_pPather->Reset();
+    HandOverCosts(allNodes);
 }
 
 
@@ -210,57 +445,111 @@ void PathFinder::RecalculateAreaCosts(const list<Box> &boxList)
 {
     SLICK_PROFILE(0xFF343526);
 
-    // Go through all the boxes and see if any of the node centers are inside each
-    Box box;
-    for (list<Box>::const_iterator bItr = boxList.begin(); bItr != boxList.end(); bItr++)
-    {
-        // Get the current area box and make sure it's unflipped
-        box = (*bItr);
-        box.Unflip();
+    MarkAreasOutdated(boxList);
+    UpdateOutdatedCosts(-1);
+}
 
-        // Do the updates
-        UpdateNodeCostsInBox(box);
 
-        // Take care of all wrapping situations of the box
-        if (g_SceneMan.SceneWrapsX())
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          MarkAreasOutdated
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Queues all the nodes touching a list of specific rectangular areas
+//                  (which will be wrapped) to have their costs recalculated by
+//                  UpdateOutdatedCosts, without doing any of it yet.
+
+void PathFinder::MarkAreasOutdated(const list<Box> &boxList)
+{
+    vector<PathNode *> nodes;
+    GetNodesInAreas(boxList, nodes);
+
+    for (vector<PathNode *>::iterator itr = nodes.begin(); itr != nodes.end(); ++itr)
+    {
+        if (!(*itr)->m_IsOutdated)
         {
-			Box temp;
+            (*itr)->m_IsOutdated = true;
+            m_OutdatedNodes.push_back(*itr);
+        }
+    }
+}
 
-            if (box.m_Corner.m_X < 0)
-			{
-				temp =  Box(Vector(box.m_Corner.m_X + g_SceneMan.GetSceneWidth(), box.m_Corner.m_Y), box.m_Width, box.m_Height);						
-                UpdateNodeCostsInBox(temp);
-            }
-			else if (box.m_Corner.m_X + box.m_Width > g_SceneMan.GetSceneWidth())
-            {
-				temp = Box(Vector(box.m_Corner.m_X - g_SceneMan.GetSceneWidth(), box.m_Corner.m_Y), box.m_Width, box.m_Height);
-			    UpdateNodeCostsInBox(temp);
-			}
-		}
-        if (g_SceneMan.SceneWrapsY())
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          MarkAllOutdated
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Queues every node to have its costs recalculated by UpdateOutdatedCosts.
+
+void PathFinder::MarkAllOutdated()
+{
+    for (int x = 0; x < m_NodeGrid.size(); ++x)
+    {
+        for (int y = 0; y < m_NodeGrid[x].size(); ++y)
         {
-			Box temp;
-			
-            if (box.m_Corner.m_Y < 0)
-			{
-				temp = Box(Vector(box.m_Corner.m_X, box.m_Corner.m_Y + g_SceneMan.GetSceneHeight()), box.m_Width, box.m_Height);
-                UpdateNodeCostsInBox(temp);
-            }
-			else if (box.m_Corner.m_Y + box.m_Height > g_SceneMan.GetSceneHeight())
+            if (!m_NodeGrid[x][y]->m_IsOutdated)
             {
-				temp = Box(Vector(box.m_Corner.m_X, box.m_Corner.m_Y - g_SceneMan.GetSceneHeight()), box.m_Width, box.m_Height);
-			    UpdateNodeCostsInBox(temp);
-			}
-		}
+                m_NodeGrid[x][y]->m_IsOutdated = true;
+                m_OutdatedNodes.push_back(m_NodeGrid[x][y]);
+            }
+        }
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          UpdateOutdatedCosts
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Recalculates the costs of queued nodes, oldest first, until the queue
+//                  is empty or the time is up.
+
+int PathFinder::UpdateOutdatedCosts(float timeBudget)
+{
+    if (m_OutdatedNodes.empty())
+        return 0;
+
+    SLICK_PROFILE(0xFF343527);
+
+    int64_t endTime = g_TimerMan.GetAbsoulteTime() + (int64_t)(timeBudget * 1000);
+    vector<PathNode *> updatedNodes;
+    do
+    {
+        PathNode *pNode = m_OutdatedNodes.front();
+        m_OutdatedNodes.pop_front();
+        pNode->m_IsOutdated = false;
+        UpdateNodeCosts(pNode);
+        updatedNodes.push_back(pNode);
     }
+    while (!m_OutdatedNodes.empty() && (timeBudget < 0 || g_TimerMan.GetAbsoulteTime() < endTime));
 
     // Reset the pather when costs change, as per the docs
     m_pPather->Reset();
+    HandOverCosts(updatedNodes);
 
-    // Reset the changed flag on all nodes
-    for (int x = 0; x < m_NodeGrid.size(); ++x)
-        for (int y = 0; y < m_NodeGrid[x].size(); ++y)
-            m_NodeGrid[x][y]->m_IsChanged = false;
+    return updatedNodes.size();
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CalculateCostPatch
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Works out what the costs of all the nodes touching a list of areas
+//                  would be with the terrain as it is now, without changing them.
+
+void PathFinder::CalculateCostPatch(const list<Box> &boxList, vector<PathNodeCosts> &costPatch)
+{
+    vector<PathNode *> nodes;
+    GetNodesInAreas(boxList, nodes);
+
+    // Work out the costs in place, then put the old ones back. Nodes that were outdated stay queued, since the patch is only for now
+    PathNodeCosts oldCosts;
+    PathNodeCosts newCosts;
+    for (vector<PathNode *>::iterator itr = nodes.begin(); itr != nodes.end(); ++itr)
+    {
+        oldCosts.m_NodeIndex = newCosts.m_NodeIndex = (*itr)->m_Index;
+        (*itr)->GetCosts(oldCosts.m_Costs);
+        UpdateNodeCosts(*itr);
+        (*itr)->GetCosts(newCosts.m_Costs);
+        (*itr)->SetCosts(oldCosts.m_Costs);
+        costPatch.push_back(newCosts);
+    }
 }
 
 
@@ -284,9 +573,6 @@ int PathFinder::CalculatePath(Vector start, Vector end, list<Vector> &pathResult
     int endNodeX = floorf(end.m_X / (float)m_NodeDimension);
     int endNodeY = floorf(end.m_Y / (float)m_NodeDimension);
 
-    // Clear out the results if it happens to contain anything
-    pathResult.clear();
-
     // Actors capable of digging can use m_DigStrenght to modify the node adjacency cost
     m_DigStrenght = digStrength;
     
@@ -294,34 +580,100 @@ int PathFinder::CalculatePath(Vector start, Vector end, list<Vector> &pathResult
     vector<void *> statePath;
     int result = m_pPather->Solve((void *)(m_NodeGrid[startNodeX][startNodeY]), (void *)(m_NodeGrid[endNodeX][endNodeY]), &statePath, &totalCostResult);
 
-    // We got something back
-    if (!statePath.empty())
+    // Convert from a list of state void pointers to a list of scene position vectors
+    vector<Vector> nodePath;
+    for (vector<void *>::iterator itr = statePath.begin(); itr != statePath.end(); ++itr)
+        nodePath.push_back(((PathNode *)(*itr))->m_Pos);
+    BuildPathResult(nodePath, start, end, pathResult);
+
+    return result;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RequestPath
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Queues a path to be calculated by the background path worker, against
+//                  the node costs as they were last handed over to it.
+
+int PathFinder::RequestPath(Vector start, Vector end, float digStrength, const vector<PathNodeCosts> &costPatch)
+{
+    DAssert(m_pSnapshot, "No path worker exists, can't request a path!");
+
+    // Make sure start and end are within scene bounds
+    g_SceneMan.ForceBounds(start);
+    g_SceneMan.ForceBounds(end);
+
+    PathRequest request;
+    request.m_ID = m_sNextRequestID++;
+    request.m_Start = start;
+    request.m_End = end;
+    request.m_StartNode = m_NodeGrid[floorf(start.m_X / (float)m_NodeDimension)][floorf(start.m_Y / (float)m_NodeDimension)]->m_Index;
+    request.m_EndNode = m_NodeGrid[floorf(end.m_X / (float)m_NodeDimension)][floorf(end.m_Y / (float)m_NodeDimension)]->m_Index;
+    request.m_DigStrength = digStrength;
+    request.m_CostPatch = costPatch;
+
     {
-        // Replace the approximate first point from the pathfound path with the exact starting point
-        pathResult.push_back(start);
-        vector<void *>::iterator itr = statePath.begin();
-        itr++;
+        lock_guard<mutex> lock(m_RequestMutex);
+        m_Requests.push_back(request);
+    }
+    m_RequestPosted.notify_one();
 
-        // Convert from a list of state void pointers to a list of scene position vectors
-        for (; itr != statePath.end(); ++itr)
-            pathResult.push_back(((PathNode *)(*itr))->m_Pos);
+    return request.m_ID;
+}
 
-        // Adjust the last point to be exactly where the end is supposed to be (really?)
-        if (pathResult.size() > 2)
-        {
-            pathResult.pop_back();
-            pathResult.push_back(end);
-        }
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          TakePathResult
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Picks up the result of a path request, if it's done.
+
+int PathFinder::TakePathResult(int requestID, list<Vector> &pathResult, float &totalCostResult, int &solveResult)
+{
+    lock_guard<mutex> lock(m_RequestMutex);
+
+    map<int, PathResult>::iterator resultItr = m_Results.find(requestID);
+    if (resultItr != m_Results.end())
+    {
+        pathResult.swap(resultItr->second.m_Path);
+        totalCostResult = resultItr->second.m_TotalCost;
+        solveResult = resultItr->second.m_SolveResult;
+        m_Results.erase(resultItr);
+        return REQUESTDONE;
     }
-    // Empty path, give exact start and end
-    else
+
+    if (m_SolvingRequestID == requestID)
+        return REQUESTPENDING;
+    for (deque<PathRequest>::iterator itr = m_Requests.begin(); itr != m_Requests.end(); ++itr)
     {
-        pathResult.push_back(start);
-        pathResult.push_back(end);
+        if (itr->m_ID == requestID)
+            return REQUESTPENDING;
     }
-// TODO: Clean up the path, remove series of nodes in the same direction etc?
 
-    return result;
+    return REQUESTUNKNOWN;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CancelPathRequest
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Forgets about a path request, whether done or not.
+
+void PathFinder::CancelPathRequest(int requestID)
+{
+    lock_guard<mutex> lock(m_RequestMutex);
+
+    m_Results.erase(requestID);
+    if (m_SolvingRequestID == requestID)
+        m_CancelledRequests.insert(requestID);
+    for (deque<PathRequest>::iterator itr = m_Requests.begin(); itr != m_Requests.end(); ++itr)
+    {
+        if (itr->m_ID == requestID)
+        {
+            m_Requests.erase(itr);
+            break;
+        }
+    }
 }
 
 
@@ -348,67 +700,68 @@ void PathFinder::AdjacentCost(void *pState, std::vector<micropather::StateCost>
 {
     PathNode *pNode = (PathNode *)pState;
     micropather::StateCost adjCost;
-    float strength = 0;
-    
-    // Add cost for digging upwards
-    if (pNode->m_pUp)
-    {
-        strength = pNode->m_UpCost;
-        adjCost.cost = 1 + (strength > m_DigStrenght ? strength * 2000 : strength * 4); // Four times more expensive when digging
-        adjCost.state = (void *)pNode->m_pUp;
-        pAdjacentList->push_back(adjCost);
-    }
-    if (pNode->m_pRight)
-    {
-        strength = pNode->m_RightCost;
-        adjCost.cost = 1 + (strength > m_DigStrenght ? strength * 1000 : strength);
-        adjCost.state = (void *)pNode->m_pRight;
-        pAdjacentList->push_back(adjCost);
-    }
-    if (pNode->m_pDown)
-    {
-        strength = pNode->m_DownCost;
-        adjCost.cost = 1 + (strength > m_DigStrenght ? strength * 1000 : strength);
-        adjCost.state = (void *)pNode->m_pDown;
-        pAdjacentList->push_back(adjCost);
-    }
-    if (pNode->m_pLeft)
-    {
-        strength = pNode->m_LeftCost;
-        adjCost.cost = 1 + (strength > m_DigStrenght ? strength * 1000 : strength);
-        adjCost.state = (void *)pNode->m_pLeft;
-        pAdjacentList->push_back(adjCost);
-    }
-    
-    // Add cost for digging at 45 degrees and for digging upwards
-    if (pNode->m_pUpRight)
-    {
-        strength = pNode->m_UpRightCost;
-        adjCost.cost = 1.4 + (strength > m_DigStrenght ? strength * 2828 : strength * 4.2);  // Three times more expensive when digging
-        adjCost.state = (void *)pNode->m_pUpRight;
-        pAdjacentList->push_back(adjCost);
-    }
-    if (pNode->m_pRightDown)
+    float aCosts[PathNode::DIRECTIONCOUNT];
+    pNode->GetCosts(aCosts);
+
+    // Add the cost of going to each existing adjacent node
+    for (int direction = 0; direction < PathNode::DIRECTIONCOUNT; ++direction)
     {
-        strength = pNode->m_RightDownCost;
-        adjCost.cost = 1.4 + (strength > m_DigStrenght ? strength * 1414 : strength * 1.4);
-        adjCost.state = (void *)pNode->m_pRightDown;
-        pAdjacentList->push_back(adjCost);
+        if (pNode->GetAdjacent(direction))
+        {
+            adjCost.cost = GetAdjacentCost(direction, aCosts[direction], m_DigStrenght);
+            adjCost.state = (void *)pNode->GetAdjacent(direction);
+            pAdjacentList->push_back(adjCost);
+        }
     }
-    if (pNode->m_pDownLeft)
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   GetAdjacentCost
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the cost of going to an adjacent node for AdjacentCost, from the
+//                  strength of the material in between and the strength that can be dug
+//                  through.
+
+float PathFinder::GetAdjacentCost(int direction, float strength, float digStrength)
+{
+    return s_aBaseCosts[direction] + (strength > digStrength ? strength * s_aUndiggableScales[direction] : strength * s_aStrengthScales[direction]);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   BuildPathResult
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Turns the node positions along a solved path into the list of
+//                  waypoints handed back.
+
+void PathFinder::BuildPathResult(const vector<Vector> &nodePath, const Vector &start, const Vector &end, list<Vector> &pathResult)
+{
+    // Clear out the results if it happens to contain anything
+    pathResult.clear();
+
+    // We got something back
+    if (!nodePath.empty())
     {
-        strength = pNode->m_DownLeftCost;
-        adjCost.cost = 1.4 + (strength > m_DigStrenght ? strength * 1414 : strength * 1.4);
-        adjCost.state = (void *)pNode->m_pDownLeft;
-        pAdjacentList->push_back(adjCost);
+        // Replace the approximate first point from the pathfound path with the exact starting point
+        pathResult.push_back(start);
+        for (vector<Vector>::const_iterator itr = nodePath.begin() + 1; itr != nodePath.end(); ++itr)
+            pathResult.push_back(*itr);
+
+        // Adjust the last point to be exactly where the end is supposed to be (really?)
+        if (pathResult.size() > 2)
+        {
+            pathResult.pop_back();
+            pathResult.push_back(end);
+        }
     }
-    if (pNode->m_pLeftUp)
+    // Empty path, give exact start and end
+    else
     {
-        strength = pNode->m_LeftUpCost;
-        adjCost.cost = 1.4 + (strength > m_DigStrenght ? strength * 2828 : strength * 4.2);  // Three times more expensive when digging
-        adjCost.state = (void *)pNode->m_pLeftUp;
-        pAdjacentList->push_back(adjCost);
+        pathResult.push_back(start);
+        pathResult.push_back(end);
     }
+// TODO: Clean up the path, remove series of nodes in the same direction etc?
 }
 
 
@@ -456,21 +809,17 @@ void PathFinder::UpdateNodeCosts(PathNode *pNode)
         pNode->m_DownLeftCost = CostAlongLine(pNode->m_Pos+Vector(-2,-2), pNode->m_pDownLeft->m_Pos+Vector(-2,-2));
     if (pNode->m_pLeftUp)
         pNode->m_LeftUpCost = max(pNode->m_pLeftUp->m_RightDownCost, CostAlongLine(pNode->m_Pos+Vector(-2,2), pNode->m_pLeftUp->m_Pos+Vector(-2,2)));
-    
-    // Mark this as already changed so the above expensive calc isn't done redundantly
-    pNode->m_IsChanged = true;
 }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
-// Method:          UpdateNodeCostsInBox
+// Method:          GetNodesInBox
 //////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Helper function for updating all the values of cost edges crossed by
-//                  a specific box. This does NOT update the pather, which is required
-//                  before solving more paths after calling this. Also it does NOT wrap the
-//                  box coming in here, only truncates it!
+// Description:     Helper function for finding all the nodes with cost edges crossed by
+//                  a specific box. It does NOT wrap the box coming in here, only
+//                  truncates it!
 
-void PathFinder::UpdateNodeCostsInBox(Box &box)
+void PathFinder::GetNodesInBox(Box &box, vector<PathNode *> &nodes)
 {
     box.Unflip();
 
@@ -491,16 +840,128 @@ void PathFinder::UpdateNodeCostsInBox(Box &box)
         lastY = m_NodeGrid[0].size() - 1;
 
     // Only iterate through the grid where the box overlaps any edges
-    PathNode *pNode = 0;
     for (int nodeX = firstX; nodeX <= lastX; ++nodeX)
     {
         for (int nodeY = firstY; nodeY <= lastY; ++nodeY)
+            nodes.push_back(m_NodeGrid[nodeX][nodeY]);
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetNodesInAreas
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Helper function for finding all the nodes with cost edges crossed by
+//                  a list of boxes, wrapping them as needed.
+
+void PathFinder::GetNodesInAreas(const list<Box> &boxList, vector<PathNode *> &nodes)
+{
+    // Go through all the boxes and see if any of the node centers are inside each
+    Box box;
+    for (list<Box>::const_iterator bItr = boxList.begin(); bItr != boxList.end(); bItr++)
+    {
+        // Get the current area box and make sure it's unflipped
+        box = (*bItr);
+        box.Unflip();
+
+        GetNodesInBox(box, nodes);
+
+        // Take care of all wrapping situations of the box
+        if (g_SceneMan.SceneWrapsX())
+        {
+			Box temp;
+
+            if (box.m_Corner.m_X < 0)
+			{
+				temp =  Box(Vector(box.m_Corner.m_X + g_SceneMan.GetSceneWidth(), box.m_Corner.m_Y), box.m_Width, box.m_Height);						
+                GetNodesInBox(temp, nodes);
+            }
+			else if (box.m_Corner.m_X + box.m_Width > g_SceneMan.GetSceneWidth())
+            {
+				temp = Box(Vector(box.m_Corner.m_X - g_SceneMan.GetSceneWidth(), box.m_Corner.m_Y), box.m_Width, box.m_Height);
+			    GetNodesInBox(temp, nodes);
+			}
+		}
+        if (g_SceneMan.SceneWrapsY())
+        {
+			Box temp;
+			
+            if (box.m_Corner.m_Y < 0)
+			{
+				temp = Box(Vector(box.m_Corner.m_X, box.m_Corner.m_Y + g_SceneMan.GetSceneHeight()), box.m_Width, box.m_Height);
+                GetNodesInBox(temp, nodes);
+            }
+			else if (box.m_Corner.m_Y + box.m_Height > g_SceneMan.GetSceneHeight())
+            {
+				temp = Box(Vector(box.m_Corner.m_X, box.m_Corner.m_Y - g_SceneMan.GetSceneHeight()), box.m_Width, box.m_Height);
+			    GetNodesInBox(temp, nodes);
+			}
+		}
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          HandOverCosts
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Queues the current costs of some nodes to be copied into the snapshot
+//                  the background path worker uses, before it solves its next request.
+
+void PathFinder::HandOverCosts(const vector<PathNode *> &nodes)
+{
+    // Nobody to hand over to yet while creating
+    if (!m_pSnapshot || nodes.empty())
+        return;
+
+    PathNodeCosts costs;
+    lock_guard<mutex> lock(m_RequestMutex);
+    for (vector<PathNode *>::const_iterator itr = nodes.begin(); itr != nodes.end(); ++itr)
+    {
+        costs.m_NodeIndex = (*itr)->m_Index;
+        (*itr)->GetCosts(costs.m_Costs);
+        m_CostHandOvers.push_back(costs);
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          WorkerLoop
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     The function the background path worker runs until the PathFinder is
+//                  destroyed, solving requests in the order they were made.
+
+void PathFinder::WorkerLoop()
+{
+    vector<PathNodeCosts> costUpdates;
+    vector<Vector> nodePath;
+
+    unique_lock<mutex> lock(m_RequestMutex);
+    while (!m_QuitWorker)
+    {
+        if (m_Requests.empty())
         {
-            pNode = m_NodeGrid[nodeX][nodeY];
-            // Update all the costs going out from each node which is found to be affected by the box
-            if (!pNode->m_IsChanged)
-                UpdateNodeCosts(pNode);
+            m_RequestPosted.wait(lock);
+            continue;
         }
+
+        PathRequest request = m_Requests.front();
+        m_Requests.pop_front();
+        m_SolvingRequestID = request.m_ID;
+        // Take all the costs changed so far, so the path is solved against the grid as it is now
+        costUpdates.swap(m_CostHandOvers);
+        lock.unlock();
+
+        m_pSnapshot->ApplyCosts(costUpdates);
+        costUpdates.clear();
+
+        PathResult result;
+        result.m_SolveResult = m_pSnapshot->Solve(request.m_StartNode, request.m_EndNode, request.m_DigStrength, request.m_CostPatch, nodePath, result.m_TotalCost);
+        BuildPathResult(nodePath, request.m_Start, request.m_End, result.m_Path);
+
+        lock.lock();
+        m_SolvingRequestID = -1;
+        if (m_CancelledRequests.erase(request.m_ID) == 0)
+            m_Results[request.m_ID] = result;
     }
 }
 
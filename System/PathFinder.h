@@ -16,6 +16,13 @@
 
 #include <string>
 #include <vector>
+#include <list>
+#include <deque>
+#include <map>
+#include <set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include "Vector.h"
 #include "Box.h"
 #include "SceneMan.h"
@@ -27,6 +34,7 @@ namespace RTE
 {
 
 class Scene;
+class PathClusterGraph;
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -38,10 +46,26 @@ class Scene;
 
 struct PathNode
 {
+    // The directions to the adjacent nodes, in the order their costs are listed in by GetCosts
+    enum Direction
+    {
+        UP = 0,
+        RIGHT,
+        DOWN,
+        LEFT,
+        UPRIGHT,
+        RIGHTDOWN,
+        DOWNLEFT,
+        LEFTUP,
+        DIRECTIONCOUNT
+    };
+
     // Absolute position of the center of this node in the scene
     Vector m_Pos;
-    // Whether this has been updated since last call to Reset the pather
-    bool m_IsChanged;
+    // Index of this in the grid, counting down each column from the left
+    int m_Index;
+    // Whether this is queued to have its costs recalculated
+    bool m_IsOutdated;
     // Pointers to all adjacent nodes. These are not owned, and may be 0 if adjacent to non-wrapping scene border
     PathNode *m_pUp;
     PathNode *m_pRight;
@@ -61,10 +85,160 @@ struct PathNode
     float m_DownLeftCost;
     float m_LeftUpCost;
 
-    PathNode(Vector pos) { m_Pos = pos;
+    PathNode(Vector pos, int index) { m_Pos = pos;
+                           m_Index = index;
+                           m_IsOutdated = false;
                            m_pUp = m_pRight = m_pDown = m_pLeft = m_pUpRight = m_pRightDown = m_pDownLeft = m_pLeftUp = 0;
                            // Costs are infinite unless recalculated as otherwise
                            m_UpCost = m_RightCost = m_DownCost = m_LeftCost = m_UpRightCost = m_RightDownCost = m_DownLeftCost = m_LeftUpCost = FLT_MAX; }
+
+    // Adjacent node in a Direction
+    PathNode * GetAdjacent(int direction) const { PathNode * const apAdjacent[DIRECTIONCOUNT] = { m_pUp, m_pRight, m_pDown, m_pLeft, m_pUpRight, m_pRightDown, m_pDownLeft, m_pLeftUp }; return apAdjacent[direction]; }
+    // Copies all the costs to and from an array of DIRECTIONCOUNT floats
+    void GetCosts(float *pCosts) const { pCosts[UP] = m_UpCost; pCosts[RIGHT] = m_RightCost; pCosts[DOWN] = m_DownCost; pCosts[LEFT] = m_LeftCost;
+                                         pCosts[UPRIGHT] = m_UpRightCost; pCosts[RIGHTDOWN] = m_RightDownCost; pCosts[DOWNLEFT] = m_DownLeftCost; pCosts[LEFTUP] = m_LeftUpCost; }
+    void SetCosts(const float *pCosts) { m_UpCost = pCosts[UP]; m_RightCost = pCosts[RIGHT]; m_DownCost = pCosts[DOWN]; m_LeftCost = pCosts[LEFT];
+                                         m_UpRightCost = pCosts[UPRIGHT]; m_RightDownCost = pCosts[RIGHTDOWN]; m_DownLeftCost = pCosts[DOWNLEFT]; m_LeftUpCost = pCosts[LEFTUP]; }
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Struct:          PathNodeCosts
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     The costs going out from one PathNode, for handing them over to the
+//                  background path worker.
+// Parent(s):       None.
+// Class history:   10/17/2026 PathNodeCosts created.
+
+struct PathNodeCosts
+{
+    // PathNode::m_Index of the node
+    int m_NodeIndex;
+    // Costs in PathNode::Direction order
+    float m_Costs[PathNode::DIRECTIONCOUNT];
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Class:           PathGraphSnapshot
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     A copy of the node grid of a PathFinder, with its own pather, which the
+//                  background path worker solves requests against while the sim thread
+//                  goes on changing the costs of the real grid. Long paths are found over
+//                  cluster graphs laid on top of the copy instead of node by node. Only
+//                  ever touched by the worker once made.
+// Parent(s):       Graph, a MicroPather pure abstract class.
+// Class history:   10/17/2026 PathGraphSnapshot created.
+
+class PathGraphSnapshot:
+    public Graph
+{
+
+public:
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Constructor:     PathGraphSnapshot
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Copies the positions, adjacency and costs of a node grid.
+// Arguments:       The node grid to copy.
+//                  The dimensions of the scene, and whether it wraps in either direction.
+//                  The block size that the node cache is allocated from.
+
+    PathGraphSnapshot(const std::vector<std::vector<PathNode *> > &nodeGrid, int sceneWidth, int sceneHeight, bool wrapsX, bool wrapsY, unsigned int allocate);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Destructor:      ~PathGraphSnapshot
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Destructor method used to clean up a PathGraphSnapshot.
+
+    virtual ~PathGraphSnapshot();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ApplyCosts
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Brings the costs of some nodes up to date with the real grid.
+// Arguments:       The new costs.
+// Return value:    None.
+
+    void ApplyCosts(const std::vector<PathNodeCosts> &costs);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Solve
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Finds the least difficult path between two nodes, with some costs
+//                  temporarily replaced for just this path.
+// Arguments:       The indices of the start and end nodes.
+//                  What material strength the search is capable of digging trough.
+//                  Costs to use instead of the current ones for this path only.
+//                  A vector which will be filled out with the positions of the nodes along
+//                  the path.
+//                  The total minimum difficulty cost of the path.
+// Return value:    Success or failure, expressed as SOLVED, NO_SOLUTION, or START_END_SAME.
+
+    int Solve(int startNode, int endNode, float digStrength, const std::vector<PathNodeCosts> &costPatch, std::vector<Vector> &nodePath, float &totalCostResult);
+
+
+    // Implementation of the abstract interface of Graph, the same as PathFinder's
+    virtual float LeastCostEstimate(void *pStartState, void *pEndState);
+    virtual void AdjacentCost(void *pState, std::vector<micropather::StateCost> *pAdjacentList);
+    virtual void PrintStateInfo(void *pState) { ; }
+
+
+    // A copied PathNode
+    struct SnapshotNode
+    {
+        Vector m_Pos;
+        // Indices of the adjacent nodes in PathNode::Direction order, -1 where there are none
+        int m_Adjacent[PathNode::DIRECTIONCOUNT];
+        float m_Costs[PathNode::DIRECTIONCOUNT];
+    };
+
+
+protected:
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetClusterGraph
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the cluster graph for a dig strength, making it if there isn't one
+//                  yet. Only a few are kept; the least recently used is dropped to make
+//                  room.
+// Arguments:       What material strength the paths are capable of digging trough.
+// Return value:    The cluster graph. Ownership is NOT transferred!
+
+    PathClusterGraph * GetClusterGraph(float digStrength);
+
+
+    // How many cluster graphs are kept at most; there's seldom more than a few different dig strengths around
+    static const int m_sMaxClusterGraphs;
+
+    // The copied nodes, never resized after creation so they can be used as pather states
+    std::vector<SnapshotNode> m_Nodes;
+    // The number of node columns and rows
+    int m_NodeXCount;
+    int m_NodeYCount;
+    // The scene dimensions and wrapping, kept here so the worker doesn't have to look at the scene
+    float m_SceneWidth;
+    float m_SceneHeight;
+    bool m_WrapsX;
+    bool m_WrapsY;
+    // What material strength the current search is capable of digging trough
+    float m_DigStrength;
+    // Whether costs have changed since the pather was last reset
+    bool m_PatherOutdated;
+    // The pather working on the copy. Owned.
+    MicroPather *m_pPather;
+    // The graphs for finding long paths over clusters of the copied nodes, one per dig strength, most recently used first. Owned.
+    std::list<PathClusterGraph *> m_ClusterGraphs;
+
+private:
+
+    // Disallow the use of some implicit methods.
+    PathGraphSnapshot(const PathGraphSnapshot &reference);
+    PathGraphSnapshot & operator=(const PathGraphSnapshot &rhs);
+
 };
 
 
@@ -86,6 +260,14 @@ class PathFinder:
 
 public:
 
+    // What became of a path request, as returned by TakePathResult
+    enum RequestState
+    {
+        REQUESTUNKNOWN = -1,
+        REQUESTPENDING = 0,
+        REQUESTDONE = 1
+    };
+
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // Constructor:     PathFinder
@@ -179,13 +361,117 @@ public:
 // Method:          RecalculateAreaCosts
 //////////////////////////////////////////////////////////////////////////////////////////
 // Description:     Recalculates the costs between all the nodes touching a list of specific
-//                  rectangular areas (which will be wrapped). Also resets the pather itself.
+//                  rectangular areas (which will be wrapped), along with any others still
+//                  queued by MarkAreasOutdated. Also resets the pather itself.
 // Arguments:       The list of Box:es representing the updated areas.
 // Return value:    None.
 
     void RecalculateAreaCosts(const std::list<Box> &boxList);
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          MarkAreasOutdated
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Queues all the nodes touching a list of specific rectangular areas
+//                  (which will be wrapped) to have their costs recalculated by
+//                  UpdateOutdatedCosts, without doing any of it yet.
+// Arguments:       The list of Box:es representing the updated areas.
+// Return value:    None.
+
+    void MarkAreasOutdated(const std::list<Box> &boxList);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          MarkAllOutdated
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Queues every node to have its costs recalculated by UpdateOutdatedCosts,
+//                  for spreading a full recalculation out over many frames.
+// Arguments:       None.
+// Return value:    None.
+
+    void MarkAllOutdated();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          UpdateOutdatedCosts
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Recalculates the costs of queued nodes, oldest first, until the queue
+//                  is empty or the time is up. At least one node is always done so the
+//                  queue keeps moving. Resets the pather if any costs changed, and hands
+//                  the new costs over to the background path worker.
+// Arguments:       How much time to spend, in ms. Negative means until the queue is empty.
+// Return value:    The number of nodes recalculated.
+
+    int UpdateOutdatedCosts(float timeBudget);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetOutdatedCount
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the number of nodes queued to have their costs recalculated.
+// Arguments:       None.
+// Return value:    The count.
+
+    int GetOutdatedCount() const { return m_OutdatedNodes.size(); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CalculateCostPatch
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Works out what the costs of all the nodes touching a list of areas
+//                  would be with the terrain as it is now, without changing them. Used
+//                  to have one path request see a temporary change of the terrain, like
+//                  a team's doors being open.
+// Arguments:       The list of Box:es representing the changed areas.
+//                  A vector to fill out with the costs.
+// Return value:    None.
+
+    void CalculateCostPatch(const std::list<Box> &boxList, std::vector<PathNodeCosts> &costPatch);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RequestPath
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Queues a path to be calculated by the background path worker, against
+//                  the node costs as they were last handed over to it. The result is
+//                  picked up later with TakePathResult.
+// Arguments:       Start and end positions on the scene to find the path between.
+//                  What material strength the search is capable of digging trough.
+//                  Costs to use instead of the current ones for this path only, as made
+//                  by CalculateCostPatch.
+// Return value:    The ID of the request, for TakePathResult. IDs are never reused, even
+//                  across PathFinders.
+
+    int RequestPath(Vector start, Vector end, float digStrength, const std::vector<PathNodeCosts> &costPatch);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          TakePathResult
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Picks up the result of a path request, if it's done.
+// Arguments:       The ID returned by RequestPath.
+//                  A list which will be filled out with waypoints between the start and
+//                  end, if done.
+//                  The total minimum difficulty cost calculated between the two points on
+//                  the scene, if done.
+//                  The MicroPather result, SOLVED, NO_SOLUTION, or START_END_SAME, if done.
+// Return value:    The RequestState. Once REQUESTDONE has been returned, the request is
+//                  forgotten and the same ID gives REQUESTUNKNOWN.
+
+    int TakePathResult(int requestID, std::list<Vector> &pathResult, float &totalCostResult, int &solveResult);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CancelPathRequest
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Forgets about a path request, whether done or not. Unknown IDs are
+//                  ignored.
+// Arguments:       The ID returned by RequestPath.
+// Return value:    None.
+
+    void CancelPathRequest(int requestID);
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          CalculatePath
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -241,11 +527,59 @@ public:
     virtual void PrintStateInfo(void *pState);
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   GetAdjacentCost
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the cost of going to an adjacent node for AdjacentCost, from the
+//                  strength of the material in between and the strength that can be dug
+//                  through.
+// Arguments:       The PathNode::Direction of the adjacent node.
+//                  The cost stored for the edge, ie the strongest material along it.
+//                  What material strength the search is capable of digging trough.
+// Return value:    The cost.
+
+    static float GetAdjacentCost(int direction, float strength, float digStrength);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   BuildPathResult
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Turns the node positions along a solved path into the list of
+//                  waypoints handed back, with the exact start and end points in place
+//                  of the approximate ones of the nodes.
+// Arguments:       The positions of the nodes along the path, if any.
+//                  The exact start and end points.
+//                  The list to fill out.
+// Return value:    None.
+
+    static void BuildPathResult(const std::vector<Vector> &nodePath, const Vector &start, const Vector &end, std::list<Vector> &pathResult);
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Protected member variable and method declarations
 
 protected:
 
+    // A path waiting for the background path worker
+    struct PathRequest
+    {
+        int m_ID;
+        Vector m_Start;
+        Vector m_End;
+        int m_StartNode;
+        int m_EndNode;
+        float m_DigStrength;
+        std::vector<PathNodeCosts> m_CostPatch;
+    };
+
+    // A path the background path worker is done with
+    struct PathResult
+    {
+        std::list<Vector> m_Path;
+        float m_TotalCost;
+        int m_SolveResult;
+    };
+
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          CostAlongLine
@@ -275,16 +609,50 @@ protected:
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
-// Method:          UpdateNodeCostsInBox
+// Method:          GetNodesInBox
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Helper function for finding all the nodes with cost edges crossed by
+//                  a specific box. It does NOT wrap the box coming in here, only
+//                  truncates it!
+// Arguments:       The Box of which all edges it touches should be found.
+//                  A vector to add the nodes to. Nodes may be added more than once.
+// Return value:    None.
+
+    void GetNodesInBox(Box &box, std::vector<PathNode *> &nodes);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetNodesInAreas
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Helper function for finding all the nodes with cost edges crossed by
+//                  a list of boxes, wrapping them as needed.
+// Arguments:       The list of Box:es.
+//                  A vector to add the nodes to. Nodes may be added more than once.
+// Return value:    None.
+
+    void GetNodesInAreas(const std::list<Box> &boxList, std::vector<PathNode *> &nodes);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          HandOverCosts
 //////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Helper function for updating all the values of cost edges crossed by
-//                  a specific box. This does NOT update the pather, which is required
-//                  before solving more paths after calling this. Also it does NOT wrap the
-//                  box coming in here, only truncates it!
-// Arguments:       The Box of which all edges it touches should be recalculated.
+// Description:     Queues the current costs of some nodes to be copied into the snapshot
+//                  the background path worker uses, before it solves its next request.
+// Arguments:       The nodes.
+// Return value:    None.
+
+    void HandOverCosts(const std::vector<PathNode *> &nodes);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          WorkerLoop
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     The function the background path worker runs until the PathFinder is
+//                  destroyed, solving requests in the order they were made.
+// Arguments:       None.
 // Return value:    None.
 
-    void UpdateNodeCostsInBox(Box &box);
+    void WorkerLoop();
 
 
     // The array of PathNodes representing the grid on the scene. The nodes are owned by this
@@ -295,6 +663,31 @@ protected:
     float m_DigStrenght;
     // The actual pathing object that does the pathfinding work. Owned.
     MicroPather *m_pPather;
+    // Nodes waiting to have their costs recalculated, oldest first. Each is only in here once, see PathNode::m_IsOutdated
+    std::deque<PathNode *> m_OutdatedNodes;
+
+    // The next request ID to hand out, shared by all PathFinders so IDs stay unique across scenes
+    static int m_sNextRequestID;
+    // The copy of the grid the background path worker solves against. Owned.
+    PathGraphSnapshot *m_pSnapshot;
+    // The background path worker
+    std::thread m_Worker;
+    // Guards all the request state below
+    std::mutex m_RequestMutex;
+    // Signalled when a request is made, or when the worker should quit
+    std::condition_variable m_RequestPosted;
+    // Requests not yet picked up by the worker, oldest first
+    std::deque<PathRequest> m_Requests;
+    // Finished requests not yet taken, by ID
+    std::map<int, PathResult> m_Results;
+    // The request the worker is on right now, or -1
+    int m_SolvingRequestID;
+    // Requests cancelled while the worker was on them, so their results are thrown away
+    std::set<int> m_CancelledRequests;
+    // Costs changed since the worker last looked, to be copied into its snapshot
+    std::vector<PathNodeCosts> m_CostHandOvers;
+    // Whether the worker has been told to exit
+    bool m_QuitWorker;
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,219 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// File:            RotatedSpriteCache.cpp
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Source file for the RotatedSpriteCache class.
+// Project:         Retro Terrain Engine
+// Author(s):
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Inclusions of header files
+
+#include "RotatedSpriteCache.h"
+#include <cmath>
+
+#include "allegro.h"
+
+using namespace std;
+
+namespace RTE
+{
+
+const int RotatedSpriteCache::m_MaxSpriteSize = 64;
+const int RotatedSpriteCache::m_ScaleSteps = 64;
+
+list<RotatedSpriteCache::CachedSprite> RotatedSpriteCache::m_sCachedSprites;
+unordered_map<RotatedSpriteCache::SpriteKey, list<RotatedSpriteCache::CachedSprite>::iterator, RotatedSpriteCache::SpriteKeyHash> RotatedSpriteCache::m_sSpriteIndex;
+long RotatedSpriteCache::m_sMemoryBudget = 32 * 1024 * 1024;
+long RotatedSpriteCache::m_sMemoryUsed = 0;
+unsigned long RotatedSpriteCache::m_sLookups[USERCOUNT] = { 0, 0, 0 };
+unsigned long RotatedSpriteCache::m_sHits[USERCOUNT] = { 0, 0, 0 };
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   GetRotatedSprite
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets a copy of a sprite frame rotated and scaled around a pivot point,
+//                  from the cache or by making and caching it.
+
+BITMAP * RotatedSpriteCache::GetRotatedSprite(BITMAP *pSprite, bool hFlipped, int pivotX, int pivotY, float angle, float scale, CacheUser user)
+{
+    if (m_sMemoryBudget <= 0 || !pSprite || bitmap_color_depth(pSprite) != 8 || pSprite->w > m_MaxSpriteSize || pSprite->h > m_MaxSpriteSize)
+        return 0;
+
+    SpriteKey key;
+    key.m_pSprite = pSprite;
+    key.m_HFlipped = hFlipped;
+    key.m_PivotX = pivotX;
+    key.m_PivotY = pivotY;
+    key.m_Angle = ((int)floorf(angle + 0.5f) % 256 + 256) % 256;
+    key.m_Scale = (int)floorf(scale * m_ScaleSteps + 0.5f);
+    if (key.m_Scale <= 0)
+        return 0;
+
+    // Halve the counts now and then so the hit ratio follows what is going on lately rather than all session
+    if (++m_sLookups[user] > (1 << 20))
+    {
+        m_sLookups[user] /= 2;
+        m_sHits[user] /= 2;
+    }
+
+    unordered_map<SpriteKey, list<CachedSprite>::iterator, SpriteKeyHash>::iterator indexItr = m_sSpriteIndex.find(key);
+    if (indexItr != m_sSpriteIndex.end())
+    {
+        m_sHits[user]++;
+        // Move it to the front as the most recently used
+        m_sCachedSprites.splice(m_sCachedSprites.begin(), m_sCachedSprites, indexItr->second);
+        return indexItr->second->m_pBitmap;
+    }
+
+    BITMAP *pRotated = RotateSprite(key);
+    if (!pRotated)
+        return 0;
+
+    long size = (long)pRotated->w * pRotated->h;
+    EvictToBudget(size);
+
+    CachedSprite cached;
+    cached.m_Key = key;
+    cached.m_pBitmap = pRotated;
+    m_sCachedSprites.push_front(cached);
+    m_sSpriteIndex[key] = m_sCachedSprites.begin();
+    m_sMemoryUsed += size;
+
+    return pRotated;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   SetMemoryBudget
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Sets how much memory the cached copies may use in total.
+
+void RotatedSpriteCache::SetMemoryBudget(long budget)
+{
+    m_sMemoryBudget = budget;
+    EvictToBudget(0);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   GetHitRatio
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets how many of the lookups for a draw mode were found in the cache,
+//                  since the last ResetStats.
+
+float RotatedSpriteCache::GetHitRatio(CacheUser user)
+{
+    return m_sLookups[user] > 0 ? (float)m_sHits[user] / (float)m_sLookups[user] : 0;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   ResetStats
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Resets the hit and lookup counts of all draw modes.
+
+void RotatedSpriteCache::ResetStats()
+{
+    for (int user = 0; user < USERCOUNT; ++user)
+    {
+        m_sLookups[user] = 0;
+        m_sHits[user] = 0;
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   FreeAll
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Frees all cached copies.
+
+void RotatedSpriteCache::FreeAll()
+{
+    for (list<CachedSprite>::iterator itr = m_sCachedSprites.begin(); itr != m_sCachedSprites.end(); ++itr)
+        destroy_bitmap(itr->m_pBitmap);
+
+    m_sCachedSprites.clear();
+    m_sSpriteIndex.clear();
+    m_sMemoryUsed = 0;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          operator()
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Hashes what a cached copy was made from.
+
+size_t RotatedSpriteCache::SpriteKeyHash::operator()(const SpriteKey &key) const
+{
+    size_t hash = reinterpret_cast<size_t>(key.m_pSprite) >> 4;
+    hash = hash * 31 + key.m_Angle;
+    hash = hash * 31 + (key.m_PivotX & 0xFFFF) + (key.m_PivotY << 16);
+    hash = hash * 31 + (key.m_HFlipped ? 1 : 0);
+    hash = hash * 31 + key.m_Scale;
+    return hash;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   RotateSprite
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Makes a new rotated copy of a sprite frame.
+
+BITMAP * RotatedSpriteCache::RotateSprite(const SpriteKey &key)
+{
+    BITMAP *pSprite = const_cast<BITMAP *>(key.m_pSprite);
+
+    // Make the copy large enough to hold the corner of the sprite farthest from the pivot at any angle
+    float reachX = MAX(fabs((float)key.m_PivotX), fabs((float)(pSprite->w - key.m_PivotX)));
+    float reachY = MAX(fabs((float)key.m_PivotY), fabs((float)(pSprite->h - key.m_PivotY)));
+    float scale = (float)key.m_Scale / (float)m_ScaleSteps;
+    int halfSize = (int)ceilf(sqrtf(reachX * reachX + reachY * reachY) * scale) + 1;
+
+    BITMAP *pRotated = create_bitmap_ex(8, halfSize * 2, halfSize * 2);
+    if (!pRotated)
+        return 0;
+    clear_to_color(pRotated, bitmap_mask_color(pRotated));
+
+    // Flip first, the same way MOSRotating::Draw does, so the pivot is in the same place
+    BITMAP *pSource = pSprite;
+    if (key.m_HFlipped)
+    {
+        pSource = create_bitmap_ex(8, pSprite->w, pSprite->h);
+        if (!pSource)
+        {
+            destroy_bitmap(pRotated);
+            return 0;
+        }
+        clear_to_color(pSource, bitmap_mask_color(pSource));
+        draw_sprite_h_flip(pSource, pSprite, 0, 0);
+    }
+
+    pivot_scaled_sprite(pRotated, pSource, halfSize, halfSize, key.m_PivotX, key.m_PivotY, itofix(key.m_Angle), ftofix(scale));
+
+    if (pSource != pSprite)
+        destroy_bitmap(pSource);
+
+    return pRotated;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   EvictToBudget
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Frees the least recently used copies until the cache is within budget.
+
+void RotatedSpriteCache::EvictToBudget(long roomNeeded)
+{
+    while (!m_sCachedSprites.empty() && m_sMemoryUsed + roomNeeded > m_sMemoryBudget)
+    {
+        CachedSprite &oldest = m_sCachedSprites.back();
+        m_sMemoryUsed -= (long)oldest.m_pBitmap->w * oldest.m_pBitmap->h;
+        m_sSpriteIndex.erase(oldest.m_Key);
+        destroy_bitmap(oldest.m_pBitmap);
+        m_sCachedSprites.pop_back();
+    }
+}
+
+} // namespace RTE
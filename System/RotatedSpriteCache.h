@@ -0,0 +1,205 @@
+#ifndef _RTEROTATEDSPRITECACHE_
+#define _RTEROTATEDSPRITECACHE_
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// File:            RotatedSpriteCache.h
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Header file for the RotatedSpriteCache class.
+// Project:         Retro Terrain Engine
+// Author(s):
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Inclusions of header files
+
+#include <list>
+#include <unordered_map>
+
+struct BITMAP;
+
+namespace RTE
+{
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Class:           RotatedSpriteCache
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     A bounded, least recently used cache of pre-rotated and scaled copies
+//                  of small sprite frames, so that the many gibs, shells and bits of
+//                  debris spinning through the same angles don't each need to be rotated
+//                  anew in every draw mode every frame. The copies are 8-bit, so they can
+//                  be drawn as they are for color, or with draw_character_ex for any
+//                  silhouette; one copy serves every draw mode.
+// Parent(s):       None.
+// Class history:   10/17/2026 RotatedSpriteCache created.
+
+class RotatedSpriteCache
+{
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Public member variable, method and friend function declarations
+
+public:
+
+    // What a rotated sprite is drawn as, for keeping separate hit counts
+    enum CacheUser
+    {
+        COLOR = 0,
+        MATERIAL,
+        MOID,
+        USERCOUNT
+    };
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   GetRotatedSprite
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets a copy of a sprite frame rotated and scaled around a pivot point,
+//                  from the cache or by making and caching it. The angle is rounded to
+//                  the nearest whole Allegro angle unit, and the scale to the nearest
+//                  step of m_ScaleSteps per 1.0.
+// Arguments:       The sprite frame to rotate. Must stay loaded as long as the cache.
+//                  Whether the sprite is to be flipped horizontally before rotating.
+//                  The pivot point on the sprite, or on the flipped sprite if flipped.
+//                  The Allegro angle to rotate by, 256 being a full turn.
+//                  The scale to draw at.
+//                  What the copy is going to be drawn as.
+// Return value:    The rotated copy, with the pivot point in its exact middle, ie at
+//                  (w / 2, h / 2). Zero if the cache is disabled or the sprite is too
+//                  large to be worth caching; it should then be rotated as usual.
+//                  Ownership is NOT transferred!
+
+    static BITMAP * GetRotatedSprite(BITMAP *pSprite, bool hFlipped, int pivotX, int pivotY, float angle, float scale, CacheUser user);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   SetMemoryBudget
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Sets how much memory the cached copies may use in total. The least
+//                  recently used copies are freed to stay within it.
+// Arguments:       The budget, in bytes. 0 disables the cache.
+// Return value:    None.
+
+    static void SetMemoryBudget(long budget);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   GetMemoryUsed
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets how much memory the cached copies use now.
+// Arguments:       None.
+// Return value:    The memory used, in bytes.
+
+    static long GetMemoryUsed() { return m_sMemoryUsed; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   GetHitRatio
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets how many of the lookups for a draw mode were found in the cache,
+//                  since the last ResetStats. The counts are halved every million or so
+//                  lookups, so this mostly reflects recent drawing.
+// Arguments:       What the copies were drawn as.
+// Return value:    The ratio of hits to lookups, 0 - 1.0. 0 if there have been none.
+
+    static float GetHitRatio(CacheUser user);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   ResetStats
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Resets the hit and lookup counts of all draw modes. SceneMan does
+//                  this whenever a scene is loaded.
+// Arguments:       None.
+// Return value:    None.
+
+    static void ResetStats();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   FreeAll
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Frees all cached copies. Must be done before the sprites they were
+//                  made from are destroyed, ie before ContentFile::FreeAllLoaded.
+// Arguments:       None.
+// Return value:    None.
+
+    static void FreeAll();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Protected member variable and method declarations
+
+protected:
+
+    // What a cached copy was made from
+    struct SpriteKey
+    {
+        const BITMAP *m_pSprite;
+        bool m_HFlipped;
+        int m_PivotX;
+        int m_PivotY;
+        // Whole Allegro angle units, 0 - 255
+        int m_Angle;
+        // Whole scale steps, m_ScaleSteps being 1.0
+        int m_Scale;
+
+        bool operator==(const SpriteKey &rhs) const { return m_pSprite == rhs.m_pSprite && m_HFlipped == rhs.m_HFlipped && m_PivotX == rhs.m_PivotX && m_PivotY == rhs.m_PivotY && m_Angle == rhs.m_Angle && m_Scale == rhs.m_Scale; }
+    };
+
+    struct SpriteKeyHash
+    {
+        size_t operator()(const SpriteKey &key) const;
+    };
+
+    // A cached copy and what it was made from
+    struct CachedSprite
+    {
+        SpriteKey m_Key;
+        BITMAP *m_pBitmap;
+    };
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   RotateSprite
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Makes a new rotated copy of a sprite frame.
+// Arguments:       What to make the copy from.
+// Return value:    The new copy. Ownership IS transferred!
+
+    static BITMAP * RotateSprite(const SpriteKey &key);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   EvictToBudget
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Frees the least recently used copies until the cache is within budget.
+// Arguments:       How much memory, in bytes, to leave room for besides the budget.
+// Return value:    None.
+
+    static void EvictToBudget(long roomNeeded);
+
+
+    // Sprites with a larger width or height than this aren't cached; they are few, big, and rotation steps would show
+    static const int m_MaxSpriteSize;
+    // How many steps the scale is rounded to per 1.0, so scale animations don't make a new copy every frame. Fine enough that the
+    // largest cached sprite is off by less than a pixel, about as much as the angle rounding makes it
+    static const int m_ScaleSteps;
+
+    // All cached copies, most recently used first
+    static std::list<CachedSprite> m_sCachedSprites;
+    // The same copies, by what they were made from
+    static std::unordered_map<SpriteKey, std::list<CachedSprite>::iterator, SpriteKeyHash> m_sSpriteIndex;
+    // How much memory the copies may use, and use now, in bytes
+    static long m_sMemoryBudget;
+    static long m_sMemoryUsed;
+    // Lookups and hits per draw mode since the last ResetStats
+    static unsigned long m_sLookups[USERCOUNT];
+    static unsigned long m_sHits[USERCOUNT];
+
+};
+
+} // namespace RTE
+
+#endif // File
@@ -0,0 +1,181 @@
+#ifndef _RTESHAREDDATA_
+#define _RTESHAREDDATA_
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// File:            SharedData.h
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Header file for the SharedData class template.
+// Project:         Retro Terrain Engine
+// Author(s):
+
+
+namespace RTE
+{
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Class template:  SharedData
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Holds a value which is shared by reference count between all copies of
+//                  it, and is only copied for real once one of them is changed; copy on
+//                  write. Meant for the preset data which instances cloned from a preset
+//                  almost never change, so each clone doesn't have to copy it all over.
+//                  The reference count isn't atomic, so copies of one value must only be
+//                  made and changed on one thread, like Entity:s are.
+// Parent(s):       None.
+// Class history:   10/17/2026 SharedData created.
+
+template <class Type>
+class SharedData
+{
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Public member variable, method and friend function declarations
+
+public:
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Constructor:     SharedData
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Constructor method used to instantiate an empty SharedData object in
+//                  system memory. Nothing is allocated until it's changed.
+// Arguments:       None.
+
+    SharedData(): m_pShared(0) { }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Constructor:     SharedData
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Copy constructor method used to instantiate a SharedData object
+//                  sharing the value of another.
+// Arguments:       The SharedData to share the value of.
+
+    SharedData(const SharedData &reference): m_pShared(reference.m_pShared) { if (m_pShared) { ++m_pShared->m_RefCount; } }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Destructor:      ~SharedData
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Destructor method used to let go of the shared value, which is deleted
+//                  with the last SharedData sharing it.
+// Arguments:       None.
+
+    ~SharedData() { Reset(); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Operator:        Assignment
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Lets go of the current value and shares the value of another instead.
+// Arguments:       The SharedData to share the value of.
+// Return value:    A reference to this.
+
+    SharedData & operator=(const SharedData &rhs)
+    {
+        if (rhs.m_pShared != m_pShared)
+        {
+            Reset();
+            m_pShared = rhs.m_pShared;
+            if (m_pShared)
+                ++m_pShared->m_RefCount;
+        }
+        return *this;
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Reset
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Lets go of the current value, leaving this empty.
+// Arguments:       None.
+// Return value:    None.
+
+    void Reset()
+    {
+        if (m_pShared && --m_pShared->m_RefCount == 0)
+            delete m_pShared;
+        m_pShared = 0;
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Get
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the value for reading.
+// Arguments:       None.
+// Return value:    The value, or an empty one if none has been made.
+
+    const Type & Get() const { return m_pShared ? m_pShared->m_Value : GetEmpty(); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Edit
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the value for changing. If it's shared with any other SharedData,
+//                  this gets its own copy of it first.
+// Arguments:       None.
+// Return value:    The value, owned by this alone.
+
+    Type & Edit()
+    {
+        if (!m_pShared)
+            m_pShared = new Shared();
+        else if (m_pShared->m_RefCount > 1)
+        {
+            --m_pShared->m_RefCount;
+            m_pShared = new Shared(m_pShared->m_Value);
+        }
+        return m_pShared->m_Value;
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsShared
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Shows whether the value is shared with any other SharedData.
+// Arguments:       None.
+// Return value:    Whether it's shared.
+
+    bool IsShared() const { return m_pShared && m_pShared->m_RefCount > 1; }
+
+
+    const Type & operator*() const { return Get(); }
+    const Type * operator->() const { return &Get(); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Private member variable and method declarations
+
+private:
+
+    // The value and how many SharedData:s share it
+    struct Shared
+    {
+        Shared(): m_RefCount(1) { }
+        Shared(const Type &value): m_Value(value), m_RefCount(1) { }
+
+        Type m_Value;
+        int m_RefCount;
+    };
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   GetEmpty
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the value read from all SharedData:s of this type which are empty.
+// Arguments:       None.
+// Return value:    An empty value.
+
+    static const Type & GetEmpty() { static const Type s_Empty; return s_Empty; }
+
+
+    // The shared value, 0 if empty
+    Shared *m_pShared;
+
+};
+
+} // namespace RTE
+
+#endif // File
@@ -0,0 +1,236 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// File:            SlabAllocator.cpp
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Source file for the SlabAllocator class.
+// Project:         Retro Terrain Engine
+// Author(s):
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Inclusions of header files
+
+#include "SlabAllocator.h"
+#include "Writer.h"
+#include <cstdlib>
+
+using namespace std;
+
+namespace RTE
+{
+
+const size_t SlabAllocator::m_sChunkAlignment = 16;
+const size_t SlabAllocator::m_sSlabAlignment = 64;
+const size_t SlabAllocator::m_sMinSlabSize = 16 * 1024;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Clear
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Clears all the member variables of this SlabAllocator, effectively
+//                  resetting the members of this abstraction level only.
+
+void SlabAllocator::Clear()
+{
+    m_ChunkStride = 0;
+    m_ChunksPerSlab = 0;
+    m_Slabs.clear();
+    m_SlabsByAddress.clear();
+    m_pCurrentSlab = 0;
+    m_FreeChunks = 0;
+    m_ChunksInUse = 0;
+    m_PeakChunksInUse = 0;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Create
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Makes the SlabAllocator ready for use.
+
+int SlabAllocator::Create(size_t chunkSize, int chunksPerSlab)
+{
+    if (chunkSize == 0)
+        return -1;
+
+    // Each free chunk holds the free list link in its first bytes
+    if (chunkSize < sizeof(void *))
+        chunkSize = sizeof(void *);
+    m_ChunkStride = (chunkSize + m_sChunkAlignment - 1) & ~(m_sChunkAlignment - 1);
+
+    m_ChunksPerSlab = chunksPerSlab > 0 ? chunksPerSlab : 1;
+    if (m_ChunkStride * m_ChunksPerSlab < m_sMinSlabSize)
+        m_ChunksPerSlab = (m_sMinSlabSize + m_ChunkStride - 1) / m_ChunkStride;
+
+    return 0;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Reserve
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Makes new slabs until at least a certain number of chunks are free.
+
+void SlabAllocator::Reserve(int freeChunks)
+{
+    while (IsCreated() && m_FreeChunks < freeChunks)
+    {
+        if (!AddSlab())
+            break;
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Allocate
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Hands out a free chunk, making a new slab if all are in use.
+
+void * SlabAllocator::Allocate()
+{
+    if (!IsCreated())
+        return 0;
+
+    // Keep packing the current slab until it runs out, then move on to the fullest one with room left
+    if (!m_pCurrentSlab || m_pCurrentSlab->m_FreeCount == 0)
+    {
+        m_pCurrentSlab = FindFullestFreeSlab();
+        if (!m_pCurrentSlab)
+            m_pCurrentSlab = AddSlab();
+        if (!m_pCurrentSlab)
+            return 0;
+    }
+
+    void *pChunk = m_pCurrentSlab->m_pFreeList;
+    m_pCurrentSlab->m_pFreeList = *reinterpret_cast<void **>(pChunk);
+    m_pCurrentSlab->m_FreeCount--;
+    m_FreeChunks--;
+
+    if (++m_ChunksInUse > m_PeakChunksInUse)
+        m_PeakChunksInUse = m_ChunksInUse;
+
+    return pChunk;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Deallocate
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Puts a chunk handed out by Allocate back on its slab's free list.
+
+bool SlabAllocator::Deallocate(void *pChunk)
+{
+    if (!pChunk || m_SlabsByAddress.empty())
+        return false;
+
+    // The slab with the highest start address at or below the chunk
+    char *pAddress = static_cast<char *>(pChunk);
+    map<char *, Slab *>::iterator itr = m_SlabsByAddress.upper_bound(pAddress);
+    if (itr == m_SlabsByAddress.begin())
+        return false;
+    --itr;
+
+    Slab *pSlab = itr->second;
+    size_t offset = pAddress - pSlab->m_pChunks;
+    if (offset >= GetSlabSize() || offset % m_ChunkStride != 0)
+        return false;
+
+    *reinterpret_cast<void **>(pChunk) = pSlab->m_pFreeList;
+    pSlab->m_pFreeList = pChunk;
+    pSlab->m_FreeCount++;
+    m_FreeChunks++;
+    m_ChunksInUse--;
+
+    return true;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetPartialSlabCount
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the number of slabs that are neither full nor empty.
+
+int SlabAllocator::GetPartialSlabCount() const
+{
+    int partialCount = 0;
+    for (vector<Slab *>::const_iterator itr = m_Slabs.begin(); itr != m_Slabs.end(); ++itr)
+    {
+        if ((*itr)->m_FreeCount > 0 && (*itr)->m_FreeCount < m_ChunksPerSlab)
+            ++partialCount;
+    }
+    return partialCount;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          DumpInfo
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Writes the slab count and size, how full the slabs are, and how many
+//                  are partially used, all on the current line.
+
+void SlabAllocator::DumpInfo(Writer &fileWriter) const
+{
+    int capacity = m_Slabs.size() * m_ChunksPerSlab;
+    int occupancy = capacity > 0 ? (100 * m_ChunksInUse) / capacity : 0;
+    int peakOccupancy = capacity > 0 ? (100 * m_PeakChunksInUse) / capacity : 0;
+
+    fileWriter << ", Slabs: " << (int)m_Slabs.size() << " x " << (int)GetSlabSize() << " bytes (" << m_ChunksPerSlab << " each)";
+    fileWriter << ", Occupancy: " << occupancy << "% (peak " << peakOccupancy << "%)";
+    fileWriter << ", Partial slabs: " << GetPartialSlabCount();
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          AddSlab
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Makes a new slab with all its chunks free.
+
+SlabAllocator::Slab * SlabAllocator::AddSlab()
+{
+    void *pRawMemory = malloc(GetSlabSize() + m_sSlabAlignment - 1);
+    if (!pRawMemory)
+        return 0;
+
+    Slab *pSlab = new Slab;
+    pSlab->m_pRawMemory = pRawMemory;
+    pSlab->m_pChunks = reinterpret_cast<char *>((reinterpret_cast<size_t>(pRawMemory) + m_sSlabAlignment - 1) & ~(m_sSlabAlignment - 1));
+
+    // Link up the free list so chunks are handed out in address order
+    pSlab->m_pFreeList = 0;
+    for (int i = m_ChunksPerSlab - 1; i >= 0; --i)
+    {
+        void *pChunk = pSlab->m_pChunks + i * m_ChunkStride;
+        *reinterpret_cast<void **>(pChunk) = pSlab->m_pFreeList;
+        pSlab->m_pFreeList = pChunk;
+    }
+    pSlab->m_FreeCount = m_ChunksPerSlab;
+
+    m_Slabs.push_back(pSlab);
+    m_SlabsByAddress[pSlab->m_pChunks] = pSlab;
+    m_FreeChunks += m_ChunksPerSlab;
+
+    return pSlab;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          FindFullestFreeSlab
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Finds the slab with the fewest free chunks left, but at least one.
+
+SlabAllocator::Slab * SlabAllocator::FindFullestFreeSlab() const
+{
+    Slab *pFullest = 0;
+    for (vector<Slab *>::const_iterator itr = m_Slabs.begin(); itr != m_Slabs.end(); ++itr)
+    {
+        if ((*itr)->m_FreeCount > 0 && (!pFullest || (*itr)->m_FreeCount < pFullest->m_FreeCount))
+        {
+            pFullest = *itr;
+            // Can't do better than one left
+            if (pFullest->m_FreeCount == 1)
+                break;
+        }
+    }
+    return pFullest;
+}
+
+} // namespace RTE
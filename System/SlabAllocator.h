@@ -0,0 +1,266 @@
+#ifndef _RTESLABALLOCATOR_
+#define _RTESLABALLOCATOR_
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// File:            SlabAllocator.h
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Header file for the SlabAllocator class.
+// Project:         Retro Terrain Engine
+// Author(s):
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Inclusions of header files
+
+#include <cstddef>
+#include <vector>
+#include <map>
+
+namespace RTE
+{
+
+class Writer;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Class:           SlabAllocator
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Hands out fixed size chunks of memory carved from large, cache line
+//                  aligned slabs, so that instances of one class end up next to each
+//                  other in memory instead of strewn all over the heap. Each slab keeps
+//                  its own free list, and new chunks are taken from the fullest slab that
+//                  has any left, which keeps the live instances packed into few slabs.
+//                  Slabs are never given back to the system once made, same as the plain
+//                  pools this replaces.
+// Parent(s):       None.
+// Class history:   10/17/2026 SlabAllocator created.
+
+class SlabAllocator
+{
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Public member variable, method and friend function declarations
+
+public:
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Constructor:     SlabAllocator
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Constructor method used to instantiate a SlabAllocator object in system
+//                  memory. Create() should be called before using the object.
+// Arguments:       None.
+
+    SlabAllocator() { Clear(); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Create
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Makes the SlabAllocator ready for use. No slabs are made until needed.
+// Arguments:       The size in bytes of each chunk handed out.
+//                  The least number of chunks to fit in each slab. Small chunks get more,
+//                  so that no slab is smaller than a few pages.
+// Return value:    An error return value signaling sucess or any particular failure.
+//                  Anything below 0 is an error signal.
+
+    int Create(size_t chunkSize, int chunksPerSlab);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsCreated
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Shows whether this has been made ready for use.
+// Arguments:       None.
+// Return value:    Whether Create() has succeeded.
+
+    bool IsCreated() const { return m_ChunkStride > 0; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Reserve
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Makes new slabs until at least a certain number of chunks are free.
+// Arguments:       The number of chunks that should be free.
+// Return value:    None.
+
+    void Reserve(int freeChunks);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Allocate
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Hands out a free chunk, making a new slab if all are in use.
+// Arguments:       None.
+// Return value:    The chunk, or 0 if a new slab couldn't be made. OWNERSHIP IS TRANSFERRED!
+
+    void * Allocate();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Deallocate
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Puts a chunk handed out by Allocate back on its slab's free list.
+// Arguments:       The chunk. OWNERSHIP IS TRANSFERRED!
+// Return value:    Whether the chunk belonged to this.
+
+    bool Deallocate(void *pChunk);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetChunksInUse
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the number of chunks handed out and not yet given back.
+// Arguments:       None.
+// Return value:    The number of chunks in use.
+
+    int GetChunksInUse() const { return m_ChunksInUse; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetPeakChunksInUse
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the most chunks that have been in use at once.
+// Arguments:       None.
+// Return value:    The peak number of chunks in use.
+
+    int GetPeakChunksInUse() const { return m_PeakChunksInUse; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetSlabCount
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the number of slabs made so far.
+// Arguments:       None.
+// Return value:    The number of slabs.
+
+    int GetSlabCount() const { return m_Slabs.size(); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetPartialSlabCount
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the number of slabs that are neither full nor empty. Many of
+//                  these compared to the number of chunks in use means the live chunks
+//                  are spread thin.
+// Arguments:       None.
+// Return value:    The number of partially used slabs.
+
+    int GetPartialSlabCount() const;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetChunksPerSlab
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets how many chunks fit in each slab.
+// Arguments:       None.
+// Return value:    The number of chunks per slab.
+
+    int GetChunksPerSlab() const { return m_ChunksPerSlab; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetSlabSize
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the size in bytes of each slab.
+// Arguments:       None.
+// Return value:    The slab size.
+
+    size_t GetSlabSize() const { return m_ChunkStride * m_ChunksPerSlab; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          DumpInfo
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Writes the slab count and size, how full the slabs are, and how many
+//                  are partially used, all on the current line.
+// Arguments:       The writer to write info to.
+// Return value:    None.
+
+    void DumpInfo(Writer &fileWriter) const;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Protected member variable and method declarations
+
+protected:
+
+    // One contiguous block of chunks
+    struct Slab
+    {
+        // What was actually malloc'd, before aligning
+        void *m_pRawMemory;
+        // The first chunk
+        char *m_pChunks;
+        // The free chunks, linked through their first bytes
+        void *m_pFreeList;
+        int m_FreeCount;
+    };
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          AddSlab
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Makes a new slab with all its chunks free.
+// Arguments:       None.
+// Return value:    The new slab, or 0 if the memory couldn't be allocated.
+
+    Slab * AddSlab();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          FindFullestFreeSlab
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Finds the slab with the fewest free chunks left, but at least one.
+// Arguments:       None.
+// Return value:    The slab, or 0 if every slab is full.
+
+    Slab * FindFullestFreeSlab() const;
+
+
+    // Chunks are aligned to this within a slab, and slabs to a cache line
+    static const size_t m_sChunkAlignment;
+    static const size_t m_sSlabAlignment;
+    // Slabs are made at least this large in bytes, however few chunks they hold
+    static const size_t m_sMinSlabSize;
+
+    // The chunk size rounded up to m_sChunkAlignment
+    size_t m_ChunkStride;
+    int m_ChunksPerSlab;
+    // All slabs, in the order made
+    std::vector<Slab *> m_Slabs;
+    // The same slabs by the address of their first chunk, for finding which one a returned chunk belongs to
+    std::map<char *, Slab *> m_SlabsByAddress;
+    // The slab chunks are being taken from now
+    Slab *m_pCurrentSlab;
+    int m_FreeChunks;
+    int m_ChunksInUse;
+    int m_PeakChunksInUse;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Private member variable and method declarations
+
+private:
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Clear
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Clears all the member variables of this SlabAllocator, effectively
+//                  resetting the members of this abstraction level only.
+// Arguments:       None.
+// Return value:    None.
+
+    void Clear();
+
+
+    // Disallow the use of some implicit methods.
+    SlabAllocator(const SlabAllocator &reference);
+    SlabAllocator & operator=(const SlabAllocator &rhs);
+
+};
+
+} // namespace RTE
+
+#endif // File
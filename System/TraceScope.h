@@ -0,0 +1,89 @@
+#ifndef _RTETRACESCOPE_
+#define _RTETRACESCOPE_
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// File:            TraceScope.h
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Header file for the TraceScope class, and the profiling macros which
+//                  use it when the Slick Profiler isn't built in.
+// Project:         Retro Terrain Engine
+// Author(s):
+//
+//
+
+
+namespace RTE
+{
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Class:           TraceScope
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Measures the time from its construction to its destruction and records
+//                  it as an event of the trace TraceMan is capturing, if it's capturing
+//                  one. Otherwise it costs next to nothing, so it's made on the stack by the
+//                  SLICK_PROFILE macros around every interesting scope.
+// Parent(s):       None.
+// Class history:   10/17/2026 TraceScope created.
+
+class TraceScope
+{
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Public member variable, method and friend function declarations
+
+public:
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Constructor:     TraceScope
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Constructor method used to start measuring a scope.
+// Arguments:       The name of the function the scope is in. Must stay valid until the
+//                  trace is written, so a string literal or __FUNCTION__.
+//                  The name of the scope within the function, 0 if it's all of it. Must
+//                  stay valid just the same.
+
+    TraceScope(const char *function, const char *name);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Destructor:      ~TraceScope
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Destructor method used to record the scope as it ends.
+// Arguments:       None.
+
+    ~TraceScope();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Private member variable and method declarations
+
+private:
+
+    // The names of the function and the scope within it
+    const char *m_Function;
+    const char *m_Name;
+    // The absolute time the scope started in microseconds, -1 if no trace was being captured then
+    long long m_Start;
+
+    // Disallow the use of some implicit methods.
+    TraceScope(const TraceScope &reference);
+    TraceScope & operator=(const TraceScope &rhs);
+
+};
+
+} // namespace RTE
+
+
+// The Slick Profiler is Windows only, so everywhere else the same scopes are traced by TraceMan instead
+#ifndef PROFILER_ENABLED
+#undef SLICK_PROFILE
+#undef SLICK_PROFILENAME
+#undef SLICK_PROFILE_DYNAMIC_NAME
+#define SLICK_PROFILE(color) RTE::TraceScope _prof_obj_(__FUNCTION__, 0);
+#define SLICK_PROFILENAME(name, color) RTE::TraceScope _prof_obj_(__FUNCTION__, name);
+#define SLICK_PROFILE_DYNAMIC_NAME(name, colour) RTE::TraceScope _prof_obj(name, 0);
+#endif
+
+#endif // File